@@ -4,9 +4,16 @@
 #
 ###############################################################################
 
-## Variably define the channel count (MUST BE 1 TO 8 INCLUSIVE)
+## Variably define the channel count (MUST BE 1 TO max_board_count INCLUSIVE)
 set board_count 4
 
+## Number of board slots in the design (unused slots are tied off)
+# Sets the FIFO address map, buffer reset mask width and status register layout.
+# ----------------------------!!!!!!!!!!!!!!!!!!-------------------------------
+# This MUST match SHIM_MAX_BOARDS in software/shim-test/include/sys/shim_boards.h
+# ----------------------------!!!!!!!!!!!!!!!!!!-------------------------------
+set max_board_count 8
+
 
 ## Variably choose complexity of threshold module
 # Set to:
@@ -43,9 +50,16 @@ set trig_data_fifo_addr_width 10
 #
 ###############################################################################
 
-# If the board count is not 8, then error out
-if {$board_count < 1 || $board_count > 8} {
-  puts "Error: board_count must be between 1 and 8."
+# The HDL cores are still built for exactly 8 board slots (hw_manager's 3-bit board number and 8-bit status
+# inputs, axi_sys_ctrl's 17-bit buffer reset registers, shutdown_sense, spi_sts_sync and the board I/O ports)
+if {$max_board_count != 8} {
+  puts "Error: max_board_count must be 8 until the HDL cores are widened."
+  exit 1
+}
+
+# If the board count is out of range, then error out
+if {$board_count < 1 || $board_count > $max_board_count} {
+  puts "Error: board_count must be between 1 and $max_board_count."
   exit 1
 }
 
@@ -164,6 +178,7 @@ cell xilinx.com:ip:xlconstant:1.1 const_1 {
 
 ### Create processing system
 # Enable M_AXI_GP0 and M_AXI_GP1
+# Enable S_AXI_HP0 (64-bit) for the DAC command DMA engines
 # Enable UART1 on the correct MIO pins
 # UART1 baud rate 921600
 # Pullup for UART1 RX
@@ -178,6 +193,8 @@ init_ps ps {
   PCW_USE_M_AXI_GP0 1
   PCW_USE_M_AXI_GP1 1
   PCW_USE_S_AXI_ACP 0
+  PCW_USE_S_AXI_HP0 1
+  PCW_S_AXI_HP0_DATA_WIDTH 64
   PCW_UART1_PERIPHERAL_ENABLE 1
   PCW_UART1_UART1_IO {MIO 36 .. 37}
   PCW_UART1_BAUD_RATE 921600
@@ -195,6 +212,7 @@ init_ps ps {
 } {
   M_AXI_GP0_ACLK ps/FCLK_CLK0
   M_AXI_GP1_ACLK ps/FCLK_CLK0
+  S_AXI_HP0_ACLK ps/FCLK_CLK0
 }
 
 ## PS clock reset core
@@ -207,7 +225,7 @@ cell xilinx.com:ip:proc_sys_reset:5.0 ps_rst {} {
 ### AXI Smart Connect
 cell xilinx.com:ip:smartconnect:1.0 sys_cfg_axi_intercon {
   NUM_SI 1
-  NUM_MI 3
+  NUM_MI 4
 } {
   aclk ps/FCLK_CLK0
   S00_AXI ps/M_AXI_GP0
@@ -268,12 +286,12 @@ cell shim:user:hw_manager hw_manager {
 ## Shutdown sense
 # Set which shutdown sense channels are connected
 cell xilinx.com:ip:xlconcat:2.1 shutdown_sense_connected {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {}
 for {set i 0} {$i < $board_count} {incr i} {
   wire shutdown_sense_connected/In${i} const_1/dout
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire shutdown_sense_connected/In${i} const_0/dout
 }
 # Shutdown sense module
@@ -521,13 +539,63 @@ wire axi_spi_interface/trig_data_wr_en spi_clk_domain/trig_data_wr_en
 wire axi_spi_interface/trig_data_full spi_clk_domain/trig_data_full
 wire axi_spi_interface/trig_data_almost_full spi_clk_domain/trig_data_almost_full
 ## Address assignment
-# DAC and ADC FIFOs
+# DAC and ADC FIFOs (64 KB apart per board, below the trigger FIFOs)
+# Each FIFO gets a 4 KB window: every address in it aliases the FIFO, so bursts can stream through it
 for {set i 0} {$i < $board_count} {incr i} {
-  addr 0x800${i}0000 128 axi_spi_interface/dac_fifo_${i}_axi_bridge/S_AXI ps/M_AXI_GP1
-  addr 0x800${i}1000 128 axi_spi_interface/adc_fifo_${i}_axi_bridge/S_AXI ps/M_AXI_GP1
+  addr [format 0x%08X [expr {0x80000000 + $i * 0x10000}]] 4096 axi_spi_interface/dac_fifo_${i}_axi_bridge/S_AXI ps/M_AXI_GP1
+  addr [format 0x%08X [expr {0x80001000 + $i * 0x10000}]] 4096 axi_spi_interface/adc_fifo_${i}_axi_bridge/S_AXI ps/M_AXI_GP1
 }
 # Trigger command and data FIFOs
-addr 0x80100000 128 axi_spi_interface/trig_fifo_axi_bridge/S_AXI ps/M_AXI_GP1
+addr 0x80100000 4096 axi_spi_interface/trig_fifo_axi_bridge/S_AXI ps/M_AXI_GP1
+
+## DAC command DMA
+# One AXI DMA (MM2S only, scatter-gather) per board streams pre-encoded DAC commands from DDR into the
+# board's DAC command FIFO, so long waveforms play without the CPU refilling the FIFO.
+# Software keeps the waveforms and descriptor rings in reserved memory (see device_tree.dtsi and dac_dma.h).
+# Register access (GP0)
+cell xilinx.com:ip:smartconnect:1.0 dac_dma_cfg_axi_intercon {
+  NUM_SI 1
+  NUM_MI $board_count
+} {
+  aclk ps/FCLK_CLK0
+  S00_AXI sys_cfg_axi_intercon/M03_AXI
+  aresetn ps_rst/peripheral_aresetn
+}
+# Descriptor and data reads (HP0)
+cell xilinx.com:ip:smartconnect:1.0 dac_dma_mem_axi_intercon {
+  NUM_SI [expr {2 * $board_count}]
+  NUM_MI 1
+} {
+  aclk ps/FCLK_CLK0
+  M00_AXI ps/S_AXI_HP0
+  aresetn ps_rst/peripheral_aresetn
+}
+for {set i 0} {$i < $board_count} {incr i} {
+  cell xilinx.com:ip:axi_dma:7.1 dac_dma_$i {
+    c_include_sg 1
+    c_sg_length_width 23
+    c_sg_include_stscntrl_strm 0
+    c_include_mm2s 1
+    c_include_s2mm 0
+    c_m_axi_mm2s_data_width 32
+    c_m_axis_mm2s_tdata_width 32
+    c_mm2s_burst_size 16
+  } {
+    s_axi_lite_aclk ps/FCLK_CLK0
+    m_axi_sg_aclk ps/FCLK_CLK0
+    m_axi_mm2s_aclk ps/FCLK_CLK0
+    axi_resetn ps_rst/peripheral_aresetn
+    S_AXI_LITE dac_dma_cfg_axi_intercon/[format M%02d_AXI $i]
+    M_AXI_SG dac_dma_mem_axi_intercon/[format S%02d_AXI [expr {2 * $i}]]
+    M_AXI_MM2S dac_dma_mem_axi_intercon/[format S%02d_AXI [expr {2 * $i + 1}]]
+    M_AXIS_MM2S axi_spi_interface/dac_ch${i}_cmd_dma
+  }
+  # Registers 64 KB apart per board
+  addr [format 0x%08X [expr {0x40400000 + $i * 0x10000}]] 65536 dac_dma_$i/S_AXI_LITE ps/M_AXI_GP0
+  # Full 1 GB of DDR visible to both masters
+  addr 0x00000000 0x40000000 ps/S_AXI_HP0 dac_dma_$i/M_AXI_SG
+  addr 0x00000000 0x40000000 ps/S_AXI_HP0 dac_dma_$i/M_AXI_MM2S
+}
 
 ## AXI-domain over/underflow detection
 wire axi_spi_interface/dac_cmd_buf_overflow hw_manager/dac_cmd_buf_overflow
@@ -539,9 +607,15 @@ wire axi_spi_interface/trig_data_buf_underflow hw_manager/trig_data_buf_underflo
 
 ###############################################################################
 
-### Status register (4096 bits)
+### Status register (4096 bits for 8 boards)
+# 9 + 8 * max_board_count used 32-bit words, padded to a power of two
+set sts_used_width [expr {32 * (9 + 8 * $max_board_count)}]
+set sts_width 4096
+while {$sts_width < $sts_used_width} {
+  set sts_width [expr {$sts_width * 2}]
+}
 cell pavel-demin:user:axi_sts_register status_reg {
-  STS_DATA_WIDTH 4096
+  STS_DATA_WIDTH $sts_width
 } {
   aclk ps/FCLK_CLK0
   aresetn ps_rst/peripheral_aresetn
@@ -585,9 +659,9 @@ cell xilinx.com:ip:xlconcat:2.1 adc_min_delay_time_concat {
   In0 adc_timing_calc/min_delay_time
   In1 pad_7/dout
 }
-# 512 bytes (4096 bits)
-addr 0x40100000 512 status_reg/S_AXI ps/M_AXI_GP0
-## Concatenation
+# 512 bytes (4096 bits) for 8 boards
+addr 0x40100000 [expr {$sts_width / 8}] status_reg/S_AXI ps/M_AXI_GP0
+## Concatenation (bit ranges for max_board_count = 8; the per-board fields scale with it, see sys_sts.h)
 #  0    31 : 0    --  32b Hardware status code (31:29 board num, 28:4 status code, 3:0 internal state)
 #  1   575 : 32   -- 544b Command FIFO status (32 bits per buffer, ordered as DAC0, ADC0, ..., DAC7, ADC7, Trigger)
 #  2  1119 : 576  -- 544b Data FIFO status (32 bits per buffer, ordered as DAC0, ADC0, ..., DAC7, ADC7, Trigger)
@@ -601,7 +675,7 @@ addr 0x40100000 512 status_reg/S_AXI ps/M_AXI_GP0
 # 10  1823 : 1568 -- 256b ADC last received command (32 bits per channel, ordered as ADC0, ..., ADC7)
 # 11  2079 : 1824 -- 256b DAC commands since reset  (32 bits per channel, ordered as DAC0, ..., DAC7)
 # 12  2335 : 2080 -- 256b ADC commands since reset  (32 bits per channel, ordered as ADC0, ..., ADC7)
-# 13  4095 : 2336 -- RESERVED (zero-filled)
+# 13  4095 : 2336 -- RESERVED (zero-filled up to sts_width)
 cell xilinx.com:ip:xlconcat:2.1 sts_concat {
   NUM_PORTS 14
 } {
@@ -624,7 +698,7 @@ cell xilinx.com:ip:xlconcat:2.1 sts_concat {
 # Pad reserved bits
 cell xilinx.com:ip:xlconstant:1.1 pad_sts_reserved {
   CONST_VAL 0
-  CONST_WIDTH [expr {4096 - 2336}]
+  CONST_WIDTH [expr {$sts_width - $sts_used_width}]
 } {
   dout sts_concat/In13
 }
@@ -645,7 +719,7 @@ cell base:user:clock_gate spi_mosi_sck_gate {} {
   en hw_manager/spi_clk_gate
 }
 cell base:user:clock_gate spi_miso_sck_gate {
-  WIDTH 8
+  WIDTH $max_board_count
 } {
   en hw_manager/spi_clk_gate
   clk_o spi_clk_domain/miso_sck
@@ -0,0 +1,184 @@
+`timescale 1 ns / 1 ps
+
+module axi_burst_fifo_bridge #(
+  parameter integer AXI_ID_WIDTH   = 1,
+  parameter integer AXI_ADDR_WIDTH = 12,
+  parameter integer AXI_DATA_WIDTH = 32,
+  parameter         ENABLE_WRITE   = 1, // 1=enable AXI writes to FIFO
+  parameter         ENABLE_READ    = 1  // 1=enable AXI reads from FIFO
+)(
+  input  wire                       aclk,
+  input  wire                       wr_resetn,
+  input  wire                       rd_resetn,
+
+  // AXI4 subordinate interface
+  input  wire [AXI_ID_WIDTH-1:0]     s_axi_awid,    // AXI4 subordinate: Write address ID
+  input  wire [AXI_ADDR_WIDTH-1:0]   s_axi_awaddr,  // AXI4 subordinate: Write address (ignored)
+  input  wire [7:0]                  s_axi_awlen,   // AXI4 subordinate: Write burst length (beats - 1)
+  input  wire [2:0]                  s_axi_awsize,  // AXI4 subordinate: Write burst size (ignored)
+  input  wire [1:0]                  s_axi_awburst, // AXI4 subordinate: Write burst type (ignored)
+  input  wire                        s_axi_awvalid, // AXI4 subordinate: Write address valid
+  output wire                        s_axi_awready, // AXI4 subordinate: Write address ready
+  input  wire [AXI_DATA_WIDTH-1:0]   s_axi_wdata,   // AXI4 subordinate: Write data
+  input  wire [AXI_DATA_WIDTH/8-1:0] s_axi_wstrb,   // AXI4 subordinate: Write strobe (ignored)
+  input  wire                        s_axi_wlast,   // AXI4 subordinate: Write last beat
+  input  wire                        s_axi_wvalid,  // AXI4 subordinate: Write data valid
+  output wire                        s_axi_wready,  // AXI4 subordinate: Write data ready
+  output reg  [AXI_ID_WIDTH-1:0]     s_axi_bid,     // AXI4 subordinate: Write response ID
+  output reg  [1:0]                  s_axi_bresp,   // AXI4 subordinate: Write response
+  output reg                         s_axi_bvalid,  // AXI4 subordinate: Write response valid
+  input  wire                        s_axi_bready,  // AXI4 subordinate: Write response ready
+  input  wire [AXI_ID_WIDTH-1:0]     s_axi_arid,    // AXI4 subordinate: Read address ID
+  input  wire [AXI_ADDR_WIDTH-1:0]   s_axi_araddr,  // AXI4 subordinate: Read address (ignored)
+  input  wire [7:0]                  s_axi_arlen,   // AXI4 subordinate: Read burst length (beats - 1)
+  input  wire [2:0]                  s_axi_arsize,  // AXI4 subordinate: Read burst size (ignored)
+  input  wire [1:0]                  s_axi_arburst, // AXI4 subordinate: Read burst type (ignored)
+  input  wire                        s_axi_arvalid, // AXI4 subordinate: Read address valid
+  output wire                        s_axi_arready, // AXI4 subordinate: Read address ready
+  output reg  [AXI_ID_WIDTH-1:0]     s_axi_rid,     // AXI4 subordinate: Read data ID
+  output reg  [AXI_DATA_WIDTH-1:0]   s_axi_rdata,   // AXI4 subordinate: Read data
+  output reg  [1:0]                  s_axi_rresp,   // AXI4 subordinate: Read data response
+  output reg                         s_axi_rlast,   // AXI4 subordinate: Read last beat
+  output reg                         s_axi_rvalid,  // AXI4 subordinate: Read data valid
+  input  wire                        s_axi_rready,  // AXI4 subordinate: Read data ready
+
+  // FIFO write side
+  output wire [AXI_DATA_WIDTH-1:0]  fifo_wr_data,
+  output wire                       fifo_wr_en,
+  input  wire                       fifo_full,
+
+  // FIFO read side (first-word fall-through)
+  input  wire [AXI_DATA_WIDTH-1:0]  fifo_rd_data,
+  output wire                       fifo_rd_en,
+  input  wire                       fifo_empty,
+
+  // Underflow/overflow signals for the AXI side
+  output reg                        fifo_underflow,
+  output reg                        fifo_overflow
+);
+
+  // Validate parameters
+  initial begin
+    if (AXI_ID_WIDTH <= 0)
+      $error("Invalid value for AXI_ID_WIDTH parameter: %d. Must be greater than 0.", AXI_ID_WIDTH);
+    if (AXI_ADDR_WIDTH <= 0)
+      $error("Invalid value for AXI_ADDR_WIDTH parameter: %d. Must be greater than 0.", AXI_ADDR_WIDTH);
+    if (AXI_DATA_WIDTH <= 0 || AXI_DATA_WIDTH % 8 != 0)
+      $error("Invalid value for AXI_DATA_WIDTH parameter: %d. Must be greater than 0 and a multiple of 8.", AXI_DATA_WIDTH);
+    if (ENABLE_WRITE != 0 && ENABLE_WRITE != 1)
+      $error("Invalid value for ENABLE_WRITE parameter: %d. Must be 0 or 1.", ENABLE_WRITE);
+    if (ENABLE_READ != 0 && ENABLE_READ != 1)
+      $error("Invalid value for ENABLE_READ parameter: %d. Must be 0 or 1.", ENABLE_READ);
+  end
+
+  // Response signals
+  localparam RESP_OKAY = 2'b00;
+  localparam RESP_SLVERR = 2'b10;
+
+  // Burst states
+  localparam S_ADDR = 2'd0; // Waiting for an address
+  localparam S_DATA = 2'd1; // Moving burst beats
+  localparam S_RESP = 2'd2; // Write response pending
+
+
+  //// Write logic
+  // Every beat of a burst pushes into the FIFO, whatever its address, so a multi-word window aliases the FIFO.
+  // Beats that arrive while the FIFO is full (or writes are disabled) are still accepted, not allowed to hang,
+  // and dropped, and the burst gets an error response
+  reg  [1:0] wr_state;
+  reg        wr_error;
+  wire       wr_beat = (wr_state == S_DATA) && s_axi_wvalid;
+  wire       write_allowed = !fifo_full && ENABLE_WRITE;
+  assign s_axi_awready = (wr_state == S_ADDR);
+  assign s_axi_wready  = (wr_state == S_DATA);
+  assign fifo_wr_en    = wr_beat && write_allowed;
+  assign fifo_wr_data  = s_axi_wdata;
+
+  always @(posedge aclk) begin
+    if (!wr_resetn) begin
+      wr_state      <= S_ADDR;
+      wr_error      <= 1'b0;
+      s_axi_bid     <= {AXI_ID_WIDTH{1'b0}};
+      s_axi_bvalid  <= 1'b0;
+      s_axi_bresp   <= 2'b00;
+      fifo_overflow <= 1'b0; // Reset overflow flag on reset
+    end else begin
+      case (wr_state)
+        S_ADDR: if (s_axi_awvalid) begin
+          s_axi_bid <= s_axi_awid;
+          wr_error  <= 1'b0;
+          wr_state  <= S_DATA;
+        end
+        S_DATA: if (wr_beat) begin
+          if (!write_allowed) begin
+            wr_error <= 1'b1;
+            if (fifo_full) fifo_overflow <= 1'b1; // Indicate overflow if FIFO was trying to write when full
+          end
+          if (s_axi_wlast) begin
+            s_axi_bvalid <= 1'b1;
+            s_axi_bresp  <= (wr_error || !write_allowed) ? RESP_SLVERR : RESP_OKAY;
+            wr_state     <= S_RESP;
+          end
+        end
+        S_RESP: if (s_axi_bready) begin
+          s_axi_bvalid <= 1'b0;
+          wr_state     <= S_ADDR;
+        end
+        default: wr_state <= S_ADDR;
+      endcase
+    end
+  end
+
+
+  //// Read logic
+  // Every beat of a burst pops from the FIFO, whatever its address. Beats requested while the FIFO is empty
+  // (or reads are disabled) return zero data with an error response rather than stalling the burst
+  reg  [1:0] rd_state;
+  reg  [8:0] rd_beats_left; // Beats not yet loaded into the read data register
+  wire       rd_load = (rd_state == S_DATA) && (rd_beats_left != 0) && (!s_axi_rvalid || s_axi_rready);
+  wire       read_allowed = !fifo_empty && ENABLE_READ;
+  assign s_axi_arready = (rd_state == S_ADDR);
+  assign fifo_rd_en    = rd_load && read_allowed;
+
+  always @(posedge aclk) begin
+    if (!rd_resetn) begin
+      rd_state       <= S_ADDR;
+      rd_beats_left  <= 9'd0;
+      s_axi_rid      <= {AXI_ID_WIDTH{1'b0}};
+      s_axi_rvalid   <= 1'b0;
+      s_axi_rresp    <= 2'b00;
+      s_axi_rlast    <= 1'b0;
+      s_axi_rdata    <= {AXI_DATA_WIDTH{1'b0}};
+      fifo_underflow <= 1'b0; // Reset underflow flag on reset
+    end else begin
+      case (rd_state)
+        S_ADDR: if (s_axi_arvalid) begin
+          s_axi_rid     <= s_axi_arid;
+          rd_beats_left <= {1'b0, s_axi_arlen} + 9'd1;
+          rd_state      <= S_DATA;
+        end
+        S_DATA: begin
+          if (rd_load) begin
+            s_axi_rvalid  <= 1'b1;
+            s_axi_rlast   <= (rd_beats_left == 9'd1);
+            rd_beats_left <= rd_beats_left - 9'd1;
+            if (read_allowed) begin
+              s_axi_rdata <= fifo_rd_data;
+              s_axi_rresp <= RESP_OKAY;
+            end else begin
+              s_axi_rdata <= {AXI_DATA_WIDTH{1'b0}}; // Return zero data on error
+              s_axi_rresp <= RESP_SLVERR;
+              if (fifo_empty) fifo_underflow <= 1'b1; // Indicate underflow if FIFO was trying to read when empty
+            end
+          end else if (s_axi_rvalid && s_axi_rready) begin
+            s_axi_rvalid <= 1'b0;
+            s_axi_rlast  <= 1'b0;
+            if (s_axi_rlast) rd_state <= S_ADDR; // Last beat taken
+          end
+        end
+        default: rd_state <= S_ADDR;
+      endcase
+    end
+  end
+
+endmodule
@@ -37,8 +37,8 @@ module axis_fifo_bridge #(
 
   // Parameter validation
   initial begin
-    if (AXI_DATA_WIDTH <= 0 || AXI_DATA_WIDTH % 8 != 0)
-      $error("Invalid value for AXI_DATA_WIDTH parameter: %d. Must be greater than 0 and a multiple of 8.", AXI_DATA_WIDTH);
+    if (AXIS_DATA_WIDTH <= 0 || AXIS_DATA_WIDTH % 8 != 0)
+      $error("Invalid value for AXIS_DATA_WIDTH parameter: %d. Must be greater than 0 and a multiple of 8.", AXIS_DATA_WIDTH);
     if (ENABLE_WRITE != 0 && ENABLE_WRITE != 1)
       $error("Invalid value for ENABLE_WRITE parameter: %d. Must be 0 or 1.", ENABLE_WRITE);
     if (ENABLE_READ != 0 && ENABLE_READ != 1)
@@ -0,0 +1,35 @@
+`timescale 1 ns / 1 ps
+
+module fifo_write_merge #(
+  parameter integer DATA_WIDTH = 32
+)(
+  // Priority write port (never held off beyond the FIFO's own full flag)
+  input  wire [DATA_WIDTH-1:0] pri_wr_data,
+  input  wire                  pri_wr_en,
+  output wire                  pri_full,
+
+  // Secondary write port (sees full while the priority port is writing)
+  input  wire [DATA_WIDTH-1:0] sec_wr_data,
+  input  wire                  sec_wr_en,
+  output wire                  sec_full,
+
+  // Merged FIFO write side
+  output wire [DATA_WIDTH-1:0] fifo_wr_data,
+  output wire                  fifo_wr_en,
+  input  wire                  fifo_full
+);
+
+  // Validate parameters
+  initial begin
+    if (DATA_WIDTH <= 0)
+      $error("Invalid value for DATA_WIDTH parameter: %d. Must be greater than 0.", DATA_WIDTH);
+  end
+
+  // The secondary writer is expected to gate its write enable with its full flag (as a blocking AXIS bridge
+  // does), so it simply waits out any cycle the priority writer takes
+  assign pri_full     = fifo_full;
+  assign sec_full     = fifo_full || pri_wr_en;
+  assign fifo_wr_en   = pri_wr_en || (sec_wr_en && !sec_full);
+  assign fifo_wr_data = pri_wr_en ? pri_wr_data : sec_wr_data;
+
+endmodule
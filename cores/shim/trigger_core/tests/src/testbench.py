@@ -297,6 +297,132 @@ async def test_force_trig_cmd(dut):
     data_buf_task.kill()
     data_buf_scoreboard_task.kill()
 
+@cocotb.test()
+async def test_periodic_cmd(dut):
+    tb = await setup_testbench(dut)
+    tb.dut._log.info("STARTING TEST: test_periodic_cmd")
+
+    # First have the DUT at a known state
+    await tb.reset()
+
+    # Start monitor_cmd_done and monitor_state_transitions tasks
+    monitor_cmd_done_task = cocotb.start_soon(tb.monitor_cmd_done())
+    monitor_state_transitions_task = cocotb.start_soon(tb.monitor_state_transitions())
+
+    # Actual Reset
+    await tb.reset()
+
+    cmd_list = []
+
+    # Command to set the period to the minimum
+    cmd_list.append(tb.periodic_command_word_generator(False, tb.TRIGGER_PERIOD_MIN))
+
+    # Command to emit 5 logged triggers at the minimum period
+    cmd_list.append(tb.periodic_command_word_generator(True, 5, log=True))
+
+    # Command to set a longer period, then emit a single logged trigger
+    cmd_list.append(tb.periodic_command_word_generator(False, 8))
+    cmd_list.append(tb.periodic_command_word_generator(True, 1, log=True))
+
+    # Give the log words room, then run infinite periodic triggers until cancelled
+    cmd_list.append(tb.command_word_generator(4, 10))
+    cmd_list.append(tb.periodic_command_word_generator(True, 0, log=True))
+    cmd_list.append(tb.command_word_generator(7, 0))
+
+    # Command to set the period with an invalid value
+    cmd_list.append(tb.periodic_command_word_generator(False, tb.TRIGGER_PERIOD_MIN - 1))
+
+    # Start the command buffer model, data buffer model and trig timer tracker
+    await RisingEdge(dut.clk)
+    cmd_buf_task = cocotb.start_soon(tb.command_buf_model())
+    data_buf_task = cocotb.start_soon(tb.data_buf_model())
+    trig_timer_task = cocotb.start_soon(tb.trig_timer_tracker())
+
+    # Start the scoreboard to monitor command execution
+    scoreboard_executing_cmd_task = cocotb.start_soon(tb.executing_command_scoreboard(len(cmd_list)))
+
+    # Send the commands to the command buffer
+    await tb.send_commands(cmd_list)
+    await scoreboard_executing_cmd_task
+
+    # Start data buffer scoreboard to check the expected trigger timing data
+    data_buf_scoreboard_task = cocotb.start_soon(tb.data_buf_scoreboard())
+    await data_buf_scoreboard_task
+
+    # Give time before ending the test and ensure we don't collide with other tests
+    await RisingEdge(dut.clk)
+    await RisingEdge(dut.clk)
+    await RisingEdge(dut.clk)
+    await RisingEdge(dut.clk)
+    cmd_buf_task.kill()
+    monitor_cmd_done_task.kill()
+    monitor_state_transitions_task.kill()
+    scoreboard_executing_cmd_task.kill()
+    trig_timer_task.kill()
+    data_buf_task.kill()
+    data_buf_scoreboard_task.kill()
+
+@cocotb.test()
+async def test_delta_log(dut):
+    tb = await setup_testbench(dut)
+    tb.dut._log.info("STARTING TEST: test_delta_log")
+
+    # First have the DUT at a known state
+    await tb.reset()
+
+    # Start monitor_cmd_done and monitor_state_transitions tasks
+    monitor_cmd_done_task = cocotb.start_soon(tb.monitor_cmd_done())
+    monitor_state_transitions_task = cocotb.start_soon(tb.monitor_state_transitions())
+
+    # Actual Reset
+    await tb.reset()
+
+    cmd_list = []
+
+    # Command to reset the count and select delta logging
+    cmd_list.append(tb.command_word_generator(6, 1 << 28))
+
+    # Commands to log triggers at the minimum period, then more at a longer period
+    cmd_list.append(tb.periodic_command_word_generator(False, tb.TRIGGER_PERIOD_MIN))
+    cmd_list.append(tb.periodic_command_word_generator(True, 6, log=True))
+    cmd_list.append(tb.periodic_command_word_generator(False, 20))
+    cmd_list.append(tb.periodic_command_word_generator(True, 4, log=True))
+
+    # Command to go back to absolute logging, then log one forced trigger
+    cmd_list.append(tb.command_word_generator(4, 10))
+    cmd_list.append(tb.command_word_generator(6, 0))
+    cmd_list.append(tb.command_word_generator(5, 1 << 28))
+
+    # Start the command buffer model, data buffer model and trig timer tracker
+    await RisingEdge(dut.clk)
+    cmd_buf_task = cocotb.start_soon(tb.command_buf_model())
+    data_buf_task = cocotb.start_soon(tb.data_buf_model())
+    trig_timer_task = cocotb.start_soon(tb.trig_timer_tracker())
+
+    # Start the scoreboard to monitor command execution
+    scoreboard_executing_cmd_task = cocotb.start_soon(tb.executing_command_scoreboard(len(cmd_list)))
+
+    # Send the commands to the command buffer
+    await tb.send_commands(cmd_list)
+    await scoreboard_executing_cmd_task
+
+    # Start data buffer scoreboard to check the expected trigger timing data
+    data_buf_scoreboard_task = cocotb.start_soon(tb.data_buf_scoreboard())
+    await data_buf_scoreboard_task
+
+    # Give time before ending the test and ensure we don't collide with other tests
+    await RisingEdge(dut.clk)
+    await RisingEdge(dut.clk)
+    await RisingEdge(dut.clk)
+    await RisingEdge(dut.clk)
+    cmd_buf_task.kill()
+    monitor_cmd_done_task.kill()
+    monitor_state_transitions_task.kill()
+    scoreboard_executing_cmd_task.kill()
+    trig_timer_task.kill()
+    data_buf_task.kill()
+    data_buf_scoreboard_task.kill()
+
 @cocotb.test()
 async def test_cancel_cmd(dut):
     tb = await setup_testbench(dut)
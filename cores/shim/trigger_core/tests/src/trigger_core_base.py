@@ -9,11 +9,13 @@ import random
 class trigger_core_base:
 
     CMD_ENCODING = {
+        0: 'CMD_PERIODIC',
         1: 'CMD_SYNC_CH',
         2: 'CMD_SET_LOCKOUT',
         3: 'CMD_EXPECT_EXT_TRIG',
         4: 'CMD_DELAY',
         5: 'CMD_FORCE_TRIG',
+        6: 'CMD_RESET_COUNT',
         7: 'CMD_CANCEL'
     }
 
@@ -23,7 +25,8 @@ class trigger_core_base:
         2: 'S_SYNC_CH',
         3: 'S_EXPECT_TRIG',
         4: 'S_DELAY',
-        5: 'S_ERROR'
+        5: 'S_ERROR',
+        6: 'S_PERIODIC'
     }
 
     def __init__ (self, dut, clk_period=4, time_unit='ns'):
@@ -34,12 +37,15 @@ class trigger_core_base:
         # Parameters
         self.TRIGGER_LOCKOUT_DEFAULT = int(self.dut.TRIGGER_LOCKOUT_DEFAULT.value)
         self.TRIGGER_LOCKOUT_MIN = int(self.dut.TRIGGER_LOCKOUT_MIN.value)
+        self.TRIGGER_PERIOD_DEFAULT = int(self.dut.TRIGGER_PERIOD_DEFAULT.value)
+        self.TRIGGER_PERIOD_MIN = int(self.dut.TRIGGER_PERIOD_MIN.value)
         self.MAX_CMD_VALUE = 0x1FFFFFFF  # 29 bits for cmd_value
 
         # Initialize clock
         cocotb.start_soon(Clock(dut.clk, clk_period, time_unit).start(start_high=False))
 
         self.dut._log.info(f"TRIGGER_LOCKOUT_DEFAULT set to {self.TRIGGER_LOCKOUT_DEFAULT}")
+        self.dut._log.info(f"TRIGGER_PERIOD_DEFAULT set to {self.TRIGGER_PERIOD_DEFAULT}")
 
         # Initialize Input Signals
         self.dut.cmd_word.value = 0
@@ -57,7 +63,7 @@ class trigger_core_base:
         # Queue to keep track of current executing command in the DUT
         self.executing_cmd_queue = deque()
 
-        # For tracking expected trigger timing data
+        # For tracking expected trigger timing data (one tuple of data words per logged trigger)
         self.expected_trig_timer_list = []
 
     def get_state_name(self, state_value):
@@ -90,6 +96,9 @@ class trigger_core_base:
         # Check the expected output after reset
         assert int(self.dut.state.value) == 0, "DUT did not reset to initial state"
         assert int(self.dut.trig_lockout.value) == self.TRIGGER_LOCKOUT_DEFAULT, "Trigger lockout not set to default value"
+        assert int(self.dut.trig_period.value) == self.TRIGGER_PERIOD_DEFAULT, "Trigger period not set to default value"
+        assert int(self.dut.period_counter.value) == 0, "Period counter not reset to zero"
+        assert int(self.dut.periodic_trig_counter.value) == 0, "Periodic trigger counter not reset to zero"
         assert int(self.dut.trig_counter.value) == 0, "Trigger counter not reset to zero"
         assert int(self.dut.delay_counter.value) == 0, "Delay counter not reset to zero"
         assert int(self.dut.lockout_counter.value) == 0, "Lockout counter not reset to zero"
@@ -98,6 +107,8 @@ class trigger_core_base:
         assert int(self.dut.data_buf_overflow.value) == 0, "Data buffer overflow not reset to zero"
         assert int(self.dut.data_word_wr_en.value) == 0, "Data word read enable not reset to zero"
         assert int(self.dut.data_word.value) == 0, "Data word not reset to zero"
+        assert int(self.dut.delta_log.value) == 0, "Delta logging not reset to absolute"
+        assert int(self.dut.last_log_time.value) == 0, "Last log time not reset to zero"
 
     async def monitor_cmd_done(self):
         """Check if cmd_done signal is asserted when it should be."""
@@ -125,6 +136,11 @@ class trigger_core_base:
                 assert int(self.dut.cmd_done.value) == 1, \
                     f"cmd_done should be asserted when state is S_DELAY and delay_counter is 0, but got {int(self.dut.cmd_done.value)}"
 
+            # S_PERIODIC
+            if int(self.dut.state.value) == 6 and int(self.dut.period_counter.value) == 0 and int(self.dut.periodic_trig_counter.value) == 1:
+                assert int(self.dut.cmd_done.value) == 1, \
+                    f"cmd_done should be asserted on the last periodic trigger in S_PERIODIC, but got {int(self.dut.cmd_done.value)}"
+
             # S_ERROR
             if int(self.dut.state.value) != 5 and int(self.dut.cancel.value) == 1:
                 assert int(self.dut.cmd_done.value) == 1, \
@@ -153,10 +169,10 @@ class trigger_core_base:
                 assert int(self.dut.next_cmd_state.value) == 1, \
                     f"next_cmd_state should be S_IDLE when cmd_buf_empty is 1, but got {self.get_state_name(int(self.dut.next_cmd_state.value))}"
 
-            # next_cmd_state should be S_IDLE when cmd_type is CMD_CANCEL or CMD_FORCE_TRIG
-            elif int(self.dut.cmd_type.value) == 7 or int(self.dut.cmd_type.value) == 5:
+            # next_cmd_state should be S_IDLE when cmd_type is CMD_CANCEL, CMD_FORCE_TRIG or CMD_RESET_COUNT
+            elif int(self.dut.cmd_type.value) in (5, 6, 7):
                 assert int(self.dut.next_cmd_state.value) == 1, \
-                    f"next_cmd_state should be S_IDLE when cmd_type is CMD_CANCEL or CMD_FORCE_TRIG, but got {self.get_state_name(int(self.dut.next_cmd_state.value))}"
+                    f"next_cmd_state should be S_IDLE when cmd_type is CMD_CANCEL, CMD_FORCE_TRIG or CMD_RESET_COUNT, but got {self.get_state_name(int(self.dut.next_cmd_state.value))}"
 
             # next_cmd_state should be S_IDLE or S_ERROR if cmd_type is CMD_SET_LOCKOUT and cmd_val is above or equal to TRIGGER_LOCKOUT_MIN or below it respectively
             elif int(self.dut.cmd_type.value) == 2:
@@ -194,6 +210,17 @@ class trigger_core_base:
                     assert int(self.dut.next_cmd_state.value) == 1, \
                         f"next_cmd_state should be S_IDLE when cmd_type is CMD_DELAY and cmd_val is 0, but got {self.get_state_name(int(self.dut.next_cmd_state.value))}"
 
+            # next_cmd_state for CMD_PERIODIC: starting goes to S_PERIODIC (S_IDLE for a single trigger),
+            # setting the period goes to S_IDLE or S_ERROR if the period is at or above TRIGGER_PERIOD_MIN or below it respectively
+            elif int(self.dut.cmd_type.value) == 0:
+                periodic_start, periodic_value = self.periodic_value_decoder(int(self.dut.cmd_val.value))
+                if periodic_start:
+                    expected_state = 1 if periodic_value == 1 else 6
+                else:
+                    expected_state = 1 if periodic_value >= self.TRIGGER_PERIOD_MIN else 5
+                assert int(self.dut.next_cmd_state.value) == expected_state, \
+                    f"next_cmd_state should be {self.get_state_name(expected_state)} for CMD_PERIODIC with start={periodic_start} and value={periodic_value}, but got {self.get_state_name(int(self.dut.next_cmd_state.value))}"
+
             # next_cmd_state should be S_ERROR otherwise
             else:
                 assert int(self.dut.next_cmd_state.value) == 5, \
@@ -255,30 +282,47 @@ class trigger_core_base:
         cmd_value = cmd_word & 0x1FFFFFFF
         return cmd_type, cmd_value
 
+    def periodic_command_word_generator(self, start, value, log=False):
+        """
+        Generate a CMD_PERIODIC command word: set the period (start=False) or start periodic triggers (start=True).
+        """
+        cmd_value = (int(log) << 28) | (int(start) << 27) | (value & 0x7FFFFFF)
+        return self.command_word_generator(0, cmd_value)
+
+    def periodic_value_decoder(self, cmd_value):
+        """
+        Decode a CMD_PERIODIC command value into the start bit and the period or trigger count.
+        """
+        return (cmd_value >> 27) & 0x1, cmd_value & 0x7FFFFFF
+
     def random_command_word_generator(self, n):
         """
         Generates up to n random command words and returns them as a command list.
 
-        - If an unexpected command is generated or CMD_SET_LOCKOUT is generated with
-          an invalid value, that command is appended and generation stops (it is the
-          literal last command in the returned list).
+        - If an unexpected command (a CMD_PERIODIC set period below the minimum) is
+          generated or CMD_SET_LOCKOUT is generated with an invalid value, that command
+          is appended and generation stops (it is the literal last command in the
+          returned list).
         - Chance of unexpected commands are ~5%.
         """
         cmd_list = []
         if n == 0:
             return cmd_list
 
-        unexpected_prob = 0.05  # ~5% chance to produce an unexpected command (types 0 or 6)
+        unexpected_prob = 0.05  # ~5% chance to produce an unexpected command (invalid period)
 
         while len(cmd_list) < n:
             # Pick whether to generate an unexpected command
-            if random.random() < unexpected_prob:
-                cmd_type = random.choice([0, 6])  # unexpected types
+            is_unexpected = random.random() < unexpected_prob
+            if is_unexpected:
+                cmd_type = 0  # CMD_PERIODIC set period, below the minimum
             else:
-                cmd_type = random.choice([1, 2, 3, 4, 5, 7])  # expected types
+                cmd_type = random.choice([1, 2, 3, 4, 5, 6, 7])  # expected types
 
             # Generate cmd_value based on type
-            if cmd_type == 1:  # CMD_SYNC_CH
+            if is_unexpected:
+                cmd_value = random.randint(0, self.TRIGGER_PERIOD_MIN - 1)
+            elif cmd_type == 1:  # CMD_SYNC_CH
                 cmd_value = random.randint(0, self.MAX_CMD_VALUE)
             elif cmd_type == 2:  # CMD_SET_LOCKOUT
                 cmd_value = random.randint(0, 50)
@@ -288,17 +332,15 @@ class trigger_core_base:
                 cmd_value = random.randint(0, 50)
             elif cmd_type == 5:  # CMD_FORCE_TRIG
                 cmd_value = random.randint(0, self.MAX_CMD_VALUE)
-            elif cmd_type == 7:  # CMD_CANCEL
+            elif cmd_type == 6:  # CMD_RESET_COUNT
                 cmd_value = random.randint(0, self.MAX_CMD_VALUE)
-            else:
-                # unexpected command types
+            elif cmd_type == 7:  # CMD_CANCEL
                 cmd_value = random.randint(0, self.MAX_CMD_VALUE)
 
             cmd_word = self.command_word_generator(cmd_type, cmd_value)
             cmd_list.append(cmd_word)
 
             # If this command is unexpected or an invalid SET_LOCKOUT, stop generation
-            is_unexpected = cmd_type not in self.CMD_ENCODING
             is_invalid_lockout = (cmd_type == 2 and cmd_value < self.TRIGGER_LOCKOUT_MIN)
             if is_unexpected or is_invalid_lockout:
                 # This command must be the literal last command in cmd_list
@@ -364,7 +406,9 @@ class trigger_core_base:
                 task = None
                 command_i = commands_processed - 1
 
-                if cmd_type == 1:
+                if cmd_type == 0:
+                    task = cocotb.start_soon(self.cmd_periodic_scoreboard(cmd_value, command_i))
+                elif cmd_type == 1:
                     task = cocotb.start_soon(self.cmd_sync_ch_scoreboard(cmd_value, command_i))
                 elif cmd_type == 2:
                     task = cocotb.start_soon(self.cmd_set_lockout_scoreboard(cmd_value, command_i))
@@ -374,6 +418,8 @@ class trigger_core_base:
                     task = cocotb.start_soon(self.cmd_delay_scoreboard(cmd_value, command_i))
                 elif cmd_type == 5:
                     task = cocotb.start_soon(self.cmd_force_trig_scoreboard(cmd_value, command_i))
+                elif cmd_type == 6:
+                    task = cocotb.start_soon(self.cmd_reset_count_scoreboard(cmd_value, command_i))
                 elif cmd_type == 7:
                     task = cocotb.start_soon(self.cmd_cancel_scoreboard(cmd_value, command_i))
                 else:
@@ -582,6 +628,84 @@ class trigger_core_base:
         assert int(self.dut.state.value) == 1, \
             f"For command index:{command_i} State should be S_IDLE after FORCE_TRIG command, but got {self.get_state_name(int(self.dut.state.value))}"
 
+    async def cmd_periodic_scoreboard(self, cmd_value, command_i):
+        """ Scoreboard to verify PERIODIC command."""
+        periodic_start, periodic_value = self.periodic_value_decoder(cmd_value)
+
+        # Set period
+        if not periodic_start:
+            self.dut._log.info(f"Verifying PERIODIC set period command for command index:{command_i} with period {periodic_value}")
+            expected_period = periodic_value if periodic_value >= self.TRIGGER_PERIOD_MIN else int(self.dut.trig_period.value)
+
+            await RisingEdge(self.dut.clk)  # Wait one clock cycle for the period to be updated
+            await ReadOnly()
+            assert int(self.dut.trig_period.value) == expected_period, \
+                f"For command index:{command_i} Trigger period mismatch: expected {expected_period} but got {int(self.dut.trig_period.value)}"
+
+            if periodic_value < self.TRIGGER_PERIOD_MIN:
+                assert int(self.dut.state.value) == 5, \
+                    f"For command index:{command_i} State should be S_ERROR for invalid period value, but got {self.get_state_name(int(self.dut.state.value))}"
+                assert int(self.dut.bad_cmd.value) == 1, \
+                    f"For command index:{command_i} bad_cmd should be asserted for invalid period value, but got {int(self.dut.bad_cmd.value)}"
+            return
+
+        # Start periodic triggers: the first fires on the command, the rest exactly one period apart
+        self.dut._log.info(f"Verifying PERIODIC start command for command index:{command_i} with count {periodic_value}")
+        period = int(self.dut.trig_period.value)
+        assert int(self.dut.do_trig.value) == 1, "do_trig should be asserted immediately for PERIODIC start command"
+
+        num_of_trigs_done = 1
+        cycles_since_trig = 0
+        if periodic_value == 1:
+            await RisingEdge(self.dut.clk)
+            await ReadOnly()
+            assert int(self.dut.state.value) == 1, \
+                f"For command index:{command_i} State should be S_IDLE after a single periodic trigger, but got {self.get_state_name(int(self.dut.state.value))}"
+            return
+
+        while True:
+            await RisingEdge(self.dut.clk)
+            await ReadOnly()
+
+            # Cancel exit condition
+            if int(self.dut.cancel.value) == 1:
+                self.dut._log.info(f"For command index:{command_i} Command was cancelled after {num_of_trigs_done} periodic triggers.")
+                return
+
+            assert int(self.dut.state.value) == 6, \
+                f"For command index:{command_i} State should be S_PERIODIC, but got {self.get_state_name(int(self.dut.state.value))}"
+
+            cycles_since_trig += 1
+            expected_do_trig = 1 if cycles_since_trig == period else 0
+            assert int(self.dut.do_trig.value) == expected_do_trig, \
+                f"For command index:{command_i} do_trig should be {expected_do_trig} {cycles_since_trig} cycles after the last periodic trigger (period {period}), but got {int(self.dut.do_trig.value)}"
+
+            if expected_do_trig:
+                num_of_trigs_done += 1
+                cycles_since_trig = 0
+                if num_of_trigs_done == periodic_value:
+                    assert int(self.dut.cmd_done.value) == 1, \
+                        f"For command index:{command_i} cmd_done should be asserted on the last periodic trigger, but got {int(self.dut.cmd_done.value)}"
+                    self.dut._log.info(f"For command index:{command_i} All {num_of_trigs_done} periodic triggers are done.")
+                    break
+
+    async def cmd_reset_count_scoreboard(self, cmd_value, command_i):
+        """ Scoreboard to verify RESET_COUNT command."""
+        self.dut._log.info(f"Verifying RESET_COUNT command for command index:{command_i} with value {cmd_value}")
+        assert int(self.dut.reset_count.value) == 1, "reset_count should be asserted immediately for RESET_COUNT command"
+        expected_delta_log = (cmd_value >> 28) & 0x1
+
+        await RisingEdge(self.dut.clk)
+        await ReadOnly()
+        assert int(self.dut.trig_counter.value) == 0, \
+            f"For command index:{command_i} trig_counter should be 0 after RESET_COUNT command, but got {int(self.dut.trig_counter.value)}"
+        assert int(self.dut.trig_timer.value) == 0, \
+            f"For command index:{command_i} trig_timer should be 0 after RESET_COUNT command, but got {int(self.dut.trig_timer.value)}"
+        assert int(self.dut.last_log_time.value) == 0, \
+            f"For command index:{command_i} last_log_time should be 0 after RESET_COUNT command, but got {int(self.dut.last_log_time.value)}"
+        assert int(self.dut.delta_log.value) == expected_delta_log, \
+            f"For command index:{command_i} delta_log should be {expected_delta_log} after RESET_COUNT command, but got {int(self.dut.delta_log.value)}"
+
     async def cmd_cancel_scoreboard(self, cmd_value, command_i):
         """ Scoreboard to verify CANCEL command."""
         self.dut._log.info(f"Verifying CANCEL command for command index:{command_i} with value {cmd_value}")
@@ -635,28 +759,46 @@ class trigger_core_base:
     async def trig_timer_tracker(self):
         """Generate expected trigger timing data based on do_trig signal and store in a list for later comparison."""
         expected_trig_timer = 0
+        delta_log = False
+        last_log_time = 0
 
         while True:
             await RisingEdge(self.dut.clk)
             prev_do_trig = int(self.dut.do_trig.value)
+            prev_reset_count = int(self.dut.reset_count.value)
+            prev_cmd_log_trig = int(self.dut.cmd_log_trig.value)
 
             await ReadOnly()
-            sample_cond = int(self.dut.do_trig.value) == 1 and int(self.dut.data_buf_full.value) == 0 and int(self.dut.data_buf_almost_full.value) == 0
 
-            if prev_do_trig == 1 and expected_trig_timer == 0:
+            if prev_reset_count == 1:
+                # RESET_COUNT clears the timer and the delta base, and selects the logging format
+                expected_trig_timer = 0
+                last_log_time = 0
+                delta_log = prev_cmd_log_trig == 1
+            elif prev_do_trig == 1 and expected_trig_timer == 0:
                 expected_trig_timer = 1
             elif expected_trig_timer > 0:
                 expected_trig_timer += 1
 
+            # Absolute entries and long deltas take two words, short deltas one
+            delta = expected_trig_timer - last_log_time
+            one_word = delta_log and delta < (1 << 31)
+            has_room = int(self.dut.data_buf_full.value) == 0 and (one_word or int(self.dut.data_buf_almost_full.value) == 0)
+            sample_cond = int(self.dut.do_trig.value) == 1 and has_room
+
             if sample_cond:
-                first_data_word = expected_trig_timer & 0xFFFFFFFF
-                second_data_word = (expected_trig_timer >> 32) & 0xFFFFFFFF
-                await RisingEdge(self.dut.clk)
-                expected_trig_timer += 1
-                await RisingEdge(self.dut.clk)
-                expected_trig_timer += 1
-                self.dut._log.info(f"Expected Trigger Timing Data Generated: First Word:0x{first_data_word:08X}, Second Word:0x{second_data_word:08X}")
-                self.expected_trig_timer_list.append((first_data_word, second_data_word))
+                if not delta_log:
+                    data_words = (expected_trig_timer & 0xFFFFFFFF, (expected_trig_timer >> 32) & 0xFFFFFFFF)
+                elif one_word:
+                    data_words = (delta,)
+                else:
+                    data_words = ((1 << 31) | ((delta >> 32) & 0x7FFFFFFF), delta & 0xFFFFFFFF)
+                last_log_time = expected_trig_timer
+                for _word in data_words:
+                    await RisingEdge(self.dut.clk)
+                    expected_trig_timer += 1
+                self.dut._log.info(f"Expected Trigger Timing Data Generated: {', '.join(f'0x{word:08X}' for word in data_words)}")
+                self.expected_trig_timer_list.append(data_words)
 
 
     async def data_buf_scoreboard(self):
@@ -667,25 +809,23 @@ class trigger_core_base:
         self.dut._log.info("Starting data buffer scoreboard for trig_timer.")
         num_of_data_words_checked = 0
 
-        while 2*len(self.expected_trig_timer_list) > 0 or not self.data_buf.is_empty():
+        expected_words = deque()
+
+        while len(self.expected_trig_timer_list) > 0 or len(expected_words) > 0 or not self.data_buf.is_empty():
             await RisingEdge(self.dut.clk)
             await ReadOnly()
 
             read_data = int(self.data_buf.pop_item())
 
-            if num_of_data_words_checked % 2 == 0:
-                expected_first_word, expected_second_word = self.expected_trig_timer_list.pop(0)
+            if len(expected_words) == 0:
+                expected_words.extend(self.expected_trig_timer_list.pop(0))
+                word_i = 0
 
-            if num_of_data_words_checked % 2 == 0:
-                # First word
-                assert read_data == expected_first_word, \
-                    f"Data buffer mismatch on first word: expected 0x{expected_first_word:08X} but got 0x{read_data:08X}"
-                self.dut._log.info(f"Data buffer match on first word: 0x{read_data:08X}")
-            else:
-                # Second word
-                assert read_data == expected_second_word, \
-                    f"Data buffer mismatch on second word: expected 0x{expected_second_word:08X} but got 0x{read_data:08X}"
-                self.dut._log.info(f"Data buffer match on second word: 0x{read_data:08X}")
+            expected_word = expected_words.popleft()
+            assert read_data == expected_word, \
+                f"Data buffer mismatch on word {word_i} of a trigger entry: expected 0x{expected_word:08X} but got 0x{read_data:08X}"
+            self.dut._log.info(f"Data buffer match on word {word_i} of a trigger entry: 0x{read_data:08X}")
+            word_i += 1
 
             num_of_data_words_checked += 1
 
@@ -1,7 +1,8 @@
 `timescale 1 ns / 1 ps
 
 module trigger_core #(
-  parameter unsigned TRIGGER_LOCKOUT_DEFAULT = 10000000 // Default lockout period in clock cycles (e.g., 10000000 at 20 MHz SPI clock -> 0.5 seconds)
+  parameter unsigned TRIGGER_LOCKOUT_DEFAULT = 10000000, // Default lockout period in clock cycles (e.g., 10000000 at 20 MHz SPI clock -> 0.5 seconds)
+  parameter unsigned TRIGGER_PERIOD_DEFAULT = 20000 // Default periodic trigger period in clock cycles (e.g., 20000 at 20 MHz SPI clock -> 1 kHz)
 ) (
   input  wire        clk,
   input  wire        resetn,
@@ -31,10 +32,14 @@ module trigger_core #(
 
   // Trigger lockout minimum
   localparam [27:0] TRIGGER_LOCKOUT_MIN = 4;
+  // Periodic trigger period minimum (leaves room for the two log words between logged triggers)
+  localparam [26:0] TRIGGER_PERIOD_MIN = 4;
   // Validate parameters
   initial begin
     if (TRIGGER_LOCKOUT_DEFAULT < TRIGGER_LOCKOUT_MIN || TRIGGER_LOCKOUT_DEFAULT > 28'hFFFFFFF)
       $error("Invalid value for TRIGGER_LOCKOUT_DEFAULT parameter: %d. Must be between %d and %d.", TRIGGER_LOCKOUT_DEFAULT, TRIGGER_LOCKOUT_MIN, 28'hFFFFFFF);
+    if (TRIGGER_PERIOD_DEFAULT < TRIGGER_PERIOD_MIN || TRIGGER_PERIOD_DEFAULT > 27'h7FFFFFF)
+      $error("Invalid value for TRIGGER_PERIOD_DEFAULT parameter: %d. Must be between %d and %d.", TRIGGER_PERIOD_DEFAULT, TRIGGER_PERIOD_MIN, 27'h7FFFFFF);
   end
 
   // FSM states
@@ -44,8 +49,10 @@ module trigger_core #(
   localparam S_EXPECT_TRIG = 3'd3;
   localparam S_DELAY       = 3'd4;
   localparam S_ERROR       = 3'd5;
+  localparam S_PERIODIC    = 3'd6;
 
   // Command types
+  localparam CMD_PERIODIC        = 3'd0; // [27] selects: 0 = set period, 1 = periodic triggers
   localparam CMD_SYNC_CH         = 3'd1;
   localparam CMD_SET_LOCKOUT     = 3'd2;
   localparam CMD_EXPECT_EXT_TRIG = 3'd3;
@@ -69,12 +76,20 @@ module trigger_core #(
   wire [ 2:0] cmd_type = cmd_word[31:29];
   wire        cmd_log_trig = cmd_word[28];
   wire [27:0] cmd_val = cmd_word[27:0];
+  wire        cmd_periodic_start = cmd_word[27]; // Periodic command: start triggers (1) or set period (0)
+  wire [26:0] cmd_periodic_val = cmd_word[26:0];
 
   // Command execution
   reg  [27:0] delay_counter;
   reg  [27:0] lockout_counter;
   reg  [27:0] ext_trig_counter;
   reg  [27:0] trig_lockout;
+  reg  [26:0] trig_period;
+  reg  [26:0] period_counter;
+  reg  [26:0] periodic_trig_counter;
+  wire        set_period;
+  wire        start_periodic;
+  wire        periodic_trig;
   reg  ext_trig_sync[1:0]; // 2-stage synchronizer for external trigger
   reg  log_trig;
   wire do_log;
@@ -84,6 +99,16 @@ module trigger_core #(
   reg [63:0] trig_timer; // 64-bit timer to track trigger timing
   reg [31:0] second_word; // Second word to write to data buffer
   reg        trig_data_second_word; // Flag to indicate if the second word is being written
+  reg        trig_data_two_words; // Flag to indicate if the current log entry has a second word
+
+  // Delta logging (selected by RESET_COUNT with the log bit set)
+  reg        delta_log; // Log one word of delta since the last logged trigger instead of the absolute timer
+  reg [63:0] last_log_time; // Timer value of the last logged trigger
+  wire [63:0] log_delta = trig_timer - last_log_time;
+  wire        log_delta_long = |log_delta[63:31]; // Delta needs the two-word escape form
+  wire        log_one_word = delta_log && !log_delta_long;
+  wire        log_room = log_one_word ? !data_buf_full : (!data_buf_full && !data_buf_almost_full);
+  wire        log_write = do_log && log_room && !data_word_wr_en;
 
   // External trigger synchronization
   always @(posedge clk) begin
@@ -100,12 +125,17 @@ module trigger_core #(
   assign cancel = !cmd_buf_empty && cmd_type == CMD_CANCEL;
   assign reset_count = !cmd_buf_empty && cmd_type == CMD_RESET_COUNT;
   assign all_waiting = &dac_waiting_for_trig && &adc_waiting_for_trig;
+  // Periodic command decode and period expiry
+  assign set_period = do_next_cmd && cmd_type == CMD_PERIODIC && !cmd_periodic_start && cmd_periodic_val >= TRIGGER_PERIOD_MIN;
+  assign start_periodic = do_next_cmd && cmd_type == CMD_PERIODIC && cmd_periodic_start;
+  assign periodic_trig = state == S_PERIODIC && period_counter == 0;
 
   // Command done logic
   assign cmd_done = (state == S_IDLE && !cmd_buf_empty)
                   || (state == S_SYNC_CH && all_waiting)
                   || (state == S_EXPECT_TRIG && ext_trig_counter == 1 && lockout_counter == 0 && ext_trig_sync[1])
                   || (state == S_DELAY && delay_counter == 0)
+                  || (periodic_trig && periodic_trig_counter == 1) // Last periodic trigger
                   || (state != S_ERROR && cancel); // Allow cancel at any time
   assign do_next_cmd = cmd_done && !cmd_buf_empty;
   // Next state from upcoming command
@@ -117,6 +147,8 @@ module trigger_core #(
                           : (cmd_type == CMD_FORCE_TRIG) ? S_IDLE
                           : (cmd_type == CMD_RESET_COUNT) ? S_IDLE
                           : (cmd_type == CMD_CANCEL) ? S_IDLE
+                          : (cmd_type == CMD_PERIODIC && cmd_periodic_start) ? ((cmd_periodic_val != 1) ? S_PERIODIC : S_IDLE) // A single trigger goes right to idle
+                          : (cmd_type == CMD_PERIODIC) ? (cmd_periodic_val >= TRIGGER_PERIOD_MIN ? S_IDLE : S_ERROR) // Period must be at least the minimum
                           : S_ERROR;
   // State transition logic
   always @(posedge clk) begin
@@ -131,6 +163,23 @@ module trigger_core #(
     if (!resetn) trig_lockout <= TRIGGER_LOCKOUT_DEFAULT;
     else if (do_next_cmd && cmd_type == CMD_SET_LOCKOUT && cmd_val >= TRIGGER_LOCKOUT_MIN) trig_lockout <= cmd_val;
   end
+  // Set periodic trigger period
+  always @(posedge clk) begin
+    if (!resetn) trig_period <= TRIGGER_PERIOD_DEFAULT;
+    else if (set_period) trig_period <= cmd_periodic_val;
+  end
+  // Periodic triggers left, including the one firing now (0 is "infinite", until cancelled)
+  always @(posedge clk) begin
+    if (!resetn || cancel || state == S_ERROR) periodic_trig_counter <= 0;
+    else if (start_periodic) periodic_trig_counter <= (cmd_periodic_val == 0) ? 0 : cmd_periodic_val - 1; // The first trigger fires on the command
+    else if (periodic_trig) periodic_trig_counter <= (periodic_trig_counter == 0) ? 0 : periodic_trig_counter - 1;
+  end
+  // Period counter, reloaded on each periodic trigger so triggers are exactly trig_period cycles apart
+  always @(posedge clk) begin
+    if (!resetn || cancel || state == S_ERROR) period_counter <= 0;
+    else if (start_periodic || periodic_trig) period_counter <= trig_period - 1;
+    else if (period_counter > 0) period_counter <= period_counter - 1;
+  end
   // Expected trigger count (note that 0 will be treated as "infinite")
   always @(posedge clk) begin
     if (!resetn || cancel || state == S_ERROR) ext_trig_counter <= 0;
@@ -153,7 +202,9 @@ module trigger_core #(
   assign do_trig = (do_next_cmd && cmd_type == CMD_FORCE_TRIG) // Force trigger
                     || (do_next_cmd && cmd_type == CMD_SYNC_CH && all_waiting) // Sync channels edge case where all channels are already waiting
                     || (state == S_SYNC_CH && all_waiting) // Sync channels when all are waiting
-                    || (state == S_EXPECT_TRIG && lockout_counter == 0 && ext_trig_sync[1]); // External trigger when expected and lockout is done
+                    || (state == S_EXPECT_TRIG && lockout_counter == 0 && ext_trig_sync[1]) // External trigger when expected and lockout is done
+                    || start_periodic // First periodic trigger
+                    || periodic_trig; // Later periodic triggers
   always @(posedge clk) begin
     if (!resetn || state == S_ERROR) trig_out <= 0;
     else trig_out <= do_trig; // Trigger pulse
@@ -166,7 +217,9 @@ module trigger_core #(
   assign do_log = (do_next_cmd && cmd_type == CMD_FORCE_TRIG && cmd_log_trig) // Force trigger with logging
                   || (do_next_cmd && cmd_type == CMD_SYNC_CH && all_waiting && cmd_log_trig) // Sync channels edge case with logging
                   || (state == S_SYNC_CH && all_waiting && log_trig) // Sync channels with logging
-                  || (state == S_EXPECT_TRIG && lockout_counter == 0 && ext_trig_sync[1] && log_trig); // External trigger with logging
+                  || (state == S_EXPECT_TRIG && lockout_counter == 0 && ext_trig_sync[1] && log_trig) // External trigger with logging
+                  || (start_periodic && cmd_log_trig) // First periodic trigger with logging
+                  || (periodic_trig && log_trig); // Later periodic triggers with logging
 
   //// Error handling
   // Bad command
@@ -177,7 +230,7 @@ module trigger_core #(
   // Data buffer overflow
   always @(posedge clk) begin
     if (!resetn) data_buf_overflow <= 0;
-    else if (do_log && (data_buf_full || data_buf_almost_full)) data_buf_overflow <= 1;
+    else if (do_log && !log_room) data_buf_overflow <= 1;
   end
 
   //// Read enable
@@ -199,30 +252,52 @@ module trigger_core #(
     else if (trig_timer > 0 && trig_timer < 64'hFFFFFFFFFFFFFFFF) trig_timer <= trig_timer + 1; // Increment timer without overflow
   end
 
+  //// Delta logging
+  // Mode is latched by RESET_COUNT (log bit set: delta, clear: absolute)
+  always @(posedge clk) begin
+    if (!resetn) delta_log <= 0;
+    else if (reset_count) delta_log <= cmd_log_trig;
+  end
+  // Deltas are taken from the last trigger actually written, so a dropped log entry doesn't shift later times
+  always @(posedge clk) begin
+    if (!resetn || reset_count) last_log_time <= 0;
+    else if (log_write) last_log_time <= trig_timer;
+  end
+
   //// Data buffer write logic
-  // Write two sequential 32-bit words to the data buffer each trigger
+  // Absolute mode: write two sequential 32-bit words (timer low, then high) each trigger
+  // Delta mode: write one word {0, delta[30:0]}, or {1, delta[62:32]} then delta[31:0] if the delta needs more than 31 bits
   always @(posedge clk) begin
     if (!resetn) begin
       data_word_wr_en <= 0;
       data_word <= 32'h0;
       second_word <= 32'h0;
       trig_data_second_word <= 0;
+      trig_data_two_words <= 0;
     // If already writing a word
     end else if (data_word_wr_en) begin
-      // If already writing the second word, disable write and reset flag
-      if (trig_data_second_word) begin
-        data_word_wr_en <= 0; // Disable write after second word
+      // If already writing the second word (or the entry is one word), disable write and reset flag
+      if (trig_data_second_word || !trig_data_two_words) begin
+        data_word_wr_en <= 0; // Disable write after the last word
         trig_data_second_word <= 0; // Reset second word flag
       // If writing the first word, prepare to write the second word next cycle
       end else begin
         data_word <= second_word; // Write second word
         trig_data_second_word <= 1; // Set flag to write second word next cycle
       end
-    // Write first word on trigger if buffer has at least two free entries
-    end else if (do_log && !data_buf_full && !data_buf_almost_full) begin
+    // Write first word on trigger if buffer has room for the whole entry
+    end else if (log_write) begin
       data_word_wr_en <= 1;
-      data_word <= trig_timer[31:0]; // First word is the lower 32 bits of the timer
-      second_word <= trig_timer[63:32]; // Second word is the upper 32 bits of the timer
+      trig_data_two_words <= !log_one_word;
+      if (!delta_log) begin
+        data_word <= trig_timer[31:0]; // First word is the lower 32 bits of the timer
+        second_word <= trig_timer[63:32]; // Second word is the upper 32 bits of the timer
+      end else if (log_delta_long) begin
+        data_word <= {1'b1, log_delta[62:32]}; // Escape word with the upper delta bits
+        second_word <= log_delta[31:0]; // Second word is the lower 32 bits of the delta
+      end else begin
+        data_word <= {1'b0, log_delta[30:0]};
+      end
     end
   end
 
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""
+Random access to ADC data files by trigger number using the .idx sidecar
+written by shim-test (stream_adc_data_to_file with an ADC command file, and
+waveform_test).
+
+Index layout (little-endian):
+- Header (32 bytes): magic "SHIMADCI", version, board, binary flag, reserved,
+  entry count (uint64)
+- Entries (16 bytes each): byte offset (uint64), first frame (uint64)
+
+A frame is one 8-channel ADC read (16 bytes in binary files, one line in
+ASCII files). Entry 0 covers the frames read before the first trigger, and
+entry t (t >= 1) covers the frames read after trigger t, which is row t-1
+of the trigger data file. The last entry is an end-of-data sentinel.
+
+Usage:
+  adc_index.py <data_file> <trigger> [--trig <trigger_file>] [--index <index_file>]
+"""
+
+import os
+import sys
+import struct
+import argparse
+
+INDEX_MAGIC = b'SHIMADCI'
+INDEX_VERSION = 1
+HEADER = struct.Struct('<8sIIIIQ')
+ENTRY = struct.Struct('<QQ')
+ASCII_TRIGGER_LINE_BYTES = 19  # "0x" + 16 hex digits + newline
+
+
+class AdcIndex:
+    """Reader for an ADC trigger index sidecar. Each lookup is one seek."""
+
+    def __init__(self, index_path):
+        self.path = index_path
+        self.file = open(index_path, 'rb')
+        magic, version, board, binary, _, entry_count = HEADER.unpack(self.file.read(HEADER.size))
+        if magic != INDEX_MAGIC:
+            raise ValueError(f"{index_path} is not an ADC index file")
+        if version != INDEX_VERSION:
+            raise ValueError(f"{index_path} has unsupported version {version}")
+        if entry_count < 1:
+            raise ValueError(f"{index_path} was not finalized (stream still running or interrupted)")
+        self.board = board
+        self.binary = bool(binary)
+        self.entry_count = entry_count
+
+    @property
+    def trigger_count(self):
+        """Triggers with entries (entry 0, before the first trigger, is not counted)."""
+        return max(self.entry_count - 2, 0)
+
+    def lookup(self, trigger):
+        """Return (byte_offset, byte_length, first_frame, frame_count) for a trigger (0 = before the first)."""
+        if trigger < 0 or trigger + 1 >= self.entry_count:
+            raise IndexError(f"trigger {trigger} out of range (0-{self.trigger_count})")
+        self.file.seek(HEADER.size + trigger * ENTRY.size)
+        offset0, frame0 = ENTRY.unpack(self.file.read(ENTRY.size))
+        offset1, frame1 = ENTRY.unpack(self.file.read(ENTRY.size))
+        return offset0, offset1 - offset0, frame0, frame1 - frame0
+
+    def read_frames(self, data_path, trigger):
+        """Return the frames (lists of 8 int16 samples, in stream order) read after a trigger."""
+        offset, length, _, frame_count = self.lookup(trigger)
+        with open(data_path, 'rb') as f:
+            f.seek(offset)
+            raw = f.read(length)
+        if self.binary:
+            samples = struct.unpack(f'<{frame_count * 8}h', raw)
+            return [list(samples[i * 8:(i + 1) * 8]) for i in range(frame_count)]
+        return [[int(v) for v in line.split()] for line in raw.decode('ascii').splitlines()]
+
+    def close(self):
+        self.file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+def read_trigger_timestamp(trigger_path, trigger):
+    """Return the timestamp (clock cycles) of trigger t (1-based) from a binary or ASCII trigger file."""
+    with open(trigger_path, 'rb') as f:
+        head = f.read(2)
+        if head == b'0x':
+            f.seek((trigger - 1) * ASCII_TRIGGER_LINE_BYTES)
+            return int(f.read(ASCII_TRIGGER_LINE_BYTES).strip(), 16)
+        f.seek((trigger - 1) * 8)
+        data = f.read(8)
+        if len(data) != 8:
+            raise IndexError(f"trigger {trigger} is not in {trigger_path}")
+        return struct.unpack('<Q', data)[0]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Print the ADC frames recorded after a trigger')
+    parser.add_argument('data', help='ADC data file')
+    parser.add_argument('trigger', type=int, help='Trigger number (0 = before the first trigger)')
+    parser.add_argument('--index', help='Index file (default: <data>.idx)')
+    parser.add_argument('--trig', help='Trigger data file, to also print the trigger timestamp')
+    args = parser.parse_args()
+
+    index_path = args.index if args.index else args.data + '.idx'
+    if not os.path.isfile(index_path):
+        print(f"Error: index file {index_path} does not exist")
+        return 1
+
+    with AdcIndex(index_path) as index:
+        offset, length, first_frame, frame_count = index.lookup(args.trigger)
+        print(f"Board {index.board}, trigger {args.trigger}/{index.trigger_count}: "
+              f"{frame_count} frames from frame {first_frame} (bytes {offset}-{offset + length})")
+        if args.trig and args.trigger > 0:
+            print(f"Trigger timestamp: {read_trigger_timestamp(args.trig, args.trigger)} cycles")
+        for frame in index.read_frames(args.data, args.trigger):
+            print(' '.join(str(v) for v in frame))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""
+Decode a binary DAC or ADC debug capture written by shim-test into the same
+text the on-board decoders produce.
+
+DAC captures come from `stream_dac_debug <board> <file> --bin`; ADC debug
+words come from `stream_adc_data ... --bin` with the board's ADC debug bit set
+(`set_debug`).
+Both are raw little-endian 32-bit words. The top 4 bits of each word are the
+debug code; the field layouts mirror dac_decode_data and adc_decode_debug in
+software/shim-test/src/sys/{dac,adc}_ctrl.c.
+
+Usage:
+  debug_bin_decode.py {dac,adc} <capture.bin> [-o <out.txt>]
+"""
+
+import sys
+import struct
+import argparse
+
+DAC_STATES = {
+    0: 'RESET', 1: 'Init', 2: 'Test Write', 3: 'Request Read', 4: 'Test Read',
+    5: 'Set Midrange', 6: 'Idle', 7: 'Delay Wait', 8: 'Trigger Wait',
+    9: 'DAC Write', 10: 'DAC Write Channel', 11: 'Pre-Delay Wait', 15: 'ERROR',
+}
+DAC_SPI_CMDS = {0x0: 'NO_OP', 0x1: 'DAC_WR_LDAC_WAIT', 0x3: 'DAC_WR_IMMEDIATE', 0x9: 'REQ_RD'}
+
+ADC_STATES = {
+    0: 'RESET', 1: 'Init', 2: 'Set OTF mode', 3: 'Request Read', 4: 'Test Read',
+    5: 'Idle', 6: 'Delay Wait', 7: 'Trigger Wait', 8: 'ADC Read',
+    9: 'ADC Read Channel', 15: 'ERROR',
+}
+ADC_CMDS = {0: 'NO_OP', 1: 'SET_ORD', 2: 'ADC_RD', 3: 'ADC_RD_CH', 7: 'CANCEL'}
+
+
+def signed16(value):
+    return value - 0x10000 if value & 0x8000 else value
+
+
+def state_name(states, code):
+    return states.get(code, f'Unknown State: {code}')
+
+
+def decode_dac(word):
+    code = (word >> 28) & 0xF
+    if code == 1:
+        return f'Debug: MISO Data = 0x{word & 0xFFFF:04X}'
+    if code == 2:
+        return (f'Debug: State Transition from {state_name(DAC_STATES, (word >> 4) & 0xF)} '
+                f'to {state_name(DAC_STATES, word & 0xF)}')
+    if code == 3:
+        return f'Debug: n_cs Timer = {word & 0x0FFF}'
+    if code == 4:
+        return f'Debug: SPI Bit Counter = {word & 0x1F}'
+    if code == 5:
+        spi_cmd = DAC_SPI_CMDS.get((word >> 20) & 0xF, 'Unknown Command')
+        return (f'Debug: DAC SPI Word Writing = 0x{word & 0xFFFFFF:06X}\n'
+                f'  Command: {spi_cmd} to Register: {(word >> 16) & 0xF}, Data: {word & 0xFFFF:05d}')
+    if code == 8:
+        return f'Calibration: Channel {(word >> 16) & 0x7} = {signed16(word & 0xFFFF)}'
+    return f'Data: Unknown code {code} with value 0x{word:08x}'
+
+
+def decode_adc(word):
+    code = (word >> 28) & 0xF
+    command = ADC_CMDS.get((word >> 19) & 0x7, 'Unknown Command')
+    if code == 1:
+        return f'Debug: Startup test MISO Data = 0x{word & 0xFFFF:04x} (signed: {signed16(word & 0xFFFF)})'
+    if code == 2:
+        return (f'Debug: State Transition from {state_name(ADC_STATES, (word >> 4) & 0xF)} '
+                f'to {state_name(ADC_STATES, word & 0xF)}')
+    if code == 3:
+        repeat = 'set' if (word >> 16) & 0x1 else 'clear'
+        return f'Debug: Repeat (Count = {word & 0xFFFF}) command {command} with Repeat Bit {repeat}'
+    if code == 4:
+        return f'Debug: Starting ~CS timer with value = {word & 0x0FFF}'
+    if code == 5:
+        return f'Debug: Starting SPI command at bit = {word & 0x1F}'
+    if code == 6:
+        if (word >> 22) & 0x1:
+            return (f'Debug: Command Done with next command ready: {command} -- '
+                    f'Remaining repeat count: {word & 0xFFFF}')
+        return f'Debug: Command Done with no next command ready -- Remaining repeat count: {word & 0xFFFF}'
+    return f'Debug: Unknown code {code} with value 0x{word:08x}'
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode a binary shim-test DAC/ADC debug capture')
+    parser.add_argument('kind', choices=['dac', 'adc'], help='Which core produced the capture')
+    parser.add_argument('capture', help='Raw 32-bit word capture (--bin)')
+    parser.add_argument('-o', '--output', help='Write decoded text here instead of stdout')
+    args = parser.parse_args()
+
+    with open(args.capture, 'rb') as f:
+        data = f.read()
+    if len(data) % 4 != 0:
+        print(f"Warning: {args.capture} ends with a partial word ({len(data) % 4} bytes ignored)",
+              file=sys.stderr)
+    decode = decode_dac if args.kind == 'dac' else decode_adc
+
+    out = open(args.output, 'w') if args.output else sys.stdout
+    try:
+        for i, (word,) in enumerate(struct.iter_unpack('<I', data[:len(data) - len(data) % 4])):
+            out.write(f'[{i}] {decode(word)}\n')
+    finally:
+        if out is not sys.stdout:
+            out.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
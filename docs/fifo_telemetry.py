@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""
+Read a FIFO fill-level telemetry dump written by shim-test
+(`fifo_telemetry_dump`, or automatically when the hardware leaves the running
+state) and print per-FIFO fill statistics, optionally exporting CSV.
+
+Layout (little-endian), see software/shim-test/include/commands/fifo_telemetry.h:
+- Header (168 bytes for 8 boards): magic "SHIMFIFO", version, header size,
+  record size, FIFO count, sample rate, dump reason, sample count, samples
+  lost to ring wrap, CLOCK_REALTIME start time, FIFO ids, FIFO depths (one
+  slot per FIFO the build supports, 4 per board + 2, 34 for 8 boards)
+- Record: uint64 t_ns (since sampling started), uint32 hardware status,
+  uint16 word count per FIFO in header order
+
+FIFO ids: board b DAC command 4b, DAC data 4b+1, ADC command 4b+2, ADC data
+4b+3; then trigger command and trigger data (32 and 33 for 8 boards).
+
+Usage:
+  fifo_telemetry.py <dump_file> [--csv <out.csv>]
+"""
+
+import sys
+import struct
+import argparse
+
+MAGIC = b'SHIMFIFO'
+VERSION = 1
+PREFIX = struct.Struct('<8sIIIIIIQQQ')
+REASONS = {0: 'on demand', 1: 'hardware halt'}
+KINDS = ['DAC cmd', 'DAC data', 'ADC cmd', 'ADC data']
+
+
+def fifo_slots(header_bytes):
+    """FIFO id/depth slots in a header of header_bytes (4 per board + 2, laid out as in fifo_telemetry.h)."""
+    for slots in range(6, 256, 4):
+        if (PREFIX.size + slots + 6 + 2 * slots + 4 + 7) // 8 * 8 == header_bytes:
+            return slots
+    raise ValueError(f"unexpected header size {header_bytes}")
+
+
+def fifo_name(fifo_id, slots):
+    if fifo_id == slots - 2:
+        return 'Trig cmd'
+    if fifo_id == slots - 1:
+        return 'Trig data'
+    return f'{KINDS[fifo_id % 4]} {fifo_id // 4}'
+
+
+def read_dump(path):
+    """Return (header dict, [(t_ns, hw_status, [counts])])."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    (magic, version, header_bytes, record_bytes, fifo_count, rate_hz, reason,
+     sample_count, overwritten, start_realtime_ns) = PREFIX.unpack_from(data, 0)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError(f"{path} is not a version {VERSION} FIFO telemetry dump")
+    slots = fifo_slots(header_bytes)
+    ids = data[PREFIX.size:PREFIX.size + slots]
+    depths = struct.unpack_from(f'<{slots}H', data, PREFIX.size + slots + 6)
+    record = struct.Struct(f'<QI{fifo_count}H')
+    if record_bytes != record.size:
+        raise ValueError(f"{path} has unexpected record size {record_bytes}")
+    header = {
+        'rate_hz': rate_hz,
+        'reason': REASONS.get(reason, str(reason)),
+        'overwritten': overwritten,
+        'start_realtime_ns': start_realtime_ns,
+        'fifo_slots': slots,
+        'fifo_id': list(ids[:fifo_count]),
+        'fifo_depth': list(depths[:fifo_count]),
+    }
+    records = []
+    for i in range(sample_count):
+        r = record.unpack_from(data, header_bytes + i * record_bytes)
+        records.append((r[0], r[1], list(r[2:])))
+    return header, records
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Summarize a shim-test FIFO telemetry dump')
+    parser.add_argument('dump', help='Dump file written by fifo_telemetry_dump')
+    parser.add_argument('--csv', help='Also write t_ns, hw_status and every FIFO count to this CSV file')
+    args = parser.parse_args()
+
+    header, records = read_dump(args.dump)
+    names = [fifo_name(i, header['fifo_slots']) for i in header['fifo_id']]
+    print(f"{len(records)} samples at {header['rate_hz']} Hz ({header['reason']}), "
+          f"{header['overwritten']} earlier samples overwritten")
+    if records:
+        print(f"  {'FIFO':<10} {'Depth':>6} {'Min':>6} {'Mean':>8} {'Max':>6} {'Headroom':>9} {'Empty':>7}")
+        for i, name in enumerate(names):
+            counts = [r[2][i] for r in records]
+            depth = header['fifo_depth'][i]
+            empty = 100.0 * sum(1 for c in counts if c == 0) / len(counts)
+            print(f"  {name:<10} {depth:>6} {min(counts):>6} {sum(counts) / len(counts):>8.1f} "
+                  f"{max(counts):>6} {depth - max(counts):>9} {empty:>6.1f}%")
+
+    if args.csv:
+        with open(args.csv, 'w') as f:
+            f.write(','.join(['t_ns', 'hw_status'] + [n.replace(' ', '_') for n in names]) + '\n')
+            for t_ns, hw_status, counts in records:
+                f.write(','.join([str(t_ns), f'0x{hw_status:08X}'] + [str(c) for c in counts]) + '\n')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""
+Generate large DAC waveform (.wfm) and ADC command files for shim-test's
+`parse_bench` command.
+
+The DAC file alternates triggered writes with delayed writes of all 8
+channels; the ADC file sets a channel order and then alternates triggered and
+delayed reads with repeat counts. Comment and blank lines are sprinkled in so
+the parser's skip paths are exercised too.
+
+Usage:
+  gen_parse_bench_files.py <out_prefix> [--lines N] [--seed S]
+  (writes <out_prefix>.wfm and <out_prefix>_adc.txt)
+"""
+
+import sys
+import random
+import argparse
+
+
+def write_dac(path, lines, rng):
+    with open(path, 'w') as f:
+        f.write('# parse_bench DAC waveform\n')
+        for i in range(lines):
+            if i % 1000 == 999:
+                f.write('\n# block %d\n' % (i // 1000))
+            vals = ' '.join(str(rng.randint(-32767, 32767)) for _ in range(8))
+            if i % 100 == 0:
+                f.write(f'T 1 {vals}\n')
+            elif i % 50 == 0:
+                f.write('ND 2000\n')
+            else:
+                f.write(f'D {rng.randint(500, 5000)} {vals}\n')
+
+
+def write_adc(path, lines, rng):
+    with open(path, 'w') as f:
+        f.write('# parse_bench ADC commands\n')
+        f.write('O 0 1 2 3 4 5 6 7\n')
+        for i in range(lines - 1):
+            if i % 1000 == 999:
+                f.write('\n# block %d\n' % (i // 1000))
+            if i % 100 == 0:
+                f.write(f'T 1 {rng.randint(0, 10)}\n')
+            elif i % 50 == 0:
+                f.write('NT 1\n')
+            else:
+                f.write(f'D {rng.randint(500, 5000)} {rng.randint(0, 100)}\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate large command files for parse_bench')
+    parser.add_argument('out_prefix', help='Output path prefix')
+    parser.add_argument('--lines', type=int, default=2000000, help='Commands per file (default 2000000)')
+    parser.add_argument('--seed', type=int, default=1, help='Random seed')
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    write_dac(args.out_prefix + '.wfm', args.lines, rng)
+    write_adc(args.out_prefix + '_adc.txt', args.lines, rng)
+    print(f'Wrote {args.out_prefix}.wfm and {args.out_prefix}_adc.txt ({args.lines} commands each)')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""
+Read live ADC and trigger data from the shared-memory ring that shim-test
+publishes to after `live_ring_open` (/dev/shm/rev_d_shim_live).
+
+Each ADC board and the trigger stream has its own ring with one producer (the
+stream thread) and any number of readers. Readers never block the producer:
+a reader that falls a full ring behind skips ahead and counts the records it
+lost.
+
+Layout (little-endian), see software/shim-test/include/commands/live_ring.h:
+- Header: magic "SHIMLIVE", version, header size, segment size, record
+  sizes, offset of the control blocks, offsets of the ADC rings (one per
+  board the build supports, SHIM_MAX_BOARDS; the count follows from the
+  header size) and the trigger ring
+- Control block per ring (64 bytes): head sequence number, stream number,
+  capacity
+- ADC record (64 bytes): seq, stream, board, frame, trigger, publish_ns,
+  8 int16 samples
+- Trigger record (40 bytes): seq, stream, trigger, timestamp, publish_ns
+
+ADC records with trigger == t were read after the trigger record with
+trigger == t (0 = before the first trigger; UINT64_MAX = alignment unknown
+because the ADC stream was started without an ADC command file).
+
+Usage:
+  live_ring.py [--board <board>] [--trig] [--all]
+"""
+
+import sys
+import mmap
+import time
+import struct
+import argparse
+from collections import namedtuple
+
+SHM_PATH = '/dev/shm/rev_d_shim_live'
+MAGIC = b'SHIMLIVE'
+VERSION = 1
+NO_TRIGGER = 0xFFFFFFFFFFFFFFFF
+HEADER = struct.Struct('<8sIIQIIQ')  # Followed by one offset per ADC ring, then the trigger ring offset
+OFFSET = struct.Struct('<Q')
+CTRL = struct.Struct('<QII48x')
+ADC_RECORD = struct.Struct('<QIIQQQ8hQ')
+TRIG_RECORD = struct.Struct('<QIIQQQ')
+SEQ = struct.Struct('<Q')
+
+AdcFrame = namedtuple('AdcFrame', 'seq stream board frame trigger publish_ns samples')
+Trigger = namedtuple('Trigger', 'seq stream trigger timestamp publish_ns')
+
+
+class LiveRing:
+    """Reader for the shim-test live data ring."""
+
+    def __init__(self, path=SHM_PATH):
+        with open(path, 'rb') as f:
+            self.map = mmap.mmap(f.fileno(), 0, prot=mmap.PROT_READ)
+        (magic, version, header_bytes, segment_bytes, adc_bytes, trig_bytes,
+         ctrl_offset) = HEADER.unpack_from(self.map, 0)
+        if magic != MAGIC or version != VERSION:
+            raise ValueError(f"{path} is not a version {VERSION} live ring")
+        if adc_bytes != ADC_RECORD.size or trig_bytes != TRIG_RECORD.size:
+            raise ValueError(f"{path} has unexpected record sizes ({adc_bytes}, {trig_bytes})")
+        self.adc_rings = (header_bytes - HEADER.size) // OFFSET.size - 1
+        offsets = struct.unpack_from(f'<{self.adc_rings + 1}Q', self.map, HEADER.size)
+        self.ctrl_offset = ctrl_offset
+        self.adc_offset = offsets[:self.adc_rings]
+        self.trig_offset = offsets[self.adc_rings]
+
+    def _ctrl(self, ring):
+        return CTRL.unpack_from(self.map, self.ctrl_offset + ring * CTRL.size)
+
+    def head(self, ring):
+        """Newest sequence number in a ring (ADC boards 0 to adc_rings-1, then the trigger ring)."""
+        return self._ctrl(ring)[0]
+
+    def _read(self, ring, offset, record, next_seq, max_records):
+        head, _, capacity = self._ctrl(ring)
+        next_seq = max(next_seq, 1)
+        records, dropped = [], 0
+        while len(records) < max_records and next_seq <= head:
+            if head - next_seq >= capacity:
+                oldest = head - capacity + 1
+                dropped += oldest - next_seq
+                next_seq = oldest
+            slot = offset + ((next_seq - 1) & (capacity - 1)) * record.size
+            data = bytes(self.map[slot:slot + record.size])
+            # Valid only if the slot held this sequence number before and after the copy
+            if SEQ.unpack_from(data)[0] == next_seq and SEQ.unpack_from(self.map, slot)[0] == next_seq:
+                records.append(record.unpack(data))
+                next_seq += 1
+                continue
+            head = self._ctrl(ring)[0]
+            oldest = max(head - capacity + 1, next_seq + 1) if head >= capacity else next_seq + 1
+            dropped += oldest - next_seq
+            next_seq = oldest
+        return records, next_seq, dropped
+
+    def read_adc(self, board, next_seq, max_records=4096):
+        """Return ([AdcFrame], next_seq, dropped) for a board, starting at next_seq."""
+        raw, next_seq, dropped = self._read(board, self.adc_offset[board], ADC_RECORD, next_seq, max_records)
+        frames = [AdcFrame(r[0], r[1], r[2], r[3], r[4], r[5], list(r[6:14])) for r in raw]
+        return frames, next_seq, dropped
+
+    def read_trig(self, next_seq, max_records=4096):
+        """Return ([Trigger], next_seq, dropped), starting at next_seq."""
+        raw, next_seq, dropped = self._read(self.adc_rings, self.trig_offset, TRIG_RECORD, next_seq, max_records)
+        return [Trigger(r[0], r[1], r[3], r[4], r[5]) for r in raw], next_seq, dropped
+
+    def close(self):
+        self.map.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Print live ADC frames and triggers from shim-test')
+    parser.add_argument('--board', type=int, action='append', help='ADC board to follow (repeatable, default all)')
+    parser.add_argument('--trig', action='store_true', help='Also print triggers')
+    parser.add_argument('--all', action='store_true', help='Start from the oldest records still in the ring')
+    parser.add_argument('--path', default=SHM_PATH, help=f'Shared memory file (default {SHM_PATH})')
+    args = parser.parse_args()
+
+    try:
+        ring = LiveRing(args.path)
+    except FileNotFoundError:
+        print(f"Error: {args.path} does not exist (run live_ring_open in shim-test first)")
+        return 1
+    boards = args.board if args.board else list(range(ring.adc_rings))
+
+    with ring:
+        next_adc = {b: 1 if args.all else ring.head(b) + 1 for b in boards}
+        next_trig = 1 if args.all else ring.head(ring.adc_rings) + 1
+        try:
+            while True:
+                idle = True
+                for board in boards:
+                    frames, next_adc[board], dropped = ring.read_adc(board, next_adc[board])
+                    if dropped:
+                        print(f"board {board}: dropped {dropped} frames")
+                    for f in frames:
+                        trig = '-' if f.trigger == NO_TRIGGER else f.trigger
+                        print(f"board {f.board} frame {f.frame} trig {trig}: " + ' '.join(str(v) for v in f.samples))
+                    idle = idle and not frames
+                if args.trig:
+                    triggers, next_trig, dropped = ring.read_trig(next_trig)
+                    if dropped:
+                        print(f"trigger: dropped {dropped} records")
+                    for t in triggers:
+                        print(f"trigger {t.trigger}: {t.timestamp} cycles")
+                    idle = idle and not triggers
+                if idle:
+                    time.sleep(0.01)
+        except KeyboardInterrupt:
+            pass
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -2,10 +2,12 @@
 
 # Get the board count from the calling context
 set board_count [module_get_upvar board_count]
+# Get the number of board slots (unused slots are tied off) from the calling context
+set max_board_count [module_get_upvar max_board_count]
 
-# If the board count is not 8, then error out
-if {$board_count < 1 || $board_count > 8} {
-  puts "Error: board_count must be between 1 and 8."
+# If the board count is out of range, then error out
+if {$board_count < 1 || $board_count > $max_board_count} {
+  puts "Error: board_count must be between 1 and $max_board_count."
   exit 1
 }
 
@@ -35,12 +37,16 @@ if {$dac_cmd_fifo_addr_width < 10 || $dac_cmd_fifo_addr_width > 17 ||
 # System signals
 create_bd_pin -dir I -type clock aclk
 create_bd_pin -dir I -type reset aresetn
-create_bd_pin -dir I -from 16 -to 0 cmd_buf_reset
-create_bd_pin -dir I -from 16 -to 0 data_buf_reset
+create_bd_pin -dir I -from [expr {2 * $max_board_count}] -to 0 cmd_buf_reset
+create_bd_pin -dir I -from [expr {2 * $max_board_count}] -to 0 data_buf_reset
 create_bd_pin -dir I -type clock spi_clk
 
 # AXI interface
 create_bd_intf_pin -mode slave -vlnv xilinx.com:interface:aximm_rtl:1.0 S_AXI
+# DMA streams into the DAC command FIFOs (one per board)
+for {set i 0} {$i < $board_count} {incr i} {
+  create_bd_intf_pin -mode slave -vlnv xilinx.com:interface:axis_rtl:1.0 dac_ch${i}_cmd_dma
+}
 
 # Status concatenated out
 create_bd_pin -dir O -from 543 -to 0 cmd_fifo_sts
@@ -84,10 +90,10 @@ create_bd_pin -dir O trig_data_full
 create_bd_pin -dir O trig_data_almost_full
 
 # Overflow and underflow signals
-create_bd_pin -dir O -from 7 -to 0 dac_cmd_buf_overflow
-create_bd_pin -dir O -from 7 -to 0 dac_data_buf_underflow
-create_bd_pin -dir O -from 7 -to 0 adc_cmd_buf_overflow
-create_bd_pin -dir O -from 7 -to 0 adc_data_buf_underflow
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 dac_cmd_buf_overflow
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 dac_data_buf_underflow
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 adc_cmd_buf_overflow
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 adc_data_buf_underflow
 create_bd_pin -dir O trig_cmd_buf_overflow
 create_bd_pin -dir O trig_data_buf_underflow
 
@@ -148,14 +154,14 @@ for {set i 0} {$i < $board_count} {incr i} {
     NUM_MI 2
   } {
     aclk aclk
-    S00_AXI board_ch_axi_intercon/M0${i}_AXI
+    S00_AXI board_ch_axi_intercon/[format M%02d_AXI $i]
     aresetn aresetn
   }
 
   ## DAC command FIFO
   # DAC command FIFO resetn
   cell xilinx.com:ip:xlslice:1.0 dac_cmd_fifo_${i}_rst_slice {
-    DIN_WIDTH 17
+    DIN_WIDTH [expr {2 * $max_board_count + 1}]
     DIN_FROM [expr {2 * $i + 0}]
     DIN_TO [expr {2 * $i + 0}]
   } {
@@ -189,6 +195,27 @@ for {set i 0} {$i < $board_count} {incr i} {
     rd_en dac_ch${i}_cmd_rd_en
     empty dac_ch${i}_cmd_empty
   }
+  # DAC command FIFO write side, shared by the AXI bridge (priority) and the DMA stream
+  cell base:user:fifo_write_merge dac_cmd_fifo_${i}_wr_merge {
+    DATA_WIDTH 32
+  } {
+    fifo_wr_data dac_cmd_fifo_${i}/wr_data
+    fifo_wr_en dac_cmd_fifo_${i}/wr_en
+    fifo_full dac_cmd_fifo_${i}/full
+  }
+  # DMA stream into the DAC command FIFO (holds the stream off while the FIFO is full, so nothing is dropped)
+  cell base:user:axis_fifo_bridge dac_cmd_fifo_${i}_dma_bridge {
+    AXIS_DATA_WIDTH 32
+    ENABLE_READ 0
+    ALWAYS_READY 0
+  } {
+    aclk aclk
+    aresetn dac_cmd_fifo_${i}_aclk_rst/peripheral_aresetn
+    S_AXIS dac_ch${i}_cmd_dma
+    fifo_wr_data dac_cmd_fifo_${i}_wr_merge/sec_wr_data
+    fifo_wr_en dac_cmd_fifo_${i}_wr_merge/sec_wr_en
+    fifo_full dac_cmd_fifo_${i}_wr_merge/sec_full
+  }
   # 32-bit DAC command FIFO status word
   cell xilinx.com:ip:xlconcat:2.1 dac_cmd_fifo_${i}_sts_word {
     NUM_PORTS 7
@@ -205,7 +232,7 @@ for {set i 0} {$i < $board_count} {incr i} {
   ## DAC data FIFO
   # DAC data FIFO resetn
   cell xilinx.com:ip:xlslice:1.0 dac_data_fifo_${i}_rst_slice {
-    DIN_WIDTH 17
+    DIN_WIDTH [expr {2 * $max_board_count + 1}]
     DIN_FROM [expr {2 * $i + 0}]
     DIN_TO [expr {2 * $i + 0}]
   } {
@@ -253,7 +280,7 @@ for {set i 0} {$i < $board_count} {incr i} {
   }
 
   ## DAC FIFO AXI interface
-  cell base:user:axi_fifo_bridge dac_fifo_${i}_axi_bridge {
+  cell base:user:axi_burst_fifo_bridge dac_fifo_${i}_axi_bridge {
     AXI_ADDR_WIDTH 32
     AXI_DATA_WIDTH 32
   } {
@@ -261,9 +288,9 @@ for {set i 0} {$i < $board_count} {incr i} {
     wr_resetn dac_cmd_fifo_${i}_spi_clk_rst/peripheral_aresetn
     rd_resetn dac_data_fifo_${i}_spi_clk_rst/peripheral_aresetn
     S_AXI ch${i}_axi_intercon/M00_AXI
-    fifo_wr_data dac_cmd_fifo_${i}/wr_data
-    fifo_wr_en dac_cmd_fifo_${i}/wr_en
-    fifo_full dac_cmd_fifo_${i}/full
+    fifo_wr_data dac_cmd_fifo_${i}_wr_merge/pri_wr_data
+    fifo_wr_en dac_cmd_fifo_${i}_wr_merge/pri_wr_en
+    fifo_full dac_cmd_fifo_${i}_wr_merge/pri_full
     fifo_rd_data dac_data_fifo_${i}/rd_data
     fifo_rd_en dac_data_fifo_${i}/rd_en
     fifo_empty dac_data_fifo_${i}/empty
@@ -273,7 +300,7 @@ for {set i 0} {$i < $board_count} {incr i} {
   ## ADC command FIFO
   # ADC command FIFO resetn
   cell xilinx.com:ip:xlslice:1.0 adc_cmd_fifo_${i}_rst_slice {
-    DIN_WIDTH 17
+    DIN_WIDTH [expr {2 * $max_board_count + 1}]
     DIN_FROM [expr {2 * $i + 1}]
     DIN_TO [expr {2 * $i + 1}]
   } {
@@ -323,7 +350,7 @@ for {set i 0} {$i < $board_count} {incr i} {
   ## ADC data FIFO
   # ADC data FIFO resetn
   cell xilinx.com:ip:xlslice:1.0 adc_data_fifo_${i}_rst_slice {
-    DIN_WIDTH 17
+    DIN_WIDTH [expr {2 * $max_board_count + 1}]
     DIN_FROM [expr {2 * $i + 1}]
     DIN_TO [expr {2 * $i + 1}]
   } {
@@ -371,7 +398,7 @@ for {set i 0} {$i < $board_count} {incr i} {
   }
 
   ## ADC FIFO AXI interface
-  cell base:user:axi_fifo_bridge adc_fifo_${i}_axi_bridge {
+  cell base:user:axi_burst_fifo_bridge adc_fifo_${i}_axi_bridge {
     AXI_ADDR_WIDTH 32
     AXI_DATA_WIDTH 32
   } {
@@ -391,9 +418,9 @@ for {set i 0} {$i < $board_count} {incr i} {
 ## Trigger command FIFO
 # Trigger command FIFO resetn
 cell xilinx.com:ip:xlslice:1.0 trig_cmd_fifo_rst_slice {
-  DIN_WIDTH 17
-  DIN_FROM 16
-  DIN_TO 16
+  DIN_WIDTH [expr {2 * $max_board_count + 1}]
+  DIN_FROM [expr {2 * $max_board_count}]
+  DIN_TO [expr {2 * $max_board_count}]
 } {
   din cmd_buf_reset
 }
@@ -440,9 +467,9 @@ cell xilinx.com:ip:xlconcat:2.1 trig_cmd_fifo_sts_word {
 ## Trigger data FIFO
 # Trigger data FIFO resetn
 cell xilinx.com:ip:xlslice:1.0 trig_data_fifo_rst_slice {
-  DIN_WIDTH 17
-  DIN_FROM 16
-  DIN_TO 16
+  DIN_WIDTH [expr {2 * $max_board_count + 1}]
+  DIN_FROM [expr {2 * $max_board_count}]
+  DIN_TO [expr {2 * $max_board_count}]
 } {
   din data_buf_reset
 }
@@ -489,14 +516,14 @@ cell xilinx.com:ip:xlconcat:2.1 trig_data_fifo_sts_word {
 }
 
 ## Trigger FIFO AXI interface
-cell base:user:axi_fifo_bridge trig_fifo_axi_bridge {
+cell base:user:axi_burst_fifo_bridge trig_fifo_axi_bridge {
   AXI_ADDR_WIDTH 32
   AXI_DATA_WIDTH 32
 } {
   aclk aclk
   wr_resetn trig_cmd_fifo_spi_clk_rst/peripheral_aresetn
   rd_resetn trig_data_fifo_spi_clk_rst/peripheral_aresetn
-  S_AXI board_ch_axi_intercon/M0${board_count}_AXI
+  S_AXI board_ch_axi_intercon/[format M%02d_AXI $board_count]
   fifo_wr_data trig_cmd_fifo/wr_data
   fifo_wr_en trig_cmd_fifo/wr_en
   fifo_full trig_cmd_fifo/full
@@ -513,13 +540,13 @@ cell xilinx.com:ip:xlconstant:1.1 empty_sts_word {
 } {}
 # Concatenate status words from all command FIFOs
 cell xilinx.com:ip:xlconcat:2.1 cmd_fifo_sts_concat {
-  NUM_PORTS 17
+  NUM_PORTS [expr {2 * $max_board_count + 1}]
 } {
   dout cmd_fifo_sts
 }
 # Concatenate status words from all data FIFOs
 cell xilinx.com:ip:xlconcat:2.1 data_fifo_sts_concat {
-  NUM_PORTS 17
+  NUM_PORTS [expr {2 * $max_board_count + 1}]
 } {
   dout data_fifo_sts
 }
@@ -529,12 +556,12 @@ for {set i 0} {$i < $board_count} {incr i} {
   wire cmd_fifo_sts_concat/In[expr {2 * $i + 1}] adc_cmd_fifo_${i}_sts_word/dout
 }
 # Wire unused board command FIFO status words to the concatenation
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire cmd_fifo_sts_concat/In[expr {2 * $i + 0}] empty_sts_word/dout
   wire cmd_fifo_sts_concat/In[expr {2 * $i + 1}] empty_sts_word/dout
 }
 # Wire trigger command FIFO status word to the concatenation
-wire cmd_fifo_sts_concat/In16 trig_cmd_fifo_sts_word/dout
+wire cmd_fifo_sts_concat/In[expr {2 * $max_board_count}] trig_cmd_fifo_sts_word/dout
 
 # Wire used board data FIFO status words to the concatenation
 for {set i 0} {$i < $board_count} {incr i} {
@@ -542,60 +569,60 @@ for {set i 0} {$i < $board_count} {incr i} {
   wire data_fifo_sts_concat/In[expr {2 * $i + 1}] adc_data_fifo_${i}_sts_word/dout
 }
 # Wire unused board data FIFO status words to the concatenation
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire data_fifo_sts_concat/In[expr {2 * $i + 0}] empty_sts_word/dout
   wire data_fifo_sts_concat/In[expr {2 * $i + 1}] empty_sts_word/dout
 }
 # Wire trigger data FIFO status word to the concatenation
-wire data_fifo_sts_concat/In16 trig_data_fifo_sts_word/dout
+wire data_fifo_sts_concat/In[expr {2 * $max_board_count}] trig_data_fifo_sts_word/dout
 
 ## Overflow and underflow signals
 # Concatenate DAC command FIFO overflow signals
 cell xilinx.com:ip:xlconcat:2.1 dac_cmd_buf_overflow_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout dac_cmd_buf_overflow
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire dac_cmd_buf_overflow_concat/In${i} dac_fifo_${i}_axi_bridge/fifo_overflow
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire dac_cmd_buf_overflow_concat/In${i} const_0/dout
 }
 # Concatenate DAC data FIFO underflow signals
 cell xilinx.com:ip:xlconcat:2.1 dac_data_buf_underflow_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout dac_data_buf_underflow
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire dac_data_buf_underflow_concat/In${i} dac_fifo_${i}_axi_bridge/fifo_underflow
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire dac_data_buf_underflow_concat/In${i} const_0/dout
 }
 # Concatenate ADC command FIFO overflow signals
 cell xilinx.com:ip:xlconcat:2.1 adc_cmd_buf_overflow_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout adc_cmd_buf_overflow
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire adc_cmd_buf_overflow_concat/In${i} adc_fifo_${i}_axi_bridge/fifo_overflow
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire adc_cmd_buf_overflow_concat/In${i} const_0/dout
 }
 # Concatenate ADC data FIFO underflow signals
 cell xilinx.com:ip:xlconcat:2.1 adc_data_buf_underflow_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout adc_data_buf_underflow
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire adc_data_buf_underflow_concat/In${i} adc_fifo_${i}_axi_bridge/fifo_underflow
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire adc_data_buf_underflow_concat/In${i} const_0/dout
 }
 # Wire trigger command/data FIFO overflow and underflow signals
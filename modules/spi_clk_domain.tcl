@@ -4,12 +4,14 @@
 
 # Get the board count from the calling context
 set board_count [module_get_upvar board_count]
+# Get the number of board slots (unused slots are tied off) from the calling context
+set max_board_count [module_get_upvar max_board_count]
 # Get the threshold_core_level flag from the calling context
 set threshold_core_level [module_get_upvar threshold_core_level]
 
-# If the board count is not 8, then error out
-if {$board_count < 1 || $board_count > 8} {
-  puts "Error: board_count must be between 1 and 8."
+# If the board count is out of range, then error out
+if {$board_count < 1 || $board_count > $max_board_count} {
+  puts "Error: board_count must be between 1 and $max_board_count."
   exit 1
 }
 
@@ -41,34 +43,34 @@ create_bd_pin -dir I do_dac_pre_delay
 # SPI system status
 create_bd_pin -dir O spi_off
 # Threshold status
-create_bd_pin -dir O -from 7 -to 0 over_thresh
-create_bd_pin -dir O -from 7 -to 0 thresh_underflow
-create_bd_pin -dir O -from 7 -to 0 thresh_overflow
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 over_thresh
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 thresh_underflow
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 thresh_overflow
 # Trigger channel status
 create_bd_pin -dir O -from 31 -to 0 trig_counter
 create_bd_pin -dir O bad_trig_cmd
 create_bd_pin -dir O trig_data_buf_overflow
 # DAC channel status
-create_bd_pin -dir O -from 7 -to 0 dac_boot_fail
-create_bd_pin -dir O -from 7 -to 0 bad_dac_cmd
-create_bd_pin -dir O -from 7 -to 0 dac_cal_oob
-create_bd_pin -dir O -from 7 -to 0 dac_val_oob
-create_bd_pin -dir O -from 7 -to 0 dac_cmd_buf_underflow
-create_bd_pin -dir O -from 7 -to 0 dac_data_buf_overflow
-create_bd_pin -dir O -from 7 -to 0 unexp_dac_trig
-create_bd_pin -dir O -from 7 -to 0 ldac_misalign
-create_bd_pin -dir O -from 7 -to 0 dac_delay_too_short
-create_bd_pin -dir O -from 255 -to 0 last_received_dac_cmds_concat
-create_bd_pin -dir O -from 255 -to 0 dac_cmds_since_reset_concat
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 dac_boot_fail
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 bad_dac_cmd
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 dac_cal_oob
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 dac_val_oob
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 dac_cmd_buf_underflow
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 dac_data_buf_overflow
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 unexp_dac_trig
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 ldac_misalign
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 dac_delay_too_short
+create_bd_pin -dir O -from [expr {32 * $max_board_count - 1}] -to 0 last_received_dac_cmds_concat
+create_bd_pin -dir O -from [expr {32 * $max_board_count - 1}] -to 0 dac_cmds_since_reset_concat
 # ADC channel status
-create_bd_pin -dir O -from 7 -to 0 adc_boot_fail
-create_bd_pin -dir O -from 7 -to 0 bad_adc_cmd
-create_bd_pin -dir O -from 7 -to 0 adc_cmd_buf_underflow
-create_bd_pin -dir O -from 7 -to 0 adc_data_buf_overflow
-create_bd_pin -dir O -from 7 -to 0 unexp_adc_trig
-create_bd_pin -dir O -from 7 -to 0 adc_delay_too_short
-create_bd_pin -dir O -from 255 -to 0 last_received_adc_cmds_concat
-create_bd_pin -dir O -from 255 -to 0 adc_cmds_since_reset_concat
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 adc_boot_fail
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 bad_adc_cmd
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 adc_cmd_buf_underflow
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 adc_data_buf_overflow
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 unexp_adc_trig
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 adc_delay_too_short
+create_bd_pin -dir O -from [expr {32 * $max_board_count - 1}] -to 0 last_received_adc_cmds_concat
+create_bd_pin -dir O -from [expr {32 * $max_board_count - 1}] -to 0 adc_cmds_since_reset_concat
 
 # Commands and data
 for {set i 0} {$i < $board_count} {incr i} {
@@ -110,15 +112,15 @@ create_bd_pin -dir I block_bufs
 
 # SPI interface signals (out)
 create_bd_pin -dir O ldac
-create_bd_pin -dir O -from 7 -to 0 n_dac_cs
-create_bd_pin -dir O -from 7 -to 0 dac_mosi
-create_bd_pin -dir O -from 7 -to 0 n_adc_cs
-create_bd_pin -dir O -from 7 -to 0 adc_mosi
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 n_dac_cs
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 dac_mosi
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 n_adc_cs
+create_bd_pin -dir O -from [expr {$max_board_count - 1}] -to 0 adc_mosi
 
 # SPI interface signals (in)
-create_bd_pin -dir I -from 7 -to 0 miso_sck
-create_bd_pin -dir I -from 7 -to 0 dac_miso
-create_bd_pin -dir I -from 7 -to 0 adc_miso
+create_bd_pin -dir I -from [expr {$max_board_count - 1}] -to 0 miso_sck
+create_bd_pin -dir I -from [expr {$max_board_count - 1}] -to 0 dac_miso
+create_bd_pin -dir I -from [expr {$max_board_count - 1}] -to 0 adc_miso
 
 ## 0 and 1 constants to fill bits for unused boards
 cell xilinx.com:ip:xlconstant:1.1 const_0 {
@@ -326,12 +328,12 @@ for {set i 0} {$i < $board_count} {incr i} {
 
 # Waiting for trigger signals
 cell xilinx.com:ip:xlconcat:2.1 dac_waiting_for_trig_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout trig_core/dac_waiting_for_trig
 }
 cell xilinx.com:ip:xlconcat:2.1 adc_waiting_for_trig_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout trig_core/adc_waiting_for_trig
 }
@@ -339,7 +341,7 @@ for {set i 0} {$i < $board_count} {incr i} {
   wire dac_waiting_for_trig_concat/In${i} dac_ch${i}/waiting_for_trig
   wire adc_waiting_for_trig_concat/In${i} adc_ch${i}/waiting_for_trig
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire dac_waiting_for_trig_concat/In${i} const_1/dout
   wire adc_waiting_for_trig_concat/In${i} const_1/dout
 }
@@ -383,53 +385,53 @@ for {set i 0} {$i < $board_count} {incr i} {
 
 # ~DAC_CS
 cell xilinx.com:ip:xlconcat:2.1 n_dac_cs_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout n_dac_cs
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire n_dac_cs_concat/In${i} dac_ch${i}/n_cs
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire n_dac_cs_concat/In${i} const_1/dout
 }
 
 # DAC_MOSI
 cell xilinx.com:ip:xlconcat:2.1 dac_mosi_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout dac_mosi
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire dac_mosi_concat/In${i} dac_ch${i}/mosi
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire dac_mosi_concat/In${i} const_0/dout
 }
 
 # ~ADC_CS
 cell xilinx.com:ip:xlconcat:2.1 n_adc_cs_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout n_adc_cs
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire n_adc_cs_concat/In${i} adc_ch${i}/n_cs
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire n_adc_cs_concat/In${i} const_1/dout
 }
 
 # ADC_MOSI
 cell xilinx.com:ip:xlconcat:2.1 adc_mosi_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout adc_mosi
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire adc_mosi_concat/In${i} adc_ch${i}/mosi
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire adc_mosi_concat/In${i} const_0/dout
 }
 
@@ -437,7 +439,7 @@ for {set i $board_count} {$i < 8} {incr i} {
 # MISO_SCK
 for {set i 0} {$i < $board_count} {incr i} {
   cell xilinx.com:ip:xlslice:1.0 miso_sck_ch$i {
-    DIN_WIDTH 8
+    DIN_WIDTH $max_board_count
     DIN_FROM ${i}
     DIN_TO ${i}
   } {
@@ -449,7 +451,7 @@ for {set i 0} {$i < $board_count} {incr i} {
 # DAC_MISO
 for {set i 0} {$i < $board_count} {incr i} {
   cell xilinx.com:ip:xlslice:1.0 dac_miso_ch$i {
-    DIN_WIDTH 8
+    DIN_WIDTH $max_board_count
     DIN_FROM ${i}
     DIN_TO ${i}
   } {
@@ -460,7 +462,7 @@ for {set i 0} {$i < $board_count} {incr i} {
 # ADC_MISO
 for {set i 0} {$i < $board_count} {incr i} {
   cell xilinx.com:ip:xlslice:1.0 adc_miso_ch$i {
-    DIN_WIDTH 8
+    DIN_WIDTH $max_board_count
     DIN_FROM ${i}
     DIN_TO ${i}
   } {
@@ -517,286 +519,286 @@ cell xilinx.com:ip:util_vector_logic setup_done_n {
 
 ## over_thresh
 cell xilinx.com:ip:xlconcat:2.1 over_thresh_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/over_thresh
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire over_thresh_concat/In${i} dac_ch${i}/over_thresh
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire over_thresh_concat/In${i} const_0/dout
 }
 
 ## thresh_underflow
 cell xilinx.com:ip:xlconcat:2.1 thresh_underflow_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/thresh_underflow
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire thresh_underflow_concat/In${i} dac_ch${i}/thresh_underflow
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire thresh_underflow_concat/In${i} const_0/dout
 }
 
 ## thresh_overflow
 cell xilinx.com:ip:xlconcat:2.1 thresh_overflow_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/thresh_overflow
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire thresh_overflow_concat/In${i} dac_ch${i}/thresh_overflow
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire thresh_overflow_concat/In${i} const_0/dout
 }
 
 ## dac_boot_fail
 cell xilinx.com:ip:xlconcat:2.1 dac_boot_fail_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/dac_boot_fail
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire dac_boot_fail_concat/In${i} dac_ch${i}/boot_fail
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire dac_boot_fail_concat/In${i} const_0/dout
 }
 
 ## bad_dac_cmd
 cell xilinx.com:ip:xlconcat:2.1 bad_dac_cmd_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/bad_dac_cmd
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire bad_dac_cmd_concat/In${i} dac_ch${i}/bad_cmd
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire bad_dac_cmd_concat/In${i} const_0/dout
 }
 
 ## dac_cal_oob
 cell xilinx.com:ip:xlconcat:2.1 dac_cal_oob_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/dac_cal_oob
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire dac_cal_oob_concat/In${i} dac_ch${i}/cal_oob
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire dac_cal_oob_concat/In${i} const_0/dout
 }
 
 ## dac_val_oob
 cell xilinx.com:ip:xlconcat:2.1 dac_val_oob_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/dac_val_oob
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire dac_val_oob_concat/In${i} dac_ch${i}/dac_val_oob
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire dac_val_oob_concat/In${i} const_0/dout
 }
 
 ## dac_cmd_buf_underflow
 cell xilinx.com:ip:xlconcat:2.1 dac_cmd_buf_underflow_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/dac_cmd_buf_underflow
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire dac_cmd_buf_underflow_concat/In${i} dac_ch${i}/cmd_buf_underflow
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire dac_cmd_buf_underflow_concat/In${i} const_0/dout
 }
 
 ## dac_data_buf_overflow
 cell xilinx.com:ip:xlconcat:2.1 dac_data_buf_overflow_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/dac_data_buf_overflow
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire dac_data_buf_overflow_concat/In${i} dac_ch${i}/data_buf_overflow
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire dac_data_buf_overflow_concat/In${i} const_0/dout
 }
 
 ## unexp_dac_trig
 cell xilinx.com:ip:xlconcat:2.1 unexp_dac_trig_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/unexp_dac_trig
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire unexp_dac_trig_concat/In${i} dac_ch${i}/unexp_trig
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire unexp_dac_trig_concat/In${i} const_0/dout
 }
 
 ## ldac_misalign
 cell xilinx.com:ip:xlconcat:2.1 ldac_misalign_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/ldac_misalign
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire ldac_misalign_concat/In${i} dac_ch${i}/ldac_misalign
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire ldac_misalign_concat/In${i} const_0/dout
 }
 
 ## dac_delay_too_short
 cell xilinx.com:ip:xlconcat:2.1 dac_delay_too_short_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/dac_delay_too_short
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire dac_delay_too_short_concat/In${i} dac_ch${i}/delay_too_short
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire dac_delay_too_short_concat/In${i} const_0/dout
 }
 
 ## last_received_dac_cmds_concat core
 cell xilinx.com:ip:xlconcat:2.1 last_received_dac_cmds_concat_core {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/last_received_dac_cmds_concat
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire last_received_dac_cmds_concat_core/In${i} dac_ch${i}/last_received_cmd
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire last_received_dac_cmds_concat_core/In${i} const_0_32bit/dout
 }
 
 ## dac_cmds_since_reset_concat
 cell xilinx.com:ip:xlconcat:2.1 dac_cmds_since_reset_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/dac_cmds_since_reset_concat
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire dac_cmds_since_reset_concat/In${i} dac_ch${i}/cmds_since_reset
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire dac_cmds_since_reset_concat/In${i} const_0_32bit/dout
 }
 
 ## adc_boot_fail
 cell xilinx.com:ip:xlconcat:2.1 adc_boot_fail_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/adc_boot_fail
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire adc_boot_fail_concat/In${i} adc_ch${i}/boot_fail
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire adc_boot_fail_concat/In${i} const_0/dout
 }
 
 ## bad_adc_cmd
 cell xilinx.com:ip:xlconcat:2.1 bad_adc_cmd_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/bad_adc_cmd
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire bad_adc_cmd_concat/In${i} adc_ch${i}/bad_cmd
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire bad_adc_cmd_concat/In${i} const_0/dout
 }
 
 ## adc_cmd_buf_underflow
 cell xilinx.com:ip:xlconcat:2.1 adc_cmd_buf_underflow_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/adc_cmd_buf_underflow
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire adc_cmd_buf_underflow_concat/In${i} adc_ch${i}/cmd_buf_underflow
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire adc_cmd_buf_underflow_concat/In${i} const_0/dout
 }
 
 ## adc_data_buf_overflow
 cell xilinx.com:ip:xlconcat:2.1 adc_data_buf_overflow_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/adc_data_buf_overflow
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire adc_data_buf_overflow_concat/In${i} adc_ch${i}/data_buf_overflow
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire adc_data_buf_overflow_concat/In${i} const_0/dout
 }
 
 ## unexp_adc_trig
 cell xilinx.com:ip:xlconcat:2.1 unexp_adc_trig_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/unexp_adc_trig
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire unexp_adc_trig_concat/In${i} adc_ch${i}/unexp_trig
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire unexp_adc_trig_concat/In${i} const_0/dout
 }
 
 ## adc_delay_too_short
 cell xilinx.com:ip:xlconcat:2.1 adc_delay_too_short_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/adc_delay_too_short
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire adc_delay_too_short_concat/In${i} adc_ch${i}/delay_too_short
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire adc_delay_too_short_concat/In${i} const_0/dout
 }
 
 ## last_received_adc_cmds_concat
 cell xilinx.com:ip:xlconcat:2.1 last_received_adc_cmds_concat {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/last_received_adc_cmds_concat
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire last_received_adc_cmds_concat/In${i} adc_ch${i}/last_received_cmd
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire last_received_adc_cmds_concat/In${i} const_0_32bit/dout
 }
 
 ## adc_cmds_since_reset_concat core
 cell xilinx.com:ip:xlconcat:2.1 adc_cmds_since_reset_concat_core {
-  NUM_PORTS 8
+  NUM_PORTS $max_board_count
 } {
   dout spi_sts_sync/adc_cmds_since_reset_concat
 }
 for {set i 0} {$i < $board_count} {incr i} {
   wire adc_cmds_since_reset_concat_core/In${i} adc_ch${i}/cmds_since_reset
 }
-for {set i $board_count} {$i < 8} {incr i} {
+for {set i $board_count} {$i < $max_board_count} {incr i} {
   wire adc_cmds_since_reset_concat_core/In${i} const_0_32bit/dout
 }
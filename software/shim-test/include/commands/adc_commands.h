@@ -28,6 +28,11 @@ typedef struct {
   uint64_t word_count;         // Number of words to read from ADC
   volatile bool* should_stop;
   bool binary_mode;            // true for binary format, false for ASCII format
+  bool npy_mode;               // Binary data behind an .npy header (int16 [samples, 8]), implies binary_mode
+  bool corrected;              // Subtract the ADC bias (from bias_table) from samples before writing
+  adc_convert_t bias_table;    // Bias correction captured when the stream starts (used when corrected)
+  uint32_t* index_frames;      // Frames per trigger for the <file_path>.idx sidecar (NULL = no index, freed by the thread)
+  uint64_t index_segment_count; // Entries in index_frames (triggers + 1)
 } adc_data_stream_params_t;
 
 // Structure to pass data to the ADC command streaming thread (for streaming commands from file)
@@ -42,6 +47,28 @@ typedef struct {
   bool simple_mode;     // Whether to unroll repeats instead of using repeat count in commands
 } adc_command_stream_params_t;
 
+// Validate and parse an ADC command file into an allocated command array (caller frees).
+// Pass sys_sts to also check delays against the ADC minimum delay (NULL skips timing checks).
+int parse_adc_command_file(const char* file_path, adc_command_t** commands, int* command_count,
+                           struct sys_sts_t* sys_sts, bool verbose);
+// Same, without the verbose timing printout: when sys_sts is given the file's timing summary is returned in *timing (may be NULL).
+// Reentrant, so several files can be parsed on separate threads.
+int parse_adc_command_file_timed(const char* file_path, adc_command_t** commands, int* command_count,
+                                 struct sys_sts_t* sys_sts, command_file_timing_t* timing);
+
+// Result of compact_adc_commands, per pass through the file
+typedef struct {
+  int commands_before;
+  int commands_after;
+  uint64_t words_before;  // ADC command FIFO words
+  uint64_t words_after;
+  int reads_folded;       // Reads folded into the repeat count of the read before
+} adc_compact_stats_t;
+
+// Rewrite a parsed ADC command file in place with the same reads and fewer FIFO words: consecutive reads with
+// the same wait mode and value become one read with a repeat count. Returns the new command count.
+int compact_adc_commands(adc_command_t* commands, int command_count, adc_compact_stats_t* stats);
+
 // ADC FIFO status commands
 int cmd_adc_cmd_fifo_sts(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 int cmd_adc_data_fifo_sts(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
@@ -70,6 +97,8 @@ int cmd_stop_adc_data_stream(const char** args, int arg_count, const command_fla
 int cmd_stream_adc_commands_from_file(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 int cmd_stop_adc_cmd_stream(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 
+// ADC data words produced by one pass through a parsed ADC command file
+uint64_t adc_words_per_pass(const adc_command_t* commands, int command_count);
 // Helper function to calculate expected number of ADC words from an ADC command file
 uint64_t calculate_expected_adc_words(const char* file_path, int iterations, bool verbose);
 
@@ -0,0 +1,84 @@
+#ifndef ADC_INDEX_H
+#define ADC_INDEX_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "adc_commands.h"
+
+// Trigger index sidecar for ADC data files (<data_file>.idx)
+//
+// File layout (little-endian):
+//   header (32 bytes): magic "SHIMADCI", version, board, binary flag, reserved, entry_count (uint64)
+//   entries (16 bytes each): byte_offset (uint64), first_frame (uint64)
+//
+// A frame is one 8-channel ADC read (4 data words, 16 bytes in binary files, one line in ASCII files).
+// Entry 0 covers frames read after the stream starts and before the first trigger; entry t (t >= 1)
+// covers frames read after trigger t, which is row t-1 of the trigger data file. Entries are dense
+// (a trigger with no reads gets a zero-length entry), so trigger t is found with a single seek.
+// The last entry is a sentinel at the end of the data, so entry t spans up to entry t+1.
+#define ADC_INDEX_MAGIC           "SHIMADCI"
+#define ADC_INDEX_VERSION         (uint32_t) 1
+#define ADC_INDEX_EXTENSION       ".idx"
+#define ADC_INDEX_WORDS_PER_FRAME 4
+#define ADC_INDEX_MAX_TRIGGERS    (uint64_t) 0x10000000 // Bounds the schedule allocation
+
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t board;
+  uint32_t binary;       // 1 if the data file is raw 32-bit words, 0 if ASCII lines
+  uint32_t reserved;
+  uint64_t entry_count;  // Entries including the sentinel (patched when the stream closes)
+} adc_index_header_t;
+
+typedef struct {
+  uint64_t byte_offset;  // Offset of the first frame after this trigger in the data file
+  uint64_t first_frame;  // Index of that frame in the data file
+} adc_index_entry_t;
+
+// Expected frames read between consecutive triggers, from replaying an ADC command file
+typedef struct {
+  uint32_t* frames;      // frames[t]: frames read after trigger t (t = 0 before the first trigger)
+  uint64_t segment_count; // Total triggers + 1
+} adc_index_schedule_t;
+
+// Streaming index writer (used by the ADC data stream thread)
+typedef struct {
+  FILE* file;
+  adc_index_schedule_t schedule;
+  uint64_t next_segment;     // Next entry to write
+  uint64_t next_start_frame; // First frame of next_segment
+  uint64_t entries_written;
+} adc_index_writer_t;
+
+// Reader handle (one seek per lookup, nothing loaded up front)
+typedef struct {
+  FILE* file;
+  adc_index_header_t header;
+} adc_index_t;
+
+// Build the schedule for a parsed ADC command list played <iterations> times (caller frees with adc_index_free_schedule)
+int adc_index_build_schedule(const adc_command_t* commands, int command_count, int iterations, adc_index_schedule_t* schedule);
+void adc_index_free_schedule(adc_index_schedule_t* schedule);
+
+// Open an index file for writing. Takes ownership of the schedule.
+int adc_index_writer_open(adc_index_writer_t* writer, const char* index_path, uint8_t board, bool binary, adc_index_schedule_t* schedule);
+// Record that frame <frame> starts at <byte_offset>. Call at every frame boundary that may start an entry
+// (cheap to call when adc_index_writer_next_frame() != frame).
+void adc_index_writer_mark(adc_index_writer_t* writer, uint64_t frame, uint64_t byte_offset);
+// Frame at which the next entry starts (UINT64_MAX once the schedule is exhausted)
+uint64_t adc_index_writer_next_frame(const adc_index_writer_t* writer);
+// Write the end sentinel, patch the header and close
+int adc_index_writer_close(adc_index_writer_t* writer, uint64_t frames_written, uint64_t byte_offset);
+
+// Reader API
+int adc_index_open(const char* index_path, adc_index_t* index);
+// Number of triggers with entries (entry 0, before the first trigger, is not counted)
+uint64_t adc_index_trigger_count(const adc_index_t* index);
+// Locate the data for trigger <trigger> (0 = before the first trigger). Returns 0 on success, -1 if out of range.
+int adc_index_lookup(const adc_index_t* index, uint64_t trigger, uint64_t* byte_offset, uint64_t* byte_length,
+                     uint64_t* first_frame, uint64_t* frame_count);
+void adc_index_close(adc_index_t* index);
+
+#endif // ADC_INDEX_H
@@ -18,6 +18,7 @@
 #include "adc_commands.h"       // ADC data acquisition commands
 #include "dac_commands.h"       // DAC waveform generation commands
 #include "trigger_commands.h"   // Trigger and synchronization commands
+#include "script_engine.h"      // Command scripts and wait commands
 
 // Command metadata for validation and help
 typedef struct {
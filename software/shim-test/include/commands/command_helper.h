@@ -6,16 +6,23 @@
 #include <stdio.h>
 #include <pthread.h>
 
+#include "shim_boards.h"
 #include "sys_ctrl.h"
 #include "sys_sts.h"
 #include "adc_ctrl.h"
 #include "dac_ctrl.h"
+#include "dac_dma.h"
 #include "trigger_ctrl.h"
 #include "clk_ctrl.h"
+#include "adc_convert.h"
 
 #define MAX_ARGS 16     // Maximum command arguments (including command name)
 #define MAX_FLAGS 5     // Maximum command flags
 
+struct live_ring; // Shared-memory live data ring (live_ring.h)
+struct fifo_telemetry; // FIFO fill-level sampler (fifo_telemetry.h)
+struct waveform_cache; // Parsed command file cache (waveform_cache.h)
+
 // Supported command flags
 typedef enum {
   FLAG_ALL,
@@ -24,7 +31,10 @@ typedef enum {
   FLAG_SIMPLE,
   FLAG_BIN,
   FLAG_NO_RESET,
-  FLAG_NO_CAL
+  FLAG_NO_CAL,
+  FLAG_NPY,
+  FLAG_CORRECTED,
+  FLAG_NO_PACE
 } command_flag_t;
 
 // Global context passed to all command handlers
@@ -34,6 +44,7 @@ typedef struct command_context {
   struct clk_ctrl_t* clk_ctrl;
   struct sys_sts_t* sys_sts;
   struct dac_ctrl_t* dac_ctrl;
+  struct dac_dma_t* dac_dma;
   struct adc_ctrl_t* adc_ctrl;
   struct trigger_ctrl_t* trigger_ctrl;
 
@@ -42,20 +53,20 @@ typedef struct command_context {
   bool* should_exit;
 
   // ADC streaming management
-  pthread_t adc_data_stream_threads[8];      // Thread handles for ADC data streaming (reading to file)
-  bool adc_data_stream_running[8];           // Status of each ADC data stream thread
-  volatile bool adc_data_stream_stop[8];     // Stop signals for each ADC data stream thread
-  pthread_t adc_cmd_stream_threads[8];       // Thread handles for ADC command streaming (from file)
-  bool adc_cmd_stream_running[8];            // Status of each ADC command stream thread
-  volatile bool adc_cmd_stream_stop[8];      // Stop signals for each ADC command stream thread
+  pthread_t adc_data_stream_threads[SHIM_MAX_BOARDS];      // Thread handles for ADC data streaming (reading to file)
+  bool adc_data_stream_running[SHIM_MAX_BOARDS];           // Status of each ADC data stream thread
+  volatile bool adc_data_stream_stop[SHIM_MAX_BOARDS];     // Stop signals for each ADC data stream thread
+  pthread_t adc_cmd_stream_threads[SHIM_MAX_BOARDS];       // Thread handles for ADC command streaming (from file)
+  bool adc_cmd_stream_running[SHIM_MAX_BOARDS];            // Status of each ADC command stream thread
+  volatile bool adc_cmd_stream_stop[SHIM_MAX_BOARDS];      // Stop signals for each ADC command stream thread
 
   // DAC streaming management
-  pthread_t dac_cmd_stream_threads[8];      // Thread handles for DAC command streaming
-  bool dac_cmd_stream_running[8];           // Status of each DAC command stream thread
-  volatile bool dac_cmd_stream_stop[8];     // Stop signals for each DAC command stream thread
-  pthread_t dac_debug_stream_threads[8];    // Thread handles for DAC debug data streaming (reading to file)
-  bool dac_debug_stream_running[8];         // Status of each DAC debug data stream thread
-  volatile bool dac_debug_stream_stop[8];   // Stop signals for each DAC debug data stream thread
+  pthread_t dac_cmd_stream_threads[SHIM_MAX_BOARDS];      // Thread handles for DAC command streaming
+  bool dac_cmd_stream_running[SHIM_MAX_BOARDS];           // Status of each DAC command stream thread
+  volatile bool dac_cmd_stream_stop[SHIM_MAX_BOARDS];     // Stop signals for each DAC command stream thread
+  pthread_t dac_debug_stream_threads[SHIM_MAX_BOARDS];    // Thread handles for DAC debug data streaming (reading to file)
+  bool dac_debug_stream_running[SHIM_MAX_BOARDS];         // Status of each DAC debug data stream thread
+  volatile bool dac_debug_stream_stop[SHIM_MAX_BOARDS];   // Stop signals for each DAC debug data stream thread
 
   // Trigger streaming management
   pthread_t trig_data_stream_thread;        // Thread handle for trigger data streaming
@@ -67,15 +78,22 @@ typedef struct command_context {
   bool fieldmap_running;                    // Status of fieldmap thread
   volatile bool fieldmap_stop;              // Stop signal for fieldmap thread
 
+  // Live data publishing (NULL when no ring is open)
+  struct live_ring* live_ring;              // Shared-memory ring the ADC and trigger stream threads publish to
+  struct fifo_telemetry* fifo_telemetry;    // FIFO fill-level sampler (NULL when not running)
+
+  // Parsed DAC/ADC command files, shared by waveform_test and the stream commands (NULL until first use)
+  struct waveform_cache* waveform_cache;
+
   // Command logging
   FILE* log_file;                       // File handle for command logging
   bool logging_enabled;                 // Whether command logging is active
 
   // ADC bias calibration storage (64 channels, 8 boards * 8 channels each)
-  double adc_bias[64];                  // ADC bias values for each channel (0-63)
-  bool adc_bias_valid[64];              // Whether each ADC bias value is valid
-  double adc_bias_previous[64];         // Previous ADC bias values for comparison
-  bool adc_bias_previous_valid[64];     // Whether each previous ADC bias value is valid
+  double adc_bias[SHIM_MAX_CHANNELS];                  // ADC bias values for each channel
+  bool adc_bias_valid[SHIM_MAX_CHANNELS];              // Whether each ADC bias value is valid
+  double adc_bias_previous[SHIM_MAX_CHANNELS];         // Previous ADC bias values for comparison
+  bool adc_bias_previous_valid[SHIM_MAX_CHANNELS];     // Whether each previous ADC bias value is valid
 } command_context_t;
 
 // Helper function to convert Amps to signed DAC units
@@ -83,6 +101,8 @@ typedef struct command_context {
 int16_t amps_to_dac(double amps);
 // Helper function to convert signed DAC units to Amps
 double dac_to_amps(int16_t dac_value);
+// Build an ADC conversion table from the context's current ADC bias values
+void load_adc_convert(command_context_t* ctx, adc_convert_t* conv);
 // Basic parsing and validation utilities
 uint32_t parse_value(const char* str, char** endptr);
 int parse_board_number(const char* str);
@@ -105,7 +125,17 @@ void set_file_permissions(const char* file_path, bool verbose);
 int prompt_file_selection(const char* prompt_text, const char* default_file,
                          char* resolved_path, size_t resolved_path_size);
 
+// Timing summary of a DAC or ADC command file, as checked against the current SPI clock
+typedef struct {
+  uint32_t min_delay;        // Minimum delay the file was checked against (cycles)
+  uint32_t shortest_delay;   // Shortest D delay in the file (UINT32_MAX if none)
+  uint64_t trigger_spacing;  // Longest stretch of work between trigger waits (cycles)
+  uint32_t clk_freq_hz;      // SPI clock at the time of the check
+} command_file_timing_t;
+
 // Display/output helper functions
 void print_trigger_data(uint64_t data);
+void print_file_timing(const char* file_type, const char* file_path, uint32_t min_delay, uint32_t shortest_delay,
+                       uint64_t trigger_spacing, uint32_t clk_freq_hz);
 
 #endif // COMMAND_HELPER_H
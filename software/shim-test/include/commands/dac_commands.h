@@ -19,6 +19,16 @@ typedef struct {
   bool cont;                // Continue flag
 } waveform_command_t;
 
+// Result of optimize_waveform_commands, per pass through the file
+typedef struct {
+  int commands_before;
+  int commands_after;
+  uint64_t words_before;  // DAC command FIFO words
+  uint64_t words_after;
+  int writes_removed;     // Writes of unchanged values turned into no-ops
+  int delays_merged;      // No-op delays folded into the one before
+} waveform_opt_stats_t;
+
 // Structure to pass data to the DAC streaming thread
 typedef struct {
   command_context_t* ctx;
@@ -36,8 +46,26 @@ typedef struct {
   uint8_t board;
   char file_path[1024];
   volatile bool* should_stop;
+  bool binary_mode;     // Write raw debug words instead of decoded text
 } dac_debug_stream_params_t;
 
+// Validate and parse a waveform file into an allocated command array (caller frees).
+// Pass sys_sts to also check delays against the DAC minimum delay (NULL skips timing checks).
+int parse_waveform_file(const char* file_path, waveform_command_t** commands, int* command_count,
+                        struct sys_sts_t* sys_sts, bool verbose);
+// Same, without the verbose timing printout: when sys_sts is given the file's timing summary is returned in *timing (may be NULL).
+// Reentrant, so several files can be parsed on separate threads.
+int parse_waveform_file_timed(const char* file_path, waveform_command_t** commands, int* command_count,
+                              struct sys_sts_t* sys_sts, command_file_timing_t* timing);
+
+// Rewrite a parsed waveform in place with the same output timing and fewer FIFO words: writes of values already
+// on the outputs become no-ops, and runs of no-op delays are merged. Merged delays are split so that every
+// part stays at or above min_delay (the DAC core's latched minimum). Delay-wait writes are only turned into
+// no-ops when delay_writes_exact says a write takes exactly its delay (see waveform_delay_writes_exact);
+// trigger-wait writes always are. Returns the new command count.
+int optimize_waveform_commands(waveform_command_t* commands, int command_count, uint32_t min_delay,
+                               bool delay_writes_exact, waveform_opt_stats_t* stats);
+
 // DAC FIFO status commands
 int cmd_dac_cmd_fifo_sts(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 int cmd_dac_data_fifo_sts(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
@@ -63,6 +91,11 @@ int cmd_dac_zero(const char** args, int arg_count, const command_flag_t* flags,
 int cmd_stream_dac_commands_from_file(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 int cmd_stop_dac_cmd_stream(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 
+// DAC command DMA operations (hardware streams a pre-encoded waveform from reserved memory)
+int cmd_dma_dac_commands_from_file(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+int cmd_stop_dac_dma(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+int cmd_dac_dma_sts(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+
 // DAC debug streaming operations (streaming debug data to files)
 int cmd_stream_dac_debug(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 int cmd_stop_dac_debug_stream(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
@@ -29,4 +29,10 @@ int cmd_stop_fieldmap(const char** args, int arg_count, const command_flag_t* fl
 // Stop waveform test command - stops all streaming and monitoring
 int cmd_stop_waveform(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 
+// Latency test command - trigger-to-DAC-write and trigger-to-ADC-data latency and jitter histograms per board
+int cmd_latency_test(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+
+// Parse benchmark command - times sequential vs per-board parallel parsing of a DAC or ADC command file
+int cmd_parse_bench(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+
 #endif // EXPERIMENT_COMMANDS_H
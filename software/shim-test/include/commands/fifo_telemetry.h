@@ -0,0 +1,103 @@
+#ifndef FIFO_TELEMETRY_H
+#define FIFO_TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "sys_sts.h"
+
+// FIFO fill-level telemetry
+//
+// A sampler thread reads the word count of every present DAC/ADC/trigger FIFO (and the hardware status word)
+// from the status registers at a fixed rate into an in-memory ring, and keeps min/max/mean fill per FIFO for
+// the whole run. The ring can be dumped to a compact binary file on demand, and is dumped automatically when
+// the hardware manager leaves the running state (the same event that raises its interrupt).
+//
+// FIFO ids: board b DAC command 4b, DAC data 4b+1, ADC command 4b+2, ADC data 4b+3; then trigger command and
+// trigger data (32 and 33 for 8 boards). Only FIFOs present when sampling starts are recorded.
+// The header's id/depth arrays have FIFO_TELEMETRY_FIFOS slots, so their size follows SHIM_MAX_BOARDS.
+//
+// Dump file layout (little-endian): fifo_telemetry_header_t, then sample_count records, oldest first:
+//   uint64_t t_ns        CLOCK_MONOTONIC time since the sampler started
+//   uint32_t hw_status   Hardware status register
+//   uint16_t count[fifo_count]  Word counts, in header fifo_id order
+#define FIFO_TELEMETRY_MAGIC            "SHIMFIFO"
+#define FIFO_TELEMETRY_VERSION          (uint32_t) 1
+#define FIFO_TELEMETRY_FIFOS            (4 * SHIM_MAX_BOARDS + 2)
+#define FIFO_TELEMETRY_TRIG_CMD         (4 * SHIM_MAX_BOARDS)
+#define FIFO_TELEMETRY_TRIG_DATA        (4 * SHIM_MAX_BOARDS + 1)
+#define FIFO_TELEMETRY_DEFAULT_RATE_HZ  (uint32_t) 10000
+#define FIFO_TELEMETRY_MAX_RATE_HZ      (uint32_t) 100000
+#define FIFO_TELEMETRY_DEFAULT_SECONDS  (uint32_t) 10
+#define FIFO_TELEMETRY_MAX_SAMPLES      (uint32_t) (1 << 24)
+#define FIFO_TELEMETRY_POST_HALT        (uint32_t) 100 // Samples kept after a halt before the automatic dump
+
+// Why a dump was written
+#define FIFO_TELEMETRY_DUMP_DEMAND      0
+#define FIFO_TELEMETRY_DUMP_HALT        1
+
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t header_bytes;       // sizeof(fifo_telemetry_header_t)
+  uint32_t record_bytes;       // 12 + 2 * fifo_count
+  uint32_t fifo_count;         // Count fields per record
+  uint32_t rate_hz;            // Requested sample rate
+  uint32_t reason;             // FIFO_TELEMETRY_DUMP_*
+  uint64_t sample_count;       // Records following the header
+  uint64_t overwritten;        // Samples lost to ring wrap before the oldest record
+  uint64_t start_realtime_ns;  // CLOCK_REALTIME when the sampler started (t_ns is relative to this)
+  uint8_t fifo_id[FIFO_TELEMETRY_FIFOS];      // FIFO id of each count field (first fifo_count entries)
+  uint8_t reserved[6];
+  uint16_t fifo_depth[FIFO_TELEMETRY_FIFOS];  // Depth in words of each count field
+  uint32_t reserved_end;
+} fifo_telemetry_header_t;
+
+// Per-FIFO statistics over the whole run
+typedef struct {
+  uint16_t min;
+  uint16_t max;
+  uint64_t sum;
+  uint64_t empty_samples;
+} fifo_telemetry_stats_t;
+
+typedef struct fifo_telemetry {
+  struct sys_sts_t* sys_sts;
+  bool verbose;
+  uint32_t rate_hz;
+  char halt_dump_path[1024];   // Automatic dump on halt (empty = none)
+
+  // Recorded FIFOs
+  uint32_t fifo_count;
+  uint8_t fifo_id[FIFO_TELEMETRY_FIFOS];
+  uint16_t fifo_depth[FIFO_TELEMETRY_FIFOS];
+  volatile uint32_t* fifo_sts[FIFO_TELEMETRY_FIFOS];
+
+  // Ring of records (record_bytes each), written by the sampler under the mutex
+  uint8_t* ring;
+  uint32_t record_bytes;
+  uint32_t capacity;
+  uint64_t written;            // Total samples taken
+  uint64_t late_samples;       // Samples taken more than one period late
+  fifo_telemetry_stats_t stats[FIFO_TELEMETRY_FIFOS];
+  uint64_t start_ns;
+  uint64_t start_realtime_ns;
+
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  volatile bool stop;
+  bool halt_dumped;
+} fifo_telemetry_t;
+
+// Start sampling every present FIFO at rate_hz, keeping the last <capacity> samples.
+// halt_dump_path (may be NULL) is written automatically when the hardware leaves the running state.
+fifo_telemetry_t* fifo_telemetry_start(struct sys_sts_t* sys_sts, uint32_t rate_hz, uint32_t capacity,
+                                       const char* halt_dump_path, bool verbose);
+// Stop the sampler thread and free the ring
+void fifo_telemetry_stop(fifo_telemetry_t* telemetry);
+// Write the ring to a file (safe while sampling). Returns the records written, or -1 on error.
+int64_t fifo_telemetry_dump(fifo_telemetry_t* telemetry, const char* path, uint32_t reason);
+// Print rate, sample counts and min/mean/max fill and minimum headroom for each FIFO
+void fifo_telemetry_print_summary(fifo_telemetry_t* telemetry);
+
+#endif // FIFO_TELEMETRY_H
@@ -0,0 +1,95 @@
+#ifndef FILE_SCAN_H
+#define FILE_SCAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+// Line and integer scanning for DAC/ADC command files
+// Files are mapped read-only and walked in place, one line at a time, with integer scanners that accept what
+// sscanf's %u and %d accept (leading whitespace, optional sign, decimal digits) without its per-call overhead.
+typedef struct {
+  const char* data;  // File contents (NULL for an empty file)
+  size_t size;
+} mapped_file_t;
+
+// Map a file read-only. Returns -1 with errno set on failure.
+int mapped_file_open(const char* path, mapped_file_t* file);
+void mapped_file_close(mapped_file_t* file);
+
+// Rough line count for a file of <bytes> at about <bytes_per_line>, for sizing an array that grows if it's short
+static inline int scan_line_estimate(size_t bytes, size_t bytes_per_line) {
+  size_t estimate = bytes / bytes_per_line + 16;
+  return estimate > (1 << 20) ? (1 << 20) : (int)estimate;
+}
+
+// Advance *pos to the next line. Sets [*line, *line_end) to the line without its '\n'; false at end of data.
+static inline bool scan_next_line(const char** pos, const char* end, const char** line, const char** line_end) {
+  if (*pos >= end) return false;
+  const char* newline = memchr(*pos, '\n', (size_t)(end - *pos));
+  *line = *pos;
+  *line_end = newline != NULL ? newline : end;
+  *pos = newline != NULL ? newline + 1 : end;
+  return true;
+}
+
+static inline bool scan_is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f' || c == '\n';
+}
+
+// Skip spaces and tabs (what the command file parsers treat as indentation)
+static inline const char* scan_skip_indent(const char* p, const char* end) {
+  while (p < end && (*p == ' ' || *p == '\t')) p++;
+  return p;
+}
+
+// Skip up to max_chars non-space characters (a "%<max>s" / "%c" command token)
+static inline const char* scan_skip_token(const char* p, const char* end, int max_chars) {
+  while (max_chars-- > 0 && p < end && !scan_is_space(*p)) p++;
+  return p;
+}
+
+// Scan an optionally signed decimal integer after whitespace. Saturates at +/-UINT32_MAX in magnitude.
+static inline bool scan_integer(const char** pos, const char* end, bool* negative, uint32_t* magnitude) {
+  const char* p = *pos;
+  while (p < end && scan_is_space(*p)) p++;
+  *negative = false;
+  if (p < end && (*p == '+' || *p == '-')) {
+    *negative = (*p == '-');
+    p++;
+  }
+  if (p >= end || *p < '0' || *p > '9') return false;
+  uint64_t value = 0;
+  while (p < end && *p >= '0' && *p <= '9') {
+    if (value <= UINT32_MAX) value = value * 10 + (uint64_t)(*p - '0');
+    p++;
+  }
+  *magnitude = value > UINT32_MAX ? UINT32_MAX : (uint32_t)value;
+  *pos = p;
+  return true;
+}
+
+// Like %u: a negative value wraps modulo 2^32
+static inline bool scan_u32(const char** pos, const char* end, uint32_t* value) {
+  bool negative;
+  uint32_t magnitude;
+  if (!scan_integer(pos, end, &negative, &magnitude)) return false;
+  *value = negative ? (uint32_t)(0u - magnitude) : magnitude;
+  return true;
+}
+
+// Like %d, saturating at the int32 range
+static inline bool scan_i32(const char** pos, const char* end, int32_t* value) {
+  bool negative;
+  uint32_t magnitude;
+  if (!scan_integer(pos, end, &negative, &magnitude)) return false;
+  if (negative) {
+    *value = magnitude > (uint32_t)INT32_MAX + 1 ? INT32_MIN : (int32_t)(0 - (int64_t)magnitude);
+  } else {
+    *value = magnitude > (uint32_t)INT32_MAX ? INT32_MAX : (int32_t)magnitude;
+  }
+  return true;
+}
+
+#endif // FILE_SCAN_H
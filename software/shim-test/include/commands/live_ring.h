@@ -0,0 +1,129 @@
+#ifndef LIVE_RING_H
+#define LIVE_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "shim_boards.h"
+#include "adc_index.h"
+
+// Live data rings in POSIX shared memory (/dev/shm<name>)
+//
+// The ADC data stream threads (one ring per board) and the trigger data stream thread (one ring) publish
+// every record they write to file. Each ring has a single producer and any number of readers; the producer
+// never waits, so a reader that falls more than a ring's capacity behind loses the oldest records.
+//
+// Segment layout (little-endian, all offsets from the start of the segment):
+//   live_ring_header_t, then live_ring_ctrl_t for each ADC board (SHIM_MAX_BOARDS) and the trigger ring, then the records.
+//
+// Publish protocol (per record, sequence numbers start at 1):
+//   slot = (seq - 1) & (capacity - 1); slot.seq = 0; write fields; slot.seq = seq (release); head = seq (release)
+// Read protocol:
+//   for seq <= head: check slot.seq == seq (acquire), copy the record, check slot.seq == seq again.
+//   A mismatch means the producer lapped the reader; skip ahead to head - capacity + 1.
+//
+// Trigger alignment: ADC record <trigger> counts the triggers before that frame (0 = before the first), known
+// when the stream was given an ADC command file. Trigger record <trigger> is the 1-based trigger number, so
+// ADC frames with trigger == t were read after the trigger whose record has trigger == t.
+#define LIVE_RING_SHM_NAME          "/rev_d_shim_live"
+#define LIVE_RING_MAGIC             "SHIMLIVE"
+#define LIVE_RING_VERSION           (uint32_t) 1
+#define LIVE_RING_ADC_RINGS         SHIM_MAX_BOARDS
+#define LIVE_RING_DEFAULT_FRAMES    (uint32_t) 4096    // ADC frames per board
+#define LIVE_RING_DEFAULT_TRIGGERS  (uint32_t) 4096    // Trigger records
+#define LIVE_RING_MAX_RECORDS       (uint32_t) (1 << 20)
+#define LIVE_RING_NO_TRIGGER        UINT64_MAX         // Trigger alignment unknown (no ADC command file)
+
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t header_bytes;       // sizeof(live_ring_header_t)
+  uint64_t segment_bytes;      // Total segment size
+  uint32_t adc_record_bytes;   // sizeof(live_adc_record_t)
+  uint32_t trig_record_bytes;  // sizeof(live_trig_record_t)
+  uint64_t ctrl_offset;        // Offset of the live_ring_ctrl_t array (ADC boards, then trigger)
+  uint64_t adc_offset[LIVE_RING_ADC_RINGS]; // Offset of each board's ADC records
+  uint64_t trig_offset;        // Offset of the trigger records
+} live_ring_header_t;
+
+// Ring control block, one cache line each so producers on different boards don't share lines
+typedef struct {
+  volatile uint64_t head;      // Sequence number of the newest published record (0 = none yet)
+  volatile uint32_t stream;    // Incremented each time a stream starts publishing to this ring
+  uint32_t capacity;           // Records in the ring (power of two)
+  uint8_t reserved[48];
+} live_ring_ctrl_t;
+
+typedef struct {
+  volatile uint64_t seq;       // Sequence number of the record in this slot (0 while being written)
+  uint32_t stream;             // Stream that wrote the record
+  uint32_t board;
+  uint64_t frame;              // Frame index within the stream
+  uint64_t trigger;            // Triggers before this frame, or LIVE_RING_NO_TRIGGER
+  uint64_t publish_ns;         // CLOCK_MONOTONIC time the frame was published
+  int16_t samples[8];          // Channels 0-7, as written to file (bias corrected with --corrected)
+  uint64_t reserved;
+} live_adc_record_t;
+
+typedef struct {
+  volatile uint64_t seq;       // Sequence number of the record in this slot (0 while being written)
+  uint32_t stream;             // Stream that wrote the record
+  uint32_t reserved;
+  uint64_t trigger;            // 1-based trigger number within the stream
+  uint64_t timestamp;          // Hardware trigger timestamp (clock cycles)
+  uint64_t publish_ns;         // CLOCK_MONOTONIC time the trigger was published
+} live_trig_record_t;
+
+// Producer handle (owned by the command context, shared by the stream threads)
+typedef struct live_ring {
+  char name[64];
+  uint8_t* base;
+  uint64_t segment_bytes;
+  live_ring_ctrl_t* ctrl;      // LIVE_RING_ADC_RINGS + 1 entries
+  live_adc_record_t* adc[LIVE_RING_ADC_RINGS];
+  live_trig_record_t* trig;
+  // Per-producer state, only touched by the thread streaming that board (or triggers)
+  struct {
+    uint32_t pending[4];       // Words of a frame split across reads
+    uint32_t pending_count;
+    uint64_t frame;
+    uint64_t segment;          // Current trigger segment and the frame where it ends
+    uint64_t segment_end;
+  } adc_state[LIVE_RING_ADC_RINGS];
+  uint64_t trig_count;
+} live_ring_t;
+
+// Reader handle
+typedef struct {
+  const uint8_t* base;
+  uint64_t segment_bytes;
+  const live_ring_header_t* header;
+  const live_ring_ctrl_t* ctrl;
+} live_ring_reader_t;
+
+// Producer API
+// Create (or replace) the shared memory segment. Record counts are rounded up to powers of two.
+live_ring_t* live_ring_create(const char* name, uint32_t adc_frames, uint32_t trig_records, bool verbose);
+// Unmap and remove the segment (readers keep their mapping until they detach)
+void live_ring_destroy(live_ring_t* ring);
+// Start a new ADC stream on a board. schedule (may be NULL) gives the frames per trigger for alignment.
+void live_ring_adc_begin(live_ring_t* ring, uint8_t board, const adc_index_schedule_t* schedule);
+// Publish data words in stream order; whole frames are published, a partial frame waits for the next call
+void live_ring_adc_publish(live_ring_t* ring, uint8_t board, const adc_index_schedule_t* schedule,
+                           const uint32_t* words, uint32_t count);
+// Start a new trigger stream
+void live_ring_trig_begin(live_ring_t* ring);
+// Publish one trigger timestamp
+void live_ring_trig_publish(live_ring_t* ring, uint64_t timestamp);
+
+// Reader API (for local tools linking this file; docs/live_ring.py is the Python equivalent)
+int live_ring_attach(const char* name, live_ring_reader_t* reader);
+void live_ring_detach(live_ring_reader_t* reader);
+// Copy up to <max> ADC records for a board starting at *next_seq (start at 1, or at head + 1 for live data only).
+// Advances *next_seq and adds records lost to overruns to *dropped (may be NULL). Returns the records copied.
+int live_ring_read_adc(const live_ring_reader_t* reader, uint8_t board, uint64_t* next_seq,
+                       live_adc_record_t* out, int max, uint64_t* dropped);
+// Same for trigger records
+int live_ring_read_trig(const live_ring_reader_t* reader, uint64_t* next_seq,
+                        live_trig_record_t* out, int max, uint64_t* dropped);
+
+#endif // LIVE_RING_H
@@ -0,0 +1,26 @@
+#ifndef NPY_FILE_H
+#define NPY_FILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// NumPy .npy (format 1.0) output for streamed data
+// The header is written with a fixed size so the row count can be patched in place when the stream closes.
+#define NPY_HEADER_BYTES 128          // Total header size including magic (multiple of 64 as numpy writes it)
+#define NPY_DESCR_INT16  "<i2"        // ADC samples
+#define NPY_DESCR_UINT64 "<u8"        // Trigger timestamps
+#define NPY_EXTENSION    ".npy"
+
+// Write an .npy header at the current position (start of the file).
+// cols == 0 gives a 1-D array of <rows>, otherwise a C-order [rows, cols] array.
+int npy_write_header(FILE* file, const char* descr, uint64_t rows, uint32_t cols);
+
+// Rewrite the header with the final row count and trim any partial row at the end of the data.
+// row_bytes is the size of one row in bytes. Leaves the file position at the end of the data.
+int npy_finalize(FILE* file, const char* descr, uint64_t rows, uint32_t cols, uint32_t row_bytes);
+
+// Whether a path ends in .npy
+bool npy_path(const char* path);
+
+#endif // NPY_FILE_H
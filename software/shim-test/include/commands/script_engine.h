@@ -0,0 +1,40 @@
+#ifndef SCRIPT_ENGINE_H
+#define SCRIPT_ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "command_helper.h"
+
+// Script engine limits
+#define SCRIPT_LINE_MAX            256     // Longest script line
+#define SCRIPT_MAX_PARALLEL        16      // Most commands in one parallel block
+#define SCRIPT_DEFAULT_TIMEOUT_MS  10000   // Timeout for wait commands that don't specify one
+#define SCRIPT_MAX_TIMEOUT_MS      3600000 // Longest accepted wait timeout (1 hour)
+#define SCRIPT_PACE_TIMEOUT_US     250000  // Bound on the drain between steps (the old fixed delay between lines)
+#define SCRIPT_PACE_SETTLE_US      1000    // Settle after the drain, for the last popped command to execute
+
+// Run a command script. With pace set, each step is followed by a drain of every command FIFO that isn't
+// fed by a stream thread or DMA (bounded by SCRIPT_PACE_TIMEOUT_US; a timeout is reported and the script
+// goes on) and a SCRIPT_PACE_SETTLE_US settle. Without it, lines execute back to back and the script paces
+// itself with the wait_* commands. Lines between "parallel" and "end" each run in their own thread and the block
+// finishes when all of them return. Commands that power or reset the system, write shared control or clock
+// registers, take over the hardware or own process-wide state (see script_exclusive_commands) are not
+// reentrant and run alone, in no particular order; all other lines, including wait_*, run concurrently.
+// Concurrent lines should target different boards: two writers to one FIFO interleave their words.
+// Prints the time taken by each step and the total.
+// Returns 0 on success, or -1 at the first failing step (with its line number printed).
+int script_run_file(const char* path, command_context_t* ctx, bool pace);
+
+// Wait commands (usable interactively and from scripts)
+// wait_empty <dac|adc|trig|all> <board|all> [timeout_ms]: wait for command FIFOs to drain
+int cmd_wait_empty(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+// wait_triggers <count> [timeout_ms]: wait for <count> more triggers than when the wait started
+int cmd_wait_triggers(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+// wait_state <state_code> [timeout_ms]: wait for the hardware manager to reach a state
+int cmd_wait_state(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+// wait_stream <dac|adc|dac_debug|adc_data|trig> <board|all> [timeout_ms]: wait for stream threads to finish
+int cmd_wait_stream(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+// wait_ms <milliseconds>: fixed delay
+int cmd_wait_ms(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+
+#endif // SCRIPT_ENGINE_H
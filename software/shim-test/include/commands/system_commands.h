@@ -36,6 +36,7 @@ int cmd_set_clk_div(const char** args, int arg_count, const command_flag_t* flag
 int cmd_clk_load_default(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 int cmd_clk_load_user(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 int cmd_clk_set(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+int cmd_clk_optimize(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 int cmd_get_min_delay_times(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 
 // Threshold configuration commands
@@ -43,6 +44,25 @@ int cmd_set_thresh_window(const char** args, int arg_count, const command_flag_t
 int cmd_set_thresh_average(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 int cmd_set_thresh_en(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 
+// Live data ring commands
+int cmd_live_ring_open(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+int cmd_live_ring_close(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+
+// FIFO fill-level telemetry commands
+int cmd_fifo_telemetry_start(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+int cmd_fifo_telemetry_dump(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+int cmd_fifo_telemetry_stop(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+
+// Real-time profile commands
+int cmd_rt_enable(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+int cmd_rt_disable(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+int cmd_rt_status(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+
+// Thread tracing commands
+int cmd_trace_start(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+int cmd_trace_stop(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+int cmd_trace_dump(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+
 // Safe buffer reset function
 void safe_buffer_reset(command_context_t* ctx, bool verbose);
 
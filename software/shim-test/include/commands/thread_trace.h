@@ -0,0 +1,76 @@
+#ifndef THREAD_TRACE_H
+#define THREAD_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timing.h"
+
+// Per-thread hot-path tracing
+//
+// Each traced thread (the DAC/ADC command stream threads, ADC/trigger data stream threads and the fieldmap
+// thread) owns one ring of span records: the start time and duration of a FIFO status read, a batch of FIFO
+// reads or writes, a file write or a sleep. Only the owning thread writes its ring, so recording takes no
+// lock (apart from the first span of a session, which may swap the ring buffer under a per-ring lock that
+// exporters also hold); when tracing is off a span costs one flag check. Rings are keyed by thread name ("DAC cmd 0", ...),
+// so a stream that is restarted keeps appending to the same timeline.
+//
+// Tracing is toggled at runtime. Each thread_trace_start begins a new session: rings are reset the next time
+// their thread records a span, and rings not written since are left out of the export. Export is Chrome
+// trace event JSON (complete "X" events, one track per thread), which chrome://tracing and Perfetto load.
+//
+// Usage in a thread:
+//   thread_trace_register("ADC data", board);
+//   uint64_t t0 = thread_trace_begin();
+//   ...work...
+//   thread_trace_end(TRACE_FIFO_STATUS, t0, 0);
+#define THREAD_TRACE_MAX_THREADS     64
+#define THREAD_TRACE_DEFAULT_EVENTS  (uint32_t) 65536   // Spans kept per thread
+#define THREAD_TRACE_MAX_EVENTS      (uint32_t) (1 << 22)
+#define THREAD_TRACE_NAME_LEN        24
+
+// Span types
+typedef enum {
+  TRACE_FIFO_STATUS,    // Status register read (arg: words in FIFO)
+  TRACE_FIFO_BATCH,     // Batch of FIFO reads or command writes (arg: words)
+  TRACE_FILE_WRITE,     // fwrite/fprintf/fflush of one batch (arg: words)
+  TRACE_SLEEP,          // Waiting for FIFO data or space (arg: requested microseconds)
+  TRACE_EVENT_COUNT
+} thread_trace_event_t;
+
+typedef struct {
+  uint64_t start_ns;    // CLOCK_MONOTONIC
+  uint32_t dur_ns;
+  uint16_t event;       // thread_trace_event_t
+  uint16_t arg;         // Saturates at 65535
+} thread_trace_record_t;
+
+// Set by thread_trace_start/stop; checked inline so disabled tracing stays off the hot path
+extern volatile bool thread_trace_enabled;
+
+static inline uint64_t thread_trace_begin(void) {
+  if (!thread_trace_enabled) return 0;
+  return timing_now_ns();
+}
+
+// Record a span that started at t0 (a thread_trace_begin value; 0 records nothing)
+void thread_trace_record(thread_trace_event_t event, uint64_t t0, uint32_t arg);
+
+static inline void thread_trace_end(thread_trace_event_t event, uint64_t t0, uint32_t arg) {
+  if (t0 != 0) thread_trace_record(event, t0, arg);
+}
+
+// Name the calling thread's ring ("<name> <index>", or just <name> if index < 0). Call once at thread start.
+void thread_trace_register(const char* name, int index);
+
+// Start a new tracing session keeping up to events_per_thread spans per thread (oldest overwritten)
+int thread_trace_start(uint32_t events_per_thread);
+// Stop recording (the rings are kept for export)
+void thread_trace_stop(void);
+// Write the current session as Chrome trace JSON. Returns the number of spans written, or -1 on error.
+int64_t thread_trace_export(const char* path);
+// Print per-thread span counts and total time in each span type
+void thread_trace_print_summary(void);
+// Free all rings. Only call once every traced thread has exited.
+void thread_trace_cleanup(void);
+
+#endif // THREAD_TRACE_H
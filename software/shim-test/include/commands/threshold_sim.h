@@ -0,0 +1,43 @@
+#ifndef THRESHOLD_SIM_H
+#define THRESHOLD_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "command_helper.h"
+#include "dac_commands.h"
+
+// Threshold core variants (matches threshold_core_level in block_design.tcl)
+typedef enum {
+  THRESH_SIM_TIMER = 1,      // threshold_timer: net time above thresh_val over the window
+  THRESH_SIM_INTEGRATOR = 2  // threshold_integrator: chunked rolling sum over the window
+} thresh_sim_core_t;
+
+// Threshold simulation configuration
+typedef struct {
+  thresh_sim_core_t core;   // Which threshold core to model
+  uint32_t window;          // thresh_window register value (SPI clock cycles)
+  uint32_t thresh_val;      // thresh_val register value (only the low 15 bits reach the core)
+  uint32_t dac_latency;     // Cycles from a DAC command starting to its values reaching the threshold core
+  uint32_t trig_period;     // Assumed cycles between external triggers (used by T/NT commands)
+} thresh_sim_config_t;
+
+// Threshold simulation result for one board (8 channels)
+typedef struct {
+  bool window_too_small;       // Integrator refuses windows below 2048 cycles and trips on enable
+  uint64_t limit;              // Integrator: max rolling sum; timer: window length in cycles
+  uint64_t end_cycle;          // Cycle at which the last waveform command finishes
+  uint64_t sim_cycles;         // Total cycles simulated (waveform plus held-value tail)
+  bool violated[8];            // Whether each channel crosses the limit
+  uint64_t violation_cycle[8]; // Cycle at which the core would flag each channel
+  uint64_t peak[8];            // Peak rolling sum (integrator) or timer value (timer) per channel
+  uint64_t peak_cycle[8];      // Cycle at which the peak was reached
+} thresh_sim_result_t;
+
+// Simulate a parsed waveform through the threshold core. Cycle 0 is the first RUNNING cycle of the core.
+// Returns 0 on success, -1 on invalid configuration.
+int thresh_sim_run(const waveform_command_t* commands, int command_count, const thresh_sim_config_t* config, thresh_sim_result_t* result);
+
+// Threshold simulation command: <timer|integrator> <window> <thresh_average> <trig_period> <board0_file> [board1_file ... board7_file]
+int cmd_thresh_sim(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+
+#endif // THRESHOLD_SIM_H
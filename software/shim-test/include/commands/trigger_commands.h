@@ -10,6 +10,7 @@ typedef struct {
   uint64_t sample_count;           // Number of trigger samples to read (64-bit each)
   volatile bool* should_stop;
   bool binary_mode;                // true for binary format, false for ASCII format
+  bool npy_mode;                   // Binary data behind an .npy header (uint64 timestamps), implies binary_mode
 } trigger_data_stream_params_t;
 
 // Structure for trigger monitoring thread
@@ -38,6 +39,8 @@ int cmd_trig_count(const char** args, int arg_count, const command_flag_t* flags
 int cmd_trig_set_lockout(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 int cmd_trig_delay(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 int cmd_trig_expect_ext(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+int cmd_trig_set_period(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
+int cmd_trig_periodic(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
 
 // Trigger data streaming commands
 int cmd_stream_trig_data_to_file(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx);
@@ -0,0 +1,53 @@
+#ifndef WAVEFORM_CACHE_H
+#define WAVEFORM_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "command_helper.h"
+#include "dac_commands.h"
+#include "adc_commands.h"
+
+// Parsed command file cache
+//
+// waveform_test and the stream commands it launches each need the same DAC and ADC command files: validated,
+// parsed into command arrays, and summarized into trigger and ADC word counts. The cache parses each file once
+// and hands out copies of the result, keyed by path, file size and modification time, so a file that changes
+// on disk is parsed again. Entries parsed with timing checks remember the SPI clock they were checked at; a
+// lookup that asks for timing checks at a different clock parses again.
+//
+// The cache lives in the command context and is created on first use.
+#define WAVEFORM_CACHE_MAX_ENTRIES (4 * SHIM_MAX_BOARDS) // Two files per board, twice over
+
+// Summary of one pass through a command file
+typedef struct {
+  int command_count;
+  int trigger_count;           // Triggers waited on by T/NT lines (a count of 0 counts as 1)
+  uint64_t adc_words_per_pass; // ADC data words produced (ADC files only)
+  command_file_timing_t timing; // Timing summary (only filled in when parsed with timing checks)
+} waveform_file_info_t;
+
+// One file for waveform_cache_load_parallel
+typedef struct {
+  const char* path;
+  bool is_adc;
+  bool check_timing;
+  waveform_file_info_t info; // Filled in on success
+  int result;                // 0 on success, -1 on failure (the error is printed by the parser)
+  command_context_t* ctx;    // Set by waveform_cache_load_parallel
+} waveform_cache_load_t;
+
+// Look up (parsing on a miss) a DAC waveform file. If commands is non-NULL it receives a copy of the command
+// array (caller frees); info may be NULL. check_timing validates delays against the current DAC minimum delay.
+int waveform_cache_get_dac(command_context_t* ctx, const char* path, bool check_timing, bool verbose,
+                           waveform_command_t** commands, waveform_file_info_t* info);
+// Same for an ADC command file
+int waveform_cache_get_adc(command_context_t* ctx, const char* path, bool check_timing, bool verbose,
+                           adc_command_t** commands, waveform_file_info_t* info);
+// Parse (or find in the cache) several files at once, one thread per file, so per-board files load in
+// parallel. Nothing is printed except parse errors; the caller reports each file's info afterwards.
+// Returns 0 if every file loaded, -1 if any failed.
+int waveform_cache_load_parallel(command_context_t* ctx, waveform_cache_load_t* loads, int load_count);
+// Free every entry and the cache itself
+void waveform_cache_destroy(struct waveform_cache* cache);
+
+#endif // WAVEFORM_CACHE_H
@@ -0,0 +1,61 @@
+#ifndef ADC_CONVERT_H
+#define ADC_CONVERT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "shim_boards.h"
+
+//////////////////// ADC Sample Conversion Definitions ////////////////////
+// Each ADC data word holds two signed 16-bit samples (bits 15:0 first, bits 31:16 second),
+// so one 8-channel read (a frame) is 4 words.
+#define ADC_CONVERT_MAX_CHANNELS   SHIM_MAX_CHANNELS
+#define ADC_CONVERT_FRAME_CHANNELS SHIM_CHANNELS_PER_BOARD
+#define ADC_CONVERT_FRAME_WORDS    4
+#define ADC_CONVERT_OFFSET_BITS    16     // Offsets are stored as Q16 ADC counts
+#define ADC_CONVERT_FULL_SCALE     32767  // ADC counts at full scale current
+#define ADC_CONVERT_DEFAULT_AMPS   5.0    // Full scale current in amps
+
+// Precomputed per-channel conversion table. Build once (e.g. when a stream starts or the bias changes)
+// and apply to many samples; the per-sample work is one saturating subtract and a rounding shift.
+typedef struct {
+  int32_t offset_q[ADC_CONVERT_MAX_CHANNELS]; // Bias to subtract, in Q16 counts (0 = no correction)
+  float scale[ADC_CONVERT_MAX_CHANNELS];      // Amps per corrected count
+} adc_convert_t;
+
+// Signed sample from a raw 16-bit ADC value
+static inline int16_t adc_sample_signed(uint16_t raw) {
+  return (int16_t)raw;
+}
+// First (bits 15:0) and second (bits 31:16) samples of an ADC data word
+static inline int16_t adc_word_sample_lo(uint32_t word) {
+  return (int16_t)(uint16_t)(word & 0xFFFF);
+}
+static inline int16_t adc_word_sample_hi(uint32_t word) {
+  return (int16_t)(uint16_t)(word >> 16);
+}
+
+// Table setup
+// Initialize with no bias correction and <full_scale_amps> at ADC_CONVERT_FULL_SCALE counts
+void adc_convert_init(adc_convert_t* conv, double full_scale_amps);
+// Set the bias (in ADC counts) subtracted from a channel
+void adc_convert_set_bias(adc_convert_t* conv, int channel, double bias_counts);
+// Set the bias for channels [0, count) from bias/valid arrays (invalid channels get no correction)
+void adc_convert_load_bias(adc_convert_t* conv, const double* bias, const bool* valid, int count);
+
+// Scalar conversions
+// Bias-corrected sample, rounded to the nearest count (halves round up) and saturated to int16
+int16_t adc_convert_sample(const adc_convert_t* conv, int channel, int16_t sample);
+// Bias-corrected sample without rounding (for averaging)
+double adc_convert_counts(const adc_convert_t* conv, int channel, int16_t sample);
+// Bias-corrected sample in amps
+double adc_convert_amps(const adc_convert_t* conv, int channel, int16_t sample);
+
+// Frame kernels (NEON when available, scalar otherwise; both give identical results)
+// Correct one 8-channel frame (4 data words) for channels [first_channel, first_channel + 8)
+void adc_convert_frame(const adc_convert_t* conv, int first_channel, const uint32_t* words, int16_t* out);
+// Convert one 8-channel frame to amps
+void adc_convert_frame_amps(const adc_convert_t* conv, int first_channel, const uint32_t* words, float* out);
+// Correct <frame_count> consecutive frames in place, keeping the data word layout
+void adc_convert_frames_in_place(const adc_convert_t* conv, int first_channel, uint32_t* words, uint32_t frame_count);
+
+#endif // ADC_CONVERT_H
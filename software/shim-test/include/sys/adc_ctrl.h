@@ -3,7 +3,9 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "map_memory.h"
+#include "shim_boards.h"
 
 // ADC wait mode flags for ADC commands
 typedef enum {
@@ -20,11 +22,16 @@ typedef enum {
 //////////////////// ADC Control Definitions ////////////////////
 // ADC FIFO address
 #define ADC_FIFO(board)    (0x80001000 + (board) * 0x10000)
+// ADC FIFO window: every word address in it aliases the FIFO, so block reads can burst through it
+#define ADC_FIFO_WINDOW_WORDS    (uint32_t)(1 << 10) // 1024 words (4 KB)
 
 // ADC FIFO depths
 #define ADC_CMD_FIFO_WORDCOUNT   (uint32_t)(1 << 10) // 1024 words (2^10)
 #define ADC_DATA_FIFO_WORDCOUNT  (uint32_t)(1 << 13) // 8192 words (2^13)
 
+// Hardware floor on the latched minimum delay (9 cycles per bit * (16 bits + 3 overhead))
+#define ADC_MIN_DELAY_FLOOR      (uint32_t) 171
+
 // ADC state codes
 #define ADC_STATE_RESET      0
 #define ADC_STATE_INIT       1
@@ -65,9 +72,20 @@ typedef enum {
 
 //////////////////////////////////////////////////////////////////
 
+// Decoded ADC debug word. Fields not used by a code are 0.
+typedef struct {
+  uint8_t code;        // ADC_DBG_*
+  uint8_t from_state;  // ADC_DBG_STATE_TRANSITION
+  uint8_t to_state;
+  uint8_t command;     // ADC_DBG_REPEAT / ADC_DBG_CMD_DONE: ADC_CMD_*
+  bool flag;           // ADC_DBG_REPEAT: repeat bit; ADC_DBG_CMD_DONE: next command ready
+  int32_t value;       // MISO data (signed), repeat count, n_cs timer, SPI bit, or the raw word if unknown
+} adc_debug_decoded_t;
+
 // ADC control structure
 struct adc_ctrl_t {
-  volatile uint32_t *buffer[8];  // ADC FIFO (command and data)
+  volatile uint32_t *buffer[SHIM_MAX_BOARDS];  // ADC FIFO window (command and data)
+  uint8_t channel_order[SHIM_MAX_BOARDS][8];   // Last channel order sent to each board (starts 0-7)
 };
 
 // Function declarations
@@ -75,9 +93,21 @@ struct adc_ctrl_t {
 struct adc_ctrl_t create_adc_ctrl(bool verbose);
 // Read ADC data word from a specific board
 uint32_t adc_read_word(struct adc_ctrl_t *adc_ctrl, uint8_t board);
-// Interpret and format ADC value as debug information
+// Read a block of data words from a specific board's ADC data FIFO (burst reads through the FIFO window).
+// The caller must know the words are there (from the FIFO status); reads past the end return 0.
+void adc_read_words(struct adc_ctrl_t *adc_ctrl, uint8_t board, uint32_t *words, size_t count);
+// Decode an ADC debug word into its fields (reentrant, no allocation)
+adc_debug_decoded_t adc_decode_debug(uint32_t adc_value);
+// Name of an ADC core state, or NULL if unknown
+const char* adc_state_name(uint8_t state_code);
+// Name of an ADC command code
+const char* adc_cmd_name(uint8_t cmd_code);
+// Format an ADC debug word / state into a caller-provided buffer (reentrant). Return the length snprintf would have written.
+int adc_format_debug_r(uint32_t adc_value, bool verbose, char* buf, size_t size);
+int adc_format_state_r(uint8_t state_code, bool verbose, char* buf, size_t size);
+// Interpret and format ADC value as debug information (per-thread static buffer)
 char* adc_format_debug(uint32_t adc_value, bool verbose);
-// Interpret and format the ADC state
+// Interpret and format the ADC state (per-thread static buffer)
 char* adc_format_state(uint8_t state_code, bool verbose);
 // Interpret and format a full ADC command word by decoding command-specific fields
 char* adc_format_command(uint32_t cmd_word, bool verbose);
@@ -85,6 +115,8 @@ char* adc_format_command(uint32_t cmd_word, bool verbose);
 char* adc_format_pair(uint32_t data_word, bool verbose);
 // Convert and format a single ADC sample from a 32-bit word
 char* adc_format_single(uint32_t data_word, bool verbose);
+// Model of ads816x_adc_timing_calc (ADS8168): minimum ADC read delay in cycles at a given SPI clock frequency
+uint32_t adc_calc_min_delay_time(uint32_t spi_clk_freq_hz);
 
 // ADC command word functions
 void adc_cmd_noop(struct adc_ctrl_t *adc_ctrl, uint8_t board, adc_wait_mode_t trig, adc_continue_mode_t cont, uint32_t value, bool verbose);
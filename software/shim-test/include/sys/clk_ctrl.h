@@ -100,4 +100,9 @@ void clk_ctrl_load_user(struct clk_ctrl_t *clk_ctrl, bool verbose);
 // Intelligently set the SPI clock to a target frequency given the source clock frequency
 int clk_ctrl_set_target_freq(struct clk_ctrl_t *clk_ctrl, struct sys_sts_t *sys_sts, double target_freq_hz, bool verbose);
 
+// Set the SPI clock (at or below max_freq_hz) that minimizes dac_weight * DAC update time + adc_weight * ADC read time,
+// using software models of the DAC/ADC timing-calc cores
+int clk_ctrl_optimize(struct clk_ctrl_t *clk_ctrl, struct sys_sts_t *sys_sts, double dac_weight, double adc_weight,
+                      double max_freq_hz, bool verbose);
+
 #endif // CLK_CTRL_H
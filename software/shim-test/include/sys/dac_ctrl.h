@@ -3,7 +3,11 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "map_memory.h"
+#include "shim_boards.h"
+
+struct dac_dma_t;
 
 // DAC wait mode flags for DAC commands
 typedef enum {
@@ -26,11 +30,16 @@ typedef enum {
 //////////////////// DAC Control Definitions ////////////////////
 // DAC FIFO address
 #define DAC_FIFO(board)    (0x80000000 + (board) * 0x10000)
+// DAC FIFO window: every word address in it aliases the FIFO, so block writes can burst through it
+#define DAC_FIFO_WINDOW_WORDS    (uint32_t)(1 << 10) // 1024 words (4 KB)
 
 // DAC FIFO depths
 #define DAC_CMD_FIFO_WORDCOUNT   (uint32_t)(1 << 13) // 8192 words (2^13)
 #define DAC_DATA_FIFO_WORDCOUNT  (uint32_t)(1 << 12) // 4096 words (2^12)
 
+// Hardware floor on the latched minimum delay (8 cycles per bit * (24 bits + 3 overhead))
+#define DAC_MIN_DELAY_FLOOR      (uint32_t) 216
+
 // DAC state codes
 #define DAC_STATE_RESET          0
 #define DAC_STATE_INIT           1
@@ -61,6 +70,10 @@ typedef enum {
 #define DAC_CMD_CONT_BIT 27
 #define DAC_CMD_LDAC_BIT 26
 
+// FIFO words per command (a DAC write is a command word plus 4 words of channel pairs)
+#define DAC_NOOP_WORDS   1
+#define DAC_WR_WORDS     5
+
 // DAC data codes
 #define DAC_DATA_CODE(word)       (((word) >> 28) & 0x0F) // Top 4 bits for debug code
 #define DAC_DBG_MISO_DATA         1
@@ -84,9 +97,21 @@ typedef enum {
 
 //////////////////////////////////////////////////////////////////
 
+// Decoded DAC data word. Fields not used by a code are 0.
+typedef struct {
+  uint8_t code;        // DAC_DBG_* or DAC_CAL_DATA
+  uint8_t from_state;  // DAC_DBG_STATE_TRANSITION
+  uint8_t to_state;
+  uint8_t spi_cmd;     // DAC_DBG_DAC_WRITE: DAC_SPI_CMD_*
+  uint8_t spi_reg;     // DAC_DBG_DAC_WRITE: register (channel)
+  uint8_t channel;     // DAC_CAL_DATA
+  int32_t value;       // MISO data, n_cs timer, SPI bit, SPI data, calibration value, or the raw word if unknown
+} dac_data_decoded_t;
+
 // DAC control structure
 struct dac_ctrl_t {
-  volatile uint32_t *buffer[8];  // DAC FIFO (command and data)
+  volatile uint32_t *buffer[SHIM_MAX_BOARDS];  // DAC FIFO window (command and data)
+  struct dac_dma_t *dma;                       // DMA feeding the same FIFOs (NULL if none); CPU writes are refused while it runs
 };
 
 // Function declarations
@@ -94,12 +119,29 @@ struct dac_ctrl_t {
 struct dac_ctrl_t create_dac_ctrl(bool verbose);
 // Read DAC data from a specific board
 uint32_t dac_read_data(struct dac_ctrl_t *dac_ctrl, uint8_t board);
-// Interpret and format DAC data word as calibration or debug information
+// Write a block of command words to a specific board's DAC command FIFO (burst writes through the FIFO window)
+void dac_write_words(struct dac_ctrl_t *dac_ctrl, uint8_t board, const uint32_t *words, size_t count);
+// Decode a DAC data word into its fields (reentrant, no allocation)
+dac_data_decoded_t dac_decode_data(uint32_t dac_value);
+// Name of a DAC core state, or NULL if unknown
+const char* dac_state_name(uint8_t state_code);
+// Name of a 4-bit AD5676 SPI command
+const char* dac_spi_cmd_name(uint8_t spi_cmd);
+// Format a DAC data word / state into a caller-provided buffer (reentrant). Return the length snprintf would have written.
+int dac_format_data_r(uint32_t dac_value, bool verbose, char* buf, size_t size);
+int dac_format_state_r(uint8_t state_code, bool verbose, char* buf, size_t size);
+// Interpret and format DAC data word as calibration or debug information (per-thread static buffer)
 char* dac_format_data(uint32_t dac_value, bool verbose);
-// Interpret and format the DAC state
+// Interpret and format the DAC state (per-thread static buffer)
 char* dac_format_state(uint8_t state_code, bool verbose);
 // Interpret and format a DAC command word by decoding command-specific fields
 char* dac_format_command(uint32_t cmd_word, bool verbose);
+// Model of ad5676_dac_timing_calc: minimum DAC update delay in cycles at a given SPI clock frequency
+uint32_t dac_calc_min_delay_time(uint32_t spi_clk_freq_hz);
+
+// Encode DAC command words without sending them (for pre-encoded command streams, e.g. DMA buffers)
+uint32_t dac_encode_noop(dac_wait_mode_t trig, dac_continue_mode_t cont, dac_ldac_mode_t ldac, uint32_t value);
+void dac_encode_dac_wr(const int16_t ch_vals[8], dac_wait_mode_t trig, dac_continue_mode_t cont, dac_ldac_mode_t ldac, uint32_t value, uint32_t words[DAC_WR_WORDS]);
 
 // DAC command word functions
 void dac_cmd_noop(struct dac_ctrl_t *dac_ctrl, uint8_t board, dac_wait_mode_t trig, dac_continue_mode_t cont, dac_ldac_mode_t ldac, uint32_t value, bool verbose);
@@ -0,0 +1,76 @@
+#ifndef DAC_DMA_H
+#define DAC_DMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "map_memory.h"
+#include "shim_boards.h"
+
+//////////////////// DAC DMA Definitions ////////////////////
+// One AXI DMA engine (MM2S only, scatter-gather) per board streams DAC command words from reserved DDR into
+// the board's DAC command FIFO. Addresses are defined in the hardware design Tcl file and the device tree.
+
+// DMA register block (64 KB apart per board)
+#define DAC_DMA(board)              (0x40400000 + (board) * 0x10000)
+#define DAC_DMA_WORDCOUNT           (uint32_t) 16 // MM2S registers (0x00 - 0x3C)
+
+// 32-bit offsets within the DMA register block
+#define DAC_DMA_MM2S_DMACR          (uint32_t) 0
+#define DAC_DMA_MM2S_DMASR          (uint32_t) 1
+#define DAC_DMA_MM2S_CURDESC        (uint32_t) 2
+#define DAC_DMA_MM2S_TAILDESC       (uint32_t) 4
+
+// MM2S control register bits
+#define DAC_DMA_DMACR_RS            (uint32_t) (1 << 0) // Run/stop
+#define DAC_DMA_DMACR_RESET         (uint32_t) (1 << 2) // Soft reset (self-clearing)
+#define DAC_DMA_DMACR_CYCLIC        (uint32_t) (1 << 4) // Cyclic BD ring (loops until stopped)
+
+// MM2S status register bits
+#define DAC_DMA_DMASR_HALTED        (uint32_t) (1 << 0)
+#define DAC_DMA_DMASR_IDLE          (uint32_t) (1 << 1)
+#define DAC_DMA_DMASR_ERR_MASK      (uint32_t) 0x00000770 // DMA and SG internal/slave/decode errors
+
+// Reserved DDR (device tree reserved-memory, no-map) split evenly between boards.
+// Each board's region starts with its descriptor ring, followed by the command words.
+#define DAC_DMA_MEM_BASE            (uint32_t) 0x38000000
+#define DAC_DMA_MEM_BYTES           (uint32_t) 0x08000000 // 128 MB
+#define DAC_DMA_BOARD_BYTES         (uint32_t) ((DAC_DMA_MEM_BYTES / SHIM_MAX_BOARDS) & ~(uint32_t)0xFFFF)
+#define DAC_DMA_BOARD_MEM(board)    (DAC_DMA_MEM_BASE + (board) * DAC_DMA_BOARD_BYTES)
+#define DAC_DMA_DESC_BYTES          (uint32_t) (64 << 10) // Descriptor ring
+#define DAC_DMA_DESC_STRIDE         (uint32_t) 64         // Descriptors must be 64-byte aligned
+#define DAC_DMA_DESC_COUNT          (DAC_DMA_DESC_BYTES / DAC_DMA_DESC_STRIDE)
+#define DAC_DMA_DATA_WORDS          ((DAC_DMA_BOARD_BYTES - DAC_DMA_DESC_BYTES) / 4)
+// Words per descriptor (the buffer length field is 23 bits of bytes)
+#define DAC_DMA_DESC_MAX_WORDS      (uint32_t) (1 << 20)
+
+//////////////////////////////////////////////////////////////////
+
+// DAC DMA structure. Both pointers are NULL for a board when the reserved memory couldn't be mapped.
+struct dac_dma_t {
+  volatile uint32_t *regs[SHIM_MAX_BOARDS]; // MM2S control and status registers
+  volatile uint32_t *mem[SHIM_MAX_BOARDS];  // Descriptor ring, then command words
+};
+
+// Create DAC DMA structure (warns, rather than exiting, if the DMA memory isn't available)
+struct dac_dma_t create_dac_dma(bool verbose);
+// Whether DMA is available for a board
+bool dac_dma_available(struct dac_dma_t *dac_dma, uint8_t board);
+// Copy command words into a board's DMA buffer. Returns 0, or -1 if they don't fit.
+int dac_dma_load(struct dac_dma_t *dac_dma, uint8_t board, const uint32_t *words, size_t count);
+// Build the descriptor ring over the loaded buffer and start the engine. The buffer holds one pass of pass_words,
+// followed by tail_words that replace the pass's last tail_words on the final pass (e.g. the last command with its
+// continue bit cleared). iterations 0 loops the pass until stopped. Returns 0, or -1 on error.
+int dac_dma_start(struct dac_dma_t *dac_dma, uint8_t board, size_t pass_words, size_t tail_words, uint32_t iterations, bool verbose);
+// Halt and reset the engine
+void dac_dma_stop(struct dac_dma_t *dac_dma, uint8_t board, bool verbose);
+// Stop the engine of every board whose DAC command buffer bit (2 * board) is set in a buffer reset mask
+void dac_dma_stop_masked(struct dac_dma_t *dac_dma, uint32_t cmd_buf_mask, bool verbose);
+// MM2S status register
+uint32_t dac_dma_status(struct dac_dma_t *dac_dma, uint8_t board);
+// Whether the engine is running and hasn't yet finished its descriptors
+bool dac_dma_busy(struct dac_dma_t *dac_dma, uint8_t board);
+// Format the MM2S status register (per-thread static buffer)
+char* dac_dma_format_status(uint32_t status);
+
+#endif // DAC_DMA_H
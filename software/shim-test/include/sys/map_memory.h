@@ -2,8 +2,15 @@
 #define MAP_MEMORY_H
 
 #include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
 
 // Function declaration for mapping 32-bit memory regions
-uint32_t *map_32bit_memory(uint32_t base_addr, uint32_t size, char *name, int verbose);
+uint32_t *map_32bit_memory(uint32_t base_addr, size_t wordcount, char *name, bool verbose);
+
+// Block copies through an aliased FIFO window (every word address in the window pushes to / pops from the
+// same FIFO). Counts longer than the window are copied in window-sized chunks, each starting at the window base.
+void fifo_window_write(volatile uint32_t *window, size_t window_words, const uint32_t *words, size_t count);
+void fifo_window_read(volatile uint32_t *window, size_t window_words, uint32_t *words, size_t count);
 
 #endif // MAP_MEMORY_H
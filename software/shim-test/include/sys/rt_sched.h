@@ -0,0 +1,68 @@
+#ifndef RT_SCHED_H
+#define RT_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//////////////////// Real-Time Execution Profile ////////////////////
+// When enabled, threads that service the FPGA FIFOs run SCHED_FIFO at a priority set by their class and
+// are pinned to one core, while the main (console/command) thread is pinned to the other core at normal
+// priority. All current and future memory is locked (mlockall) and malloc is told never to return memory
+// to the kernel, so buffers allocated once stay resident and page faults stay off the servicing loops.
+//
+// Threads opt in by calling rt_sched_thread_enter(class, name) when they start. The profile applies to
+// threads that start after it is enabled; threads already running keep their scheduling. Each thread's
+// loop calls rt_sched_loop_tick() once per iteration to record the worst-case gap between iterations
+// (how long its FIFO can go unserviced), and sleeps with rt_sched_usleep() to record how late it wakes.
+#define RT_SCHED_MAX_THREADS   64
+#define RT_SCHED_NAME_LEN      24
+#define RT_SCHED_DEFAULT_FIFO_CPU  1 // Core for FIFO-servicing threads
+#define RT_SCHED_DEFAULT_IO_CPU    0 // Core for the console and command thread (and the kernel's I/O work)
+#define RT_SCHED_STACK_PREFAULT    (64 * 1024) // Stack bytes touched at thread start so the loop never faults
+
+// Thread classes, highest priority first
+typedef enum {
+  RT_CLASS_CONTROL,   // Closed-loop control (static-shims regulator)
+  RT_CLASS_FIFO_CMD,  // DAC/ADC command stream threads (an empty command FIFO stalls the sequence)
+  RT_CLASS_FIFO_DATA, // ADC/trigger data stream threads and DAC file streaming (a full data FIFO loses data)
+  RT_CLASS_EXPERIMENT,// Fieldmap and other experiment loops
+  RT_CLASS_COUNT
+} rt_class_t;
+
+// Per-thread loop timing
+typedef struct {
+  char name[RT_SCHED_NAME_LEN];
+  rt_class_t rt_class;
+  bool realtime;               // Thread is running with the real-time profile
+  int cpu;                     // CPU the thread was pinned to (-1 = not pinned)
+  int priority;                // SCHED_FIFO priority (0 = SCHED_OTHER)
+  uint64_t iterations;
+  uint64_t last_ns;            // CLOCK_MONOTONIC time of the previous iteration
+  uint64_t max_gap_ns;         // Worst-case time between iterations
+  uint64_t sum_gap_ns;
+  uint64_t sleeps;
+  uint64_t max_wake_late_ns;   // Worst-case time slept beyond the request (scheduling latency)
+} rt_sched_thread_stats_t;
+
+// Enable the profile: lock memory, pin the calling (command) thread to io_cpu. Returns -1 on error
+// (usually missing CAP_SYS_NICE/CAP_IPC_LOCK or RLIMIT_MEMLOCK), leaving the profile disabled.
+int rt_sched_enable(int fifo_cpu, int io_cpu, bool verbose);
+// Disable the profile: unlock memory and unpin the calling thread. Running real-time threads keep their
+// scheduling until they exit.
+void rt_sched_disable(bool verbose);
+bool rt_sched_enabled(void);
+
+// Call at the start of a servicing thread. Names the thread's timing slot ("<name> <index>", or <name>
+// if index < 0) and, if the profile is enabled, applies its class priority and CPU pinning.
+void rt_sched_thread_enter(rt_class_t rt_class, const char* name, int index);
+// Record one loop iteration of the calling thread
+void rt_sched_loop_tick(void);
+// usleep, recording how late the calling thread woke
+void rt_sched_usleep(uint32_t usec);
+
+// Clear all loop timing statistics
+void rt_sched_reset_stats(void);
+// Print the profile settings and each thread's class, scheduling and worst-case loop gap
+void rt_sched_print_status(void);
+
+#endif // RT_SCHED_H
@@ -0,0 +1,21 @@
+#ifndef SHIM_BOARDS_H
+#define SHIM_BOARDS_H
+
+//////////////////// Board Count Definitions ////////////////////
+// Number of DAC/ADC board slots the software is built for. This must match max_board_count in
+// block_design.tcl: it sets the FIFO address map and the status register layout, not just array sizes.
+// Everything board-sized derives from it, but for now it must stay 8 (see below).
+#ifndef SHIM_MAX_BOARDS
+#define SHIM_MAX_BOARDS 8
+#endif
+#define SHIM_CHANNELS_PER_BOARD 8 // DAC/ADC channels on each board
+#define SHIM_MAX_CHANNELS (SHIM_MAX_BOARDS * SHIM_CHANNELS_PER_BOARD)
+
+// The HDL is built for exactly 8 board slots (block_design.tcl rejects any other max_board_count):
+// hw_manager reports a 3-bit board number and axi_sys_ctrl's buffer reset registers are 17 bits
+// (2 per board plus the trigger FIFOs). Another count needs those cores widened first.
+#if SHIM_MAX_BOARDS != 8
+#error "SHIM_MAX_BOARDS must be 8 until the HDL cores support other board counts"
+#endif
+
+#endif // SHIM_BOARDS_H
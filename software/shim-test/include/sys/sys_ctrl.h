@@ -67,6 +67,8 @@ void sys_ctrl_set_debug(struct sys_ctrl_t *sys_ctrl, uint16_t value, bool verbos
 void sys_ctrl_set_dac_cal_init(struct sys_ctrl_t *sys_ctrl, int16_t value, bool verbose);
 // Toggle the DAC pre-delay bit in the do_dac_pre_delay register
 void sys_ctrl_toggle_dac_pre_delay(struct sys_ctrl_t *sys_ctrl, bool verbose);
+// Whether the DAC pre-delay bit is set
+bool sys_ctrl_get_dac_pre_delay(struct sys_ctrl_t *sys_ctrl);
 
 
 #endif // SYS_CTRL_H
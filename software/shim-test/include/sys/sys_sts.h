@@ -3,32 +3,35 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <pthread.h>
+#include "shim_boards.h"
 
 //////////////////// System Status Definitions ////////////////////
 // Status register
 #define SYS_STS           (uint32_t) 0x40100000
-#define SYS_STS_WORDCOUNT (uint32_t) 73 // Size in 32-bit words
+#define SYS_STS_WORDCOUNT (uint32_t) (9 + 8 * SHIM_MAX_BOARDS) // Size in 32-bit words (73 for 8 boards)
 // 32-bit offsets within the status register
+// The layout follows the board count: per-board blocks are SHIM_MAX_BOARDS words (FIFO status: 2 per board)
 #define HW_STS_REG_OFFSET (uint32_t) 0 // Hardware status register
 // Command FIFO status offset for DAC board (in 32-bit words)
 #define DAC_CMD_FIFO_STS_OFFSET(board)   (1 + (2 * (board)))
 // Data FIFO status offset for DAC board (in 32-bit words)
-#define DAC_DATA_FIFO_STS_OFFSET(board)  (18 + (2 * (board)))
+#define DAC_DATA_FIFO_STS_OFFSET(board)  (2 + 2 * SHIM_MAX_BOARDS + (2 * (board)))
 // Command FIFO status offset for ADC board (in 32-bit words)
 #define ADC_CMD_FIFO_STS_OFFSET(board)   (1 + (2 * (board) + 1))
 // Data FIFO status offset for ADC board (in 32-bit words)
-#define ADC_DATA_FIFO_STS_OFFSET(board)  (18 + (2 * (board) + 1))
-#define TRIG_CMD_FIFO_STS_OFFSET    (uint32_t) 17 // Trigger command FIFO status
-#define TRIG_DATA_FIFO_STS_OFFSET   (uint32_t) 34 // Trigger data FIFO status
+#define ADC_DATA_FIFO_STS_OFFSET(board)  (2 + 2 * SHIM_MAX_BOARDS + (2 * (board) + 1))
+#define TRIG_CMD_FIFO_STS_OFFSET    (uint32_t) (1 + 2 * SHIM_MAX_BOARDS) // Trigger command FIFO status
+#define TRIG_DATA_FIFO_STS_OFFSET   (uint32_t) (2 + 4 * SHIM_MAX_BOARDS) // Trigger data FIFO status
 // SPI clock frequency offset
-#define CLK_FREQ_OFFSET         (uint32_t) 35 // SPI clock frequency in Hz
+#define CLK_FREQ_OFFSET         (uint32_t) (3 + 4 * SHIM_MAX_BOARDS) // SPI clock frequency in Hz
 // SPI source clock frequency offset
-#define SOURCE_CLK_FREQ_OFFSET      (uint32_t) 36 // SPI source clock frequency in Hz
+#define SOURCE_CLK_FREQ_OFFSET      (uint32_t) (4 + 4 * SHIM_MAX_BOARDS) // SPI source clock frequency in Hz
 // Trigger counter offset
-#define TRIG_COUNTER_OFFSET         (uint32_t) 37 // Trigger counter offset
+#define TRIG_COUNTER_OFFSET         (uint32_t) (5 + 4 * SHIM_MAX_BOARDS) // Trigger counter offset
 // Timing debug register
-#define DEBUG_REG_OFFSET            (uint32_t) 38 // Timing debug register offset
+#define DEBUG_REG_OFFSET            (uint32_t) (6 + 4 * SHIM_MAX_BOARDS) // Timing debug register offset
 #define DEBUG_CLK_LOCKED_BIT     0  // SPI clock locked status bit
 #define DEBUG_SPI_OFF_BIT        1  // SPI off status bit
 #define DEBUG_DAC_CS_HIGH_TIME(word) (((word) >> 2) & 0x1F) // DAC ~CS high time (5 bits)
@@ -44,14 +47,14 @@
 #define SNOOP_STATE_CALC_DIV       6 // Calculating divider
 
 // Minimum delay times (in SPI clock cycles)
-#define DEBUG_DAC_MIN_DELAY_TIME_OFFSET (uint32_t) 39 // DAC minimum delay time offset
-#define DEBUG_ADC_MIN_DELAY_TIME_OFFSET (uint32_t) 40 // ADC minimum delay time offset
+#define DEBUG_DAC_MIN_DELAY_TIME_OFFSET (uint32_t) (7 + 4 * SHIM_MAX_BOARDS) // DAC minimum delay time offset
+#define DEBUG_ADC_MIN_DELAY_TIME_OFFSET (uint32_t) (8 + 4 * SHIM_MAX_BOARDS) // ADC minimum delay time offset
 // Last received command words (32-bit per board)
-#define DAC_LAST_RECEIVED_CMD_OFFSET(board)   (41 + (board))
-#define ADC_LAST_RECEIVED_CMD_OFFSET(board)   (49 + (board))
+#define DAC_LAST_RECEIVED_CMD_OFFSET(board)   (9 + 4 * SHIM_MAX_BOARDS + (board))
+#define ADC_LAST_RECEIVED_CMD_OFFSET(board)   (9 + 5 * SHIM_MAX_BOARDS + (board))
 // Command counters since reset (32-bit per board)
-#define DAC_CMDS_SINCE_RESET_OFFSET(board)    (57 + (board))
-#define ADC_CMDS_SINCE_RESET_OFFSET(board)    (65 + (board))
+#define DAC_CMDS_SINCE_RESET_OFFSET(board)    (9 + 6 * SHIM_MAX_BOARDS + (board))
+#define ADC_CMDS_SINCE_RESET_OFFSET(board)    (9 + 7 * SHIM_MAX_BOARDS + (board))
 
 // Macro for extracting the 4-bit state
 #define HW_STS_STATE(hw_status) ((hw_status) & 0xF)
@@ -138,16 +141,26 @@
 #define FIFO_STS_ALMOST_EMPTY(sts) (((sts) >> 30) & 0x1) // FIFO almost empty flag
 #define FIFO_PRESENT(sts)          (((sts) >> 31) & 0x1) // FIFO present flag
 
+// Bounded status polling
+// Buffer masks use the buffer reset layout: DAC board b is bit 2b, ADC board b is bit 2b+1, trigger is the
+// bit after the last board (bit 16 for 8 boards)
+#define SYS_STS_POLL_INTERVAL_US  (uint32_t) 20 // Interval between status register reads while polling
+#define SYS_STS_BUF_MASK_TRIG     (uint32_t) (1U << (2 * SHIM_MAX_BOARDS))
+#define SYS_STS_BUF_MASK_ALL      (uint32_t) ((SYS_STS_BUF_MASK_TRIG << 1) - 1) // Every board and the trigger
+#define SYS_STS_BUF_RESET_TIMEOUT_US (uint32_t) 10000 // Bound on a buffer reset or cancel taking effect
+#define SYS_STS_BUF_RESET_HOLD_US    (uint32_t) 1000  // Minimum buffer reset pulse width (well above the proc_sys_reset minimum)
+#define SYS_STS_BUF_RESET_SETTLE_US  (uint32_t) 1000  // Settle time after deasserting a buffer reset
+
 
 //////////////////////////////////////////////////////////////////
 
 // System status structure
 struct sys_sts_t {
   volatile uint32_t *hw_status_reg;        // Hardware status
-  volatile uint32_t *dac_cmd_fifo_sts[8];  // DAC command FIFO status for 8 boards
-  volatile uint32_t *dac_data_fifo_sts[8]; // DAC data FIFO status for 8 boards
-  volatile uint32_t *adc_cmd_fifo_sts[8];  // ADC command FIFO status for 8 boards
-  volatile uint32_t *adc_data_fifo_sts[8]; // ADC data FIFO status for 8 boards
+  volatile uint32_t *dac_cmd_fifo_sts[SHIM_MAX_BOARDS];  // DAC command FIFO status per board
+  volatile uint32_t *dac_data_fifo_sts[SHIM_MAX_BOARDS]; // DAC data FIFO status per board
+  volatile uint32_t *adc_cmd_fifo_sts[SHIM_MAX_BOARDS];  // ADC command FIFO status per board
+  volatile uint32_t *adc_data_fifo_sts[SHIM_MAX_BOARDS]; // ADC data FIFO status per board
   volatile uint32_t *trig_cmd_fifo_sts;    // Trigger command FIFO status
   volatile uint32_t *trig_data_fifo_sts;   // Trigger data FIFO status
   volatile uint32_t *clk_freq_hz;      // SPI clock frequency in Hz
@@ -156,10 +169,10 @@ struct sys_sts_t {
   volatile uint32_t *debug;                // Debug register
   volatile uint32_t *dac_min_delay_time;   // DAC minimum delay time in SPI clock cycles
   volatile uint32_t *adc_min_delay_time;   // ADC minimum delay time in SPI clock cycles
-  volatile uint32_t *last_received_dac_cmd[8]; // Last received DAC command for 8 boards
-  volatile uint32_t *last_received_adc_cmd[8]; // Last received ADC command for 8 boards
-  volatile uint32_t *dac_cmds_since_reset[8];  // DAC command count since reset for 8 boards
-  volatile uint32_t *adc_cmds_since_reset[8];  // ADC command count since reset for 8 boards
+  volatile uint32_t *last_received_dac_cmd[SHIM_MAX_BOARDS]; // Last received DAC command per board
+  volatile uint32_t *last_received_adc_cmd[SHIM_MAX_BOARDS]; // Last received ADC command per board
+  volatile uint32_t *dac_cmds_since_reset[SHIM_MAX_BOARDS];  // DAC command count since reset per board
+  volatile uint32_t *adc_cmds_since_reset[SHIM_MAX_BOARDS];  // ADC command count since reset per board
 };
 
 // Structure initialization function
@@ -204,6 +217,12 @@ uint32_t sys_sts_get_adc_cmds_since_reset(struct sys_sts_t *sys_sts, uint8_t boa
 
 // Interpret and print hardware status
 void print_hw_status(uint32_t hw_status, bool verbose);
+// Format hardware status into a caller-provided buffer (reentrant). Returns the length snprintf would have written.
+int hw_status_format(uint32_t hw_status, bool verbose, char* buf, size_t size);
+// Name of a hardware manager state, or NULL if unknown
+const char* hw_state_name(uint32_t state);
+// Description of a hardware status code, or NULL if unknown. *has_board (may be NULL) is set if the code reports a board.
+const char* hw_status_code_name(uint32_t code, bool* has_board);
 // Print SPI clock frequency in Hz and MHz
 void print_clk_freq(uint32_t freq_hz, bool verbose);
 // Print debug register
@@ -211,6 +230,18 @@ void print_debug_register(struct sys_sts_t *sys_sts);
 // Print FIFO status details
 void print_fifo_status(uint32_t fifo_status, const char *fifo_name);
 
+// Bounded status polling. Each returns 0 once the condition holds, or -1 (with an error message) on timeout.
+// Wait for the hardware manager to reach a state (fails early if the system halts on the way)
+int sys_sts_wait_for_state(struct sys_sts_t *sys_sts, uint32_t state, uint32_t timeout_us, bool verbose);
+// Wait for every present command/data FIFO selected by the buffer masks to be empty
+int sys_sts_wait_for_fifos_empty(struct sys_sts_t *sys_sts, uint32_t cmd_mask, uint32_t data_mask, uint32_t timeout_us, bool verbose);
+// Hold an asserted buffer reset for at least SYS_STS_BUF_RESET_HOLD_US and until the selected FIFOs read empty
+int sys_sts_hold_buf_reset(struct sys_sts_t *sys_sts, uint32_t cmd_mask, uint32_t data_mask, uint32_t timeout_us, bool verbose);
+// Wait for a board's DAC command count since reset to reach a value
+int sys_sts_wait_for_dac_cmds_since_reset(struct sys_sts_t *sys_sts, uint8_t board, uint32_t count, uint32_t timeout_us, bool verbose);
+// Wait for the trigger count to reach a value
+int sys_sts_wait_for_trig_count(struct sys_sts_t *sys_sts, uint32_t count, uint32_t timeout_us, bool verbose);
+
 // Hardware manager interrupt monitoring
 int sys_sts_start_hw_manager_irq_monitor(struct sys_sts_t *sys_sts, bool verbose);
 
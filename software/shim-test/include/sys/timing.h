@@ -0,0 +1,45 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdint.h>
+#include <time.h>
+
+//////////////////// Timing Helpers ////////////////////
+// Shared by the stream, telemetry, tracing, scheduling and latency code so every timestamp comes from one clock.
+
+// Time on a clock in nanoseconds
+static inline uint64_t timing_clock_ns(clockid_t clock) {
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+// CLOCK_MONOTONIC time in nanoseconds
+static inline uint64_t timing_now_ns(void) {
+  return timing_clock_ns(CLOCK_MONOTONIC);
+}
+
+// Timing histogram in microseconds. The bin edges are set by timing_hist_init: bin_count bins, whose upper
+// edges are the bin_count - 1 values of edges_us (the last bin is open-ended). The edges array must outlive the
+// histogram and its copies.
+#define TIMING_HIST_MAX_BINS 16
+typedef struct {
+  const double *edges_us;
+  int bin_count;
+  uint64_t count;
+  uint64_t bins[TIMING_HIST_MAX_BINS];
+  double min_us;
+  double max_us;
+  double sum_us;
+  double sum_sq_us;
+} timing_hist_t;
+
+// Clear a histogram and set its bin edges
+void timing_hist_init(timing_hist_t *hist, const double *edges_us, int bin_count);
+// Add one sample
+void timing_hist_add(timing_hist_t *hist, double us);
+// Mean of the samples (0 if there are none)
+double timing_hist_mean_us(const timing_hist_t *hist);
+// Print the non-empty bins with their share of the samples, one line each
+void timing_hist_print_bins(const timing_hist_t *hist);
+
+#endif // TIMING_H
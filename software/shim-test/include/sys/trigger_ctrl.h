@@ -13,6 +13,7 @@
 #define TRIG_DATA_FIFO_WORDCOUNT  (uint32_t)(1 << 10) // 1024 words (2^10)
 
 // Trigger command codes (top 3 bits of command word)
+#define TRIG_CMD_PERIODIC     0x0  // Set periodic trigger period or start periodic triggers
 #define TRIG_CMD_SYNC_CH      0x1  // Synchronize channels
 #define TRIG_CMD_SET_LOCKOUT  0x2  // Set trigger lockout time
 #define TRIG_CMD_EXPECT_EXT   0x3  // Expect external triggers
@@ -25,19 +26,39 @@
 #define TRIG_CMD_CODE_SHIFT   29   // Command code position
 #define TRIG_CMD_LOG_BIT      28   // Trigger logging enable bit
 #define TRIG_CMD_VALUE_MASK   0x0FFFFFFF // Command value mask (lower 28 bits)
+#define TRIG_CMD_PERIODIC_START_BIT  27         // Periodic command: start triggers (1) or set period (0)
+#define TRIG_CMD_PERIODIC_VALUE_MASK 0x07FFFFFF // Periodic command value mask (lower 27 bits)
+#define TRIG_PERIOD_MIN              4          // Minimum periodic trigger period in cycles
+
+// Delta trigger logging (selected by a reset count command with the log bit set)
+// Each logged trigger is one word {0, delta[30:0]} of cycles since the previous logged trigger,
+// or an escape word {1, delta[62:32]} followed by delta[31:0] for longer gaps
+#define TRIG_DELTA_ESCAPE_BIT        31
+#define TRIG_DELTA_HIGH_MASK         0x7FFFFFFF // Upper delta bits in an escape word
 
 //////////////////////////////////////////////////////////////////
 
 // Trigger control structure
 struct trigger_ctrl_t {
   volatile uint32_t *buffer; // Trigger FIFO (command and data)
+  bool delta_log;            // Trigger data is logged as deltas (set by trigger_cmd_reset_count)
+  uint64_t last_timestamp;   // Last reconstructed timestamp (delta logging)
+  bool partial;              // The first word of a two-word entry has been read
+  uint32_t partial_word;     // That first word
 };
 
 // Create trigger control structure
 struct trigger_ctrl_t create_trigger_ctrl(bool verbose);
 
-// Read 64-bit trigger data from FIFO as a pair of 32-bit words
+// Read one absolute 64-bit trigger timestamp from FIFO (two words, or one or two delta words)
 uint64_t trigger_read(struct trigger_ctrl_t *trigger_ctrl);
+// Read one raw 32-bit word from the trigger data FIFO
+uint32_t trigger_read_word(struct trigger_ctrl_t *trigger_ctrl);
+// Feed one raw trigger data word to the decoder. Returns true and sets *timestamp (absolute) when it completes an entry.
+bool trigger_decode_word(struct trigger_ctrl_t *trigger_ctrl, uint32_t word, uint64_t *timestamp);
+// Restart the decoder after the trigger data FIFO was reset (dropping any half-read entry and the timestamp base).
+// core_reset: the trigger core itself was reset (system turned off), so it is back to absolute logging too.
+void trigger_reset_decoder(struct trigger_ctrl_t *trigger_ctrl, bool core_reset);
 
 // Trigger command functions
 void trigger_cmd_sync_ch(struct trigger_ctrl_t *trigger_ctrl, bool log, bool verbose);
@@ -45,7 +66,11 @@ void trigger_cmd_set_lockout(struct trigger_ctrl_t *trigger_ctrl, uint32_t cycle
 void trigger_cmd_expect_ext(struct trigger_ctrl_t *trigger_ctrl, uint32_t count, bool log, bool verbose);
 void trigger_cmd_delay(struct trigger_ctrl_t *trigger_ctrl, uint32_t cycles, bool verbose);
 void trigger_cmd_force_trig(struct trigger_ctrl_t *trigger_ctrl, bool log, bool verbose);
-void trigger_cmd_reset_count(struct trigger_ctrl_t *trigger_ctrl, bool verbose);
+void trigger_cmd_set_period(struct trigger_ctrl_t *trigger_ctrl, uint32_t cycles, bool verbose);
+void trigger_cmd_periodic(struct trigger_ctrl_t *trigger_ctrl, uint32_t count, bool log, bool verbose);
+// Resets the count and timer, and selects delta (or absolute) logging. Drain the data FIFO first:
+// the software decoder restarts with it, so words logged before the reset would decode wrong.
+void trigger_cmd_reset_count(struct trigger_ctrl_t *trigger_ctrl, bool delta_log, bool verbose);
 void trigger_cmd_cancel(struct trigger_ctrl_t *trigger_ctrl, bool verbose);
 
 #endif // TRIGGER_CTRL_H
@@ -13,10 +13,16 @@
 #include "sys_ctrl.h"
 #include "adc_ctrl.h"
 #include "dac_ctrl.h"
+#include "dac_dma.h"
 #include "clk_ctrl.h"
 #include "sys_sts.h"
 #include "trigger_ctrl.h"
 #include "command_handler.h"
+#include "live_ring.h"
+#include "fifo_telemetry.h"
+#include "waveform_cache.h"
+#include "thread_trace.h"
+#include "rt_sched.h"
 
 //////////////////// Main ////////////////////
 int main(int argc, char *argv[])
@@ -30,6 +36,7 @@ int main(int argc, char *argv[])
   struct clk_ctrl_t clk_ctrl;         // Clock control interface
   struct sys_sts_t sys_sts;           // System status
   struct dac_ctrl_t dac_ctrl;         // DAC command FIFOs (all boards)
+  struct dac_dma_t dac_dma;           // DAC command DMA engines and their reserved memory (all boards)
   struct adc_ctrl_t adc_ctrl;         // ADC command and data FIFOs (all boards)
   struct trigger_ctrl_t trigger_ctrl; // Trigger command and data FIFOs
 
@@ -54,10 +61,14 @@ int main(int argc, char *argv[])
 
   // Initialize FIFO modules
   dac_ctrl = create_dac_ctrl(verbose);
-  printf("DAC control modules initialized (8 boards)\n");
+  printf("DAC control modules initialized (%d boards)\n", SHIM_MAX_BOARDS);
+
+  dac_dma = create_dac_dma(verbose);
+  dac_ctrl.dma = &dac_dma;
+  printf("DAC DMA modules initialized\n");
 
   adc_ctrl = create_adc_ctrl(verbose);
-  printf("ADC control modules initialized (8 boards)\n");
+  printf("ADC control modules initialized (%d boards)\n", SHIM_MAX_BOARDS);
 
   trigger_ctrl = create_trigger_ctrl(verbose);
   printf("Trigger control module initialized\n");
@@ -77,6 +88,7 @@ int main(int argc, char *argv[])
     .clk_ctrl = &clk_ctrl,
     .sys_sts = &sys_sts,
     .dac_ctrl = &dac_ctrl,
+    .dac_dma = &dac_dma,
     .adc_ctrl = &adc_ctrl,
     .trigger_ctrl = &trigger_ctrl,
     .verbose = &verbose,
@@ -92,6 +104,9 @@ int main(int argc, char *argv[])
     .trig_data_stream_stop = false,     // Initialize trigger data stream stop flag as false
     .fieldmap_running = false,          // Initialize fieldmap as not running
     .fieldmap_stop = false,             // Initialize fieldmap stop flag as false
+    .live_ring = NULL,                  // No live data ring until live_ring_open
+    .fifo_telemetry = NULL,             // No FIFO telemetry until fifo_telemetry_start
+    .waveform_cache = NULL,             // Created by the first command file lookup
     .log_file = NULL,                   // Initialize log file as NULL
     .logging_enabled = false,           // Initialize logging as disabled
     .adc_bias = {0.0},                  // Initialize all ADC bias values to 0.0
@@ -130,7 +145,7 @@ int main(int argc, char *argv[])
 
   // Stop all running ADC streaming threads
   printf("Stopping all ADC streams...\n");
-  for (int i = 0; i < 8; i++) {
+  for (int i = 0; i < SHIM_MAX_BOARDS; i++) {
     if (cmd_ctx.adc_data_stream_running[i]) {
       printf("Stopping ADC data stream for board %d...\n", i);
       cmd_ctx.adc_data_stream_stop[i] = true;
@@ -158,6 +173,10 @@ int main(int argc, char *argv[])
         printf("DAC command stream for board %d stopped.\n", i);
       }
     }
+    if (dac_dma_busy(&dac_dma, (uint8_t)i)) {
+      printf("Stopping DAC command DMA for board %d...\n", i);
+      dac_dma_stop(&dac_dma, (uint8_t)i, verbose);
+    }
   }
 
   // Stop trigger data stream if running
@@ -182,6 +201,30 @@ int main(int argc, char *argv[])
     }
   }
 
+  // Stop FIFO telemetry if running
+  if (cmd_ctx.fifo_telemetry != NULL) {
+    printf("Stopping FIFO telemetry...\n");
+    fifo_telemetry_stop(cmd_ctx.fifo_telemetry);
+    cmd_ctx.fifo_telemetry = NULL;
+  }
+
+  // Drop the real-time profile before cleanup I/O
+  rt_sched_disable(false);
+
+  // Free the thread trace rings (all traced threads have stopped)
+  thread_trace_cleanup();
+
+  // Remove the live data ring (all publishing streams have stopped)
+  if (cmd_ctx.live_ring != NULL) {
+    printf("Removing live data ring...\n");
+    live_ring_destroy(cmd_ctx.live_ring);
+    cmd_ctx.live_ring = NULL;
+  }
+
+  // Free parsed command files
+  waveform_cache_destroy(cmd_ctx.waveform_cache);
+  cmd_ctx.waveform_cache = NULL;
+
   // Close log file if logging is active
   if (cmd_ctx.logging_enabled && cmd_ctx.log_file != NULL) {
     printf("Closing command log file...\n");
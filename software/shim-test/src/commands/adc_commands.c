@@ -10,6 +10,13 @@
 #include <pthread.h>
 #include <glob.h>
 #include "adc_commands.h"
+#include "adc_index.h"
+#include "npy_file.h"
+#include "live_ring.h"
+#include "thread_trace.h"
+#include "rt_sched.h"
+#include "waveform_cache.h"
+#include "file_scan.h"
 #include "command_helper.h"
 #include "sys_sts.h"
 #include "adc_ctrl.h"
@@ -18,7 +25,6 @@
 // Forward declarations for helper functions
 static void* adc_data_stream_thread(void* arg);
 static void* adc_cmd_stream_thread(void* arg);
-static int parse_adc_command_file(const char* file_path, adc_command_t** commands, int* command_count);
 
 // Local helper function to check if system is running
 static int validate_system_running(command_context_t* ctx) {
@@ -35,7 +41,7 @@ static int validate_system_running(command_context_t* ctx) {
 int cmd_adc_cmd_fifo_sts(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = validate_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for adc_cmd_fifo_sts: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for adc_cmd_fifo_sts: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
   uint32_t fifo_status = sys_sts_get_adc_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, *(ctx->verbose));
@@ -46,7 +52,7 @@ int cmd_adc_cmd_fifo_sts(const char** args, int arg_count, const command_flag_t*
 int cmd_adc_data_fifo_sts(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = validate_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for adc_data_fifo_sts: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for adc_data_fifo_sts: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
   uint32_t fifo_status = sys_sts_get_adc_data_fifo_status(ctx->sys_sts, (uint8_t)board, *(ctx->verbose));
@@ -57,7 +63,7 @@ int cmd_adc_data_fifo_sts(const char** args, int arg_count, const command_flag_t
 int cmd_adc_last_received_cmd(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = validate_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for adc_last_received_cmd: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for adc_last_received_cmd: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -72,7 +78,7 @@ int cmd_adc_last_received_cmd(const char** args, int arg_count, const command_fl
 int cmd_adc_cmds_since_reset(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = validate_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for adc_cmds_since_reset: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for adc_cmds_since_reset: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -85,7 +91,7 @@ int cmd_adc_cmds_since_reset(const char** args, int arg_count, const command_fla
 int cmd_read_adc_pair(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = validate_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for read_adc_data: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for read_adc_data: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -122,7 +128,7 @@ int cmd_read_adc_pair(const char** args, int arg_count, const command_flag_t* fl
 int cmd_read_adc_single(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = validate_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for read_adc_single: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for read_adc_single: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -160,7 +166,7 @@ int cmd_read_adc_single(const char** args, int arg_count, const command_flag_t*
 int cmd_read_adc_dbg(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = parse_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for read_adc_dbg: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for read_adc_dbg: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -209,10 +215,10 @@ int cmd_adc_noop(const char** args, int arg_count, const command_flag_t* flags,
 
   if (use_all) {
     // Check which boards are connected by checking FIFOs
-    bool connected_boards[8] = {false};
+    bool connected_boards[SHIM_MAX_BOARDS] = {false};
     int connected_count = 0;
 
-    for (int board = 0; board < 8; board++) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       uint32_t adc_cmd_fifo_status = sys_sts_get_adc_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, false);
       uint32_t adc_data_fifo_status = sys_sts_get_adc_data_fifo_status(ctx->sys_sts, (uint8_t)board, false);
 
@@ -230,7 +236,7 @@ int cmd_adc_noop(const char** args, int arg_count, const command_flag_t* flags,
     printf("Sending ADC no-op command to %d connected board(s) with %s mode, value %u%s:\n",
            connected_count, is_trigger ? "trigger" : "delay", value, cont ? ", continuous" : "");
 
-    for (int board = 0; board < 8; board++) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       if (!connected_boards[board]) continue;
 
       adc_cmd_noop(ctx->adc_ctrl, (uint8_t)board, is_trigger ? ADC_TRIGGER_WAIT : ADC_DELAY_WAIT, cont ? ADC_CONTINUE : ADC_NO_CONTINUE, value, *(ctx->verbose));
@@ -239,7 +245,7 @@ int cmd_adc_noop(const char** args, int arg_count, const command_flag_t* flags,
   } else {
     int board = validate_board_number(args[0]);
     if (board < 0) {
-      fprintf(stderr, "Invalid board number for adc_noop: '%s'. Must be 0-7.\n", args[0]);
+      fprintf(stderr, "Invalid board number for adc_noop: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
       return -1;
     }
 
@@ -254,7 +260,7 @@ int cmd_adc_noop(const char** args, int arg_count, const command_flag_t* flags,
 int cmd_adc_cancel(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = validate_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for adc_cancel: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for adc_cancel: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -266,7 +272,7 @@ int cmd_adc_cancel(const char** args, int arg_count, const command_flag_t* flags
 int cmd_adc_set_ord(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = validate_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for adc_set_ord: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for adc_set_ord: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -297,7 +303,7 @@ int cmd_adc_set_ord(const char** args, int arg_count, const command_flag_t* flag
 int cmd_do_adc_rd(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = validate_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for adc_rd: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for adc_rd: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -362,6 +368,26 @@ int cmd_do_adc_rd_ch(const char** args, int arg_count, const command_flag_t* fla
   return 0;
 }
 
+// Bias-correct <count> data words in place. <first_word> is the stream position of words[0], which
+// sets the channel of each sample; whole frames go through the frame kernel.
+static void correct_adc_words(const adc_convert_t* conv, int first_channel, uint64_t first_word, uint32_t* words, uint32_t count) {
+  uint32_t i = 0;
+  while (i < count) {
+    uint32_t phase = (uint32_t)((first_word + i) % ADC_CONVERT_FRAME_WORDS);
+    if (phase == 0 && count - i >= ADC_CONVERT_FRAME_WORDS) {
+      uint32_t frames = (count - i) / ADC_CONVERT_FRAME_WORDS;
+      adc_convert_frames_in_place(conv, first_channel, &words[i], frames);
+      i += frames * ADC_CONVERT_FRAME_WORDS;
+      continue;
+    }
+    int ch = first_channel + (int)phase * 2;
+    int16_t lo = adc_convert_sample(conv, ch, adc_word_sample_lo(words[i]));
+    int16_t hi = adc_convert_sample(conv, ch + 1, adc_word_sample_hi(words[i]));
+    words[i] = (uint32_t)(uint16_t)lo | ((uint32_t)(uint16_t)hi << 16);
+    i++;
+  }
+}
+
 // Thread function for ADC data streaming
 static void* adc_data_stream_thread(void* arg) {
   adc_data_stream_params_t* stream_data = (adc_data_stream_params_t*)arg;
@@ -371,11 +397,17 @@ static void* adc_data_stream_thread(void* arg) {
   uint64_t word_count = stream_data->word_count;
   volatile bool* should_stop = stream_data->should_stop;
   bool binary_mode = stream_data->binary_mode;
+  bool npy_mode = stream_data->npy_mode;
+  bool corrected = stream_data->corrected;
+  live_ring_t* live_ring = ctx->live_ring; // Fixed for the stream (the ring can't close while it runs)
   bool verbose = *(ctx->verbose);
+  thread_trace_register("ADC data", board);
+  rt_sched_thread_enter(RT_CLASS_FIFO_DATA, "ADC data", board);
 
   if (verbose) {
-    printf("ADC Data Stream Thread[%d]: Starting to write %llu words to file '%s' (%s format)\n",
-           board, word_count, file_path, binary_mode ? "binary" : "ASCII");
+    printf("ADC Data Stream Thread[%d]: Starting to write %llu words to file '%s' (%s format%s)\n",
+           board, word_count, file_path, npy_mode ? "NPY" : (binary_mode ? "binary" : "ASCII"),
+           corrected ? ", bias corrected" : "");
   }
 
   // Open file for writing (binary or text mode based on format)
@@ -386,13 +418,49 @@ static void* adc_data_stream_thread(void* arg) {
     goto cleanup;
   }
 
+  // NPY: the row count is patched in when the stream closes. The data words are two little-endian
+  // int16 samples each, so they are written unchanged as 8-sample rows.
+  uint64_t data_offset = 0;
+  if (npy_mode) {
+    if (npy_write_header(file, NPY_DESCR_INT16, 0, 8) != 0) {
+      fclose(file);
+      goto cleanup;
+    }
+    data_offset = NPY_HEADER_BYTES;
+  }
+
   uint64_t words_written = 0;
   uint32_t write_buffer[256]; // Buffer for writing data
   int samples_on_line = 0; // Track samples per line for formatting (ASCII mode only)
+  uint64_t frames_written = 0; // Complete 8-channel reads written (ASCII mode index tracking)
+
+  // Trigger index sidecar
+  adc_index_writer_t index_writer = {0};
+  bool indexing = false;
+  if (stream_data->index_frames != NULL) {
+    char index_path[1100];
+    snprintf(index_path, sizeof(index_path), "%s%s", file_path, ADC_INDEX_EXTENSION);
+    adc_index_schedule_t schedule = {stream_data->index_frames, stream_data->index_segment_count};
+    stream_data->index_frames = NULL; // Owned by the writer now
+    if (adc_index_writer_open(&index_writer, index_path, board, binary_mode, &schedule) == 0) {
+      indexing = true;
+      adc_index_writer_mark(&index_writer, 0, data_offset);
+      if (verbose) {
+        printf("ADC Data Stream Thread[%d]: Writing trigger index to '%s'\n", board, index_path);
+      }
+    }
+  }
+
+  // Live ring: frames carry trigger alignment when the index schedule is available
+  const adc_index_schedule_t* live_schedule = indexing ? &index_writer.schedule : NULL;
+  live_ring_adc_begin(live_ring, board, live_schedule);
 
   while (words_written < word_count && !(*should_stop)) {
+    rt_sched_loop_tick();
     // Check data FIFO status
+    uint64_t trace_t0 = thread_trace_begin();
     uint32_t data_status = sys_sts_get_adc_data_fifo_status(ctx->sys_sts, board, false);
+    thread_trace_end(TRACE_FIFO_STATUS, trace_t0, FIFO_STS_WORD_COUNT(data_status));
 
     if (FIFO_PRESENT(data_status) == 0) {
       fprintf(stderr, "ADC Data Stream Thread[%d]: Data FIFO not present, stopping stream\n", board);
@@ -412,11 +480,16 @@ static void* adc_data_stream_thread(void* arg) {
       }
 
       // Read data from FIFO
-      for (uint32_t i = 0; i < words_to_read; i++) {
-        write_buffer[i] = adc_read_word(ctx->adc_ctrl, board);
+      trace_t0 = thread_trace_begin();
+      adc_read_words(ctx->adc_ctrl, board, write_buffer, words_to_read);
+      thread_trace_end(TRACE_FIFO_BATCH, trace_t0, words_to_read);
+      if (corrected) {
+        correct_adc_words(&stream_data->bias_table, board * 8, words_written, write_buffer, words_to_read);
       }
+      live_ring_adc_publish(live_ring, board, live_schedule, write_buffer, words_to_read);
 
       // Write data based on format mode
+      trace_t0 = thread_trace_begin();
       if (binary_mode) {
         // Binary mode: write raw 32-bit words directly
         size_t written = fwrite(write_buffer, sizeof(uint32_t), words_to_read, file);
@@ -425,6 +498,14 @@ static void* adc_data_stream_thread(void* arg) {
                  board, strerror(errno));
           break;
         }
+        if (indexing) {
+          // Binary frames are fixed size, so entry offsets follow from the frame number
+          uint64_t frames_done = (words_written + words_to_read) / ADC_INDEX_WORDS_PER_FRAME;
+          uint64_t next_frame;
+          while ((next_frame = adc_index_writer_next_frame(&index_writer)) <= frames_done) {
+            adc_index_writer_mark(&index_writer, next_frame, data_offset + next_frame * ADC_INDEX_WORDS_PER_FRAME * sizeof(uint32_t));
+          }
+        }
       } else {
         // ASCII mode: convert and write samples as text
         for (uint32_t i = 0; i < words_to_read; i++) {
@@ -458,12 +539,17 @@ static void* adc_data_stream_thread(void* arg) {
           if (samples_on_line >= 8) {
             fprintf(file, "\n");
             samples_on_line = 0;
+            frames_written++;
+            if (indexing && adc_index_writer_next_frame(&index_writer) == frames_written) {
+              adc_index_writer_mark(&index_writer, frames_written, (uint64_t)ftello(file));
+            }
           }
         }
       }
 
       // Flush the file to ensure data is written
       fflush(file);
+      thread_trace_end(TRACE_FILE_WRITE, trace_t0, words_to_read);
 
       words_written += words_to_read;
 
@@ -474,7 +560,9 @@ static void* adc_data_stream_thread(void* arg) {
       }
     } else {
       // No data available, sleep briefly
-      usleep(100);
+      trace_t0 = thread_trace_begin();
+      rt_sched_usleep(100);
+      thread_trace_end(TRACE_SLEEP, trace_t0, 100);
     }
   }
 
@@ -483,6 +571,18 @@ static void* adc_data_stream_thread(void* arg) {
     if (!binary_mode && samples_on_line > 0) {
       fprintf(file, "\n");
     }
+    if (npy_mode) {
+      // Only whole 8-sample rows are kept
+      uint64_t rows = words_written / ADC_INDEX_WORDS_PER_FRAME;
+      if (npy_finalize(file, NPY_DESCR_INT16, rows, 8, ADC_INDEX_WORDS_PER_FRAME * sizeof(uint32_t)) != 0) {
+        fprintf(stderr, "ADC Data Stream Thread[%d]: Failed to finalize NPY file '%s'\n", board, file_path);
+      }
+      words_written = rows * ADC_INDEX_WORDS_PER_FRAME;
+    }
+    if (indexing) {
+      uint64_t end_offset = binary_mode ? data_offset + words_written * sizeof(uint32_t) : (uint64_t)ftello(file);
+      adc_index_writer_close(&index_writer, words_written / ADC_INDEX_WORDS_PER_FRAME, end_offset);
+    }
     fclose(file);
   }
 
@@ -496,6 +596,7 @@ static void* adc_data_stream_thread(void* arg) {
 
 cleanup:
   ctx->adc_data_stream_running[board] = false;
+  free(stream_data->index_frames);
   free(stream_data);
   return NULL;
 }
@@ -504,7 +605,7 @@ int cmd_stream_adc_data_to_file(const char** args, int arg_count, const command_
   // Parse board number
   int board = parse_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for stream_adc_data_to_file: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for stream_adc_data_to_file: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -518,6 +619,30 @@ int cmd_stream_adc_data_to_file(const char** args, int arg_count, const command_
 
   // Check for binary mode flag
   bool binary_mode = has_flag(flags, flag_count, FLAG_BIN);
+  bool npy_mode = has_flag(flags, flag_count, FLAG_NPY);
+  bool corrected = has_flag(flags, flag_count, FLAG_CORRECTED);
+  if (binary_mode && npy_mode) {
+    fprintf(stderr, "stream_adc_data_to_file: --bin and --npy are mutually exclusive.\n");
+    return -1;
+  }
+
+  // Optional ADC command file and iterations for the trigger index sidecar
+  if (arg_count == 4) {
+    fprintf(stderr, "stream_adc_data_to_file: the trigger index needs both <adc_cmd_file> and <iterations>.\n");
+    return -1;
+  }
+  int index_iterations = 0;
+  char index_cmd_path[1024];
+  if (arg_count >= 5) {
+    if (resolve_file_pattern(args[3], index_cmd_path, sizeof(index_cmd_path)) != 0) {
+      return -1;
+    }
+    index_iterations = (int)parse_value(args[4], &endptr);
+    if (*endptr != '\0' || index_iterations < 1) {
+      fprintf(stderr, "Invalid iterations for stream_adc_data_to_file: '%s'. Must be a positive integer.\n", args[4]);
+      return -1;
+    }
+  }
 
   // Check if stream is already running
   if (ctx->adc_data_stream_running[board]) {
@@ -555,7 +680,9 @@ int cmd_stream_adc_data_to_file(const char** args, int arg_count, const command_
   // Check if there's a dot after the last slash (or no slash at all)
   if (dot == NULL || (slash != NULL && dot < slash)) {
     // No extension, add default
-    if (binary_mode) {
+    if (npy_mode) {
+      strcat(final_path, NPY_EXTENSION);
+    } else if (binary_mode) {
       strcat(final_path, ".dat");
     } else {
       strcat(final_path, ".csv");
@@ -563,9 +690,17 @@ int cmd_stream_adc_data_to_file(const char** args, int arg_count, const command_
   }
   // If extension exists, user specified it explicitly, so keep it
 
+  // An .npy path selects NPY output even without the flag
+  if (!binary_mode && npy_path(final_path)) {
+    npy_mode = true;
+  }
+  if (npy_mode) {
+    binary_mode = true;
+  }
+
   if (*(ctx->verbose)) {
     printf("Output file path: '%s' -> '%s' (%s format)\n",
-           args[2], final_path, binary_mode ? "binary" : "ASCII");
+           args[2], final_path, npy_mode ? "NPY" : (binary_mode ? "binary" : "ASCII"));
   }
 
   // Allocate thread data structure
@@ -585,6 +720,34 @@ int cmd_stream_adc_data_to_file(const char** args, int arg_count, const command_
   stream_data->word_count = word_count;
   stream_data->should_stop = &(ctx->adc_data_stream_stop[board]);
   stream_data->binary_mode = binary_mode;
+  stream_data->npy_mode = npy_mode;
+  stream_data->corrected = corrected;
+  if (corrected) {
+    load_adc_convert(ctx, &stream_data->bias_table);
+  }
+  stream_data->index_frames = NULL;
+  stream_data->index_segment_count = 0;
+
+  // Build the trigger index schedule by replaying the ADC command file
+  if (index_iterations > 0) {
+    adc_command_t* index_commands = NULL;
+    waveform_file_info_t index_info = {0};
+    adc_index_schedule_t schedule;
+    if (waveform_cache_get_adc(ctx, index_cmd_path, false, false, &index_commands, &index_info) != 0 ||
+        adc_index_build_schedule(index_commands, index_info.command_count, index_iterations, &schedule) != 0) {
+      fprintf(stderr, "Failed to build trigger index for board %d from '%s'\n", board, index_cmd_path);
+      free(index_commands);
+      free(stream_data);
+      return -1;
+    }
+    free(index_commands);
+    stream_data->index_frames = schedule.frames;
+    stream_data->index_segment_count = schedule.segment_count;
+    if (*(ctx->verbose)) {
+      printf("Trigger index: %llu triggers from '%s' (%d iterations)\n",
+             schedule.segment_count - 1, index_cmd_path, index_iterations);
+    }
+  }
 
   if (*(ctx->verbose)) {
     printf("Stream parameters: board=%d, word_count=%llu, file='%s', format=%s\n",
@@ -606,6 +769,7 @@ int cmd_stream_adc_data_to_file(const char** args, int arg_count, const command_
   if (pthread_create(&(ctx->adc_data_stream_threads[board]), NULL, adc_data_stream_thread, stream_data) != 0) {
     fprintf(stderr, "Failed to create ADC data streaming thread for board %d: %s\n", board, strerror(errno));
     ctx->adc_data_stream_running[board] = false;
+    free(stream_data->index_frames);
     free(stream_data);
     return -1;
   }
@@ -622,7 +786,7 @@ int cmd_stop_adc_data_stream(const char** args, int arg_count, const command_fla
   // Parse board number
   int board = parse_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for stop_adc_data_stream: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for stop_adc_data_stream: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -647,179 +811,278 @@ int cmd_stop_adc_data_stream(const char** args, int arg_count, const command_fla
   return 0;
 }
 
-// Function to validate and parse an ADC command file
-static int parse_adc_command_file(const char* file_path, adc_command_t** commands, int* command_count) {
-  FILE* file = fopen(file_path, "r");
-  if (file == NULL) {
+// Function to validate and parse an ADC command file in a single pass over the mapped file
+// If sys_sts is given, delays are also checked against the ADC minimum delay at the current SPI clock,
+// and the file's timing summary is returned in *timing (if non-NULL)
+int parse_adc_command_file_timed(const char* file_path, adc_command_t** commands, int* command_count,
+                                 struct sys_sts_t* sys_sts, command_file_timing_t* timing) {
+  mapped_file_t file;
+  if (mapped_file_open(file_path, &file) != 0) {
     fprintf(stderr, "Failed to open ADC command file '%s': %s\n", file_path, strerror(errno));
     return -1;
   }
 
-  // First pass: count lines and validate format
-  char line[512];
+  // Timing limits (shorter delays raise DELAY_TOO_SHORT in the ADC core)
+  uint32_t min_delay = 0;
+  uint32_t clk_freq_hz = 0;
+  if (sys_sts != NULL) {
+    min_delay = sys_sts_get_adc_min_delay_time(sys_sts, false);
+    if (min_delay < ADC_MIN_DELAY_FLOOR) min_delay = ADC_MIN_DELAY_FLOOR;
+    clk_freq_hz = sys_sts_get_clk_freq_hz(sys_sts, false);
+  }
+
+  // Timing tracking: shortest D delay, and cycles of work between trigger waits
+  uint32_t shortest_delay = UINT32_MAX;
+  uint64_t cycles_since_wait = 0;
+  uint64_t cycles_before_first_wait = 0;
+  uint64_t trigger_spacing = 0;
+  bool found_wait = false;
+
+  // Commands are stored as each line is validated (a typical T/D line is ~12 bytes)
+  int capacity = scan_line_estimate(file.size, 12);
+  adc_command_t* cmds = malloc((size_t)capacity * sizeof(adc_command_t));
+  if (cmds == NULL) {
+    fprintf(stderr, "Failed to allocate memory for ADC commands\n");
+    mapped_file_close(&file);
+    return -1;
+  }
+
+  const char* pos = file.data;
+  const char* end = file.data + file.size;
+  const char* line;
+  const char* line_end;
   int line_num = 0;
   int valid_lines = 0;
 
-  while (fgets(line, sizeof(line), file)) {
+  while (scan_next_line(&pos, end, &line, &line_end)) {
     line_num++;
 
     // Skip empty lines and comments
-    char* trimmed = line;
-    while (*trimmed == ' ' || *trimmed == '\t') trimmed++;
-    if (*trimmed == '\n' || *trimmed == '\r' || *trimmed == '\0' || *trimmed == '#') {
+    const char* p = scan_skip_indent(line, line_end);
+    if (p == line_end || *p == '\r' || *p == '\0' || *p == '#') {
       continue;
     }
 
     // Check if line starts with T, D, O, NT, or ND
-    if (*trimmed != 'T' && *trimmed != 'D' && *trimmed != 'O' &&
-        strncmp(trimmed, "NT", 2) != 0 && strncmp(trimmed, "ND", 2) != 0) {
+    bool is_noop_cmd = (line_end - p >= 2 && p[0] == 'N' && (p[1] == 'T' || p[1] == 'D'));
+    if (*p != 'T' && *p != 'D' && *p != 'O' && !is_noop_cmd) {
       fprintf(stderr, "Invalid line %d: must start with 'T', 'D', 'O', 'NT', or 'ND'\n", line_num);
-      fclose(file);
-      return -1;
+      goto fail;
     }
 
     // Parse the line to validate format
-    char mode;
-    uint32_t value, repeat_count;
-    uint8_t s1, s2, s3, s4, s5, s6, s7, s8;
+    adc_command_t cmd = {0};
 
-    if (*trimmed == 'O') {
+    if (*p == 'O') {
       // Order command: O s1 s2 s3 s4 s5 s6 s7 s8
-      int parsed = sscanf(trimmed, "%c %hhu %hhu %hhu %hhu %hhu %hhu %hhu %hhu",
-                         &mode, &s1, &s2, &s3, &s4, &s5, &s6, &s7, &s8);
-      if (parsed != 9) {
+      p++;
+      uint32_t order[8];
+      int parsed = 0;
+      while (parsed < 8 && scan_u32(&p, line_end, &order[parsed])) parsed++;
+      if (parsed != 8) {
         fprintf(stderr, "Invalid line %d: 'O' command must have 8 order values\n", line_num);
-        fclose(file);
-        return -1;
+        goto fail;
       }
       // Validate order values (0-7)
-      if (s1 > 7 || s2 > 7 || s3 > 7 || s4 > 7 || s5 > 7 || s6 > 7 || s7 > 7 || s8 > 7) {
-        fprintf(stderr, "Invalid line %d: order values must be 0-7\n", line_num);
-        fclose(file);
-        return -1;
+      for (int i = 0; i < 8; i++) {
+        if (order[i] > 7) {
+          fprintf(stderr, "Invalid line %d: order values must be 0-7\n", line_num);
+          goto fail;
+        }
+        cmd.order[i] = (uint8_t)order[i];
       }
-    } else if (strncmp(trimmed, "NT", 2) == 0 || strncmp(trimmed, "ND", 2) == 0) {
+      cmd.type = ADC_ORDER_CMD;
+    } else if (is_noop_cmd) {
       // NT, ND commands (noop): <cmd> <value>
-      char cmd_str[3];
-      int parsed = sscanf(trimmed, "%2s %u", cmd_str, &value);
-      if (parsed < 2) {
+      char cmd_str[3] = {p[0], p[1], '\0'};
+      p = scan_skip_token(p, line_end, 2);
+      if (!scan_u32(&p, line_end, &cmd.value)) {
         fprintf(stderr, "Invalid line %d: '%s' command must have a value\n", line_num, cmd_str);
-        fclose(file);
-        return -1;
+        goto fail;
       }
       // Validate value range (noop uses 25-bit value)
-      if (value > 0x1FFFFFF) {
-        fprintf(stderr, "Invalid line %d: value %u out of range (max 0x1FFFFFF)\n", line_num, value);
-        fclose(file);
-        return -1;
+      if (cmd.value > 0x1FFFFFF) {
+        fprintf(stderr, "Invalid line %d: value %u out of range (max 0x1FFFFFF)\n", line_num, cmd.value);
+        goto fail;
+      }
+
+      if (cmd_str[1] == 'D') {
+        if (cmd.value < min_delay) {
+          fprintf(stderr, "Invalid line %d: delay %u cycles is below the ADC minimum delay of %u cycles (%.3f MHz SPI clock)\n",
+                  line_num, cmd.value, min_delay, clk_freq_hz / 1e6);
+          goto fail;
+        }
+        cycles_since_wait += cmd.value;
+        cmd.type = ADC_NOOP_DELAY_CMD;
+      } else {
+        if (cmd.value > 0) {
+          // A trigger arriving before the core is waiting again is an unexpected trigger
+          if (found_wait) {
+            if (cycles_since_wait > trigger_spacing) trigger_spacing = cycles_since_wait;
+          } else {
+            cycles_before_first_wait = cycles_since_wait;
+          }
+          found_wait = true;
+          cycles_since_wait = 0;
+        }
+        cmd.type = ADC_NOOP_TRIGGER_CMD;
       }
     } else {
       // T, D commands: <cmd> <value> [repeat_count]
-      int parsed = sscanf(trimmed, "%c %u %u", &mode, &value, &repeat_count);
-      if (parsed < 2) {
+      char mode = *p++;
+      if (!scan_u32(&p, line_end, &cmd.value)) {
         fprintf(stderr, "Invalid line %d: must have command and value\n", line_num);
-        fclose(file);
-        return -1;
+        goto fail;
       }
-      if (parsed == 2) {
-        repeat_count = 0; // Default repeat count
+      if (!scan_u32(&p, line_end, &cmd.repeat_count)) {
+        cmd.repeat_count = 0; // Default repeat count
       }
 
       // Validate value range
-      if (value > 0x1FFFFFF) {
-        fprintf(stderr, "Invalid line %d: value %u out of range (max 0x1FFFFFF or 33554431)\n", line_num, value);
-        fclose(file);
-        return -1;
+      if (cmd.value > 0x1FFFFFF) {
+        fprintf(stderr, "Invalid line %d: value %u out of range (max 0x1FFFFFF or 33554431)\n", line_num, cmd.value);
+        goto fail;
       }
 
       // Validate repeat_count range
-      if (repeat_count > 0x1FFFFFF) {
-        fprintf(stderr, "Invalid line %d: repeat_count %u out of range (max 0x1FFFFFF or 33554431)\n", line_num, repeat_count);
-        fclose(file);
-        return -1;
+      if (cmd.repeat_count > 0x1FFFFFF) {
+        fprintf(stderr, "Invalid line %d: repeat_count %u out of range (max 0x1FFFFFF or 33554431)\n", line_num, cmd.repeat_count);
+        goto fail;
+      }
+
+      if (mode == 'D') {
+        if (cmd.value < min_delay) {
+          fprintf(stderr, "Invalid line %d: delay %u cycles is below the ADC minimum delay of %u cycles (%.3f MHz SPI clock)\n",
+                  line_num, cmd.value, min_delay, clk_freq_hz / 1e6);
+          goto fail;
+        }
+        if (cmd.value < shortest_delay) shortest_delay = cmd.value;
+        cycles_since_wait += (uint64_t)cmd.value * (cmd.repeat_count + 1);
+        cmd.type = ADC_DELAY_CMD;
+      } else {
+        // Trigger mode: each repeat reads first, then waits for triggers
+        cycles_since_wait += min_delay;
+        if (cmd.value > 0) {
+          // A trigger arriving before the core is waiting again is an unexpected trigger
+          if (found_wait) {
+            if (cycles_since_wait > trigger_spacing) trigger_spacing = cycles_since_wait;
+          } else {
+            cycles_before_first_wait = cycles_since_wait;
+          }
+          if (cmd.repeat_count > 0 && min_delay > trigger_spacing) trigger_spacing = min_delay;
+          found_wait = true;
+          cycles_since_wait = 0;
+        }
+        cmd.type = ADC_TRIGGER_CMD;
       }
     }
 
-    valid_lines++;
+    // Store the command
+    if (valid_lines == capacity) {
+      capacity *= 2;
+      adc_command_t* grown = realloc(cmds, (size_t)capacity * sizeof(adc_command_t));
+      if (grown == NULL) {
+        fprintf(stderr, "Failed to allocate memory for ADC commands\n");
+        goto fail;
+      }
+      cmds = grown;
+    }
+    cmds[valid_lines++] = cmd;
   }
+  mapped_file_close(&file);
 
   if (valid_lines == 0) {
     fprintf(stderr, "No valid commands found in ADC command file\n");
-    fclose(file);
+    free(cmds);
     return -1;
   }
 
-  // Allocate memory for commands
-  *commands = malloc(valid_lines * sizeof(adc_command_t));
-  if (*commands == NULL) {
-    fprintf(stderr, "Failed to allocate memory for ADC commands\n");
-    fclose(file);
+  // Looping back to the start of the file joins the tail and the head
+  if (found_wait && cycles_since_wait + cycles_before_first_wait > trigger_spacing) {
+    trigger_spacing = cycles_since_wait + cycles_before_first_wait;
+  }
+
+  if (timing != NULL) {
+    timing->min_delay = min_delay;
+    timing->shortest_delay = shortest_delay;
+    timing->trigger_spacing = trigger_spacing;
+    timing->clk_freq_hz = clk_freq_hz;
+  }
+
+  if (valid_lines < capacity) {
+    adc_command_t* trimmed = realloc(cmds, (size_t)valid_lines * sizeof(adc_command_t));
+    if (trimmed != NULL) cmds = trimmed;
+  }
+
+  *commands = cmds;
+  *command_count = valid_lines;
+  return 0;
+
+fail:
+  free(cmds);
+  mapped_file_close(&file);
+  return -1;
+}
+
+// Function to validate and parse an ADC command file
+// If sys_sts is given, delays are also checked against the ADC minimum delay at the current SPI clock
+int parse_adc_command_file(const char* file_path, adc_command_t** commands, int* command_count,
+                           struct sys_sts_t* sys_sts, bool verbose) {
+  command_file_timing_t timing;
+  if (parse_adc_command_file_timed(file_path, commands, command_count, sys_sts, &timing) != 0) {
     return -1;
   }
+  if (sys_sts != NULL && verbose) {
+    print_file_timing("ADC command", file_path, timing.min_delay, timing.shortest_delay, timing.trigger_spacing,
+                      timing.clk_freq_hz);
+  }
+  return 0;
+}
 
-  // Second pass: actually parse the commands
-  rewind(file);
-  line_num = 0;
-  *command_count = 0;
+#define ADC_MAX_REPEAT 0x1FFFFFF // Largest repeat count the file format accepts
 
-  while (fgets(line, sizeof(line), file)) {
-    line_num++;
+// ADC command FIFO words one command takes (a read with a repeat count is followed by the count word)
+static uint32_t adc_command_words(const adc_command_t* cmd) {
+  bool is_read = (cmd->type == ADC_DELAY_CMD || cmd->type == ADC_TRIGGER_CMD);
+  return (is_read && cmd->repeat_count > 0) ? 2 : 1;
+}
 
-    // Skip empty lines and comments
-    char* trimmed = line;
-    while (*trimmed == ' ' || *trimmed == '\t') trimmed++;
-    if (*trimmed == '\n' || *trimmed == '\r' || *trimmed == '\0' || *trimmed == '#') {
-      continue;
-    }
+// Function to fold runs of identical ADC reads into repeat commands, in place
+// The ADC core replays a repeated command word back to back, exactly as if the reads had been sent one by one.
+int compact_adc_commands(adc_command_t* commands, int command_count, adc_compact_stats_t* stats) {
+  adc_compact_stats_t st = {0};
+  int out = 0;
 
-    adc_command_t* cmd = &(*commands)[*command_count];
-
-    if (*trimmed == 'O') {
-      cmd->type = ADC_ORDER_CMD;
-      uint8_t s1, s2, s3, s4, s5, s6, s7, s8;
-      char dummy_char;
-      sscanf(trimmed, "%c %hhu %hhu %hhu %hhu %hhu %hhu %hhu %hhu",
-             &dummy_char, &s1, &s2, &s3, &s4, &s5, &s6, &s7, &s8);
-      cmd->order[0] = s1; cmd->order[1] = s2; cmd->order[2] = s3; cmd->order[3] = s4;
-      cmd->order[4] = s5; cmd->order[5] = s6; cmd->order[6] = s7; cmd->order[7] = s8;
-      cmd->value = 0; // Not used for order commands
-      cmd->repeat_count = 0; // Not used for order commands
-    } else if (strncmp(trimmed, "NT", 2) == 0) {
-      // Noop with trigger
-      cmd->type = ADC_NOOP_TRIGGER_CMD;
-      char cmd_str[3];
-      sscanf(trimmed, "%2s %u", cmd_str, &cmd->value);
-      cmd->repeat_count = 0; // Not used for noop
-      for (int i = 0; i < 8; i++) cmd->order[i] = 0;
-    } else if (strncmp(trimmed, "ND", 2) == 0) {
-      // Noop with delay
-      cmd->type = ADC_NOOP_DELAY_CMD;
-      char cmd_str[3];
-      sscanf(trimmed, "%2s %u", cmd_str, &cmd->value);
-      cmd->repeat_count = 0; // Not used for noop
-      for (int i = 0; i < 8; i++) cmd->order[i] = 0;
-    } else {
-      // Parse T, D commands with optional repeat_count
-      char cmd_char;
-      uint32_t repeat_count;
-      int parsed = sscanf(trimmed, "%c %u %u", &cmd_char, &cmd->value, &repeat_count);
-      cmd->type = (cmd_char == 'T') ? ADC_TRIGGER_CMD : ADC_DELAY_CMD;
-      if (parsed >= 3) {
-        cmd->repeat_count = repeat_count;
-      } else {
-        cmd->repeat_count = 0; // Default repeat count
-      }
-      // Initialize order array (not used for non-O commands)
-      for (int i = 0; i < 8; i++) {
-        cmd->order[i] = 0;
+  st.commands_before = command_count;
+  for (int i = 0; i < command_count; i++) {
+    adc_command_t cmd = commands[i];
+    st.words_before += adc_command_words(&cmd);
+
+    // Same read (type and wait value) as the previous command: add its runs to the previous repeat count
+    adc_command_t* prev = out > 0 ? &commands[out - 1] : NULL;
+    bool is_read = (cmd.type == ADC_DELAY_CMD || cmd.type == ADC_TRIGGER_CMD);
+    if (is_read && prev != NULL && prev->type == cmd.type && prev->value == cmd.value) {
+      uint64_t runs = (uint64_t)prev->repeat_count + 1 + cmd.repeat_count + 1;
+      if (runs - 1 <= ADC_MAX_REPEAT) {
+        prev->repeat_count = (uint32_t)(runs - 1);
+        st.reads_folded++;
+        continue;
       }
+      // Fill the previous command up to the limit and carry the rest
+      uint64_t carried = runs - (ADC_MAX_REPEAT + 1);
+      prev->repeat_count = ADC_MAX_REPEAT;
+      cmd.repeat_count = (uint32_t)(carried - 1);
     }
 
-    (*command_count)++;
+    commands[out++] = cmd;
   }
 
-  fclose(file);
-  return 0;
+  for (int i = 0; i < out; i++) {
+    st.words_after += adc_command_words(&commands[i]);
+  }
+  st.commands_after = out;
+  if (stats != NULL) *stats = st;
+  return out;
 }
 
 // ADC command streaming thread function (for streaming commands from file)
@@ -834,6 +1097,8 @@ static void* adc_cmd_stream_thread(void* arg) {
   int iterations = stream_data->iterations;
   bool simple_mode = stream_data->simple_mode;
   bool verbose = *(ctx->verbose);
+  thread_trace_register("ADC cmd", board);
+  rt_sched_thread_enter(RT_CLASS_FIFO_CMD, "ADC cmd", board);
 
   if (verbose) {
     printf("ADC Command Stream Thread[%d]: Started streaming from file '%s' (%d commands, %d iteration%s)\n",
@@ -847,16 +1112,23 @@ static void* adc_cmd_stream_thread(void* arg) {
   while (!(*should_stop) && current_iteration < iterations) {
     int cmd_index = 0;
     int commands_sent_this_iteration = 0;
+    uint32_t runs_sent = 0; // Simple mode: runs of the current read sent so far
 
     while (!(*should_stop) && cmd_index < command_count) {
       adc_command_t* cmd = &commands[cmd_index];
+      rt_sched_loop_tick();
 
       // Calculate words needed for this command
+      // A read with a repeat count needs a second word for the count (one word per run in simple mode)
       // Noop commands (ADC_NOOP_TRIGGER_CMD and ADC_NOOP_DELAY_CMD) always need 1 word
-      uint32_t words_needed = ((cmd->type == ADC_DELAY_CMD) && (cmd->repeat_count > 0)) ? 2 : 1;
+      bool is_read = (cmd->type == ADC_TRIGGER_CMD || cmd->type == ADC_DELAY_CMD);
+      uint32_t repeat_count = simple_mode ? 0 : cmd->repeat_count;
+      uint32_t words_needed = (is_read && repeat_count > 0) ? 2 : 1;
 
       // Check ADC command FIFO status
+      uint64_t trace_t0 = thread_trace_begin();
       uint32_t fifo_status = sys_sts_get_adc_cmd_fifo_status(ctx->sys_sts, board, false);
+      thread_trace_end(TRACE_FIFO_STATUS, trace_t0, FIFO_STS_WORD_COUNT(fifo_status));
 
       if (FIFO_PRESENT(fifo_status) == 0) {
         fprintf(stderr, "ADC Command Stream Thread[%d]: FIFO not present, stopping stream\n", board);
@@ -868,12 +1140,13 @@ static void* adc_cmd_stream_thread(void* arg) {
 
       if (words_available >= words_needed) {
         // Send the command
+        trace_t0 = thread_trace_begin();
         switch (cmd->type) {
           case ADC_TRIGGER_CMD:
-            adc_cmd_adc_rd(ctx->adc_ctrl, board, ADC_TRIGGER_WAIT, ADC_NO_CONTINUE, cmd->value, cmd->repeat_count, false);
+            adc_cmd_adc_rd(ctx->adc_ctrl, board, ADC_TRIGGER_WAIT, ADC_NO_CONTINUE, cmd->value, repeat_count, false);
             break;
           case ADC_DELAY_CMD:
-            adc_cmd_adc_rd(ctx->adc_ctrl, board, ADC_DELAY_WAIT, ADC_NO_CONTINUE, cmd->value, cmd->repeat_count, false);
+            adc_cmd_adc_rd(ctx->adc_ctrl, board, ADC_DELAY_WAIT, ADC_NO_CONTINUE, cmd->value, repeat_count, false);
             break;
           case ADC_ORDER_CMD:
             adc_cmd_set_ord(ctx->adc_ctrl, board, cmd->order, false);
@@ -888,10 +1161,14 @@ static void* adc_cmd_stream_thread(void* arg) {
             fprintf(stderr, "ADC Command Stream Thread[%d]: Invalid command type %d\n", board, cmd->type);
             break;
         }
+        thread_trace_end(TRACE_FIFO_BATCH, trace_t0, words_needed);
 
+        total_words_sent += words_needed;
+        // In simple mode a repeated read is sent once per run before moving on
+        if (simple_mode && is_read && ++runs_sent <= cmd->repeat_count) continue;
+        runs_sent = 0;
         commands_sent_this_iteration++;
         total_commands_sent++;
-        total_words_sent += words_needed;
         cmd_index++;
 
         if (verbose) {
@@ -902,7 +1179,9 @@ static void* adc_cmd_stream_thread(void* arg) {
         }
       } else {
         // Not enough space in FIFO, sleep and try again
-        usleep(1000); // 1ms
+        trace_t0 = thread_trace_begin();
+        rt_sched_usleep(1000); // 1ms
+        thread_trace_end(TRACE_SLEEP, trace_t0, 1000);
       }
     }
 
@@ -932,7 +1211,7 @@ int cmd_stream_adc_commands_from_file(const char** args, int arg_count, const co
   // Parse board number
   int board = parse_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for stream_adc_commands_from_file: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for stream_adc_commands_from_file: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -976,9 +1255,11 @@ int cmd_stream_adc_commands_from_file(const char** args, int arg_count, const co
   adc_command_t* commands = NULL;
   int command_count = 0;
 
-  if (parse_adc_command_file(full_path, &commands, &command_count) != 0) {
+  waveform_file_info_t info;
+  if (waveform_cache_get_adc(ctx, full_path, true, *(ctx->verbose), &commands, &info) != 0) {
     return -1; // Error already printed by parse_adc_command_file
   }
+  command_count = info.command_count;
 
   if (*(ctx->verbose)) {
     printf("Parsed %d commands from ADC command file '%s'\n", command_count, full_path);
@@ -987,6 +1268,21 @@ int cmd_stream_adc_commands_from_file(const char** args, int arg_count, const co
     }
   }
 
+  // Fold runs of identical reads into repeat commands (simple mode unrolls repeats instead)
+  if (!simple_mode) {
+    adc_compact_stats_t compact;
+    command_count = compact_adc_commands(commands, command_count, &compact);
+    if (compact.words_after < compact.words_before) {
+      printf("Board %d ADC commands compacted: %d -> %d commands, %llu -> %llu FIFO words per pass (%.1f%% fewer; "
+             "%d reads folded into repeats)\n",
+             board, compact.commands_before, compact.commands_after, (unsigned long long)compact.words_before,
+             (unsigned long long)compact.words_after,
+             100.0 * (compact.words_before - compact.words_after) / compact.words_before, compact.reads_folded);
+    } else if (*(ctx->verbose)) {
+      printf("Board %d ADC commands have no repeated reads to compact\n", board);
+    }
+  }
+
   // Allocate thread data structure
   adc_command_stream_params_t* stream_data = malloc(sizeof(adc_command_stream_params_t));
   if (stream_data == NULL) {
@@ -1029,7 +1325,7 @@ int cmd_stop_adc_cmd_stream(const char** args, int arg_count, const command_flag
   // Parse board number
   int board = parse_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for stop_adc_cmd_stream: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for stop_adc_cmd_stream: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -1054,16 +1350,8 @@ int cmd_stop_adc_cmd_stream(const char** args, int arg_count, const command_flag
   return 0;
 }
 
-// Helper function to calculate expected number of ADC words from an ADC command file
-uint64_t calculate_expected_adc_words(const char* file_path, int iterations, bool verbose) {
-  // Parse the ADC command file using existing parser
-  adc_command_t* commands = NULL;
-  int command_count = 0;
-
-  if (parse_adc_command_file(file_path, &commands, &command_count) != 0) {
-    return 0;
-  }
-
+// ADC data words produced by one pass through a parsed ADC command file
+uint64_t adc_words_per_pass(const adc_command_t* commands, int command_count) {
   // Count ADC words based on command types:
   // - ADC_TRIGGER_CMD: generates 4 ADC words per trigger count (value field), multiplied by (repeat_count + 1)
   // - ADC_DELAY_CMD: generates 4 ADC words per total runs (repeat_count + 1)
@@ -1087,7 +1375,19 @@ uint64_t calculate_expected_adc_words(const char* file_path, int iterations, boo
         break;
     }
   }
+  return adc_words_per_execution;
+}
+
+// Helper function to calculate expected number of ADC words from an ADC command file
+uint64_t calculate_expected_adc_words(const char* file_path, int iterations, bool verbose) {
+  // Parse the ADC command file using existing parser
+  adc_command_t* commands = NULL;
+  int command_count = 0;
 
+  if (parse_adc_command_file(file_path, &commands, &command_count, NULL, false) != 0) {
+    return 0;
+  }
+  uint64_t adc_words_per_execution = adc_words_per_pass(commands, command_count);
   free(commands);
 
   // Calculate total ADC words: adc_words_per_execution * total_iterations
@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <sys/types.h>
+#include "adc_index.h"
+
+// Walk the command list once, counting triggers (frames == NULL) or filling frames per trigger segment
+static uint64_t adc_index_walk(const adc_command_t* commands, int command_count, int iterations, uint32_t* frames) {
+  uint64_t segment = 0;
+  for (int iter = 0; iter < iterations; iter++) {
+    for (int i = 0; i < command_count; i++) {
+      const adc_command_t* cmd = &commands[i];
+      uint64_t runs = (uint64_t)cmd->repeat_count + 1;
+      switch (cmd->type) {
+        case ADC_TRIGGER_CMD:
+          // Each run reads once, then waits for <value> triggers
+          if (cmd->value == 0) {
+            if (frames) frames[segment] += (uint32_t)runs;
+          } else if (frames) {
+            for (uint64_t run = 0; run < runs; run++) {
+              frames[segment]++;
+              segment += cmd->value;
+            }
+          } else {
+            segment += runs * cmd->value;
+          }
+          break;
+        case ADC_DELAY_CMD:
+          if (frames) frames[segment] += (uint32_t)runs;
+          break;
+        case ADC_NOOP_TRIGGER_CMD:
+          segment += cmd->value;
+          break;
+        case ADC_NOOP_DELAY_CMD:
+        case ADC_ORDER_CMD:
+          break;
+      }
+      if (frames == NULL && segment > ADC_INDEX_MAX_TRIGGERS) {
+        return segment;
+      }
+    }
+  }
+  return segment;
+}
+
+int adc_index_build_schedule(const adc_command_t* commands, int command_count, int iterations, adc_index_schedule_t* schedule) {
+  schedule->frames = NULL;
+  schedule->segment_count = 0;
+
+  uint64_t triggers = adc_index_walk(commands, command_count, iterations, NULL);
+  if (triggers > ADC_INDEX_MAX_TRIGGERS) {
+    fprintf(stderr, "ADC command file waits for more than %llu triggers, too many to index\n", ADC_INDEX_MAX_TRIGGERS);
+    return -1;
+  }
+
+  schedule->frames = calloc(triggers + 1, sizeof(uint32_t));
+  if (schedule->frames == NULL) {
+    fprintf(stderr, "Failed to allocate memory for ADC index schedule (%llu triggers)\n", triggers);
+    return -1;
+  }
+  schedule->segment_count = triggers + 1;
+  adc_index_walk(commands, command_count, iterations, schedule->frames);
+  return 0;
+}
+
+void adc_index_free_schedule(adc_index_schedule_t* schedule) {
+  free(schedule->frames);
+  schedule->frames = NULL;
+  schedule->segment_count = 0;
+}
+
+int adc_index_writer_open(adc_index_writer_t* writer, const char* index_path, uint8_t board, bool binary, adc_index_schedule_t* schedule) {
+  memset(writer, 0, sizeof(*writer));
+  writer->schedule = *schedule;
+  schedule->frames = NULL;
+  schedule->segment_count = 0;
+
+  writer->file = fopen(index_path, "wb");
+  if (writer->file == NULL) {
+    fprintf(stderr, "Failed to open ADC index file '%s' for writing: %s\n", index_path, strerror(errno));
+    adc_index_free_schedule(&writer->schedule);
+    return -1;
+  }
+
+  // Header is rewritten with the final entry count on close
+  adc_index_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, ADC_INDEX_MAGIC, sizeof(header.magic));
+  header.version = ADC_INDEX_VERSION;
+  header.board = board;
+  header.binary = binary ? 1 : 0;
+  if (fwrite(&header, sizeof(header), 1, writer->file) != 1) {
+    fprintf(stderr, "Failed to write ADC index header to '%s': %s\n", index_path, strerror(errno));
+    fclose(writer->file);
+    writer->file = NULL;
+    adc_index_free_schedule(&writer->schedule);
+    return -1;
+  }
+  return 0;
+}
+
+uint64_t adc_index_writer_next_frame(const adc_index_writer_t* writer) {
+  if (writer->file == NULL || writer->next_segment >= writer->schedule.segment_count) {
+    return UINT64_MAX;
+  }
+  return writer->next_start_frame;
+}
+
+void adc_index_writer_mark(adc_index_writer_t* writer, uint64_t frame, uint64_t byte_offset) {
+  // Several segments can start on the same frame when triggers arrive with no reads in between
+  while (writer->file != NULL && writer->next_segment < writer->schedule.segment_count &&
+         writer->next_start_frame <= frame) {
+    adc_index_entry_t entry = {byte_offset, writer->next_start_frame};
+    fwrite(&entry, sizeof(entry), 1, writer->file);
+    writer->entries_written++;
+    writer->next_start_frame += writer->schedule.frames[writer->next_segment];
+    writer->next_segment++;
+  }
+}
+
+int adc_index_writer_close(adc_index_writer_t* writer, uint64_t frames_written, uint64_t byte_offset) {
+  if (writer->file == NULL) {
+    return -1;
+  }
+
+  // Sentinel entry marks the end of the data actually written
+  adc_index_entry_t sentinel = {byte_offset, frames_written};
+  fwrite(&sentinel, sizeof(sentinel), 1, writer->file);
+  writer->entries_written++;
+
+  uint64_t entry_count = writer->entries_written;
+  int result = 0;
+  if (fseek(writer->file, offsetof(adc_index_header_t, entry_count), SEEK_SET) != 0 ||
+      fwrite(&entry_count, sizeof(entry_count), 1, writer->file) != 1) {
+    fprintf(stderr, "Failed to finalize ADC index header: %s\n", strerror(errno));
+    result = -1;
+  }
+  if (fclose(writer->file) != 0) {
+    result = -1;
+  }
+  writer->file = NULL;
+  adc_index_free_schedule(&writer->schedule);
+  return result;
+}
+
+int adc_index_open(const char* index_path, adc_index_t* index) {
+  index->file = fopen(index_path, "rb");
+  if (index->file == NULL) {
+    fprintf(stderr, "Failed to open ADC index file '%s': %s\n", index_path, strerror(errno));
+    return -1;
+  }
+  if (fread(&index->header, sizeof(index->header), 1, index->file) != 1 ||
+      memcmp(index->header.magic, ADC_INDEX_MAGIC, sizeof(index->header.magic)) != 0) {
+    fprintf(stderr, "'%s' is not an ADC index file\n", index_path);
+    adc_index_close(index);
+    return -1;
+  }
+  if (index->header.version != ADC_INDEX_VERSION) {
+    fprintf(stderr, "ADC index file '%s' has unsupported version %u\n", index_path, index->header.version);
+    adc_index_close(index);
+    return -1;
+  }
+  if (index->header.entry_count < 1) {
+    fprintf(stderr, "ADC index file '%s' was not finalized (stream still running or interrupted)\n", index_path);
+    adc_index_close(index);
+    return -1;
+  }
+  return 0;
+}
+
+uint64_t adc_index_trigger_count(const adc_index_t* index) {
+  // Entry 0 is the pre-trigger span and the last entry is the sentinel
+  return index->header.entry_count >= 2 ? index->header.entry_count - 2 : 0;
+}
+
+int adc_index_lookup(const adc_index_t* index, uint64_t trigger, uint64_t* byte_offset, uint64_t* byte_length,
+                     uint64_t* first_frame, uint64_t* frame_count) {
+  if (index->file == NULL || trigger + 1 >= index->header.entry_count) {
+    return -1;
+  }
+
+  adc_index_entry_t entries[2];
+  off_t offset = (off_t)(sizeof(adc_index_header_t) + trigger * sizeof(adc_index_entry_t));
+  if (fseeko(index->file, offset, SEEK_SET) != 0 || fread(entries, sizeof(adc_index_entry_t), 2, index->file) != 2) {
+    fprintf(stderr, "Failed to read ADC index entry %llu: %s\n", trigger, strerror(errno));
+    return -1;
+  }
+
+  if (byte_offset) *byte_offset = entries[0].byte_offset;
+  if (byte_length) *byte_length = entries[1].byte_offset - entries[0].byte_offset;
+  if (first_frame) *first_frame = entries[0].first_frame;
+  if (frame_count) *frame_count = entries[1].first_frame - entries[0].first_frame;
+  return 0;
+}
+
+void adc_index_close(adc_index_t* index) {
+  if (index->file != NULL) {
+    fclose(index->file);
+    index->file = NULL;
+  }
+}
@@ -17,6 +17,8 @@
 #include "trigger_commands.h"
 #include "experiment_commands.h"
 #include "rev_c_compat.h"
+#include "threshold_sim.h"
+#include "script_engine.h"
 
 /**
  * Command Table
@@ -55,7 +57,7 @@ static command_entry_t command_table[] = {
   {"off", cmd_off, {0, 0, {-1}, "Turn the system off"}},
   {"sts", cmd_sts, {0, 0, {-1}, "Show hardware manager status"}},
   {"dbg", cmd_dbg, {0, 0, {-1}, "Show debug register"}},
-  {"hard_reset", cmd_hard_reset, {0, 0, {-1}, "Perform hard reset: turn the system off, set cmd/data buffer resets to 0x1FFFF, then to 0"}},
+  {"hard_reset", cmd_hard_reset, {0, 0, {-1}, "Perform hard reset: turn the system off, set all cmd/data buffer resets, then clear them"}},
   {"exit", cmd_exit, {0, 0, {-1}, "Exit the program"}},
   {"set_boot_test_skip", cmd_set_boot_test_skip, {1, 1, {-1}, "Set boot test skip register to a 16-bit value"}},
   {"set_debug", cmd_set_debug, {1, 1, {-1}, "Set debug register to a 16-bit value"}},
@@ -76,45 +78,49 @@ static command_entry_t command_table[] = {
   {"clk_load_default", cmd_clk_load_default, {0, 0, {-1}, "Load default SPI clock parameters"}},
   {"clk_load_user", cmd_clk_load_user, {0, 0, {-1}, "Load user SPI clock parameters"}},
   {"clk_set", cmd_clk_set, {1, 1, {-1}, "Set SPI clock frequency to a target value in MHz (e.g. clk_set 25.5)"}},
+  {"clk_optimize", cmd_clk_optimize, {2, 3, {-1}, "Set the SPI clock minimizing weighted DAC/ADC cycle time: <dac_weight> <adc_weight> [max_freq_mhz=50] (e.g. clk_optimize 1 1)"}},
   {"get_min_delay_times", cmd_get_min_delay_times, {0, 0, {-1}, "Show minimum delay times for DAC and ADC in SPI clock cycles"}},
 
   // ===== DAC COMMANDS (from dac_commands.h) =====
-  {"dac_cmd_fifo_sts", cmd_dac_cmd_fifo_sts, {1, 1, {-1}, "Show DAC command FIFO status for specified board (0-7)"}},
-  {"dac_data_fifo_sts", cmd_dac_data_fifo_sts, {1, 1, {-1}, "Show DAC data FIFO status for specified board (0-7)"}},
-  {"dac_last_received_cmd", cmd_dac_last_received_cmd, {1, 1, {-1}, "Show and decode last received DAC command for specified board (0-7)"}},
-  {"dac_cmds_since_reset", cmd_dac_cmds_since_reset, {1, 1, {-1}, "Show DAC command count since last reset for specified board (0-7)"}},
-  {"read_dac_data", cmd_read_dac_data, {1, 1, {FLAG_ALL, -1}, "Read and print data (debug or calibration) from specified board (0-7)"}},
+  {"dac_cmd_fifo_sts", cmd_dac_cmd_fifo_sts, {1, 1, {-1}, "Show DAC command FIFO status for specified board"}},
+  {"dac_data_fifo_sts", cmd_dac_data_fifo_sts, {1, 1, {-1}, "Show DAC data FIFO status for specified board"}},
+  {"dac_last_received_cmd", cmd_dac_last_received_cmd, {1, 1, {-1}, "Show and decode last received DAC command for specified board"}},
+  {"dac_cmds_since_reset", cmd_dac_cmds_since_reset, {1, 1, {-1}, "Show DAC command count since last reset for specified board"}},
+  {"read_dac_data", cmd_read_dac_data, {1, 1, {FLAG_ALL, -1}, "Read and print data (debug or calibration) from specified board"}},
   {"dac_noop", cmd_dac_noop, {3, 3, {FLAG_CONTINUE, -1}, "Send DAC no-op command: <board|all> <\"trig\"|\"delay\"> <value> [--continue]"}},
-  {"dac_cancel", cmd_dac_cancel, {1, 1, {-1}, "Send DAC cancel command to specified board (0-7)"}},
+  {"dac_cancel", cmd_dac_cancel, {1, 1, {-1}, "Send DAC cancel command to specified board"}},
   {"do_dac_wr", cmd_do_dac_wr, {11, 11, {FLAG_CONTINUE, -1}, "Send DAC write update command: <board> <ch0> <ch1> <ch2> <ch3> <ch4> <ch5> <ch6> <ch7> <\"trig\"|\"delay\"> <value> [--continue]"}},
-  {"do_dac_wr_ch", cmd_do_dac_wr_ch, {2, 2, {-1}, "Write DAC single channel: <channel> <value> (channel 0-63, board=ch/8, ch=ch%8)"}},
-  {"get_dac_cal", cmd_get_dac_cal, {0, 1, {FLAG_ALL, FLAG_NO_RESET, -1}, "Get DAC calibration value: <channel> [--no_reset] OR --all [--no_reset] (channel 0-63, board=ch/8, ch=ch%8)"}},
-  {"do_dac_get_cal", cmd_do_dac_get_cal, {1, 1, {-1}, "Send DAC GET_CAL command for single channel: <channel> (channel 0-63, board=ch/8, ch=ch%8)"}},
-  {"set_dac_cal", cmd_set_dac_cal, {2, 2, {-1}, "Set DAC calibration value for single channel: <channel> <cal_value> (channel 0-63, cal_value -32767 to 32767)"}},
-  {"stream_dac_commands_from_file", cmd_stream_dac_commands_from_file, {2, 3, {-1}, "Start DAC command streaming from waveform file: <board> <file_path> [iterations] (supports * wildcards)"}},
-  {"stop_dac_cmd_stream", cmd_stop_dac_cmd_stream, {1, 1, {-1}, "Stop DAC command streaming for specified board (0-7)"}},
-  {"stream_dac_debug", cmd_stream_dac_debug, {2, 2, {-1}, "Start DAC debug data streaming to file: <board> <file_path> (streams DAC debug data to file)"}},
-  {"stop_dac_debug_stream", cmd_stop_dac_debug_stream, {1, 1, {-1}, "Stop DAC debug data streaming for specified board (0-7)"}},
+  {"do_dac_wr_ch", cmd_do_dac_wr_ch, {2, 2, {-1}, "Write DAC single channel: <channel> <value> (board=ch/8, ch=ch%8)"}},
+  {"get_dac_cal", cmd_get_dac_cal, {0, 1, {FLAG_ALL, FLAG_NO_RESET, -1}, "Get DAC calibration value: <channel> [--no_reset] OR --all [--no_reset] (board=ch/8, ch=ch%8)"}},
+  {"do_dac_get_cal", cmd_do_dac_get_cal, {1, 1, {-1}, "Send DAC GET_CAL command for single channel: <channel> (board=ch/8, ch=ch%8)"}},
+  {"set_dac_cal", cmd_set_dac_cal, {2, 2, {-1}, "Set DAC calibration value for single channel: <channel> <cal_value> (cal_value -32767 to 32767)"}},
+  {"stream_dac_commands_from_file", cmd_stream_dac_commands_from_file, {2, 3, {FLAG_SIMPLE, -1}, "Start DAC command streaming from waveform file: <board> <file_path> [iterations] [--simple] (supports * wildcards; unless --simple, repeated writes are sent as no-ops (delay writes only when the pre-delay is on and the DAC minimum delay equals its SPI write time) and no-op delays are merged)"}},
+  {"stop_dac_cmd_stream", cmd_stop_dac_cmd_stream, {1, 1, {-1}, "Stop DAC command streaming for specified board"}},
+  {"dma_dac_commands_from_file", cmd_dma_dac_commands_from_file, {2, 3, {FLAG_SIMPLE, -1}, "Load a waveform file into DMA memory and let hardware stream it: <board> <file_path> [iterations] [--simple] (iterations defaults to 1, 0 loops until stop_dac_dma; no other DAC commands may be sent to the board while it runs)"}},
+  {"stop_dac_dma", cmd_stop_dac_dma, {1, 1, {-1}, "Stop DAC command DMA for specified board, clear its command buffer and cancel the current command"}},
+  {"dac_dma_sts", cmd_dac_dma_sts, {1, 1, {-1}, "Show DAC command DMA status for specified board"}},
+  {"stream_dac_debug", cmd_stream_dac_debug, {2, 2, {FLAG_BIN, -1}, "Start DAC debug data streaming to file: <board> <file_path> [--bin] (--bin writes raw debug words for offline decoding)"}},
+  {"stop_dac_debug_stream", cmd_stop_dac_debug_stream, {1, 1, {-1}, "Stop DAC debug data streaming for specified board"}},
   {"set_dac_cal_init", cmd_set_dac_cal_init, {1, 1, {-1}, "Set the unified DAC calibration init register to a 16-bit signed value: <cal_init_value> (-32767 to 32767)"}},
   {"toggle_dac_pre_delay", cmd_toggle_dac_pre_delay, {0, 0, {-1}, "Toggle the DAC pre-delay bit in the do_dac_pre_delay register"}},
 
   // ===== ADC COMMANDS (from adc_commands.h) =====
-  {"adc_cmd_fifo_sts", cmd_adc_cmd_fifo_sts, {1, 1, {-1}, "Show ADC command FIFO status for specified board (0-7)"}},
-  {"adc_data_fifo_sts", cmd_adc_data_fifo_sts, {1, 1, {-1}, "Show ADC data FIFO status for specified board (0-7)"}},
-  {"adc_last_received_cmd", cmd_adc_last_received_cmd, {1, 1, {-1}, "Show and decode last received ADC command for specified board (0-7)"}},
-  {"adc_cmds_since_reset", cmd_adc_cmds_since_reset, {1, 1, {-1}, "Show ADC command count since last reset for specified board (0-7)"}},
-  {"read_adc_pair", cmd_read_adc_pair, {1, 1, {FLAG_ALL, -1}, "Read paired ADC channel sample(s) from specified board (0-7) [--all]"}},
-  {"read_adc_single", cmd_read_adc_single, {1, 1, {FLAG_ALL, -1}, "Read single ADC channel data sample(s) from specified board (0-7) [--all]"}},
-  {"read_adc_dbg", cmd_read_adc_dbg, {1, 1, {FLAG_ALL, -1}, "Read and print debug information for ADC data from specified board (0-7)"}},
+  {"adc_cmd_fifo_sts", cmd_adc_cmd_fifo_sts, {1, 1, {-1}, "Show ADC command FIFO status for specified board"}},
+  {"adc_data_fifo_sts", cmd_adc_data_fifo_sts, {1, 1, {-1}, "Show ADC data FIFO status for specified board"}},
+  {"adc_last_received_cmd", cmd_adc_last_received_cmd, {1, 1, {-1}, "Show and decode last received ADC command for specified board"}},
+  {"adc_cmds_since_reset", cmd_adc_cmds_since_reset, {1, 1, {-1}, "Show ADC command count since last reset for specified board"}},
+  {"read_adc_pair", cmd_read_adc_pair, {1, 1, {FLAG_ALL, -1}, "Read paired ADC channel sample(s) from specified board [--all]"}},
+  {"read_adc_single", cmd_read_adc_single, {1, 1, {FLAG_ALL, -1}, "Read single ADC channel data sample(s) from specified board [--all]"}},
+  {"read_adc_dbg", cmd_read_adc_dbg, {1, 1, {FLAG_ALL, -1}, "Read and print debug information for ADC data from specified board"}},
   {"adc_noop", cmd_adc_noop, {3, 3, {FLAG_CONTINUE, -1}, "Send ADC no-op command: <board|all> <\"trig\"|\"delay\"> <value> [--continue]"}},
-  {"adc_cancel", cmd_adc_cancel, {1, 1, {-1}, "Send ADC cancel command to specified board (0-7)"}},
+  {"adc_cancel", cmd_adc_cancel, {1, 1, {-1}, "Send ADC cancel command to specified board"}},
   {"adc_set_ord", cmd_adc_set_ord, {9, 9, {-1}, "Set ADC channel order: <board> <ord0> <ord1> <ord2> <ord3> <ord4> <ord5> <ord6> <ord7> (each order value must be 0-7)"}},
   {"do_adc_rd", cmd_do_adc_rd, {3, 4, {-1}, "Perform ADC read: <board> <\"trig\"|\"delay\"> <value> [repeat_count] (sends adc_rd command with repeat count, defaults to 0)"}},
-  {"do_adc_rd_ch", cmd_do_adc_rd_ch, {1, 2, {-1}, "Read ADC single channel: <channel> [repeat_count] (channel 0-63, board=ch/8, ch=ch%8, repeat_count defaults to 0)"}},
-  {"stream_adc_data_to_file", cmd_stream_adc_data_to_file, {3, 3, {FLAG_BIN, -1}, "Start ADC data streaming to file: <board> <word_count> <file_path> [--bin]"}},
-  {"stream_adc_commands_from_file", cmd_stream_adc_commands_from_file, {2, 3, {FLAG_SIMPLE, -1}, "Start ADC command streaming from file: <board> <file_path> [iterations] [--simple] (supports * wildcards, iterations defaults to 1)"}},
-  {"stop_adc_data_stream", cmd_stop_adc_data_stream, {1, 1, {-1}, "Stop ADC data streaming for specified board (0-7)"}},
-  {"stop_adc_cmd_stream", cmd_stop_adc_cmd_stream, {1, 1, {-1}, "Stop ADC command streaming for specified board (0-7)"}},
+  {"do_adc_rd_ch", cmd_do_adc_rd_ch, {1, 2, {-1}, "Read ADC single channel: <channel> [repeat_count] (board=ch/8, ch=ch%8, repeat_count defaults to 0)"}},
+  {"stream_adc_data_to_file", cmd_stream_adc_data_to_file, {3, 5, {FLAG_BIN, FLAG_NPY, FLAG_CORRECTED, -1}, "Start ADC data streaming to file: <board> <word_count> <file_path> [<adc_cmd_file> <iterations>] [--bin|--npy] [--corrected] (--npy or a .npy path writes an int16 [samples, 8] array; --corrected subtracts the ADC bias, assuming the default channel order; with a command file, also writes a trigger index to <file_path>.idx)"}},
+  {"stream_adc_commands_from_file", cmd_stream_adc_commands_from_file, {2, 3, {FLAG_SIMPLE, -1}, "Start ADC command streaming from file: <board> <file_path> [iterations] [--simple] (supports * wildcards, iterations defaults to 1; runs of identical reads are sent as repeat commands, --simple unrolls repeats instead)"}},
+  {"stop_adc_data_stream", cmd_stop_adc_data_stream, {1, 1, {-1}, "Stop ADC data streaming for specified board"}},
+  {"stop_adc_cmd_stream", cmd_stop_adc_cmd_stream, {1, 1, {-1}, "Stop ADC command streaming for specified board"}},
 
   // ===== TRIGGER COMMANDS (from trigger_commands.h) =====
   {"trig_cmd_fifo_sts", cmd_trig_cmd_fifo_sts, {0, 0, {-1}, "Show trigger command FIFO status"}},
@@ -123,17 +129,32 @@ static command_entry_t command_table[] = {
   {"sync_ch", cmd_trig_sync_ch, {0, 1, {-1}, "Send trigger synchronize channels command [log]"}},
   {"force_trig", cmd_trig_force_trig, {0, 1, {-1}, "Send trigger force trigger command [log]"}},
   {"trig_cancel", cmd_trig_cancel, {0, 0, {-1}, "Send trigger cancel command"}},
-  {"trig_reset_count", cmd_trig_reset_count, {0, 0, {-1}, "Reset trigger counter and timer to zero"}},
+  {"trig_reset_count", cmd_trig_reset_count, {0, 1, {-1}, "Reset trigger counter and timer to zero [delta] (delta logs one 32-bit word per trigger instead of two, reconstructed on read)"}},
   {"trig_count", cmd_trig_count, {0, 0, {-1}, "Show current trigger count"}},
   {"trig_set_lockout", cmd_trig_set_lockout, {1, 1, {-1}, "Send trigger set lockout command with cycles (1 - 0x0FFFFFFF)"}},
   {"trig_delay", cmd_trig_delay, {1, 1, {-1}, "Send trigger delay command with cycles (0 - 0x0FFFFFFF)"}},
   {"trig_expect_ext", cmd_trig_expect_ext, {1, 2, {-1}, "Send trigger expect external command with count (0 - 0x0FFFFFFF) [log]"}},
-  {"stream_trig_data_to_file", cmd_stream_trig_data_to_file, {2, 2, {FLAG_BIN, -1}, "Start trigger data streaming to file: <sample_count> <file_path> [--bin]"}},
+  {"trig_set_period", cmd_trig_set_period, {1, 1, {-1}, "Send trigger set period command with cycles between periodic triggers (4 - 0x07FFFFFF)"}},
+  {"trig_periodic", cmd_trig_periodic, {1, 2, {-1}, "Send trigger periodic command: emit count triggers one period apart (0 - 0x07FFFFFF, 0 runs until trig_cancel) [log]"}},
+  {"stream_trig_data_to_file", cmd_stream_trig_data_to_file, {2, 2, {FLAG_BIN, FLAG_NPY, -1}, "Start trigger data streaming to file: <sample_count> <file_path> [--bin|--npy] (--npy or a .npy path writes a uint64 timestamp array)"}},
   {"stop_trig_data_stream", cmd_stop_trig_data_stream, {0, 0, {-1}, "Stop trigger data streaming"}},
 
+  // ===== LIVE DATA COMMANDS (from system_commands.h) =====
+  {"live_ring_open", cmd_live_ring_open, {0, 2, {-1}, "Publish ADC and trigger stream data to a shared-memory ring (/dev/shm/rev_d_shim_live) for local readers: [frames_per_board] [triggers] (default 4096 each, rounded up to a power of two)"}},
+  {"live_ring_close", cmd_live_ring_close, {0, 0, {-1}, "Remove the shared-memory live data ring (no ADC or trigger streams may be running)"}},
+  {"fifo_telemetry_start", cmd_fifo_telemetry_start, {0, 3, {-1}, "Sample every FIFO's fill level into a ring: [rate_hz] [seconds_kept] [halt_dump_file] (default 10000 Hz, 10 s; the ring is written to halt_dump_file when the hardware leaves the running state)"}},
+  {"fifo_telemetry_dump", cmd_fifo_telemetry_dump, {1, 1, {-1}, "Write the FIFO telemetry ring to a binary file and print min/mean/max fill and headroom per FIFO: <file_path>"}},
+  {"fifo_telemetry_stop", cmd_fifo_telemetry_stop, {0, 0, {-1}, "Stop FIFO telemetry and print the fill summary"}},
+  {"rt_enable", cmd_rt_enable, {0, 2, {-1}, "Run stream and fieldmap threads started from now on with SCHED_FIFO priorities pinned to one CPU, commands and console on the other, memory locked: [fifo_cpu] [io_cpu] (default 1 and 0)"}},
+  {"rt_disable", cmd_rt_disable, {0, 0, {-1}, "Disable the real-time profile (running threads keep their scheduling until they exit)"}},
+  {"rt_status", cmd_rt_status, {0, 1, {-1}, "Show the real-time profile and each stream thread's scheduling, worst loop gap and worst wake-up latency: [reset]"}},
+  {"trace_start", cmd_trace_start, {0, 1, {-1}, "Record FIFO status, FIFO batch, file write and sleep spans in the stream and fieldmap threads: [spans_per_thread] (default 65536; discards the previous trace)"}},
+  {"trace_stop", cmd_trace_stop, {0, 0, {-1}, "Stop thread tracing and print time per span type for each thread"}},
+  {"trace_dump", cmd_trace_dump, {1, 1, {-1}, "Write the thread trace as Chrome trace JSON (Perfetto, chrome://tracing): <file_path>"}},
+
   // ===== EXPERIMENT COMMANDS (from experiment_commands.h) =====
-  {"channel_test", cmd_channel_test, {2, 2, {FLAG_NO_RESET, -1}, "Set DAC and check ADC on individual channels: <channel> <value> (channel 0-63, value -32767 to 32767) [--no_reset]"}},
-  {"channel_cal", cmd_channel_cal, {1, 1, {FLAG_NO_RESET, -1}, "Calibrate DAC/ADC channels: <channel|all> [--no_reset] (channel 0-63, board=ch/8, ch=ch%8)"}},
+  {"channel_test", cmd_channel_test, {2, 2, {FLAG_NO_RESET, -1}, "Set DAC and check ADC on individual channels: <channel> <value> (value -32767 to 32767) [--no_reset]"}},
+  {"channel_cal", cmd_channel_cal, {1, 1, {FLAG_NO_RESET, -1}, "Calibrate DAC/ADC channels: <channel|all> [--no_reset] (board=ch/8, ch=ch%8)"}},
   {"find_bias", cmd_find_bias, {0, 0, {FLAG_NO_RESET, -1}, "Find ADC bias calibration for all connected channels - verifies slope near zero and stores bias values [--no_reset]"}},
   {"print_adc_bias", cmd_print_adc_bias, {0, 0, {-1}, "Print current ADC bias values for all channels"}},
   {"save_adc_bias", cmd_save_adc_bias, {1, 1, {-1}, "Save ADC bias values to CSV file: <filename>"}},
@@ -144,12 +165,20 @@ static command_entry_t command_table[] = {
   {"stop_trigger_monitor", cmd_stop_trigger_monitor, {0, 0, {-1}, "Stop trigger monitoring thread"}},
   {"stop_waveform", cmd_stop_waveform, {0, 0, {-1}, "Stop waveform test - stops all streaming and monitoring"}},
   {"rev_c_compat", cmd_rev_c_compat, {0, 0, {FLAG_BIN, FLAG_NO_RESET, -1}, "Interactive Rev C compatibility mode: prompts for DAC file, iterations, output file, and delay [--bin] [--no_reset]"}},
+  {"thresh_sim", cmd_thresh_sim, {5, 12, {-1}, "Simulate the threshold core over DAC waveform files without hardware output: <timer|integrator> <window> <thresh_average> <trig_period_cycles> <board0_file> [board1_file ... board7_file] (reports first violation per channel)"}},
+  {"latency_test", cmd_latency_test, {2, 3, {FLAG_NO_RESET, -1}, "Measure trigger-to-output latency: <board|all> <trigger_count> [csv_file] [--no_reset] (forces logged triggers with a triggered DAC write of 0 and ADC read queued; reports per-board trigger -> DAC write (needs DAC debug bit 2*board set before power on) and trigger -> ADC data latency/jitter histograms)"}},
+  {"parse_bench", cmd_parse_bench, {2, 3, {-1}, "Benchmark command file parsing: <dac|adc> <file_path> [board_count] (parses the file once per board, sequentially and then one thread per board; default all boards)"}},
   {"dac_zero", cmd_dac_zero, {1, 1, {FLAG_NO_RESET, -1}, "Set DAC channels to calibrated zero: <board_num|all> [--no_reset]"}},
 
-  // ===== COMMAND LOGGING/PLAYBACK (from command_handler.c) =====
+  // ===== COMMAND LOGGING/PLAYBACK (from command_handler.c and script_engine.c) =====
   {"log_commands", cmd_log_commands, {1, 1, {-1}, "Start logging commands to file: <file_path>"}},
   {"stop_log", cmd_stop_log, {0, 0, {-1}, "Stop logging commands"}},
-  {"load_commands", cmd_load_commands, {1, 1, {-1}, "Load and execute commands from file: <file_path> (0.25s delay between commands, supports * wildcards)"}},
+  {"load_commands", cmd_load_commands, {1, 1, {FLAG_NO_PACE, -1}, "Load and execute commands from file: <file_path> [--no_pace] (after each line, waits up to 250 ms for command FIFOs not fed by a stream to drain; --no_pace skips this, leaving scripts to pace themselves with wait_* commands; lines between 'parallel' and 'end' run concurrently in their own threads, except that system-wide commands (power, resets, clocks, experiments, logging) run alone; supports * wildcards)"}},
+  {"wait_empty", cmd_wait_empty, {2, 3, {-1}, "Wait for command FIFOs to drain: <dac|adc|trig|all> <board|all> [timeout_ms=10000]"}},
+  {"wait_triggers", cmd_wait_triggers, {1, 2, {-1}, "Wait for more triggers: <count> [timeout_ms=10000] (counted from when the wait starts)"}},
+  {"wait_state", cmd_wait_state, {1, 2, {-1}, "Wait for the hardware manager state: <state_code> [timeout_ms=10000] (fails early on HALTED)"}},
+  {"wait_stream", cmd_wait_stream, {2, 3, {-1}, "Wait for stream threads to finish: <dac|adc|dac_debug|adc_data|trig> <board|all> [timeout_ms=10000]"}},
+  {"wait_ms", cmd_wait_ms, {1, 1, {-1}, "Fixed delay: <milliseconds>"}},
 
   // Sentinel entry - marks end of table (must be last)
   {NULL, NULL, {0, 0, {-1}, NULL}}
@@ -214,58 +243,19 @@ int cmd_load_commands(const char** args, int arg_count, const command_flag_t* fl
     return -1;
   }
 
-  // Open file for reading
-  FILE* file = fopen(resolved_path, "r");
-  if (file == NULL) {
-    fprintf(stderr, "Failed to open command file '%s' for reading: %s\n", resolved_path, strerror(errno));
-    return -1;
-  }
-
   printf("Loading and executing commands from file '%s'...\n", resolved_path);
 
-  char line[256];
-  int line_number = 0;
-  int commands_executed = 0;
-
-  while (fgets(line, sizeof(line), file) != NULL) {
-    line_number++;
-
-    // Remove newline character
-    size_t len = strlen(line);
-    if (len > 0 && line[len - 1] == '\n') {
-      line[len - 1] = '\0';
-    }
-
-    // Skip empty lines and lines starting with # (comments)
-    if (strlen(line) == 0 || line[0] == '#') {
-      continue;
-    }
-
-    printf("Executing line %d: %s\n", line_number, line);
-
-    // Execute the command
-    int result = execute_command(line, ctx);
-    if (result != 0) {
-      printf("Invalid command at line %d: '%s'\n", line_number, line);
-      printf("Performing hard reset and exiting...\n");
-      fclose(file);
-
-      // Perform hard reset
-      cmd_hard_reset(NULL, 0, NULL, 0, ctx);
+  bool pace = !has_flag(flags, flag_count, FLAG_NO_PACE);
+  if (script_run_file(resolved_path, ctx, pace) != 0) {
+    printf("Performing hard reset and exiting...\n");
 
-      // Exit
-      *(ctx->should_exit) = true;
-      return -1;
-    }
+    // Perform hard reset
+    cmd_hard_reset(NULL, 0, NULL, 0, ctx);
 
-    commands_executed++;
-
-    // 0.25 second delay between commands
-    usleep(250000);
+    // Exit
+    *(ctx->should_exit) = true;
+    return -1;
   }
-
-  fclose(file);
-  printf("Successfully executed %d commands from file '%s'.\n", commands_executed, resolved_path);
   return 0;
 }
 
@@ -374,6 +364,15 @@ void print_command_help(const char* command_name) {
         case FLAG_NO_RESET:
           printf(" --no_reset");
           break;
+        case FLAG_NPY:
+          printf(" --npy");
+          break;
+        case FLAG_CORRECTED:
+          printf(" --corrected");
+          break;
+        case FLAG_NO_PACE:
+          printf(" --no_pace");
+          break;
       }
     }
     printf("\n");
@@ -383,7 +382,9 @@ void print_command_help(const char* command_name) {
 // Main help printing function
 void print_help(void) {
   printf("\nAvailable commands:\n");
-  printf("==================\n\n");
+  printf("==================\n");
+  printf("Boards are numbered 0-%d; channels 0-%d (board=ch/%d, ch=ch%%%d)\n\n", SHIM_MAX_BOARDS - 1,
+         SHIM_MAX_CHANNELS - 1, SHIM_CHANNELS_PER_BOARD, SHIM_CHANNELS_PER_BOARD);
 
   // Count total commands first
   int total_commands = 0;
@@ -468,7 +469,29 @@ void print_help(void) {
         strstr(command_table[i].name, "waveform_test") || strstr(command_table[i].name, "fieldmap") ||
         strstr(command_table[i].name, "stop_fieldmap") || strstr(command_table[i].name, "stop_trigger_monitor") ||
         strstr(command_table[i].name, "stop_waveform") || strstr(command_table[i].name, "rev_c_compat") ||
-        strstr(command_table[i].name, "zero_all_dacs")) {
+        strstr(command_table[i].name, "zero_all_dacs") || strstr(command_table[i].name, "thresh_sim") ||
+        strstr(command_table[i].name, "latency_test") || strstr(command_table[i].name, "parse_bench")) {
+      char prefix[32];
+      snprintf(prefix, sizeof(prefix), "  %-20s ", command_table[i].name);
+      print_wrapped_line(prefix, command_table[i].info.description, "                         ");
+      printed[i] = true;
+    }
+  }
+
+  printf("\nReal-Time Commands:\n");
+  for (int i = 0; i < total_commands; i++) {
+    if (strstr(command_table[i].name, "rt_") == command_table[i].name) {
+      char prefix[32];
+      snprintf(prefix, sizeof(prefix), "  %-20s ", command_table[i].name);
+      print_wrapped_line(prefix, command_table[i].info.description, "                         ");
+      printed[i] = true;
+    }
+  }
+
+  printf("\nLive Data Commands:\n");
+  for (int i = 0; i < total_commands; i++) {
+    if (strstr(command_table[i].name, "live_ring") || strstr(command_table[i].name, "fifo_telemetry") ||
+        strstr(command_table[i].name, "trace_")) {
       char prefix[32];
       snprintf(prefix, sizeof(prefix), "  %-20s ", command_table[i].name);
       print_wrapped_line(prefix, command_table[i].info.description, "                         ");
@@ -476,10 +499,11 @@ void print_help(void) {
     }
   }
 
-  printf("\nLogging and Loading Commands:\n");
+  printf("\nLogging, Loading and Script Commands:\n");
   for (int i = 0; i < total_commands; i++) {
     if (strstr(command_table[i].name, "log_commands") || strstr(command_table[i].name, "stop_log") ||
-        strstr(command_table[i].name, "load_commands")) {
+        strstr(command_table[i].name, "load_commands") ||
+        (strstr(command_table[i].name, "wait_") && !printed[i])) {
       char prefix[32];
       snprintf(prefix, sizeof(prefix), "  %-20s ", command_table[i].name);
       print_wrapped_line(prefix, command_table[i].info.description, "                         ");
@@ -508,6 +532,9 @@ void print_help(void) {
   printf("  --bin        Write binary format instead of ASCII text\n");
   printf("  --no_reset   Skip buffer reset operations (for debugging)\n");
   printf("  --no_cal     Skip calibration step in waveform test\n");
+  printf("  --npy        Write NumPy .npy format (also chosen by a .npy file extension)\n");
+  printf("  --corrected  Subtract the ADC bias from streamed samples\n");
+  printf("  --no_pace    Skip the command FIFO drain between script lines\n");
   printf("\n");
 }
 
@@ -524,7 +551,8 @@ int parse_command_line(const char* line, const char** args, int* arg_count, comm
   *flag_count = 0;
 
   char* line_copy = strdup(line);
-  char* token = strtok(line_copy, " \t\n");
+  char* save_ptr = NULL;
+  char* token = strtok_r(line_copy, " \t\n", &save_ptr);
 
   while (token != NULL && *arg_count < MAX_ARGS) {
     if (token[0] == '-' && token[1] == '-') {
@@ -541,6 +569,12 @@ int parse_command_line(const char* line, const char** args, int* arg_count, comm
         flags[(*flag_count)++] = FLAG_NO_RESET;
       } else if (strcmp(token, "--no_cal") == 0) {
         flags[(*flag_count)++] = FLAG_NO_CAL;
+      } else if (strcmp(token, "--npy") == 0) {
+        flags[(*flag_count)++] = FLAG_NPY;
+      } else if (strcmp(token, "--corrected") == 0) {
+        flags[(*flag_count)++] = FLAG_CORRECTED;
+      } else if (strcmp(token, "--no_pace") == 0) {
+        flags[(*flag_count)++] = FLAG_NO_PACE;
       } else {
         // Unknown flag - return error
         printf("Error: Unknown flag '%s'\n", token);
@@ -550,7 +584,7 @@ int parse_command_line(const char* line, const char** args, int* arg_count, comm
     } else {
       args[(*arg_count)++] = strdup(token);
     }
-    token = strtok(NULL, " \t\n");
+    token = strtok_r(NULL, " \t\n", &save_ptr);
   }
 
   free(line_copy);
@@ -618,6 +652,9 @@ int execute_command(const char* line, command_context_t* ctx) {
         case FLAG_BIN: flag_name = "--bin"; break;
         case FLAG_NO_RESET: flag_name = "--no_reset"; break;
         case FLAG_NO_CAL: flag_name = "--no_cal"; break;
+        case FLAG_NPY: flag_name = "--npy"; break;
+        case FLAG_CORRECTED: flag_name = "--corrected"; break;
+        case FLAG_NO_PACE: flag_name = "--no_pace"; break;
       }
       printf("Error: Command '%s' does not accept flag '%s'\n", args[0], flag_name);
       printf("\n");
@@ -27,6 +27,11 @@ double dac_to_amps(int16_t dac_value) {
   double amps = ((double)dac_value) * (5.0 / 32767.0);
   return amps;
 }
+// Build an ADC conversion table from the context's current ADC bias values
+void load_adc_convert(command_context_t* ctx, adc_convert_t* conv) {
+  adc_convert_init(conv, ADC_CONVERT_DEFAULT_AMPS);
+  adc_convert_load_bias(conv, ctx->adc_bias, ctx->adc_bias_valid, ADC_CONVERT_MAX_CHANNELS);
+}
 // Parse numeric value from string, supporting decimal, hex (0x), octal (0), binary (0b)
 uint32_t parse_value(const char* str, char** endptr) {
   const char* arg = str;
@@ -38,10 +43,10 @@ uint32_t parse_value(const char* str, char** endptr) {
     return (uint32_t)strtol(arg, endptr, 0); // Handles 0x, decimal, octal
   }
 }
-// Validate and parse board number (0-7)
+// Validate and parse board number (0 to SHIM_MAX_BOARDS-1)
 int parse_board_number(const char* str) {
   int board = atoi(str);
-  if (board < 0 || board > 7) {
+  if (board < 0 || board >= SHIM_MAX_BOARDS) {
     return -1;
   }
   return board;
@@ -140,22 +145,22 @@ int parse_trigger_mode(const char* mode_str, const char* value_str, bool* is_tri
 int validate_board_number(const char* board_str) {
   int board = parse_board_number(board_str);
   if (board == -1) {
-    printf("Error: Invalid board number '%s'. Must be 0-7.\n", board_str);
+    printf("Error: Invalid board number '%s'. Must be 0-%d.\n", board_str, SHIM_MAX_BOARDS - 1);
     return -1;
   }
   return board;
 }
 
-// Validate channel number (0-63) and return board and channel, or -1 on error
+// Validate channel number (0 to SHIM_MAX_CHANNELS-1) and return board and channel, or -1 on error
 int validate_channel_number(const char* channel_str, int* board, int* channel) {
   char* endptr;
   int ch = strtol(channel_str, &endptr, 10);
-  if (*endptr != '\0' || ch < 0 || ch > 63) {
-    printf("Error: Invalid channel number '%s'. Must be 0-63.\n", channel_str);
+  if (*endptr != '\0' || ch < 0 || ch >= SHIM_MAX_CHANNELS) {
+    printf("Error: Invalid channel number '%s'. Must be 0-%d.\n", channel_str, SHIM_MAX_CHANNELS - 1);
     return -1;
   }
-  *board = ch / 8;
-  *channel = ch % 8;
+  *board = ch / SHIM_CHANNELS_PER_BOARD;
+  *channel = ch % SHIM_CHANNELS_PER_BOARD;
   return 0;
 }
 
@@ -168,6 +173,28 @@ void print_trigger_data(uint64_t data) {
   printf("  64-bit value: 0x%016" PRIX64 " (%" PRIu64 ")\n", data, data);
 }
 
+// Print the timing summary of a validated command file.
+// shortest_delay is UINT32_MAX if the file has no delay-timed updates, trigger_spacing is 0 if it has no trigger waits.
+void print_file_timing(const char* file_type, const char* file_path, uint32_t min_delay, uint32_t shortest_delay,
+                       uint64_t trigger_spacing, uint32_t clk_freq_hz) {
+  double clk_mhz = clk_freq_hz / 1e6;
+  printf("%s file '%s' timing at %.3f MHz:\n", file_type, file_path, clk_mhz);
+  if (clk_freq_hz == 0) {
+    printf("  SPI clock frequency unknown, rates not available\n");
+    return;
+  }
+  printf("  Minimum delay:        %u cycles (hardware max %.2f kHz)\n", min_delay, clk_mhz * 1e3 / min_delay);
+  if (shortest_delay != UINT32_MAX) {
+    printf("  Shortest delay:       %u cycles (file peak %.2f kHz)\n", shortest_delay, clk_mhz * 1e3 / shortest_delay);
+  } else {
+    printf("  Shortest delay:       none (no delay-timed updates)\n");
+  }
+  if (trigger_spacing > 0) {
+    printf("  Min trigger spacing:  %llu cycles (%.2f us, max %.2f kHz trigger rate)\n",
+           trigger_spacing, trigger_spacing / clk_mhz, clk_mhz * 1e3 / trigger_spacing);
+  }
+}
+
 // Helper function to clean and expand file paths
 void clean_and_expand_path(const char* input_path, char* full_path, size_t full_path_size) {
   const char* rel_path = input_path;
@@ -11,10 +11,15 @@
 #include <glob.h>
 #include "dac_commands.h"
 #include "command_helper.h"
+#include "thread_trace.h"
+#include "rt_sched.h"
+#include "waveform_cache.h"
+#include "file_scan.h"
 #include "system_commands.h"
 #include "sys_sts.h"
 #include "sys_ctrl.h"
 #include "dac_ctrl.h"
+#include "dac_dma.h"
 
 // Local helper function to check if system is running
 static int validate_system_running(command_context_t* ctx);
@@ -35,7 +40,7 @@ static int validate_system_running(command_context_t* ctx) {
 int cmd_dac_cmd_fifo_sts(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = validate_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for dac_cmd_fifo_sts: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for dac_cmd_fifo_sts: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
   uint32_t fifo_status = sys_sts_get_dac_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, *(ctx->verbose));
@@ -46,7 +51,7 @@ int cmd_dac_cmd_fifo_sts(const char** args, int arg_count, const command_flag_t*
 int cmd_dac_data_fifo_sts(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = validate_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for dac_data_fifo_sts: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for dac_data_fifo_sts: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
   uint32_t fifo_status = sys_sts_get_dac_data_fifo_status(ctx->sys_sts, (uint8_t)board, *(ctx->verbose));
@@ -57,7 +62,7 @@ int cmd_dac_data_fifo_sts(const char** args, int arg_count, const command_flag_t
 int cmd_dac_last_received_cmd(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = validate_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for dac_last_received_cmd: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for dac_last_received_cmd: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -70,7 +75,7 @@ int cmd_dac_last_received_cmd(const char** args, int arg_count, const command_fl
 int cmd_dac_cmds_since_reset(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = validate_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for dac_cmds_since_reset: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for dac_cmds_since_reset: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -82,7 +87,7 @@ int cmd_dac_cmds_since_reset(const char** args, int arg_count, const command_fla
 int cmd_read_dac_data(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = parse_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for read_dac_data: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for read_dac_data: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -134,10 +139,10 @@ int cmd_dac_noop(const char** args, int arg_count, const command_flag_t* flags,
 
   if (use_all) {
     // Check which boards are connected by checking FIFOs
-    bool connected_boards[8] = {false};
+    bool connected_boards[SHIM_MAX_BOARDS] = {false};
     int connected_count = 0;
 
-    for (int board = 0; board < 8; board++) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       uint32_t dac_cmd_fifo_status = sys_sts_get_dac_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, false);
       uint32_t dac_data_fifo_status = sys_sts_get_dac_data_fifo_status(ctx->sys_sts, (uint8_t)board, false);
 
@@ -155,7 +160,7 @@ int cmd_dac_noop(const char** args, int arg_count, const command_flag_t* flags,
     printf("Sending DAC no-op command to %d connected board(s) with %s mode, value %u%s:\n",
            connected_count, is_trigger ? "trigger" : "delay", value, cont ? ", continuous" : "");
 
-    for (int board = 0; board < 8; board++) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       if (!connected_boards[board]) continue;
 
       // Check if DAC command stream is running for this board
@@ -170,7 +175,7 @@ int cmd_dac_noop(const char** args, int arg_count, const command_flag_t* flags,
   } else {
     int board = validate_board_number(args[0]);
     if (board < 0) {
-      fprintf(stderr, "Invalid board number for dac_noop: '%s'. Must be 0-7.\n", args[0]);
+      fprintf(stderr, "Invalid board number for dac_noop: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
       return -1;
     }
 
@@ -191,7 +196,7 @@ int cmd_dac_noop(const char** args, int arg_count, const command_flag_t* flags,
 int cmd_dac_cancel(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = validate_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for dac_cancel: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for dac_cancel: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -209,7 +214,7 @@ int cmd_dac_cancel(const char** args, int arg_count, const command_flag_t* flags
 int cmd_do_dac_wr(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   int board = validate_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for do_dac_wr: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for do_dac_wr: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -297,10 +302,10 @@ int cmd_do_dac_wr_ch(const char** args, int arg_count, const command_flag_t* fla
 
 // Get DAC calibration value for a single channel
 int cmd_get_dac_cal(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
-  // Parse arguments - either a channel number (0-63) or --all flag
+  // Parse arguments - either a channel number or --all flag
   bool get_all = has_flag(flags, flag_count, FLAG_ALL);
   int start_ch = 0, end_ch = 0;
-  bool connected_boards[8] = {false}; // Track which boards are connected
+  bool connected_boards[SHIM_MAX_BOARDS] = {false}; // Track which boards are connected
 
   if (get_all && arg_count > 0) {
     fprintf(stderr, "Error: Cannot specify both channel number and --all flag\n");
@@ -314,13 +319,13 @@ int cmd_get_dac_cal(const char** args, int arg_count, const command_flag_t* flag
 
   if (get_all) {
     start_ch = 0;
-    end_ch = 63;
+    end_ch = SHIM_MAX_CHANNELS - 1;
 
     // Check which boards are connected by checking FIFOs
     int connected_count = 0;
     printf("Checking connected boards...\n");
 
-    for (int board = 0; board < 8; board++) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       uint32_t dac_cmd_fifo_status = sys_sts_get_dac_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, false);
       uint32_t dac_data_fifo_status = sys_sts_get_dac_data_fifo_status(ctx->sys_sts, (uint8_t)board, false);
 
@@ -375,20 +380,19 @@ int cmd_get_dac_cal(const char** args, int arg_count, const command_flag_t* flag
   if (!skip_reset) {
     printf("Resetting all buffers...\n");
     safe_buffer_reset(ctx, *(ctx->verbose));
-    usleep(10000); // 10ms
   }
 
   // Send cancel commands once per connected board
   if (get_all) {
     printf("Sending cancel commands to connected boards...\n");
-    for (int board = 0; board < 8; board++) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       if (connected_boards[board]) {
         dac_cmd_cancel(ctx->dac_ctrl, (uint8_t)board, *(ctx->verbose));
       }
     }
   } else {
     // For single channel, send cancel to its board
-    int board = start_ch / 8;
+    int board = start_ch / SHIM_CHANNELS_PER_BOARD;
     printf("Sending cancel commands to board %d...\n", board);
     dac_cmd_cancel(ctx->dac_ctrl, (uint8_t)board, *(ctx->verbose));
   }
@@ -397,8 +401,8 @@ int cmd_get_dac_cal(const char** args, int arg_count, const command_flag_t* flag
   // Iterate through all channels to get calibration values
   for (int ch = start_ch; ch <= end_ch; ch++) {
     int board, channel;
-    board = ch / 8;
-    channel = ch % 8;
+    board = ch / SHIM_CHANNELS_PER_BOARD;
+    channel = ch % SHIM_CHANNELS_PER_BOARD;
 
     // If getting all channels, skip boards that are not connected
     if (get_all && !connected_boards[board]) {
@@ -513,160 +517,292 @@ int cmd_set_dac_cal(const char** args, int arg_count, const command_flag_t* flag
   return 0;
 }
 
-// Function to validate and parse a waveform file
-static int parse_waveform_file(const char* file_path, waveform_command_t** commands, int* command_count) {
-  FILE* file = fopen(file_path, "r");
-  if (file == NULL) {
+// Function to validate and parse a waveform file in a single pass over the mapped file
+// If sys_sts is given, delays are also checked against the DAC minimum delay at the current SPI clock,
+// and the file's timing summary is returned in *timing (if non-NULL)
+int parse_waveform_file_timed(const char* file_path, waveform_command_t** commands, int* command_count,
+                              struct sys_sts_t* sys_sts, command_file_timing_t* timing) {
+  mapped_file_t file;
+  if (mapped_file_open(file_path, &file) != 0) {
     fprintf(stderr, "Failed to open waveform file '%s': %s\n", file_path, strerror(errno));
     return -1;
   }
 
-  // First pass: count lines and validate format
-  char line[512];
+  // Timing limits (shorter delays raise DELAY_TOO_SHORT in the DAC core)
+  uint32_t min_delay = 0;
+  uint32_t clk_freq_hz = 0;
+  if (sys_sts != NULL) {
+    min_delay = sys_sts_get_dac_min_delay_time(sys_sts, false);
+    if (min_delay < DAC_MIN_DELAY_FLOOR) min_delay = DAC_MIN_DELAY_FLOOR;
+    clk_freq_hz = sys_sts_get_clk_freq_hz(sys_sts, false);
+  }
+
+  // Timing tracking: shortest D delay, and cycles of work between trigger waits
+  uint32_t shortest_delay = UINT32_MAX;
+  uint64_t cycles_since_wait = 0;
+  uint64_t cycles_before_first_wait = 0;
+  uint64_t trigger_spacing = 0;
+  bool found_wait = false;
+
+  // Commands are stored as each line is validated (a D/T line with channels is ~40 bytes)
+  int capacity = scan_line_estimate(file.size, 40);
+  waveform_command_t* cmds = malloc((size_t)capacity * sizeof(waveform_command_t));
+  if (cmds == NULL) {
+    fprintf(stderr, "Failed to allocate memory for waveform commands\n");
+    mapped_file_close(&file);
+    return -1;
+  }
+
+  const char* pos = file.data;
+  const char* end = file.data + file.size;
+  const char* line;
+  const char* line_end;
   int line_num = 0;
   int valid_lines = 0;
 
-  while (fgets(line, sizeof(line), file)) {
+  while (scan_next_line(&pos, end, &line, &line_end)) {
     line_num++;
 
     // Skip empty lines and comments
-    char* trimmed = line;
-    while (*trimmed == ' ' || *trimmed == '\t') trimmed++;
-    if (*trimmed == '\n' || *trimmed == '\r' || *trimmed == '\0' || *trimmed == '#') {
+    const char* p = scan_skip_indent(line, line_end);
+    if (p == line_end || *p == '\r' || *p == '\0' || *p == '#') {
       continue;
     }
 
     // Check if line starts with D, T, NT, or ND
-    bool is_noop_cmd = (strncmp(trimmed, "NT", 2) == 0 || strncmp(trimmed, "ND", 2) == 0);
-    if (!is_noop_cmd && *trimmed != 'D' && *trimmed != 'T') {
+    bool is_noop_cmd = (line_end - p >= 2 && p[0] == 'N' && (p[1] == 'T' || p[1] == 'D'));
+    if (!is_noop_cmd && *p != 'D' && *p != 'T') {
       fprintf(stderr, "Invalid line %d: must start with 'D', 'T', 'NT', or 'ND'\n", line_num);
-      fclose(file);
-      return -1;
+      goto fail;
     }
+    char cmd_mode[2] = {p[0], (line_end - p >= 2) ? p[1] : '\0'};
+    p = scan_skip_token(p, line_end, 2);
 
     // Parse the line to validate format
-    char cmd_mode[3];
     uint32_t value;
-    int16_t ch_vals[8];
-    int parsed;
+    int32_t ch_vals[8] = {0};
+    int channel_count = 0;
 
     if (is_noop_cmd) {
       // NT or ND commands: only cmd_mode and value (no channel values allowed)
-      parsed = sscanf(trimmed, "%2s %u", cmd_mode, &value);
-      if (parsed != 2) {
+      if (!scan_u32(&p, line_end, &value)) {
         fprintf(stderr, "Invalid line %d: NT/ND commands must have exactly cmd_mode and value\n", line_num);
-        fclose(file);
-        return -1;
+        goto fail;
       }
     } else {
       // D or T commands: can have channel values
-      parsed = sscanf(trimmed, "%2s %u %hd %hd %hd %hd %hd %hd %hd %hd",
-                     cmd_mode, &value, &ch_vals[0], &ch_vals[1], &ch_vals[2], &ch_vals[3],
-                     &ch_vals[4], &ch_vals[5], &ch_vals[6], &ch_vals[7]);
-
-      if (parsed < 2) {
+      if (!scan_u32(&p, line_end, &value)) {
         fprintf(stderr, "Invalid line %d: must have at least cmd_mode and value\n", line_num);
-        fclose(file);
-        return -1;
+        goto fail;
       }
+      while (channel_count < 8 && scan_i32(&p, line_end, &ch_vals[channel_count])) channel_count++;
 
-      if (parsed != 2 && parsed != 10) {
+      if (channel_count != 0 && channel_count != 8) {
         fprintf(stderr, "Invalid line %d: must have either 2 fields (cmd_mode, value) or 10 fields (cmd_mode, value, 8 channels)\n", line_num);
-        fclose(file);
-        return -1;
+        goto fail;
       }
     }
 
     // Validate value range
     if (value > 0x1FFFFFF) {
       fprintf(stderr, "Invalid line %d: value %u out of range (max 0x1FFFFFF or 33554431)\n", line_num, value);
-      fclose(file);
-      return -1;
+      goto fail;
     }
 
     // Validate channel values if present (only for D/T commands)
-    if (!is_noop_cmd && parsed == 10) {
-      for (int i = 0; i < 8; i++) {
-        if (ch_vals[i] < -32767 || ch_vals[i] > 32767) {
-          fprintf(stderr, "Invalid line %d: channel %d value %d out of range (-32767 to 32767)\n",
-                 line_num, i, ch_vals[i]);
-          fclose(file);
-          return -1;
+    for (int i = 0; i < channel_count; i++) {
+      if (ch_vals[i] < -32767 || ch_vals[i] > 32767) {
+        fprintf(stderr, "Invalid line %d: channel %d value %d out of range (-32767 to 32767)\n",
+               line_num, i, ch_vals[i]);
+        goto fail;
+      }
+    }
+
+    // Validate timing against the minimum delay
+    bool is_delay = is_noop_cmd ? (cmd_mode[1] == 'D') : (cmd_mode[0] == 'D');
+    if (is_delay) {
+      if (value < min_delay) {
+        fprintf(stderr, "Invalid line %d: delay %u cycles is below the DAC minimum delay of %u cycles (%.3f MHz SPI clock)\n",
+                line_num, value, min_delay, clk_freq_hz / 1e6);
+        goto fail;
+      }
+      if (!is_noop_cmd && value < shortest_delay) shortest_delay = value;
+      cycles_since_wait += value;
+    } else {
+      // Trigger mode: a DAC write completes before the trigger wait starts
+      if (!is_noop_cmd) cycles_since_wait += min_delay;
+      if (value > 0) {
+        // A trigger arriving before the core is waiting again is an unexpected trigger
+        if (found_wait) {
+          if (cycles_since_wait > trigger_spacing) trigger_spacing = cycles_since_wait;
+        } else {
+          cycles_before_first_wait = cycles_since_wait;
         }
+        found_wait = true;
+        cycles_since_wait = 0;
       }
     }
 
+    // Store the command
+    if (valid_lines == capacity) {
+      capacity *= 2;
+      waveform_command_t* grown = realloc(cmds, (size_t)capacity * sizeof(waveform_command_t));
+      if (grown == NULL) {
+        fprintf(stderr, "Failed to allocate memory for waveform commands\n");
+        goto fail;
+      }
+      cmds = grown;
+    }
+    waveform_command_t* cmd = &cmds[valid_lines];
+    if (is_noop_cmd) {
+      cmd->type = is_delay ? DAC_NOOP_DELAY_CMD : DAC_NOOP_TRIGGER_CMD;
+    } else {
+      cmd->type = is_delay ? DAC_DELAY_CMD : DAC_TRIGGER_CMD;
+    }
+    cmd->value = value;
+    for (int i = 0; i < 8; i++) {
+      cmd->ch_vals[i] = (int16_t)ch_vals[i]; // Zero when the line has no channel values
+    }
     valid_lines++;
   }
+  mapped_file_close(&file);
 
   if (valid_lines == 0) {
     fprintf(stderr, "No valid commands found in waveform file\n");
-    fclose(file);
+    free(cmds);
     return -1;
   }
 
-  // Allocate memory for commands
-  *commands = malloc(valid_lines * sizeof(waveform_command_t));
-  if (*commands == NULL) {
-    fprintf(stderr, "Failed to allocate memory for waveform commands\n");
-    fclose(file);
-    return -1;
+  // Looping back to the start of the file joins the tail and the head
+  if (found_wait && cycles_since_wait + cycles_before_first_wait > trigger_spacing) {
+    trigger_spacing = cycles_since_wait + cycles_before_first_wait;
   }
 
-  // Second pass: parse and store commands
-  rewind(file);
-  line_num = 0;
-  int cmd_index = 0;
+  if (timing != NULL) {
+    timing->min_delay = min_delay;
+    timing->shortest_delay = shortest_delay;
+    timing->trigger_spacing = trigger_spacing;
+    timing->clk_freq_hz = clk_freq_hz;
+  }
 
-  while (fgets(line, sizeof(line), file)) {
-    line_num++;
+  for (int i = 0; i < valid_lines; i++) {
+    cmds[i].cont = (i < valid_lines - 1); // true for all except last command
+  }
+  if (valid_lines < capacity) {
+    waveform_command_t* trimmed = realloc(cmds, (size_t)valid_lines * sizeof(waveform_command_t));
+    if (trimmed != NULL) cmds = trimmed;
+  }
 
-    // Skip empty lines and comments
-    char* trimmed = line;
-    while (*trimmed == ' ' || *trimmed == '\t') trimmed++;
-    if (*trimmed == '\n' || *trimmed == '\r' || *trimmed == '\0' || *trimmed == '#') {
-      continue;
-    }
+  *commands = cmds;
+  *command_count = valid_lines;
+  return 0;
+
+fail:
+  free(cmds);
+  mapped_file_close(&file);
+  return -1;
+}
+
+// Function to validate and parse a waveform file
+// If sys_sts is given, delays are also checked against the DAC minimum delay at the current SPI clock
+int parse_waveform_file(const char* file_path, waveform_command_t** commands, int* command_count,
+                        struct sys_sts_t* sys_sts, bool verbose) {
+  command_file_timing_t timing;
+  if (parse_waveform_file_timed(file_path, commands, command_count, sys_sts, &timing) != 0) {
+    return -1;
+  }
+  if (sys_sts != NULL && verbose) {
+    print_file_timing("Waveform", file_path, timing.min_delay, timing.shortest_delay, timing.trigger_spacing,
+                      timing.clk_freq_hz);
+  }
+  return 0;
+}
 
-    waveform_command_t* cmd = &(*commands)[cmd_index];
+#define WAVEFORM_MAX_VALUE 0x1FFFFFF // 25-bit command value
 
-    // Check if this is a noop command
-    bool is_noop_cmd = (strncmp(trimmed, "NT", 2) == 0 || strncmp(trimmed, "ND", 2) == 0);
+// FIFO words one waveform command takes (a DAC write is a command word plus 4 words of channel pairs)
+static uint32_t waveform_command_words(const waveform_command_t* cmd) {
+  return (cmd->type == DAC_TRIGGER_CMD || cmd->type == DAC_DELAY_CMD) ? 5 : 1;
+}
 
-    char cmd_mode[3];
-    uint32_t value;
-    int16_t ch_vals[8];
-    int parsed;
+// DAC minimum delay the core latched (the configured value, floored at the hardware minimum)
+static uint32_t waveform_min_delay(command_context_t* ctx) {
+  uint32_t min_delay = sys_sts_get_dac_min_delay_time(ctx->sys_sts, false);
+  return min_delay < DAC_MIN_DELAY_FLOOR ? DAC_MIN_DELAY_FLOOR : min_delay;
+}
 
-    if (is_noop_cmd) {
-      // Parse NT or ND command
-      sscanf(trimmed, "%2s %u", cmd_mode, &value);
-      cmd->type = (cmd_mode[1] == 'T') ? DAC_NOOP_TRIGGER_CMD : DAC_NOOP_DELAY_CMD;
-      cmd->value = value;
-    } else {
-      // Parse D or T command
-      parsed = sscanf(trimmed, "%2s %u %hd %hd %hd %hd %hd %hd %hd %hd",
-                     cmd_mode, &value, &ch_vals[0], &ch_vals[1], &ch_vals[2], &ch_vals[3],
-                     &ch_vals[4], &ch_vals[5], &ch_vals[6], &ch_vals[7]);
+// Whether a delay-wait DAC write takes exactly its delay, so it can be swapped for a no-op with the same delay.
+// A write counts its pre-delay down to the minimum delay and then ends when the 8-channel SPI write is done:
+// it takes (delay - minimum + write time) cycles with the pre-delay on, and just the write time with it off.
+// A no-op takes its full delay, so the two only match with the pre-delay on and the minimum equal to the
+// write time (8 channels of 24 bits plus the ~CS high time).
+static bool waveform_delay_writes_exact(command_context_t* ctx) {
+  uint32_t n_cs_high_time = DEBUG_DAC_CS_HIGH_TIME(sys_sts_get_debug(ctx->sys_sts, false));
+  if (n_cs_high_time < 3) n_cs_high_time = 3; // The core's floor on the ~CS high time
+  uint32_t write_cycles = 8 * (24 + n_cs_high_time);
+  return sys_ctrl_get_dac_pre_delay(ctx->sys_ctrl) && waveform_min_delay(ctx) == write_cycles;
+}
 
-      cmd->type = (cmd_mode[0] == 'T') ? DAC_TRIGGER_CMD : DAC_DELAY_CMD;
-      cmd->value = value;
+// Function to remove redundant DAC writes from a parsed waveform, in place
+// Output timing is unchanged: the DAC core runs commands back to back, delay-wait writes are only swapped
+// for no-ops when the caller says the two take the same number of cycles, trigger-wait writes and no-ops
+// both end on the same trigger, and merged no-op delays add up to the same cycle count.
+int optimize_waveform_commands(waveform_command_t* commands, int command_count, uint32_t min_delay,
+                               bool delay_writes_exact, waveform_opt_stats_t* stats) {
+  waveform_opt_stats_t st = {0};
+  int16_t output[8];
+  bool have_output = false; // The first write of a pass must stay a write (the DAC state before it is unknown)
+  int out = 0;
+
+  st.commands_before = command_count;
+  for (int i = 0; i < command_count; i++) {
+    waveform_command_t cmd = commands[i];
+    st.words_before += waveform_command_words(&cmd);
+
+    // A write of the values already on the outputs becomes a no-op with the same wait
+    if (cmd.type == DAC_DELAY_CMD || cmd.type == DAC_TRIGGER_CMD) {
+      bool same_timing = cmd.type == DAC_TRIGGER_CMD || delay_writes_exact;
+      if (same_timing && have_output && memcmp(cmd.ch_vals, output, sizeof(output)) == 0) {
+        cmd.type = (cmd.type == DAC_DELAY_CMD) ? DAC_NOOP_DELAY_CMD : DAC_NOOP_TRIGGER_CMD;
+        memset(cmd.ch_vals, 0, sizeof(cmd.ch_vals));
+        st.writes_removed++;
+      } else {
+        memcpy(output, cmd.ch_vals, sizeof(output));
+        have_output = true;
+      }
+    }
 
-      if (parsed == 10) {
-        for (int i = 0; i < 8; i++) {
-          cmd->ch_vals[i] = ch_vals[i];
+    // Consecutive no-op delays become one longer delay, split at the 25-bit value limit. Both parts of a split
+    // must stay at or above the minimum delay, or the core raises DELAY_TOO_SHORT on the short one.
+    if (cmd.type == DAC_NOOP_DELAY_CMD) {
+      uint32_t cycles = cmd.value == 0 ? 1 : cmd.value;
+      waveform_command_t* prev = out > 0 ? &commands[out - 1] : NULL;
+      if (prev != NULL && prev->type == DAC_NOOP_DELAY_CMD && prev->value < WAVEFORM_MAX_VALUE) {
+        uint32_t space = WAVEFORM_MAX_VALUE - prev->value;
+        if (cycles <= space) {
+          prev->value += cycles;
+          st.delays_merged++;
+          continue;
         }
+        // Move what fits into the previous delay, leaving at least the minimum for this one
+        uint32_t moved = cycles - space >= min_delay ? space
+                       : cycles > min_delay ? cycles - min_delay : 0;
+        prev->value += moved;
+        cycles -= moved;
       }
+      cmd.value = cycles;
     }
 
-    cmd->cont = (cmd_index < valid_lines - 1); // true for all except last command
-
-    cmd_index++;
+    commands[out++] = cmd;
   }
 
-  fclose(file);
-  *command_count = valid_lines;
-  return 0;
+  for (int i = 0; i < out; i++) {
+    commands[i].cont = (i < out - 1); // true for all except last command
+    st.words_after += waveform_command_words(&commands[i]);
+  }
+  st.commands_after = out;
+  if (stats != NULL) *stats = st;
+  return out;
 }
 
 // Thread function for DAC debug data streaming
@@ -676,31 +812,40 @@ static void* dac_debug_stream_thread(void* arg) {
   uint8_t board = stream_data->board;
   const char* file_path = stream_data->file_path;
   volatile bool* should_stop = stream_data->should_stop;
+  bool binary_mode = stream_data->binary_mode;
   bool verbose = *(ctx->verbose);
+  uint32_t read_buffer[256];
+  char line[256];
+  uint64_t samples_written = 0;
+
+  thread_trace_register("DAC debug", board);
+  rt_sched_thread_enter(RT_CLASS_FIFO_DATA, "DAC debug", board);
 
   if (verbose) {
-    printf("DAC Debug Stream Thread[%d]: Starting to write debug data to file '%s'\n",
-           board, file_path);
+    printf("DAC Debug Stream Thread[%d]: Starting to write %s debug data to file '%s'\n",
+           board, binary_mode ? "binary" : "ASCII", file_path);
   }
 
-  // Open file for writing (text mode for formatted output)
-  FILE* file = fopen(file_path, "w");
+  // Binary mode writes the raw debug words (decode offline with docs/debug_bin_decode.py)
+  FILE* file = fopen(file_path, binary_mode ? "wb" : "w");
   if (file == NULL) {
     fprintf(stderr, "DAC Debug Stream Thread[%d]: Failed to open file '%s' for writing: %s\n",
            board, file_path, strerror(errno));
     goto cleanup;
   }
 
-  // Add header to file
-  fprintf(file, "# DAC Debug Data Stream for Board %d\n", board);
-  fprintf(file, "# Format: [timestamp] DAC debug information\n");
-  fprintf(file, "# Generated by shim-test DAC debug streaming\n\n");
-
-  uint64_t samples_written = 0;
+  if (!binary_mode) {
+    fprintf(file, "# DAC Debug Data Stream for Board %d\n", board);
+    fprintf(file, "# Format: [timestamp] DAC debug information\n");
+    fprintf(file, "# Generated by shim-test DAC debug streaming\n\n");
+  }
 
   while (!(*should_stop)) {
+    rt_sched_loop_tick();
     // Check data FIFO status
+    uint64_t trace_t0 = thread_trace_begin();
     uint32_t data_status = sys_sts_get_dac_data_fifo_status(ctx->sys_sts, board, false);
+    thread_trace_end(TRACE_FIFO_STATUS, trace_t0, FIFO_STS_WORD_COUNT(data_status));
 
     if (FIFO_PRESENT(data_status) == 0) {
       fprintf(stderr, "DAC Debug Stream Thread[%d]: Data FIFO not present, stopping stream\n", board);
@@ -710,27 +855,41 @@ static void* dac_debug_stream_thread(void* arg) {
     uint32_t words_available = FIFO_STS_WORD_COUNT(data_status);
 
     if (words_available > 0) {
-      // Read and process available words
-      for (uint32_t i = 0; i < words_available; i++) {
-        uint32_t debug_word = dac_read_data(ctx->dac_ctrl, board);
-
-        // Format and write the debug data using our formatting function
-        fprintf(file, "[%llu] %s\n", samples_written, dac_format_data(debug_word, verbose));
-        samples_written++;
-
-        // Flush periodically to ensure data is written
-        if (samples_written % 100 == 0) {
-          fflush(file);
-        }
+      uint32_t words_to_read = words_available;
+      if (words_to_read > 256) {
+        words_to_read = 256;
+      }
 
-        // Check stop condition between reads
-        if (*should_stop) {
+      trace_t0 = thread_trace_begin();
+      for (uint32_t i = 0; i < words_to_read; i++) {
+        read_buffer[i] = dac_read_data(ctx->dac_ctrl, board);
+      }
+      thread_trace_end(TRACE_FIFO_BATCH, trace_t0, words_to_read);
+
+      trace_t0 = thread_trace_begin();
+      if (binary_mode) {
+        size_t written = fwrite(read_buffer, sizeof(uint32_t), words_to_read, file);
+        if (written != words_to_read) {
+          fprintf(stderr, "DAC Debug Stream Thread[%d]: Failed to write to file: %s\n",
+                 board, strerror(errno));
           break;
         }
+      } else {
+        // Decode into a local buffer so streams on several boards don't share formatting state
+        for (uint32_t i = 0; i < words_to_read; i++) {
+          dac_format_data_r(read_buffer[i], verbose, line, sizeof(line));
+          fprintf(file, "[%llu] %s\n", samples_written + i, line);
+        }
       }
+      fflush(file);
+      thread_trace_end(TRACE_FILE_WRITE, trace_t0, words_to_read);
+
+      samples_written += words_to_read;
     } else {
       // No data available, sleep briefly to avoid busy waiting
-      usleep(1000); // 1ms
+      trace_t0 = thread_trace_begin();
+      rt_sched_usleep(1000); // 1ms
+      thread_trace_end(TRACE_SLEEP, trace_t0, 1000);
     }
   }
 
@@ -763,6 +922,8 @@ void* dac_cmd_stream_thread(void* arg) {
   waveform_command_t* commands = stream_data->commands;
   int command_count = stream_data->command_count;
   int iterations = stream_data->iterations;
+  thread_trace_register("DAC cmd", board);
+  rt_sched_thread_enter(RT_CLASS_FIFO_CMD, "DAC cmd", board);
 
   if (*(ctx->verbose)) {
     printf("DAC Command Stream Thread[%d]: Started streaming from file '%s' (%d commands, %d iteration%s)\n",
@@ -779,8 +940,11 @@ void* dac_cmd_stream_thread(void* arg) {
 
     // Process all commands in the current iteration
     while (!(*should_stop) && cmd_index < command_count) {
+      rt_sched_loop_tick();
       // Check DAC command FIFO status
+      uint64_t trace_t0 = thread_trace_begin();
       uint32_t fifo_status = sys_sts_get_dac_cmd_fifo_status(ctx->sys_sts, board, false);
+      thread_trace_end(TRACE_FIFO_STATUS, trace_t0, FIFO_STS_WORD_COUNT(fifo_status));
 
       if (FIFO_PRESENT(fifo_status) == 0) {
         fprintf(stderr, "DAC Command Stream Thread[%d]: FIFO not present, stopping stream\n", board);
@@ -804,6 +968,7 @@ void* dac_cmd_stream_thread(void* arg) {
         bool is_trigger = (cmd->type == DAC_TRIGGER_CMD || cmd->type == DAC_NOOP_TRIGGER_CMD);
 
         // Send the command based on type
+        trace_t0 = thread_trace_begin();
         if (cmd->type == DAC_TRIGGER_CMD || cmd->type == DAC_DELAY_CMD) {
           // DAC_TRIGGER_CMD or DAC_DELAY_CMD with channel values
           dac_cmd_dac_wr(ctx->dac_ctrl, board, cmd->ch_vals, is_trigger ? DAC_TRIGGER_WAIT : DAC_DELAY_WAIT, cont_flag ? DAC_CONTINUE : DAC_NO_CONTINUE, DAC_LDAC, cmd->value, *(ctx->verbose));
@@ -811,6 +976,7 @@ void* dac_cmd_stream_thread(void* arg) {
           // DAC_NOOP_TRIGGER_CMD or DAC_NOOP_DELAY_CMD (noop commands)
           dac_cmd_noop(ctx->dac_ctrl, board, is_trigger ? DAC_TRIGGER_WAIT : DAC_DELAY_WAIT, cont_flag ? DAC_CONTINUE : DAC_NO_CONTINUE, DAC_NO_LDAC, cmd->value, *(ctx->verbose));
         }
+        thread_trace_end(TRACE_FIFO_BATCH, trace_t0, words_needed);
 
         commands_sent_this_iteration++;
         total_commands_sent++;
@@ -826,7 +992,9 @@ void* dac_cmd_stream_thread(void* arg) {
         }
       } else {
         // Not enough space in FIFO, sleep and try again
-        usleep(1000); // 1ms
+        trace_t0 = thread_trace_begin();
+        rt_sched_usleep(1000); // 1ms
+        thread_trace_end(TRACE_SLEEP, trace_t0, 1000);
       }
     }
 
@@ -856,7 +1024,7 @@ int cmd_stream_dac_commands_from_file(const char** args, int arg_count, const co
   // Parse board number
   int board = parse_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for stream_dac_from_file: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for stream_dac_from_file: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -876,6 +1044,10 @@ int cmd_stream_dac_commands_from_file(const char** args, int arg_count, const co
     printf("DAC command stream for board %d is already running.\n", board);
     return -1;
   }
+  if (dac_dma_busy(ctx->dac_dma, (uint8_t)board)) {
+    printf("DAC command DMA for board %d is running. Stop it with stop_dac_dma first.\n", board);
+    return -1;
+  }
 
   // Check DAC command FIFO presence
   if (FIFO_PRESENT(sys_sts_get_dac_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, *(ctx->verbose))) == 0) {
@@ -897,14 +1069,32 @@ int cmd_stream_dac_commands_from_file(const char** args, int arg_count, const co
   waveform_command_t* commands = NULL;
   int command_count = 0;
 
-  if (parse_waveform_file(full_path, &commands, &command_count) != 0) {
+  waveform_file_info_t info;
+  if (waveform_cache_get_dac(ctx, full_path, true, *(ctx->verbose), &commands, &info) != 0) {
     return -1; // Error already printed by parse_waveform_file
   }
+  command_count = info.command_count;
 
   if (*(ctx->verbose)) {
     printf("Parsed %d commands from waveform file '%s'\n", command_count, full_path);
   }
 
+  // Drop redundant writes before streaming (--simple streams the file exactly as written)
+  if (!has_flag(flags, flag_count, FLAG_SIMPLE)) {
+    waveform_opt_stats_t opt;
+    command_count = optimize_waveform_commands(commands, command_count, waveform_min_delay(ctx),
+                                               waveform_delay_writes_exact(ctx), &opt);
+    if (opt.words_after < opt.words_before) {
+      printf("Board %d waveform optimized: %d -> %d commands, %llu -> %llu FIFO words per pass (%.1f%% fewer; "
+             "%d unchanged writes sent as no-ops, %d delays merged)\n",
+             board, opt.commands_before, opt.commands_after, (unsigned long long)opt.words_before,
+             (unsigned long long)opt.words_after, 100.0 * (opt.words_before - opt.words_after) / opt.words_before,
+             opt.writes_removed, opt.delays_merged);
+    } else if (*(ctx->verbose)) {
+      printf("Board %d waveform has no redundant writes to optimize\n", board);
+    }
+  }
+
   // Validate trigger gaps to prevent FIFO underflow
   int words_since_last_trigger = 0;
   int max_gap = 0;
@@ -992,7 +1182,7 @@ int cmd_stop_dac_cmd_stream(const char** args, int arg_count, const command_flag
   // Parse board number
   int board = parse_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for stop_dac_cmd_stream: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for stop_dac_cmd_stream: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -1017,6 +1207,179 @@ int cmd_stop_dac_cmd_stream(const char** args, int arg_count, const command_flag
   return 0;
 }
 
+// Encode one waveform command into DAC command FIFO words. Returns the word count.
+static size_t encode_waveform_command(const waveform_command_t* cmd, bool cont, uint32_t* words) {
+  bool is_trigger = (cmd->type == DAC_TRIGGER_CMD || cmd->type == DAC_NOOP_TRIGGER_CMD);
+  dac_wait_mode_t trig = is_trigger ? DAC_TRIGGER_WAIT : DAC_DELAY_WAIT;
+  dac_continue_mode_t cont_mode = cont ? DAC_CONTINUE : DAC_NO_CONTINUE;
+  if (cmd->type == DAC_TRIGGER_CMD || cmd->type == DAC_DELAY_CMD) {
+    dac_encode_dac_wr(cmd->ch_vals, trig, cont_mode, DAC_LDAC, cmd->value, words);
+    return DAC_WR_WORDS;
+  }
+  words[0] = dac_encode_noop(trig, cont_mode, DAC_NO_LDAC, cmd->value);
+  return DAC_NOOP_WORDS;
+}
+
+// Load a waveform file into a board's DMA memory and start the DMA engine
+// The buffer holds one pass with every command continuing, then the last command again without the continue bit,
+// which the final pass ends on (the same continue flags the software stream sends)
+int cmd_dma_dac_commands_from_file(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  // Parse board number
+  int board = parse_board_number(args[0]);
+  if (board < 0) {
+    fprintf(stderr, "Invalid board number for dma_dac_commands_from_file: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
+    return -1;
+  }
+
+  // Parse optional iteration count (default is 1 - play once, 0 - loop until stopped)
+  uint32_t iterations = 1;
+  if (arg_count >= 3) {
+    char* endptr;
+    long value = parse_value(args[2], &endptr);
+    if (*endptr != '\0' || value < 0 || value > 0x7FFFFFFF) {
+      fprintf(stderr, "Invalid iteration count for dma_dac_commands_from_file: '%s'. Must be 0 (loop) or a positive integer.\n", args[2]);
+      return -1;
+    }
+    iterations = (uint32_t)value;
+  }
+
+  if (!dac_dma_available(ctx->dac_dma, (uint8_t)board)) {
+    printf("DAC command DMA for board %d is not available (is the DMA memory reserved?).\n", board);
+    return -1;
+  }
+  if (ctx->dac_cmd_stream_running[board]) {
+    printf("DAC command stream for board %d is running. Stop it with stop_dac_cmd_stream first.\n", board);
+    return -1;
+  }
+  if (dac_dma_busy(ctx->dac_dma, (uint8_t)board)) {
+    printf("DAC command DMA for board %d is already running.\n", board);
+    return -1;
+  }
+
+  // Check DAC command FIFO presence
+  if (FIFO_PRESENT(sys_sts_get_dac_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, *(ctx->verbose))) == 0) {
+    printf("DAC command FIFO for board %d is not present. Cannot start DMA.\n", board);
+    return -1;
+  }
+
+  // Resolve glob pattern if present, then clean and expand the path
+  char resolved_path[1024];
+  if (resolve_file_pattern(args[1], resolved_path, sizeof(resolved_path)) != 0) {
+    return -1;
+  }
+  char full_path[1024];
+  clean_and_expand_path(resolved_path, full_path, sizeof(full_path));
+
+  // Parse and validate the waveform file
+  waveform_command_t* commands = NULL;
+  waveform_file_info_t info;
+  if (waveform_cache_get_dac(ctx, full_path, true, *(ctx->verbose), &commands, &info) != 0) {
+    return -1; // Error already printed by parse_waveform_file
+  }
+  int command_count = info.command_count;
+  if (command_count == 0) {
+    fprintf(stderr, "Waveform file '%s' has no commands.\n", full_path);
+    free(commands);
+    return -1;
+  }
+
+  // Drop redundant writes (--simple keeps the file exactly as written)
+  if (!has_flag(flags, flag_count, FLAG_SIMPLE)) {
+    waveform_opt_stats_t opt;
+    command_count = optimize_waveform_commands(commands, command_count, waveform_min_delay(ctx),
+                                               waveform_delay_writes_exact(ctx), &opt);
+    if (opt.words_after < opt.words_before) {
+      printf("Board %d waveform optimized: %d -> %d commands, %llu -> %llu DMA words per pass (%.1f%% fewer)\n",
+             board, opt.commands_before, opt.commands_after, (unsigned long long)opt.words_before,
+             (unsigned long long)opt.words_after, 100.0 * (opt.words_before - opt.words_after) / opt.words_before);
+    }
+  }
+
+  // Size the buffer: one pass, then the final command without the continue bit
+  size_t pass_words = 0;
+  for (int i = 0; i < command_count; i++) {
+    pass_words += waveform_command_words(&commands[i]);
+  }
+  size_t tail_words = waveform_command_words(&commands[command_count - 1]);
+  if (pass_words + tail_words > DAC_DMA_DATA_WORDS) {
+    fprintf(stderr, "Waveform needs %zu DMA words; board %d's DMA buffer holds %u.\n",
+            pass_words + tail_words, board, DAC_DMA_DATA_WORDS);
+    free(commands);
+    return -1;
+  }
+
+  uint32_t* words = malloc((pass_words + tail_words) * sizeof(uint32_t));
+  if (words == NULL) {
+    fprintf(stderr, "Failed to allocate memory for DAC DMA words\n");
+    free(commands);
+    return -1;
+  }
+  size_t word_count = 0;
+  for (int i = 0; i < command_count; i++) {
+    word_count += encode_waveform_command(&commands[i], true, &words[word_count]);
+  }
+  word_count += encode_waveform_command(&commands[command_count - 1], false, &words[word_count]);
+  free(commands);
+
+  int result = dac_dma_load(ctx->dac_dma, (uint8_t)board, words, word_count);
+  free(words);
+  if (result != 0) return -1;
+  if (dac_dma_start(ctx->dac_dma, (uint8_t)board, pass_words, tail_words, iterations, *(ctx->verbose)) != 0) {
+    return -1;
+  }
+
+  if (iterations == 0) {
+    printf("Started DAC command DMA for board %d from '%s' (%d commands, %zu words per pass, looping until stop_dac_dma)\n",
+           board, full_path, command_count, pass_words);
+  } else {
+    printf("Started DAC command DMA for board %d from '%s' (%d commands, %zu words per pass, %u iteration%s)\n",
+           board, full_path, command_count, pass_words, iterations, iterations == 1 ? "" : "s");
+  }
+  return 0;
+}
+
+// Stop the DAC command DMA for a board, then clear its command buffer and cancel the command in progress
+int cmd_stop_dac_dma(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  int board = parse_board_number(args[0]);
+  if (board < 0) {
+    fprintf(stderr, "Invalid board number for stop_dac_dma: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
+    return -1;
+  }
+  if (!dac_dma_available(ctx->dac_dma, (uint8_t)board)) {
+    printf("DAC command DMA for board %d is not available.\n", board);
+    return -1;
+  }
+
+  dac_dma_stop(ctx->dac_dma, (uint8_t)board, *(ctx->verbose));
+
+  // The engine may have stopped partway through a command, so drop what it had queued
+  uint32_t cmd_reset_mask = 1U << (board * 2);
+  sys_ctrl_set_cmd_buf_reset(ctx->sys_ctrl, cmd_reset_mask, *(ctx->verbose));
+  sys_sts_hold_buf_reset(ctx->sys_sts, cmd_reset_mask, 0, SYS_STS_BUF_RESET_TIMEOUT_US, *(ctx->verbose));
+  sys_ctrl_set_cmd_buf_reset(ctx->sys_ctrl, 0, *(ctx->verbose));
+  usleep(SYS_STS_BUF_RESET_SETTLE_US);
+  dac_cmd_cancel(ctx->dac_ctrl, (uint8_t)board, *(ctx->verbose));
+
+  printf("DAC command DMA for board %d has been stopped.\n", board);
+  return 0;
+}
+
+// Show the DAC command DMA status for a board
+int cmd_dac_dma_sts(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  int board = parse_board_number(args[0]);
+  if (board < 0) {
+    fprintf(stderr, "Invalid board number for dac_dma_sts: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
+    return -1;
+  }
+  if (!dac_dma_available(ctx->dac_dma, (uint8_t)board)) {
+    printf("DAC command DMA for board %d is not available.\n", board);
+    return -1;
+  }
+
+  printf("DAC command DMA for board %d: %s\n", board, dac_dma_format_status(dac_dma_status(ctx->dac_dma, (uint8_t)board)));
+  return 0;
+}
+
 // DAC zero command - set all DAC channels to calibrated zero
 int cmd_dac_zero(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   // Validate system is running
@@ -1026,7 +1389,7 @@ int cmd_dac_zero(const char** args, int arg_count, const command_flag_t* flags,
 
   // Validate arguments - must have exactly 1 argument (board number or "all")
   if (arg_count != 1) {
-    printf("Error: dac_zero requires exactly one argument: board number (0-7) or 'all'\n");
+    printf("Error: dac_zero requires exactly one argument: board number (0-%d) or 'all'\n", SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -1034,7 +1397,7 @@ int cmd_dac_zero(const char** args, int arg_count, const command_flag_t* flags,
   bool skip_reset = has_flag(flags, flag_count, FLAG_NO_RESET);
 
   bool target_all = false;
-  bool target_boards[8] = {false};
+  bool target_boards[SHIM_MAX_BOARDS] = {false};
   int target_board = -1;
 
   // Parse the argument
@@ -1044,7 +1407,7 @@ int cmd_dac_zero(const char** args, int arg_count, const command_flag_t* flags,
   } else {
     target_board = validate_board_number(args[0]);
     if (target_board < 0) {
-      printf("Error: Invalid board number '%s'. Must be 0-7 or 'all'\n", args[0]);
+      printf("Error: Invalid board number '%s'. Must be 0-%d or 'all'\n", args[0], SHIM_MAX_BOARDS - 1);
       return -1;
     }
     target_boards[target_board] = true;
@@ -1052,14 +1415,14 @@ int cmd_dac_zero(const char** args, int arg_count, const command_flag_t* flags,
   }
 
   // Check which boards are connected and validate targets
-  bool connected_boards[8] = {false};
+  bool connected_boards[SHIM_MAX_BOARDS] = {false};
   int connected_count = 0;
 
   if (*(ctx->verbose)) {
     printf("Checking board connections...\n");
   }
 
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     // Check if DAC command stream is running for this board
     if (ctx->dac_cmd_stream_running[board]) {
       if (target_all || target_boards[board]) {
@@ -1096,17 +1459,28 @@ int cmd_dac_zero(const char** args, int arg_count, const command_flag_t* flags,
 
   printf("Found %d connected DAC board(s)\n", connected_count);
 
+  // Stop any DAC command DMA on the target boards, since its commands would interleave with the ones below.
+  // It may have stopped partway through a command, so those buffers are reset even with --no_reset.
+  uint32_t dma_reset_mask = 0;
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (connected_boards[board] && (target_all || target_boards[board]) && dac_dma_busy(ctx->dac_dma, (uint8_t)board)) {
+      printf("  Board %d: Stopping DAC command DMA\n", board);
+      dac_dma_stop(ctx->dac_dma, (uint8_t)board, *(ctx->verbose));
+      dma_reset_mask |= (1U << (board * 2));
+    }
+  }
+
   // Reset only DAC command buffers for connected target boards that have commands (unless --no_reset flag is used)
-  if (!skip_reset) {
+  if (!skip_reset || dma_reset_mask != 0) {
     if (*(ctx->verbose)) {
       printf("Resetting DAC command buffers for target boards with commands...\n");
     }
 
-    uint32_t cmd_reset_mask = 0;
+    uint32_t cmd_reset_mask = dma_reset_mask;
 
     // Check DAC command buffers for target boards and build reset mask
-    for (int board = 0; board < 8; board++) {
-      if (connected_boards[board] && (target_all || target_boards[board])) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+      if (!skip_reset && connected_boards[board] && (target_all || target_boards[board])) {
         uint32_t dac_cmd_fifo_status = sys_sts_get_dac_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, false);
         if (FIFO_PRESENT(dac_cmd_fifo_status) && FIFO_STS_WORD_COUNT(dac_cmd_fifo_status) > 0) {
           uint32_t dac_bit = board * 2;  // DAC command buffers: bits 0, 2, 4, 6, 8, 10, 12, 14
@@ -1127,14 +1501,15 @@ int cmd_dac_zero(const char** args, int arg_count, const command_flag_t* flags,
         printf("Setting DAC command buffer reset mask: 0x%05X\n", cmd_reset_mask);
       }
       sys_ctrl_set_cmd_buf_reset(ctx->sys_ctrl, cmd_reset_mask, *(ctx->verbose));
-      usleep(1000); // 1ms delay
+      // Hold reset for the minimum pulse width and until the selected buffers read empty
+      sys_sts_hold_buf_reset(ctx->sys_sts, cmd_reset_mask, 0, SYS_STS_BUF_RESET_TIMEOUT_US, *(ctx->verbose));
       sys_ctrl_set_cmd_buf_reset(ctx->sys_ctrl, 0, *(ctx->verbose));
+      usleep(SYS_STS_BUF_RESET_SETTLE_US);
     } else if (*(ctx->verbose)) {
       printf("No DAC command buffers need resetting\n");
     }
 
     __sync_synchronize(); // Memory barrier
-    usleep(10000); // 10ms delay
   } else {
     if (*(ctx->verbose)) {
       printf("Skipping buffer reset (--no_reset flag specified)\n");
@@ -1145,23 +1520,29 @@ int cmd_dac_zero(const char** args, int arg_count, const command_flag_t* flags,
   if (*(ctx->verbose)) {
     printf("Sending CANCEL commands to target boards...\n");
   }
-  for (int board = 0; board < 8; board++) {
+  uint32_t target_cmd_mask = 0;
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     if (connected_boards[board] && (target_all || target_boards[board])) {
       dac_cmd_cancel(ctx->dac_ctrl, (uint8_t)board, *(ctx->verbose));
+      target_cmd_mask |= (1U << (board * 2));
     }
   }
-  usleep(1000); // 1ms to let cancel commands complete
+  // Wait for the cancel commands to be consumed
+  sys_sts_wait_for_fifos_empty(ctx->sys_sts, target_cmd_mask, 0, SYS_STS_BUF_RESET_TIMEOUT_US, *(ctx->verbose));
 
   // Zero all channels on target boards using the new ZERO command
   int channels_zeroed = 0;
   int boards_zeroed = 0;
 
+  uint32_t cmds_before[SHIM_MAX_BOARDS] = {0};
+
   printf("Setting DAC channels to calibrated zero values...\n");
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     if (connected_boards[board] && (target_all || target_boards[board])) {
       // Send DAC ZERO command - sets all channels to their calibrated midrange values
+      cmds_before[board] = sys_sts_get_dac_cmds_since_reset(ctx->sys_sts, (uint8_t)board, false);
       dac_cmd_zero(ctx->dac_ctrl, (uint8_t)board, *(ctx->verbose));
-      channels_zeroed += 8; // 8 channels per board
+      channels_zeroed += SHIM_CHANNELS_PER_BOARD;
       boards_zeroed++;
 
       if (*(ctx->verbose)) {
@@ -1172,8 +1553,16 @@ int cmd_dac_zero(const char** args, int arg_count, const command_flag_t* flags,
     }
   }
 
-  // Brief pause to let the DAC commands complete
-  usleep(1000); // 1ms delay
+  // Wait for each board to execute its ZERO command (a saturated counter wraps the target to 0 and passes immediately)
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (connected_boards[board] && (target_all || target_boards[board])) {
+      if (sys_sts_wait_for_dac_cmds_since_reset(ctx->sys_sts, (uint8_t)board, cmds_before[board] + 1,
+                                                SYS_STS_BUF_RESET_TIMEOUT_US, *(ctx->verbose)) != 0) {
+        fprintf(stderr, "Board %d did not confirm the ZERO command.\n", board);
+        return -1;
+      }
+    }
+  }
 
   printf("Successfully zeroed %d DAC channels on %d board(s) using calibrated zero values\n",
          channels_zeroed, boards_zeroed);
@@ -1186,7 +1575,7 @@ int cmd_stream_dac_debug(const char** args, int arg_count, const command_flag_t*
   // Parse board number
   int board = parse_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for stream_dac_debug: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for stream_dac_debug: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -1227,6 +1616,7 @@ int cmd_stream_dac_debug(const char** args, int arg_count, const command_flag_t*
   stream_data->board = (uint8_t)board;
   snprintf(stream_data->file_path, sizeof(stream_data->file_path), "%s", full_path);
   stream_data->should_stop = &(ctx->dac_debug_stream_stop[board]);
+  stream_data->binary_mode = has_flag(flags, flag_count, FLAG_BIN);
 
   // Initialize stop flag and mark stream as running
   ctx->dac_debug_stream_stop[board] = false;
@@ -1240,7 +1630,8 @@ int cmd_stream_dac_debug(const char** args, int arg_count, const command_flag_t*
     return -1;
   }
 
-  printf("Started DAC debug streaming for board %d to file '%s'\n", board, full_path);
+  printf("Started DAC debug streaming for board %d to file '%s'%s\n", board, full_path,
+         stream_data->binary_mode ? " (binary)" : "");
   return 0;
 }
 
@@ -1248,7 +1639,7 @@ int cmd_stop_dac_debug_stream(const char** args, int arg_count, const command_fl
   // Parse board number
   int board = parse_board_number(args[0]);
   if (board < 0) {
-    fprintf(stderr, "Invalid board number for stop_dac_debug_stream: '%s'. Must be 0-7.\n", args[0]);
+    fprintf(stderr, "Invalid board number for stop_dac_debug_stream: '%s'. Must be 0-%d.\n", args[0], SHIM_MAX_BOARDS - 1);
     return -1;
   }
 
@@ -24,10 +24,13 @@
 #include "adc_ctrl.h"
 #include "map_memory.h"
 #include "trigger_ctrl.h"
+#include "thread_trace.h"
+#include "rt_sched.h"
+#include "timing.h"
+#include "waveform_cache.h"
 
 // Forward declarations for helper functions
 static int validate_system_running(command_context_t* ctx);
-static int count_trigger_lines_in_file(const char* file_path);
 
 // Linearity status for channel calibration
 typedef enum {
@@ -56,73 +59,35 @@ static int validate_system_running(command_context_t* ctx) {
   return 0;
 }
 
-// Helper function to count trigger lines in a DAC/ADC file
-// (sum trigger counts from T and NT lines, formatted similarly enough in both files to be fine)
-static int count_trigger_lines_in_file(const char* file_path) {
-  FILE* file = fopen(file_path, "r");
-  if (file == NULL) {
-    fprintf(stderr, "Failed to open DAC/ADC file '%s': %s\n", file_path, strerror(errno));
-    return -1;
-  }
-
-  char line[512];
-  int trigger_count = 0;
-
-  while (fgets(line, sizeof(line), file)) {
-    // Skip empty lines and comments
-    char* trimmed = line;
-    while (*trimmed == ' ' || *trimmed == '\t') trimmed++;
-    if (*trimmed == '\n' || *trimmed == '\r' || *trimmed == '\0' || *trimmed == '#') {
-      continue;
-    }
-
-    // Check if line starts with T (trigger) or NT (noop-trigger)
-    if (*trimmed == 'T' || (trimmed[0] == 'N' && trimmed[1] == 'T')) {
-      int t_count = 1;
-      // For NT, skip past 'NT', for T, skip past 'T'
-      const char* count_str = (trimmed[0] == 'N' && trimmed[1] == 'T') ? (trimmed + 2) : (trimmed + 1);
-      // Try to parse the trigger count after 'T' or 'NT'
-      if (sscanf(count_str, " %d", &t_count) == 1 && t_count > 0) {
-        trigger_count += t_count;
-      } else {
-        trigger_count += 1;
-      }
-    }
-  }
-
-  fclose(file);
-  return trigger_count;
-}
-
 // Checks if a file exists
 static bool file_exists(const char* filename) {
   struct stat buffer;
   return (stat(filename, &buffer) == 0);
 }
 
-// If the filename ends with _bdX.wfm (where "X" is 0-7), check for the same filename but replacing X with X+1
+// If the filename ends with _bdX.wfm (where "X" is a board number), check for the same filename but replacing X with X+1
 // If it exists, return it in out_filename, otherwise copy the original filename to out_filename
 static void get_next_bd_wfm_if_exists(const char* filename, char* out_filename) {
   // Copy original filename to output first
   strcpy(out_filename, filename);
 
-  // Check if filename matches the pattern _bdX.wfm where X is 0-7
+  // Check if filename matches the pattern _bdX.wfm where X is a board number
   const char* bd_pattern = "_bd";
   char* bd_pos = strstr(filename, bd_pattern);
 
   // If we found "_bd" in the filename
   if (bd_pos != NULL) {
-    // Check if it's followed by a digit 0-7 and then ".wfm"
+    // Check if it's followed by a board number and then ".wfm"
     char* digit_pos = bd_pos + strlen(bd_pattern);
-    if (*digit_pos >= '0' && *digit_pos <= '7') {
-      char* wfm_pos = digit_pos + 1;
-      if (strcmp(wfm_pos, ".wfm") == 0) {
-        // Found pattern _bdX.wfm where X is 0-7
-        int current_bd = *digit_pos - '0';
-        int next_bd = current_bd + 1;
-
-        // Only check for next file if current is 0-6 (next would be 1-7)
-        if (next_bd <= 7) {
+    if (*digit_pos >= '0' && *digit_pos <= '9') {
+      char* wfm_pos;
+      long current_bd = strtol(digit_pos, &wfm_pos, 10);
+      if (strcmp(wfm_pos, ".wfm") == 0 && current_bd < SHIM_MAX_BOARDS) {
+        // Found pattern _bdX.wfm
+        int next_bd = (int)current_bd + 1;
+
+        // Only check for next file if there is a next board
+        if (next_bd < SHIM_MAX_BOARDS) {
           // Build the next filename by replacing X with X+1
           char next_filename[1024];
           size_t prefix_len = bd_pos + strlen(bd_pattern) - filename;
@@ -212,7 +177,6 @@ int cmd_channel_test(const char** args, int arg_count, const command_flag_t* fla
     }
     safe_buffer_reset(ctx, *(ctx->verbose));
     __sync_synchronize(); // Memory barrier
-    usleep(10000); // 10ms delay
     if (*(ctx->verbose)) {
       printf("  Buffer resets completed\n");
       fflush(stdout);
@@ -296,17 +260,13 @@ int cmd_channel_test(const char** args, int arg_count, const command_flag_t* fla
   }
   __sync_synchronize(); // Memory barrier
 
-  uint16_t raw_adc_value = (uint16_t)(adc_read_word(ctx->adc_ctrl, (uint8_t)board) & 0xFFFF);
-  int16_t adc_value = (raw_adc_value <= 32767) ? (int16_t)raw_adc_value : (int16_t)(raw_adc_value - 65536);
+  int16_t adc_value = adc_word_sample_lo(adc_read_word(ctx->adc_ctrl, (uint8_t)board));
 
   // Apply ADC bias correction if available
-  int ch = atoi(args[0]); // Get the global channel number (0-63)
-  double adc_reading_corrected = (double)adc_value;
-  if (ctx->adc_bias_valid[ch]) {
-    adc_reading_corrected -= ctx->adc_bias[ch];
-  }
-  // Simple rounding without math library: add 0.5 and truncate
-  int16_t adc_reading = (int16_t)(adc_reading_corrected + (adc_reading_corrected >= 0 ? 0.5 : -0.5));
+  int ch = atoi(args[0]); // Get the global channel number
+  adc_convert_t adc_conv;
+  load_adc_convert(ctx, &adc_conv);
+  int16_t adc_reading = adc_convert_sample(&adc_conv, ch, adc_value);
 
   // Calculate and print error
   if (*(ctx->verbose)) {
@@ -337,25 +297,26 @@ int cmd_channel_test(const char** args, int arg_count, const command_flag_t* fla
 
 // Channel calibration command implementation
 int cmd_channel_cal(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
-  // Parse arguments - either a channel number (0-63) or "all"
+  // Parse arguments - either a channel number or "all"
   bool calibrate_all = (strcmp(args[0], "all") == 0);
   int start_ch = 0, end_ch = 0;
-  bool connected_boards[8] = {false}; // Track which boards are connected
+  bool connected_boards[SHIM_MAX_BOARDS] = {false}; // Track which boards are connected
 
   if (arg_count != 1) {
-    fprintf(stderr, "Usage: channel_cal <channel|all> [--no_reset] (channel 0-63, board=ch/8, ch=ch%%8)\n");
+    fprintf(stderr, "Usage: channel_cal <channel|all> [--no_reset] (channel 0-%d, board=ch/8, ch=ch%%8)\n",
+            SHIM_MAX_CHANNELS - 1);
     return -1;
   }
 
   if (calibrate_all) {
     start_ch = 0;
-    end_ch = 63;
+    end_ch = SHIM_MAX_CHANNELS - 1;
 
     // Check which boards are connected by checking FIFOs
     int connected_count = 0;
     printf("Checking connected boards...\n");
 
-    for (int board = 0; board < 8; board++) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       uint32_t adc_data_fifo_status = sys_sts_get_adc_data_fifo_status(ctx->sys_sts, (uint8_t)board, false);
       uint32_t dac_cmd_fifo_status = sys_sts_get_dac_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, false);
       uint32_t adc_cmd_fifo_status = sys_sts_get_adc_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, false);
@@ -417,13 +378,12 @@ int cmd_channel_cal(const char** args, int arg_count, const command_flag_t* flag
   if (!skip_reset) {
     printf("Resetting all buffers...\n");
     safe_buffer_reset(ctx, false);
-    usleep(10000); // 10ms
   }
 
   // Send cancel commands once per connected board
   if (calibrate_all) {
     printf("Sending cancel commands to connected boards...\n");
-    for (int board = 0; board < 8; board++) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       if (connected_boards[board]) {
         dac_cmd_cancel(ctx->dac_ctrl, (uint8_t)board, false);
         adc_cmd_cancel(ctx->adc_ctrl, (uint8_t)board, false);
@@ -431,7 +391,7 @@ int cmd_channel_cal(const char** args, int arg_count, const command_flag_t* flag
     }
   } else {
     // For single channel, send cancel to its board
-    int board = start_ch / 8;
+    int board = start_ch / SHIM_CHANNELS_PER_BOARD;
     printf("Sending cancel commands to board %d...\n", board);
     dac_cmd_cancel(ctx->dac_ctrl, (uint8_t)board, false);
     adc_cmd_cancel(ctx->adc_ctrl, (uint8_t)board, false);
@@ -446,12 +406,16 @@ int cmd_channel_cal(const char** args, int arg_count, const command_flag_t* flag
   const int calibration_iterations = 4;
   const int delay_ms = 0.3; // 0.3 ms delay
 
+  // ADC bias correction for the readings
+  adc_convert_t adc_conv;
+  load_adc_convert(ctx, &adc_conv);
+
   // Iterate through all channels to calibrate
   for (int ch = start_ch; ch <= end_ch; ch++) {
     int board, channel;
     int16_t current_cal_value = 0;
-    board = ch / 8;
-    channel = ch % 8;
+    board = ch / SHIM_CHANNELS_PER_BOARD;
+    channel = ch % SHIM_CHANNELS_PER_BOARD;
 
     // If calibrating all channels, skip boards that are not connected
     if (calibrate_all && !connected_boards[board]) {
@@ -515,14 +479,10 @@ int cmd_channel_cal(const char** args, int arg_count, const command_flag_t* flag
           }
 
           uint32_t adc_word = adc_read_word(ctx->adc_ctrl, (uint8_t)board);
-          uint16_t adc_raw = (uint16_t)(adc_word & 0xFFFF);
-          int16_t adc_reading = (adc_raw <= 32767) ? (int16_t)adc_raw : (int16_t)(adc_raw - 65536);
-          double adc_value = (double)adc_reading;
+          int16_t adc_reading = adc_word_sample_lo(adc_word);
 
           // Subtract ADC bias if available
-          if (ctx->adc_bias_valid[ch]) {
-            adc_value -= ctx->adc_bias[ch];
-          }
+          double adc_value = adc_convert_counts(&adc_conv, ch, adc_reading);
 
           if (*(ctx->verbose) && avg < 3) {  // Only show first few readings to avoid spam
             printf("      Sample %d: ADC raw=0x%08X, signed=%d, bias_corrected=%.1f\n",
@@ -754,15 +714,14 @@ int cmd_waveform_test(const char** args, int arg_count, const command_flag_t* fl
   } else {
     printf("Resetting all buffers\n");
     safe_buffer_reset(ctx, *(ctx->verbose));
-    usleep(10000); // 10ms
   }
 
   // Check which boards are connected
-  bool connected_boards[8] = {false}; // Track which boards are connected
+  bool connected_boards[SHIM_MAX_BOARDS] = {false}; // Track which boards are connected
   int connected_count = 0;
   printf("Checking connected boards...\n");
 
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     uint32_t dac_cmd_fifo_status = sys_sts_get_dac_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, false);
     uint32_t dac_data_fifo_status = sys_sts_get_dac_data_fifo_status(ctx->sys_sts, (uint8_t)board, false);
     uint32_t adc_cmd_fifo_status = sys_sts_get_adc_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, false);
@@ -789,14 +748,14 @@ int cmd_waveform_test(const char** args, int arg_count, const command_flag_t* fl
   printf("Found %d connected board(s)\n", connected_count);
 
   // Prompt for DAC and ADC command files for each connected board
-  char resolved_dac_files[8][1024] = {0};  // Resolved DAC file paths
-  char resolved_adc_files[8][1024] = {0};  // Resolved ADC file paths
+  char resolved_dac_files[SHIM_MAX_BOARDS][1024] = {0};  // Resolved DAC file paths
+  char resolved_adc_files[SHIM_MAX_BOARDS][1024] = {0};  // Resolved ADC file paths
 
   char previous_dac_file[1024] = "";
   char default_dac_file[1024] = "";
   char previous_adc_file[1024] = "";
 
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     if (!connected_boards[board]) continue;
 
     printf("\nBoard %d configuration:\n", board);
@@ -836,14 +795,14 @@ int cmd_waveform_test(const char** args, int arg_count, const command_flag_t* fl
   }
 
   // Prompt for DAC and ADC iteration counts for each connected board
-  int dac_iterations[8] = {0};  // DAC iteration counts for each board
-  int adc_iterations[8] = {0};  // ADC iteration counts for each board
+  int dac_iterations[SHIM_MAX_BOARDS] = {0};  // DAC iteration counts for each board
+  int adc_iterations[SHIM_MAX_BOARDS] = {0};  // ADC iteration counts for each board
 
   int previous_dac_iterations = 0;
   int previous_adc_iterations = 0;
 
   printf("\nIteration count configuration:\n");
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     if (!connected_boards[board]) continue;
 
     // Prompt for DAC iterations with default handling
@@ -990,9 +949,44 @@ int cmd_waveform_test(const char** args, int arg_count, const command_flag_t* fl
   printf("Calculated lockout: %u cycles (%.3f ms at %.3f MHz)\n",
          lockout_time, lockout_ms, spi_freq_mhz);
 
+  // Pre-flight timing check of every board's files before anything is launched. All boards' files are parsed
+  // at once, one thread per file; the trigger and word counts below and the stream commands reuse the cached result.
+  printf("\nValidating command file timing...\n");
+  waveform_cache_load_t loads[2 * SHIM_MAX_BOARDS];
+  int load_count = 0;
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (!connected_boards[board]) continue;
+    loads[load_count++] = (waveform_cache_load_t){.path = resolved_dac_files[board], .is_adc = false, .check_timing = true};
+    loads[load_count++] = (waveform_cache_load_t){.path = resolved_adc_files[board], .is_adc = true, .check_timing = true};
+  }
+  waveform_cache_load_parallel(ctx, loads, load_count);
+
+  // Report in board order once everything is parsed
+  waveform_file_info_t dac_info[SHIM_MAX_BOARDS] = {0};
+  waveform_file_info_t adc_info[SHIM_MAX_BOARDS] = {0};
+  int load_index = 0;
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (!connected_boards[board]) continue;
+    for (int i = 0; i < 2; i++) {
+      waveform_cache_load_t* load = &loads[load_index++];
+      if (load->result != 0) {
+        fprintf(stderr, "Board %d %s file failed validation\n", board, load->is_adc ? "ADC" : "DAC");
+        return -1;
+      }
+      const command_file_timing_t* t = &load->info.timing;
+      print_file_timing(load->is_adc ? "ADC command" : "Waveform", load->path, t->min_delay, t->shortest_delay,
+                        t->trigger_spacing, t->clk_freq_hz);
+      if (load->is_adc) {
+        adc_info[board] = load->info;
+      } else {
+        dac_info[board] = load->info;
+      }
+    }
+  }
+
   // Calculate expected ADC words and triggers for each connected board
-  uint64_t adc_word_counts[8] = {0};  // Expected ADC words per board
-  uint32_t board_triggers[8] = {0};  // Triggers per board
+  uint64_t adc_word_counts[SHIM_MAX_BOARDS] = {0};  // Expected ADC words per board
+  uint32_t board_triggers[SHIM_MAX_BOARDS] = {0};  // Triggers per board
   uint32_t total_expected_triggers = 0;
 
   if (*(ctx->verbose)) {
@@ -1001,20 +995,12 @@ int cmd_waveform_test(const char** args, int arg_count, const command_flag_t* fl
 
   // First pass: calculate triggers for each board and validate consistency
   int reference_trigger_count = -1;
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     if (!connected_boards[board]) continue;
 
-    // Count trigger lines in DAC file
-    int dac_trigger_count = count_trigger_lines_in_file(resolved_dac_files[board]);
-    if (dac_trigger_count < 0) {
-      return -1;
-    }
-
-    // Count trigger lines in ADC file
-    int adc_trigger_count = count_trigger_lines_in_file(resolved_adc_files[board]);
-    if (adc_trigger_count < 0) {
-      return -1;
-    }
+    // Trigger counts per pass through the DAC and ADC files
+    int dac_trigger_count = dac_info[board].trigger_count;
+    int adc_trigger_count = adc_info[board].trigger_count;
 
     // Calculate total triggers for this board
     uint32_t dac_total_triggers = dac_trigger_count * dac_iterations[board];
@@ -1045,11 +1031,11 @@ int cmd_waveform_test(const char** args, int arg_count, const command_flag_t* fl
   }
 
   // Second pass: calculate ADC word counts now that triggers are validated
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     if (!connected_boards[board]) continue;
 
     // Calculate expected number of ADC words from ADC command file using board-specific ADC iterations
-    adc_word_counts[board] = calculate_expected_adc_words(resolved_adc_files[board], adc_iterations[board], *(ctx->verbose));
+    adc_word_counts[board] = adc_info[board].adc_words_per_pass * adc_iterations[board];
 
     total_expected_triggers = board_triggers[board]; // All boards have same count
 
@@ -1096,7 +1082,7 @@ int cmd_waveform_test(const char** args, int arg_count, const command_flag_t* fl
 
   // Add buffer stoppers (NOOP commands waiting for 1 trigger) to all buffers BEFORE starting streams
   printf("Adding buffer stoppers before starting streams...\n");
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     if (!connected_boards[board]) continue;
 
     if (*(ctx->verbose)) {
@@ -1114,7 +1100,7 @@ int cmd_waveform_test(const char** args, int arg_count, const command_flag_t* fl
   if (*(ctx->verbose)) {
     printf("\nStarting command streaming for %d connected boards...\n", connected_count);
   }
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     if (!connected_boards[board]) continue;
 
     char board_str[16], dac_iterations_str[16], adc_iterations_str[16];
@@ -1149,7 +1135,7 @@ int cmd_waveform_test(const char** args, int arg_count, const command_flag_t* fl
   if (*(ctx->verbose)) {
     printf("Starting ADC data streaming for %d connected boards...\n", connected_count);
   }
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     if (!connected_boards[board]) continue;
 
     // Create board-specific output file name
@@ -1165,16 +1151,18 @@ int cmd_waveform_test(const char** args, int arg_count, const command_flag_t* fl
       snprintf(board_output_file, sizeof(board_output_file), "%s_bd_%d", base_output_file, board);
     }
 
-    char board_str[16], word_count_str[32];
+    char board_str[16], word_count_str[32], adc_iterations_str[16];
     snprintf(board_str, sizeof(board_str), "%d", board);
     snprintf(word_count_str, sizeof(word_count_str), "%llu", adc_word_counts[board]);
+    snprintf(adc_iterations_str, sizeof(adc_iterations_str), "%d", adc_iterations[board]);
 
     if (*(ctx->verbose)) {
       printf("  Board %d: Starting ADC data streaming to '%s' (%llu ADC words)\n",
              board, board_output_file, adc_word_counts[board]);
     }
-    const char* adc_data_args[] = {board_str, word_count_str, board_output_file};
-    if (cmd_stream_adc_data_to_file(adc_data_args, 3, NULL, 0, ctx) != 0) {
+    // Pass the ADC command file so the stream also writes a trigger index
+    const char* adc_data_args[] = {board_str, word_count_str, board_output_file, resolved_adc_files[board], adc_iterations_str};
+    if (cmd_stream_adc_data_to_file(adc_data_args, 5, NULL, 0, ctx) != 0) {
       fprintf(stderr, "Failed to start ADC data streaming for board %d\n", board);
       return -1;
     }
@@ -1218,7 +1206,7 @@ int cmd_waveform_test(const char** args, int arg_count, const command_flag_t* fl
   while (!buffers_ready && check_count < max_checks) {
     buffers_ready = true;
 
-    for (int board = 0; board < 8; board++) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       if (!connected_boards[board]) continue;
 
       // Check DAC command buffer
@@ -1255,7 +1243,7 @@ int cmd_waveform_test(const char** args, int arg_count, const command_flag_t* fl
   if (check_count >= max_checks) {
     printf("Warning: Timeout waiting for buffer preload!\n");
     printf("Current buffer status:\n");
-    for (int board = 0; board < 8; board++) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       if (!connected_boards[board]) continue;
 
       if (ctx->dac_cmd_stream_running[board]) {
@@ -1301,8 +1289,9 @@ int cmd_waveform_test(const char** args, int arg_count, const command_flag_t* fl
   trigger_cmd_sync_ch(ctx->trigger_ctrl, false, *(ctx->verbose));
 
   // Reset trigger count after sync_ch to start counting from 0
+  // Log deltas (one FIFO word per trigger); the trigger stream writes them back out as absolute times
   printf("Resetting trigger count after sync\n");
-  trigger_cmd_reset_count(ctx->trigger_ctrl, *(ctx->verbose));
+  trigger_cmd_reset_count(ctx->trigger_ctrl, true, *(ctx->verbose));
 
   // Set trigger lockout
   printf("Setting trigger lockout time to %u cycles\n", lockout_time);
@@ -1332,7 +1321,7 @@ int cmd_waveform_test(const char** args, int arg_count, const command_flag_t* fl
     // Print connected boards list once
     printf("Connected boards: ");
     bool first = true;
-    for (int board = 0; board < 8; board++) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       if (!connected_boards[board]) continue;
       if (!first) printf(", ");
       printf("%d", board);
@@ -1352,7 +1341,7 @@ int cmd_waveform_test(const char** args, int arg_count, const command_flag_t* fl
     printf("  - 'trig_count' to manually check trigger count\n");
 
     printf("Expected data collection:\n");
-    for (int board = 0; board < 8; board++) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       if (!connected_boards[board]) continue;
       printf("  - Board %d: %llu ADC words\n", board, adc_word_counts[board]);
     }
@@ -1393,7 +1382,7 @@ int cmd_stop_waveform(const char** args, int arg_count, const command_flag_t* fl
   }
 
   // Stop all board streaming (DAC command, ADC command, ADC data)
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     // Stop DAC command streaming
     if (ctx->dac_cmd_stream_running[board]) {
       printf("  Stopping DAC command stream for board %d\n", board);
@@ -1447,7 +1436,7 @@ typedef struct {
   uint32_t delay_cycles;
   double spi_freq_mhz;
   const char* log_file;
-  bool connected_boards[8];
+  bool connected_boards[SHIM_MAX_BOARDS];
   bool verbose;
   volatile bool* should_stop;
 } fieldmap_params_t;
@@ -1464,6 +1453,12 @@ static void* fieldmap_thread(void* arg) {
   volatile bool* should_stop = params->should_stop;
   double spi_freq_mhz = params->spi_freq_mhz;
   bool verbose = params->verbose;
+  thread_trace_register("Fieldmap", -1);
+  rt_sched_thread_enter(RT_CLASS_EXPERIMENT, "Fieldmap", -1);
+
+  // ADC bias correction and scaling, fixed for the duration of the fieldmap
+  adc_convert_t adc_conv;
+  load_adc_convert(ctx, &adc_conv);
 
   // Open log file
   FILE* file = fopen(log_file, "w");
@@ -1476,10 +1471,10 @@ static void* fieldmap_thread(void* arg) {
   fprintf(file, "# ADC Delay: %.3f ms (%" PRIu32 " clock cycles at %.3f MHz SPI frequency)\n",
           params->delay_ms, params->delay_cycles, spi_freq_mhz);
   fprintf(file, "time_sec,channel,polarity");
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     if (!connected_boards[board]) continue;
-    for (int ch_offset = 0; ch_offset < 8; ch_offset++) {
-      int ch = board * 8 + ch_offset;
+    for (int ch_offset = 0; ch_offset < SHIM_CHANNELS_PER_BOARD; ch_offset++) {
+      int ch = board * SHIM_CHANNELS_PER_BOARD + ch_offset;
       fprintf(file, ",ch%02d", ch);
     }
   }
@@ -1495,7 +1490,7 @@ static void* fieldmap_thread(void* arg) {
   if (verbose) {
     printf("Fieldmap Thread [VERBOSE]: Channels %d-%d, verbose mode enabled\n", start_ch, end_ch);
     printf("Fieldmap Thread [VERBOSE]: Connected boards: ");
-    for (int i = 0; i < 8; i++) {
+    for (int i = 0; i < SHIM_MAX_BOARDS; i++) {
       if (connected_boards[i]) printf("%d ", i);
     }
     printf("\n");
@@ -1506,11 +1501,13 @@ static void* fieldmap_thread(void* arg) {
   time_t last_status_check_time = time(NULL);
 
   while (samples_collected < total_samples_expected && !(*should_stop)) {
-    int current_board = current_channel / 8;
+    rt_sched_loop_tick();
+    int current_board = current_channel / SHIM_CHANNELS_PER_BOARD;
     time_t current_time = time(NULL);
 
     // Check if all connected boards have data available (4 words each) and trigger has 2 words
     bool all_data_ready = true;
+    uint64_t trace_t0 = thread_trace_begin();
     uint32_t trig_status = sys_sts_get_trig_data_fifo_status(ctx->sys_sts, false);
 
     // Periodic system status check and verbose logging (once every 5 seconds)
@@ -1537,7 +1534,7 @@ static void* fieldmap_thread(void* arg) {
                  samples_collected + 1, total_samples_expected, current_channel, polarity_char);
 
         // Show status for all connected boards
-        for (int board = 0; board < 8; board++) {
+        for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
           if (!connected_boards[board]) continue;
           uint32_t adc_status = sys_sts_get_adc_data_fifo_status(ctx->sys_sts, (uint8_t)board, false);
           printf("Fieldmap Thread [VERBOSE]: Board %d ADC FIFO status=0x%08X (count=%u)\n",
@@ -1551,7 +1548,7 @@ static void* fieldmap_thread(void* arg) {
     }
 
     // Check that all connected boards have 4 words available and trigger has 2 words
-    for (int board = 0; board < 8; board++) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       if (!connected_boards[board]) continue;
       uint32_t adc_status = sys_sts_get_adc_data_fifo_status(ctx->sys_sts, (uint8_t)board, false);
       if (FIFO_STS_WORD_COUNT(adc_status) < 4) {
@@ -1559,6 +1556,7 @@ static void* fieldmap_thread(void* arg) {
         break;
       }
     }
+    thread_trace_end(TRACE_FIFO_STATUS, trace_t0, FIFO_STS_WORD_COUNT(trig_status));
 
     if (all_data_ready && FIFO_STS_WORD_COUNT(trig_status) >= 2) {
       char polarity_char = (step == FIELDMAP_POSITIVE) ? '+' : (step == FIELDMAP_NEGATIVE) ? '-' : '0';
@@ -1568,52 +1566,27 @@ static void* fieldmap_thread(void* arg) {
       }
 
       // Read ADC data from all connected boards (4 words each)
-      int16_t channel_data[64]; // Store data for all 64 channels (8 boards x 8 channels)
-      bool channel_valid[64] = {false}; // Track which channels have valid data
+      float channel_amps[SHIM_MAX_CHANNELS]; // Bias-corrected current for every channel
+      bool channel_valid[SHIM_MAX_CHANNELS] = {false}; // Track which channels have valid data
 
-      for (int board = 0; board < 8; board++) {
+      trace_t0 = thread_trace_begin();
+      uint32_t words_read = 2;
+      for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
         if (!connected_boards[board]) continue;
 
-        // Read 4 words from this board (ADC pair data)
-        for (int word = 0; word < 4; word++) {
-          uint32_t adc_word = adc_read_word(ctx->adc_ctrl, (uint8_t)board);
-
-          // Each word contains 2 channels (lower 16 bits = even channel, upper 16 bits = odd channel)
-          int ch_base = board * 8 + word * 2;
-          uint16_t ch_even_raw = (uint16_t)(adc_word & 0xFFFF);
-          int16_t ch_even = (ch_even_raw <= 32767) ? (int16_t)ch_even_raw : (int16_t)(ch_even_raw - 65536);
-          uint16_t ch_odd_raw = (uint16_t)((adc_word >> 16) & 0xFFFF);
-          int16_t ch_odd = (ch_odd_raw <= 32767) ? (int16_t)ch_odd_raw : (int16_t)(ch_odd_raw - 65536);
-
-          // Apply bias correction for even channel
-          if (ch_base < 64 && ctx->adc_bias_valid[ch_base]) {
-            double corrected = (double)ch_even - ctx->adc_bias[ch_base];
-            corrected = (corrected + (corrected >= 0 ? 0.5 : -0.5)); // Round to nearest integer
-            corrected = (corrected > 32767) ? 32767 : (corrected < -32768) ? -32768 : corrected; // Clamp to int16 range
-            ch_even = (int16_t) corrected;
-          }
-
-          // Apply bias correction for odd channel
-          if (ch_base + 1 < 64 && ctx->adc_bias_valid[ch_base + 1]) {
-            double corrected = (double)ch_odd - ctx->adc_bias[ch_base + 1];
-            corrected = (corrected + (corrected >= 0 ? 0.5 : -0.5)); // Round to nearest integer
-            corrected = (corrected > 32767) ? 32767 : (corrected < -32768) ? -32768 : corrected; // Clamp to int16 range
-            ch_odd = (int16_t) corrected;
-          }
-
-          if (ch_base < 64) {
-            channel_data[ch_base] = ch_even;
-            channel_valid[ch_base] = true;
-          }
-          if (ch_base + 1 < 64) {
-            channel_data[ch_base + 1] = ch_odd;
-            channel_valid[ch_base + 1] = true;
-          }
+        // Read one 8-channel frame (4 words, 2 channels each) and convert it in one pass
+        uint32_t frame[ADC_CONVERT_FRAME_WORDS];
+        adc_read_words(ctx->adc_ctrl, (uint8_t)board, frame, ADC_CONVERT_FRAME_WORDS);
+        words_read += ADC_CONVERT_FRAME_WORDS;
+        adc_convert_frame_amps(&adc_conv, board * SHIM_CHANNELS_PER_BOARD, frame, &channel_amps[board * SHIM_CHANNELS_PER_BOARD]);
+        for (int ch_offset = 0; ch_offset < SHIM_CHANNELS_PER_BOARD; ch_offset++) {
+          channel_valid[board * SHIM_CHANNELS_PER_BOARD + ch_offset] = true;
         }
       }
 
       // Read trigger data (64-bit)
       uint64_t trigger_data = trigger_read(ctx->trigger_ctrl);
+      thread_trace_end(TRACE_FIFO_BATCH, trace_t0, words_read);
       double time_seconds = (double)trigger_data / (spi_freq_mhz * 1e6);
 
       if (verbose) {
@@ -1622,13 +1595,14 @@ static void* fieldmap_thread(void* arg) {
       }
 
       // Write to CSV file - connected channels only
+      trace_t0 = thread_trace_begin();
       fprintf(file, "%.4f,ch%02d,%c", time_seconds, current_channel, polarity_char);
-      for (int board = 0; board < 8; board++) {
+      for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
         if (!connected_boards[board]) continue;
-        for (int ch_offset = 0; ch_offset < 8; ch_offset++) {
-          int ch = board * 8 + ch_offset;
+        for (int ch_offset = 0; ch_offset < SHIM_CHANNELS_PER_BOARD; ch_offset++) {
+          int ch = board * SHIM_CHANNELS_PER_BOARD + ch_offset;
           if (channel_valid[ch]) {
-            double current_amps = dac_to_amps(channel_data[ch]);
+            double current_amps = channel_amps[ch];
             fprintf(file, ",%.3f", current_amps);
           } else {
             fprintf(file, ",0.000");  // Default value for channels on connected boards
@@ -1637,18 +1611,19 @@ static void* fieldmap_thread(void* arg) {
       }
       fprintf(file, "\n");
       fflush(file);
+      thread_trace_end(TRACE_FILE_WRITE, trace_t0, words_read);
 
       // Find target channel data and max current from other channels
       double target_current = 0.0;
       if (channel_valid[current_channel]) {
-        target_current = dac_to_amps(channel_data[current_channel]);
+        target_current = channel_amps[current_channel];
       }
 
       double max_other_current = 0.0;
       int max_other_channel = -1;
-      for (int ch = 0; ch < 64; ch++) {
+      for (int ch = 0; ch < SHIM_MAX_CHANNELS; ch++) {
         if (ch == current_channel || !channel_valid[ch]) continue;
-        double current_amps = dac_to_amps(channel_data[ch]);
+        double current_amps = channel_amps[ch];
         double abs_current = (current_amps < 0.0) ? -current_amps : current_amps;
         double abs_max = (max_other_current < 0.0) ? -max_other_current : max_other_current;
         if (abs_current > abs_max) {
@@ -1688,7 +1663,9 @@ static void* fieldmap_thread(void* arg) {
                FIFO_STS_WORD_COUNT(trig_status));
         last_verbose_time = current_time;
       }
-      usleep(1000); // 1ms
+      trace_t0 = thread_trace_begin();
+      rt_sched_usleep(1000); // 1ms
+      thread_trace_end(TRACE_SLEEP, trace_t0, 1000);
     }
   }
 
@@ -1729,27 +1706,27 @@ int cmd_fieldmap(const char** args, int arg_count, const command_flag_t* flags,
   char input_buffer[256];
   int start_channel, end_channel;
 
-  printf("Enter start channel (0-63): ");
+  printf("Enter start channel (0-%d): ", SHIM_MAX_CHANNELS - 1);
   fflush(stdout);
   if (fgets(input_buffer, sizeof(input_buffer), stdin) == NULL) {
     fprintf(stderr, "Failed to read start channel.\n");
     return -1;
   }
   start_channel = atoi(input_buffer);
-  if (start_channel < 0 || start_channel > 63) {
-    fprintf(stderr, "Invalid start channel. Must be 0-63.\n");
+  if (start_channel < 0 || start_channel >= SHIM_MAX_CHANNELS) {
+    fprintf(stderr, "Invalid start channel. Must be 0-%d.\n", SHIM_MAX_CHANNELS - 1);
     return -1;
   }
 
-  printf("Enter end channel (0-63): ");
+  printf("Enter end channel (0-%d): ", SHIM_MAX_CHANNELS - 1);
   fflush(stdout);
   if (fgets(input_buffer, sizeof(input_buffer), stdin) == NULL) {
     fprintf(stderr, "Failed to read end channel.\n");
     return -1;
   }
   end_channel = atoi(input_buffer);
-  if (end_channel < 0 || end_channel > 63) {
-    fprintf(stderr, "Invalid end channel. Must be 0-63.\n");
+  if (end_channel < 0 || end_channel >= SHIM_MAX_CHANNELS) {
+    fprintf(stderr, "Invalid end channel. Must be 0-%d.\n", SHIM_MAX_CHANNELS - 1);
     return -1;
   }
 
@@ -1759,11 +1736,11 @@ int cmd_fieldmap(const char** args, int arg_count, const command_flag_t* flags,
   }
 
   // Check which boards are connected and validate channels
-  bool connected_boards[8] = {false};
+  bool connected_boards[SHIM_MAX_BOARDS] = {false};
   int connected_count = 0;
   printf("Checking connected boards...\n");
 
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     uint32_t adc_data_fifo_status = sys_sts_get_adc_data_fifo_status(ctx->sys_sts, (uint8_t)board, false);
     uint32_t dac_cmd_fifo_status = sys_sts_get_dac_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, false);
     uint32_t adc_cmd_fifo_status = sys_sts_get_adc_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, false);
@@ -1786,7 +1763,7 @@ int cmd_fieldmap(const char** args, int arg_count, const command_flag_t* flags,
 
   // Validate that all required boards for the channel range are connected
   for (int ch = start_channel; ch <= end_channel; ch++) {
-    int board = ch / 8;
+    int board = ch / SHIM_CHANNELS_PER_BOARD;
     if (!connected_boards[board]) {
       fprintf(stderr, "Error: Channel %d requires board %d, but board is not connected.\n", ch, board);
       return -1;
@@ -1912,14 +1889,13 @@ int cmd_fieldmap(const char** args, int arg_count, const command_flag_t* flags,
   if (!skip_reset) {
     printf("Resetting buffers...\n");
     safe_buffer_reset(ctx, false);
-    usleep(10000); // 10ms delay
   } else {
     printf("Skipping buffer reset (--no_reset flag set)\n");
   }
 
   // Add buffer stoppers
   printf("Adding buffer stoppers...\n");
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     if (!connected_boards[board]) continue;
 
     dac_cmd_noop(ctx->dac_ctrl, (uint8_t)board, DAC_TRIGGER_WAIT, DAC_NO_CONTINUE, DAC_NO_LDAC, 1, *(ctx->verbose));
@@ -1936,8 +1912,8 @@ int cmd_fieldmap(const char** args, int arg_count, const command_flag_t* flags,
   printf("Queueing DAC commands...\n");
   int total_dac_commands = 0;
   for (int ch = start_channel; ch <= end_channel; ch++) {
-    int target_board = ch / 8;
-    int target_channel = ch % 8;
+    int target_board = ch / SHIM_CHANNELS_PER_BOARD;
+    int target_channel = ch % SHIM_CHANNELS_PER_BOARD;
 
     if (*(ctx->verbose)) {
       printf("Fieldmap [VERBOSE]: Queueing DAC commands for ch%02d (board %d, channel %d)\n",
@@ -1945,7 +1921,7 @@ int cmd_fieldmap(const char** args, int arg_count, const command_flag_t* flags,
     }
 
     // Zero commands for all boards
-    for (int board = 0; board < 8; board++) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       if (!connected_boards[board]) continue;
 
       int16_t ch_vals[8] = {0};
@@ -1954,7 +1930,7 @@ int cmd_fieldmap(const char** args, int arg_count, const command_flag_t* flags,
     }
 
     // Positive polarity commands for all boards
-    for (int board = 0; board < 8; board++) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       if (!connected_boards[board]) continue;
 
       int16_t ch_vals[8] = {0};
@@ -1967,7 +1943,7 @@ int cmd_fieldmap(const char** args, int arg_count, const command_flag_t* flags,
     }
 
     // Negative polarity commands for all boards
-    for (int board = 0; board < 8; board++) {
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       if (!connected_boards[board]) continue;
 
       int16_t ch_vals[8] = {0};
@@ -1988,8 +1964,8 @@ int cmd_fieldmap(const char** args, int arg_count, const command_flag_t* flags,
   printf("Queueing ADC commands...\n");
   int total_adc_commands = 0;
   for (int ch = start_channel; ch <= end_channel; ch++) {
-    int target_board = ch / 8;
-    int target_channel = ch % 8;
+    int target_board = ch / SHIM_CHANNELS_PER_BOARD;
+    int target_channel = ch % SHIM_CHANNELS_PER_BOARD;
 
     if (*(ctx->verbose)) {
       printf("Fieldmap [VERBOSE]: Queueing ADC commands for ch%02d (board %d, channel %d)\n",
@@ -1998,7 +1974,7 @@ int cmd_fieldmap(const char** args, int arg_count, const command_flag_t* flags,
 
     // Three measurements per channel (zero, positive, negative)
     for (int measurement = 0; measurement < 3; measurement++) {
-      for (int board = 0; board < 8; board++) {
+      for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
       if (!connected_boards[board]) continue;
 
       // NOOP wait for trigger
@@ -2032,7 +2008,7 @@ int cmd_fieldmap(const char** args, int arg_count, const command_flag_t* flags,
   };
 
   // Copy connected boards array
-  for (int i = 0; i < 8; i++) {
+  for (int i = 0; i < SHIM_MAX_BOARDS; i++) {
     thread_params.connected_boards[i] = connected_boards[i];
   }
 
@@ -2056,7 +2032,7 @@ int cmd_fieldmap(const char** args, int arg_count, const command_flag_t* flags,
   if (*(ctx->verbose)) {
     printf("Fieldmap [VERBOSE]: Resetting trigger count after sync\n");
   }
-  trigger_cmd_reset_count(ctx->trigger_ctrl, *(ctx->verbose));
+  trigger_cmd_reset_count(ctx->trigger_ctrl, false, *(ctx->verbose));
 
   // Set up trigger system after sync
   int total_triggers = (end_channel - start_channel + 1) * 3; // 3 per channel
@@ -2129,6 +2105,132 @@ static int check_boards_connected(command_context_t* ctx) {
   return 0;
 }
 
+// Square root by Newton's method (avoids a libm dependency)
+static double sqrt_newton(double value) {
+  if (value <= 0.0) return 0.0;
+  double root = value > 1.0 ? value : 1.0;
+  for (int i = 0; i < 64; i++) {
+    root = 0.5 * (root + value / root);
+  }
+  return root;
+}
+
+// Per-channel statistics of one burst of bias samples
+#define BIAS_MAX_SAMPLES      64
+#define BIAS_OUTLIER_LIMIT    5.0 // Outlier threshold in robust standard deviations (1.4826 * MAD)
+#define BIAS_OUTLIER_MIN_DEV  2.0 // Never flag samples this close to the median (ADC quantization)
+typedef struct {
+  double mean;      // Bias estimate (mean of all samples)
+  double variance;  // Sample variance
+  int outliers;     // Samples far from the median
+} bias_stats_t;
+
+static void sort_doubles(double* values, int count) {
+  for (int i = 1; i < count; i++) {
+    double v = values[i];
+    int j = i - 1;
+    while (j >= 0 && values[j] > v) {
+      values[j + 1] = values[j];
+      j--;
+    }
+    values[j + 1] = v;
+  }
+}
+
+static double sorted_median(const double* values, int count) {
+  return (count % 2) ? values[count / 2] : 0.5 * (values[count / 2 - 1] + values[count / 2]);
+}
+
+// Mean, variance and outlier count of a channel's samples
+static bias_stats_t estimate_bias(const int16_t* samples, int count) {
+  bias_stats_t stats = {0};
+  if (count <= 0) return stats;
+
+  double sum = 0.0;
+  for (int i = 0; i < count; i++) sum += samples[i];
+  stats.mean = sum / count;
+  double variance_sum = 0.0;
+  for (int i = 0; i < count; i++) {
+    double diff = samples[i] - stats.mean;
+    variance_sum += diff * diff;
+  }
+  stats.variance = count > 1 ? variance_sum / (count - 1) : 0.0;
+
+  // Outliers are judged against the median and MAD, which a few bad samples can't drag along
+  double sorted[BIAS_MAX_SAMPLES];
+  double deviation[BIAS_MAX_SAMPLES];
+  for (int i = 0; i < count; i++) sorted[i] = samples[i];
+  sort_doubles(sorted, count);
+  double median = sorted_median(sorted, count);
+  for (int i = 0; i < count; i++) {
+    deviation[i] = sorted[i] > median ? sorted[i] - median : median - sorted[i];
+  }
+  sort_doubles(deviation, count);
+  double limit = BIAS_OUTLIER_LIMIT * 1.4826 * sorted_median(deviation, count);
+  if (limit < BIAS_OUTLIER_MIN_DEV) limit = BIAS_OUTLIER_MIN_DEV;
+  for (int i = 0; i < count; i++) {
+    double diff = samples[i] > median ? samples[i] - median : median - samples[i];
+    if (diff > limit) stats.outliers++;
+  }
+  return stats;
+}
+
+// Discard anything left in a board's ADC data FIFO
+static void drain_adc_data(command_context_t* ctx, uint8_t board) {
+  uint32_t words = FIFO_STS_WORD_COUNT(sys_sts_get_adc_data_fifo_status(ctx->sys_sts, board, false));
+  while (words > 0) {
+    for (uint32_t i = 0; i < words; i++) adc_read_word(ctx->adc_ctrl, board);
+    words = FIFO_STS_WORD_COUNT(sys_sts_get_adc_data_fifo_status(ctx->sys_sts, board, false));
+  }
+}
+
+// Take <frames> full-board reads from every connected board at once: one repeated ADC_RD per board,
+// spacing_cycles apart, then drain all data FIFOs together. samples[ch][i] is frame i of channel ch.
+// Channels of boards that don't deliver every frame in time are marked in no_data[].
+static void read_bias_burst(command_context_t* ctx, const bool connected_boards[SHIM_MAX_BOARDS], int frames,
+                            uint32_t spacing_cycles, uint32_t clk_freq_hz,
+                            int16_t samples[SHIM_MAX_CHANNELS][BIAS_MAX_SAMPLES], bool no_data[SHIM_MAX_CHANNELS]) {
+  uint32_t words_needed = (uint32_t)frames * 4;
+  uint32_t words_read[SHIM_MAX_BOARDS] = {0};
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (connected_boards[board]) {
+      adc_cmd_adc_rd(ctx->adc_ctrl, (uint8_t)board, ADC_DELAY_WAIT, ADC_NO_CONTINUE, spacing_cycles,
+                     (uint32_t)(frames - 1), false);
+    }
+  }
+
+  // Allow the burst time plus 100ms
+  uint64_t burst_us = clk_freq_hz > 0 ? (uint64_t)frames * spacing_cycles * 1000000ull / clk_freq_hz : 0;
+  uint64_t max_tries = (burst_us + 100000) / 100;
+  for (uint64_t tries = 0; tries < max_tries; tries++) {
+    bool all_done = true;
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+      if (!connected_boards[board] || words_read[board] >= words_needed) continue;
+      uint32_t words = FIFO_STS_WORD_COUNT(sys_sts_get_adc_data_fifo_status(ctx->sys_sts, (uint8_t)board, false));
+      if (words > words_needed - words_read[board]) words = words_needed - words_read[board];
+      for (uint32_t i = 0; i < words; i++) {
+        uint32_t word = adc_read_word(ctx->adc_ctrl, (uint8_t)board);
+        uint32_t frame = words_read[board] / 4;
+        int ch = board * SHIM_CHANNELS_PER_BOARD + (int)(words_read[board] % 4) * 2;
+        samples[ch][frame] = (int16_t)(uint16_t)(word & 0xFFFF);
+        samples[ch + 1][frame] = (int16_t)(uint16_t)(word >> 16);
+        words_read[board]++;
+      }
+      if (words_read[board] < words_needed) all_done = false;
+    }
+    if (all_done) break;
+    usleep(100); // 0.1ms
+  }
+
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    bool failed = connected_boards[board] && words_read[board] < words_needed;
+    if (failed) {
+      adc_cmd_cancel(ctx->adc_ctrl, (uint8_t)board, false);
+    }
+    for (int channel = 0; channel < SHIM_CHANNELS_PER_BOARD; channel++) no_data[board * SHIM_CHANNELS_PER_BOARD + channel] = failed;
+  }
+}
+
 // ADC bias calibration command - find and store ADC bias values for all connected channels
 int cmd_find_bias(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
   printf("Starting ADC bias calibration for all connected boards...\n");
@@ -2142,14 +2244,14 @@ int cmd_find_bias(const char** args, int arg_count, const command_flag_t* flags,
   }
 
   // Check which boards are connected by checking FIFOs
-  bool connected_boards[8] = {false};
+  bool connected_boards[SHIM_MAX_BOARDS] = {false};
   int connected_count = 0;
 
   if (*(ctx->verbose)) {
     printf("Checking connected boards...\n");
   }
 
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     uint32_t adc_data_fifo_status = sys_sts_get_adc_data_fifo_status(ctx->sys_sts, (uint8_t)board, false);
     uint32_t dac_cmd_fifo_status = sys_sts_get_dac_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, false);
     uint32_t adc_cmd_fifo_status = sys_sts_get_adc_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, false);
@@ -2179,7 +2281,7 @@ int cmd_find_bias(const char** args, int arg_count, const command_flag_t* flags,
   printf("Starting ADC bias calibration for all channels on %d connected board(s)\n", connected_count);
 
   // Store previous bias values before starting new measurement
-  for (int ch = 0; ch < 64; ch++) {
+  for (int ch = 0; ch < SHIM_MAX_CHANNELS; ch++) {
     ctx->adc_bias_previous[ch] = ctx->adc_bias[ch];
     ctx->adc_bias_previous_valid[ch] = ctx->adc_bias_valid[ch];
   }
@@ -2193,14 +2295,13 @@ int cmd_find_bias(const char** args, int arg_count, const command_flag_t* flags,
       printf("Resetting all buffers...\n");
     }
     safe_buffer_reset(ctx, *(ctx->verbose));
-    usleep(10000); // 10ms
   }
 
   // Send cancel commands to all connected boards
   if (*(ctx->verbose)) {
     printf("Sending cancel commands to connected boards...\n");
   }
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     if (connected_boards[board]) {
       dac_cmd_cancel(ctx->dac_ctrl, (uint8_t)board, *(ctx->verbose));
       adc_cmd_cancel(ctx->adc_ctrl, (uint8_t)board, *(ctx->verbose));
@@ -2216,21 +2317,42 @@ int cmd_find_bias(const char** args, int arg_count, const command_flag_t* flags,
   const int delay_ms = 1; // 1ms delay
   const double slope_tolerance = 0.1; // +/-0.1 slope tolerance
 
+  // Every board reads all 8 channels per ADC_RD, repeated with 1ms between frames (or the ADC minimum)
+  uint32_t clk_freq_hz = sys_sts_get_clk_freq_hz(ctx->sys_sts, false);
+  uint32_t spacing_cycles = clk_freq_hz / 1000 * delay_ms;
+  uint32_t adc_min_delay = sys_sts_get_adc_min_delay_time(ctx->sys_sts, false);
+  if (spacing_cycles < adc_min_delay) spacing_cycles = adc_min_delay;
+  uint32_t dac_delay = sys_sts_get_dac_min_delay_time(ctx->sys_sts, false);
+
+  // Frames need to come back in the default 0-7 channel order; the user's order is put back at the end
+  uint8_t default_order[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+  uint8_t saved_order[SHIM_MAX_BOARDS][8];
+  int result = 0;
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (connected_boards[board]) {
+      memcpy(saved_order[board], ctx->adc_ctrl->channel_order[board], sizeof(saved_order[board]));
+      adc_cmd_set_ord(ctx->adc_ctrl, (uint8_t)board, default_order, false);
+      drain_adc_data(ctx, (uint8_t)board);
+    }
+  }
+
   int channels_calibrated = 0;
   int channels_failed = 0;
-  bool channel_slope_valid[64] = {false}; // Track which channels pass slope test
+  bool channel_slope_valid[SHIM_MAX_CHANNELS] = {false}; // Track which channels pass slope test
+  static int16_t samples[SHIM_MAX_CHANNELS][BIAS_MAX_SAMPLES];
+  bool no_data[SHIM_MAX_CHANNELS];
 
   // Track failed channels for reporting
-  int failed_channels_phase1[64];
-  char failed_reasons_phase1[64][64];
+  int failed_channels_phase1[SHIM_MAX_CHANNELS];
+  char failed_reasons_phase1[SHIM_MAX_CHANNELS][64];
   int phase1_failed_count = 0;
 
-  int failed_channels_phase2[64];
-  char failed_reasons_phase2[64][64];
+  int failed_channels_phase2[SHIM_MAX_CHANNELS];
+  char failed_reasons_phase2[SHIM_MAX_CHANNELS][64];
   int phase2_failed_count = 0;
 
   // Initialize all ADC bias values as invalid
-  for (int ch = 0; ch < 64; ch++) {
+  for (int ch = 0; ch < SHIM_MAX_CHANNELS; ch++) {
     ctx->adc_bias_valid[ch] = false;
     ctx->adc_bias[ch] = 0.0;
   }
@@ -2238,69 +2360,46 @@ int cmd_find_bias(const char** args, int arg_count, const command_flag_t* flags,
   // Phase 1: Slope validation for all channels
   printf("Phase 1: Validating channels are unplugged (slope near zero)...\n");
 
-  for (int ch = 0; ch < 64; ch++) {
-    int board = ch / 8;
-    int channel = ch % 8;
-
-    // Skip boards that are not connected
-    if (!connected_boards[board]) {
-      continue;
-    }
-
+  // Step every channel on every board through the DAC values together, averaging a burst at each
+  double dac_vals[num_dac_values];
+  double avg_adc_vals[SHIM_MAX_CHANNELS][num_dac_values];
+  bool slope_no_data[SHIM_MAX_CHANNELS] = {false};
+  for (int i = 0; i < num_dac_values; i++) {
+    int16_t dac_val = (int16_t)dac_values[i];
+    dac_vals[i] = (double)dac_val;
     if (*(ctx->verbose)) {
-      printf("Checking slope for Ch %02d...\n", ch);
+      printf("Checking slope at DAC value %d...\n", dac_val);
     }
 
-    // Arrays to store DAC values and corresponding averaged ADC readings for slope test
-    double dac_vals[num_dac_values];
-    double avg_adc_vals[num_dac_values];
-    bool slope_test_failed = false;
-
-    // Test each DAC value for slope calculation
-    for (int i = 0; i < num_dac_values && !slope_test_failed; i++) {
-      int16_t dac_val = dac_values[i];
-      dac_vals[i] = (double)dac_val;
-
-      // Perform multiple reads and average them
-      double sum_adc = 0.0;
-
-      for (int avg = 0; avg < slope_samples && !slope_test_failed; avg++) {
-        // Write DAC value
-        dac_cmd_dac_wr_ch(ctx->dac_ctrl, (uint8_t)board, (uint8_t)channel, dac_val, false);
-        usleep(delay_ms * 1000); // Wait fixed delay
-
-        // Read ADC value
-        adc_cmd_adc_rd_ch(ctx->adc_ctrl, (uint8_t)board, (uint8_t)channel, 0, false);
-
-        // Wait for ADC data to be available
-        int adc_tries = 0;
-        uint32_t adc_data_fifo_status;
-        while (adc_tries < 100) {
-          adc_data_fifo_status = sys_sts_get_adc_data_fifo_status(ctx->sys_sts, (uint8_t)board, false);
-          if (FIFO_STS_WORD_COUNT(adc_data_fifo_status) > 0) break;
-          usleep(100); // 0.1ms
-          adc_tries++;
-        }
-
-        if (FIFO_STS_WORD_COUNT(adc_data_fifo_status) == 0) {
-          slope_test_failed = true;
-          break;
-        }
-
-        uint32_t adc_word = adc_read_word(ctx->adc_ctrl, (uint8_t)board);
-        uint16_t adc_reading_raw = (uint16_t)(adc_word & 0xFFFF);
-        int16_t adc_reading = adc_reading_raw < 32768 ? adc_reading_raw : adc_reading_raw - 65536; // Convert to signed
-        double adc_value = (double)adc_reading;
-
-        sum_adc += adc_value;
+    int16_t ch_vals[8];
+    for (int channel = 0; channel < 8; channel++) ch_vals[channel] = dac_val;
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+      if (connected_boards[board]) {
+        dac_cmd_dac_wr(ctx->dac_ctrl, (uint8_t)board, ch_vals, DAC_DELAY_WAIT, DAC_NO_CONTINUE, DAC_LDAC, dac_delay, false);
       }
+    }
+    usleep(delay_ms * 1000); // Wait fixed delay
 
-      if (slope_test_failed) break;
+    read_bias_burst(ctx, connected_boards, slope_samples, spacing_cycles, clk_freq_hz, samples, no_data);
+    for (int ch = 0; ch < SHIM_MAX_CHANNELS; ch++) {
+      if (!connected_boards[ch / SHIM_CHANNELS_PER_BOARD]) continue;
+      if (no_data[ch]) {
+        slope_no_data[ch] = true;
+        continue;
+      }
+      double sum_adc = 0.0;
+      for (int s = 0; s < slope_samples; s++) sum_adc += (double)samples[ch][s];
+      avg_adc_vals[ch][i] = sum_adc / slope_samples;
+    }
+  }
 
-      avg_adc_vals[i] = sum_adc / slope_samples;
+  for (int ch = 0; ch < SHIM_MAX_CHANNELS; ch++) {
+    // Skip boards that are not connected
+    if (!connected_boards[ch / SHIM_CHANNELS_PER_BOARD]) {
+      continue;
     }
 
-    if (slope_test_failed) {
+    if (slope_no_data[ch]) {
       if (*(ctx->verbose)) {
         printf("  Ch %02d: FAIL (no ADC data)\n", ch);
       }
@@ -2315,8 +2414,8 @@ int cmd_find_bias(const char** args, int arg_count, const command_flag_t* flags,
     double sum_x = 0, sum_y = 0, sum_xy = 0, sum_x2 = 0;
     for (int i = 0; i < num_dac_values; i++) {
       sum_x += dac_vals[i];
-      sum_y += avg_adc_vals[i];
-      sum_xy += dac_vals[i] * avg_adc_vals[i];
+      sum_y += avg_adc_vals[ch][i];
+      sum_xy += dac_vals[i] * avg_adc_vals[ch][i];
       sum_x2 += dac_vals[i] * dac_vals[i];
     }
 
@@ -2358,7 +2457,7 @@ int cmd_find_bias(const char** args, int arg_count, const command_flag_t* flags,
 
   // Count channels that passed slope test
   int slope_passed_count = 0;
-  for (int ch = 0; ch < 64; ch++) {
+  for (int ch = 0; ch < SHIM_MAX_CHANNELS; ch++) {
     if (channel_slope_valid[ch]) {
       slope_passed_count++;
     }
@@ -2371,16 +2470,18 @@ int cmd_find_bias(const char** args, int arg_count, const command_flag_t* flags,
     printf("Failed channels in Phase 1 (slope validation):\n");
     for (int i = 0; i < phase1_failed_count; i++) {
       int ch = failed_channels_phase1[i];
-      int board = ch / 8;
-      int channel = ch % 8;
+      int board = ch / SHIM_CHANNELS_PER_BOARD;
+      int channel = ch % SHIM_CHANNELS_PER_BOARD;
       printf("  Ch %02d (Board %d, Channel %d): %s\n", ch, board, channel, failed_reasons_phase1[i]);
     }
-    return -1;
+    result = -1;
+    goto restore_order;
   }
 
   if (slope_passed_count == 0) {
     printf("No channels passed slope validation. Aborting bias calibration.\n");
-    return -1;
+    result = -1;
+    goto restore_order;
   }
 
   // Phase 2: Bias measurement for channels that passed slope test
@@ -2388,56 +2489,25 @@ int cmd_find_bias(const char** args, int arg_count, const command_flag_t* flags,
 
   channels_failed = 0; // Reset for bias measurement phase
 
-  // Iterate through channels that passed slope test
-  for (int ch = 0; ch < 64; ch++) {
-    int board = ch / 8;
-    int channel = ch % 8;
+  // Set every DAC channel to zero and take one burst from all boards
+  int16_t zero_vals[8] = {0};
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (connected_boards[board]) {
+      dac_cmd_dac_wr(ctx->dac_ctrl, (uint8_t)board, zero_vals, DAC_DELAY_WAIT, DAC_NO_CONTINUE, DAC_LDAC, dac_delay, false);
+    }
+  }
+  usleep(delay_ms * 1000); // Wait for DAC to settle
+  read_bias_burst(ctx, connected_boards, bias_sample_count, spacing_cycles, clk_freq_hz, samples, no_data);
 
+  for (int ch = 0; ch < SHIM_MAX_CHANNELS; ch++) {
     // Skip channels that didn't pass slope test or boards not connected
-    if (!connected_boards[board] || !channel_slope_valid[ch]) {
+    if (!connected_boards[ch / SHIM_CHANNELS_PER_BOARD] || !channel_slope_valid[ch]) {
       continue;
     }
 
     printf("Ch %02d : ", ch);
-    fflush(stdout);
-
-    // Array to store all samples for this channel
-    double samples[bias_sample_count];
-    bool calibration_failed = false;
-
-    // Set DAC to zero value
-    dac_cmd_dac_wr_ch(ctx->dac_ctrl, (uint8_t)board, (uint8_t)channel, 0, false);
-    usleep(delay_ms * 1000); // Wait for DAC to settle
-
-    // Collect samples
-    for (int i = 0; i < bias_sample_count && !calibration_failed; i++) {
-      // Read ADC value
-      adc_cmd_adc_rd_ch(ctx->adc_ctrl, (uint8_t)board, (uint8_t)channel, 0, false);
 
-      // Wait for ADC data to be available
-      int adc_tries = 0;
-      uint32_t adc_data_fifo_status;
-      while (adc_tries < 100) {
-        adc_data_fifo_status = sys_sts_get_adc_data_fifo_status(ctx->sys_sts, (uint8_t)board, false);
-        if (FIFO_STS_WORD_COUNT(adc_data_fifo_status) > 0) break;
-        usleep(100); // 0.1ms
-        adc_tries++;
-      }
-
-      if (FIFO_STS_WORD_COUNT(adc_data_fifo_status) == 0) {
-        calibration_failed = true;
-        break;
-      }
-
-      uint32_t adc_word = adc_read_word(ctx->adc_ctrl, (uint8_t)board);
-      uint16_t adc_reading_raw = (uint16_t)(adc_word & 0xFFFF);
-      int16_t adc_reading = adc_reading_raw < 32768 ? adc_reading_raw : adc_reading_raw - 65536; // Convert to signed
-      samples[i] = (double)adc_reading;
-
-      usleep(delay_ms * 1000); // Small delay between samples
-    }
-
-    if (calibration_failed) {
+    if (no_data[ch]) {
       printf("FAIL (no ADC data)\n");
       failed_channels_phase2[phase2_failed_count] = ch;
       snprintf(failed_reasons_phase2[phase2_failed_count], sizeof(failed_reasons_phase2[phase2_failed_count]), "no ADC data");
@@ -2446,29 +2516,8 @@ int cmd_find_bias(const char** args, int arg_count, const command_flag_t* flags,
       continue;
     }
 
-    // Calculate mean (bias)
-    double sum = 0.0;
-    for (int i = 0; i < bias_sample_count; i++) {
-      sum += samples[i];
-    }
-    double bias_average = sum / bias_sample_count;
-
-    // Calculate standard deviation
-    double variance_sum = 0.0;
-    for (int i = 0; i < bias_sample_count; i++) {
-      double diff = samples[i] - bias_average;
-      variance_sum += diff * diff;
-    }
-    double std_dev = variance_sum > 0 ? (variance_sum / (bias_sample_count - 1)) : 0.0;
-    // Calculate square root manually without math library
-    double std_dev_sqrt = 0.0;
-    if (std_dev > 0) {
-      // Newton's method for square root
-      std_dev_sqrt = std_dev / 2.0;
-      for (int iter = 0; iter < 10; iter++) {
-        std_dev_sqrt = (std_dev_sqrt + std_dev / std_dev_sqrt) / 2.0;
-      }
-    }
+    bias_stats_t stats = estimate_bias(samples[ch], bias_sample_count);
+    double bias_average = stats.mean;
 
     // Store the bias value
     ctx->adc_bias[ch] = bias_average;
@@ -2483,7 +2532,11 @@ int cmd_find_bias(const char** args, int arg_count, const command_flag_t* flags,
       snprintf(diff_str, sizeof(diff_str), " (new)");
     }
 
-    printf("bias=%+7.2f, std=%5.2f%s\n", bias_average, std_dev_sqrt, diff_str);
+    printf("bias=%+7.2f, std=%5.2f%s", bias_average, sqrt_newton(stats.variance), diff_str);
+    if (stats.outliers > 0) {
+      printf(", %d outlier%s", stats.outliers, stats.outliers == 1 ? "" : "s");
+    }
+    printf("\n");
     channels_calibrated++;
   }
 
@@ -2495,22 +2548,23 @@ int cmd_find_bias(const char** args, int arg_count, const command_flag_t* flags,
     printf("Failed channels in Phase 2 (bias measurement):\n");
     for (int i = 0; i < phase2_failed_count; i++) {
       int ch = failed_channels_phase2[i];
-      int board = ch / 8;
-      int channel = ch % 8;
+      int board = ch / SHIM_CHANNELS_PER_BOARD;
+      int channel = ch % SHIM_CHANNELS_PER_BOARD;
       printf("  Ch %02d (Board %d, Channel %d): %s\n", ch, board, channel, failed_reasons_phase2[i]);
     }
   }
 
   if (channels_calibrated == 0) {
     printf("No channels were successfully calibrated.\n");
-    return -1;
+    result = -1;
+    goto restore_order;
   }
 
   printf("\nADC bias values for successfully calibrated channels:\n");
-  for (int ch = 0; ch < 64; ch++) {
+  for (int ch = 0; ch < SHIM_MAX_CHANNELS; ch++) {
     if (ctx->adc_bias_valid[ch]) {
-      int board = ch / 8;
-      int channel = ch % 8;
+      int board = ch / SHIM_CHANNELS_PER_BOARD;
+      int channel = ch % SHIM_CHANNELS_PER_BOARD;
 
       // Format difference from previous measurement
       char diff_str[32] = "";
@@ -2527,7 +2581,15 @@ int cmd_find_bias(const char** args, int arg_count, const command_flag_t* flags,
   }
 
   printf("ADC bias calibration completed successfully.\n");
-  return 0;
+
+restore_order:
+  // Put back each board's channel order
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (connected_boards[board]) {
+      adc_cmd_set_ord(ctx->adc_ctrl, (uint8_t)board, saved_order[board], false);
+    }
+  }
+  return result;
 }
 
 // Print ADC bias values command
@@ -2540,9 +2602,9 @@ int cmd_print_adc_bias(const char** args, int arg_count, const command_flag_t* f
   printf("%-6s %-8s %-8s %-10s %s\n", "Ch", "Board", "Channel", "Bias", "Status");
   printf("%-6s %-8s %-8s %-10s %s\n", "------", "--------", "--------", "----------", "--------");
 
-  for (int ch = 0; ch < 64; ch++) {
-    int board = ch / 8;
-    int channel = ch % 8;
+  for (int ch = 0; ch < SHIM_MAX_CHANNELS; ch++) {
+    int board = ch / SHIM_CHANNELS_PER_BOARD;
+    int channel = ch % SHIM_CHANNELS_PER_BOARD;
 
     if (ctx->adc_bias_valid[ch]) {
       printf("%-6d %-8d %-8d %-10.2f %s\n", ch, board, channel, ctx->adc_bias[ch], "Valid");
@@ -2577,9 +2639,9 @@ int cmd_save_adc_bias(const char** args, int arg_count, const command_flag_t* fl
   int saved_count = 0;
 
   // Write all channels
-  for (int ch = 0; ch < 64; ch++) {
-    int board = ch / 8;
-    int channel = ch % 8;
+  for (int ch = 0; ch < SHIM_MAX_CHANNELS; ch++) {
+    int board = ch / SHIM_CHANNELS_PER_BOARD;
+    int channel = ch % SHIM_CHANNELS_PER_BOARD;
 
     fprintf(file, "%d,%d,%d,%.6f,%s\n",
             ch, board, channel,
@@ -2594,7 +2656,7 @@ int cmd_save_adc_bias(const char** args, int arg_count, const command_flag_t* fl
   fclose(file);
 
   printf("Successfully saved ADC bias values to '%s'\n", full_path);
-  printf("Saved %d valid bias values (out of 64 channels)\n", saved_count);
+  printf("Saved %d valid bias values (out of %d channels)\n", saved_count, SHIM_MAX_CHANNELS);
 
   return 0;
 }
@@ -2622,7 +2684,7 @@ int cmd_load_adc_bias(const char** args, int arg_count, const command_flag_t* fl
   }
 
   // Initialize all bias values as invalid before loading
-  for (int ch = 0; ch < 64; ch++) {
+  for (int ch = 0; ch < SHIM_MAX_CHANNELS; ch++) {
     ctx->adc_bias_valid[ch] = false;
     ctx->adc_bias[ch] = 0.0;
   }
@@ -2648,7 +2710,7 @@ int cmd_load_adc_bias(const char** args, int arg_count, const command_flag_t* fl
     }
 
     // Validate channel number
-    if (channel < 0 || channel >= 64) {
+    if (channel < 0 || channel >= SHIM_MAX_CHANNELS) {
       fprintf(stderr, "Warning: Invalid channel %d on line %d, skipping\n", channel, line_num);
       continue;
     }
@@ -2676,3 +2738,376 @@ int cmd_load_adc_bias(const char** args, int arg_count, const command_flag_t* fl
 
   return 0;
 }
+
+// Latency histogram upper bin edges in microseconds (the last bin is open-ended)
+#define LATENCY_HIST_BINS 12
+static const double latency_hist_edges_us[LATENCY_HIST_BINS - 1] = {
+  1.0, 2.0, 5.0, 10.0, 20.0, 50.0, 100.0, 200.0, 500.0, 1000.0, 2000.0
+};
+#define LATENCY_TIMEOUT_US 100000 // Per-trigger timeout for all events to arrive
+
+// Print a histogram with mean and jitter (standard deviation)
+static void latency_hist_print(const char* name, const timing_hist_t* hist, uint32_t expected) {
+  if (hist->count == 0) {
+    printf("  %s: no events observed\n", name);
+    return;
+  }
+  double mean = timing_hist_mean_us(hist);
+  double var = hist->sum_sq_us / (double)hist->count - mean * mean;
+  printf("  %s: %" PRIu64 "/%u events, min %.2f us, mean %.2f us, max %.2f us, jitter (std) %.2f us, p-p %.2f us\n",
+         name, hist->count, expected, hist->min_us, mean, hist->max_us,
+         sqrt_newton(var), hist->max_us - hist->min_us);
+  timing_hist_print_bins(hist);
+}
+
+// Trigger-to-output latency characterization.
+// Each iteration queues a triggered DAC write (all channels 0, with LDAC) and a triggered ADC read on the selected
+// board(s), forces one logged trigger, then busy-polls the status registers and data FIFOs. Event times are taken
+// on the host clock when each event is first observed:
+//   trigger: the trigger counter increments
+//   DAC:     a DAC_DBG_DAC_WRITE debug word arrives (needs the board's DAC debug bit, debug register bit 2*board)
+//   ADC:     the 4 words of the ADC read arrive (needs the board's ADC debug bit, bit 2*board+1, to be clear)
+// Latencies are relative to the observed trigger, so they include up to one status poll of error (reported).
+// The logged hardware trigger timestamps are written to the optional CSV with the per-trigger host latencies.
+int cmd_latency_test(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  bool all_boards = (strcmp(args[0], "all") == 0);
+  int selected_board = -1;
+  if (!all_boards) {
+    selected_board = parse_board_number(args[0]);
+    if (selected_board < 0) {
+      fprintf(stderr, "Invalid board number for latency test: '%s'. Must be 0-%d or \"all\".\n", args[0],
+              SHIM_MAX_BOARDS - 1);
+      return -1;
+    }
+  }
+  char* endptr;
+  uint32_t trigger_total = parse_value(args[1], &endptr);
+  if (*endptr != '\0' || trigger_total == 0 || trigger_total > 1000000) {
+    fprintf(stderr, "Invalid trigger count: '%s'. Must be 1-1000000.\n", args[1]);
+    return -1;
+  }
+
+  if (validate_system_running(ctx) != 0) {
+    return -1;
+  }
+
+  // Select boards with DAC and ADC FIFOs present and see which events can be observed on each
+  uint32_t debug_reg = *(ctx->sys_ctrl->debug) & 0xFFFF;
+  bool board_used[SHIM_MAX_BOARDS] = {false};
+  bool dac_observable[SHIM_MAX_BOARDS] = {false};
+  bool adc_observable[SHIM_MAX_BOARDS] = {false};
+  int board_count = 0;
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (!all_boards && board != selected_board) continue;
+    if (!FIFO_PRESENT(sys_sts_get_dac_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, false)) ||
+        !FIFO_PRESENT(sys_sts_get_dac_data_fifo_status(ctx->sys_sts, (uint8_t)board, false)) ||
+        !FIFO_PRESENT(sys_sts_get_adc_cmd_fifo_status(ctx->sys_sts, (uint8_t)board, false)) ||
+        !FIFO_PRESENT(sys_sts_get_adc_data_fifo_status(ctx->sys_sts, (uint8_t)board, false))) {
+      if (!all_boards) {
+        fprintf(stderr, "Board %d is not connected (DAC/ADC FIFOs not present).\n", board);
+        return -1;
+      }
+      continue;
+    }
+    board_used[board] = true;
+    dac_observable[board] = (debug_reg >> (2 * board)) & 0x1;
+    adc_observable[board] = !((debug_reg >> (2 * board + 1)) & 0x1);
+    board_count++;
+    if (!dac_observable[board]) {
+      printf("Board %d: DAC debug is off (debug register bit %d), DAC write latency will not be measured.\n", board, 2 * board);
+    }
+    if (!adc_observable[board]) {
+      printf("Board %d: ADC debug is on (debug register bit %d), ADC latency will not be measured.\n", board, 2 * board + 1);
+    }
+  }
+  if (board_count == 0) {
+    fprintf(stderr, "No boards are connected. Aborting latency test.\n");
+    return -1;
+  }
+
+  // Optional per-trigger CSV log
+  FILE* csv = NULL;
+  char csv_path[1024] = {0};
+  if (arg_count > 2) {
+    clean_and_expand_path(args[2], csv_path, sizeof(csv_path));
+    csv = fopen(csv_path, "w");
+    if (csv == NULL) {
+      fprintf(stderr, "Failed to open latency log '%s': %s\n", csv_path, strerror(errno));
+      return -1;
+    }
+    fprintf(csv, "trigger,hw_timestamp,issue_to_trigger_us,board,dac_write_us,adc_data_us\n");
+  }
+
+  bool verbose = *(ctx->verbose);
+  if (!has_flag(flags, flag_count, FLAG_NO_RESET)) {
+    safe_buffer_reset(ctx, verbose);
+  }
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (board_used[board]) {
+      dac_cmd_cancel(ctx->dac_ctrl, (uint8_t)board, verbose);
+      adc_cmd_cancel(ctx->adc_ctrl, (uint8_t)board, verbose);
+    }
+  }
+  trigger_cmd_cancel(ctx->trigger_ctrl, verbose);
+  trigger_cmd_reset_count(ctx->trigger_ctrl, false, verbose);
+  usleep(1000);
+  // Drop anything left in the data FIFOs (cancel debug words, stale samples)
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (!board_used[board]) continue;
+    while (FIFO_STS_WORD_COUNT(sys_sts_get_dac_data_fifo_status(ctx->sys_sts, (uint8_t)board, false)) > 0) {
+      dac_read_data(ctx->dac_ctrl, (uint8_t)board);
+    }
+    while (FIFO_STS_WORD_COUNT(sys_sts_get_adc_data_fifo_status(ctx->sys_sts, (uint8_t)board, false)) > 0) {
+      adc_read_word(ctx->adc_ctrl, (uint8_t)board);
+    }
+  }
+  while (FIFO_STS_WORD_COUNT(sys_sts_get_trig_data_fifo_status(ctx->sys_sts, false)) > 0) {
+    trigger_read(ctx->trigger_ctrl);
+  }
+
+  printf("Running latency test: %u forced trigger(s) on %d board(s)...\n", trigger_total, board_count);
+
+  timing_hist_t issue_hist, dac_hist[SHIM_MAX_BOARDS], adc_hist[SHIM_MAX_BOARDS], poll_hist;
+  timing_hist_init(&issue_hist, latency_hist_edges_us, LATENCY_HIST_BINS);
+  timing_hist_init(&poll_hist, latency_hist_edges_us, LATENCY_HIST_BINS);
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    timing_hist_init(&dac_hist[board], latency_hist_edges_us, LATENCY_HIST_BINS);
+    timing_hist_init(&adc_hist[board], latency_hist_edges_us, LATENCY_HIST_BINS);
+  }
+  uint64_t prev_timestamp = 0;
+  uint64_t spacing_min = 0, spacing_max = 0;
+  uint32_t timeouts = 0;
+  int16_t zero_values[8] = {0};
+  int16_t dac_expected = 0, adc_expected = 0;
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (board_used[board] && dac_observable[board]) dac_expected++;
+    if (board_used[board] && adc_observable[board]) adc_expected++;
+  }
+
+  for (uint32_t trig = 0; trig < trigger_total && !*(ctx->should_exit); trig++) {
+    // Arm the cores and wait until they have taken the commands (now waiting for the trigger)
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+      if (!board_used[board]) continue;
+      dac_cmd_dac_wr(ctx->dac_ctrl, (uint8_t)board, zero_values, DAC_TRIGGER_WAIT, DAC_NO_CONTINUE, DAC_LDAC, 1, false);
+      adc_cmd_adc_rd(ctx->adc_ctrl, (uint8_t)board, ADC_TRIGGER_WAIT, ADC_NO_CONTINUE, 1, 0, false);
+    }
+    uint32_t cmd_mask = 0;
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+      if (board_used[board]) cmd_mask |= (0x3u << (2 * board)); // DAC and ADC bits for the board
+    }
+    if (sys_sts_wait_for_fifos_empty(ctx->sys_sts, cmd_mask, 0, LATENCY_TIMEOUT_US, false) != 0) {
+      fprintf(stderr, "Trigger %u: commands were not consumed, aborting latency test.\n", trig + 1);
+      break;
+    }
+    // Let the state transition debug words from arming land, then discard them
+    usleep(100);
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+      if (!board_used[board] || !dac_observable[board]) continue;
+      while (FIFO_STS_WORD_COUNT(sys_sts_get_dac_data_fifo_status(ctx->sys_sts, (uint8_t)board, false)) > 0) {
+        dac_read_data(ctx->dac_ctrl, (uint8_t)board);
+      }
+    }
+
+    uint32_t count_before = sys_sts_get_trig_count(ctx->sys_sts, false);
+    uint64_t issue_ns = timing_now_ns();
+    trigger_cmd_force_trig(ctx->trigger_ctrl, true, false);
+
+    // Busy-poll until every expected event is seen (no sleeping, to keep the observation error small)
+    uint64_t trig_ns = 0;
+    uint64_t dac_ns[SHIM_MAX_BOARDS] = {0};
+    uint64_t adc_ns[SHIM_MAX_BOARDS] = {0};
+    int16_t dac_seen = 0, adc_seen = 0;
+    uint64_t polls = 0;
+    uint64_t now_ns = issue_ns;
+    while ((trig_ns == 0 || dac_seen < dac_expected || adc_seen < adc_expected) &&
+           now_ns - issue_ns < (uint64_t)LATENCY_TIMEOUT_US * 1000ULL) {
+      polls++;
+      if (trig_ns == 0 && sys_sts_get_trig_count(ctx->sys_sts, false) != count_before) {
+        trig_ns = timing_now_ns();
+      }
+      for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+        if (!board_used[board]) continue;
+        if (dac_observable[board] && dac_ns[board] == 0 &&
+            FIFO_STS_WORD_COUNT(sys_sts_get_dac_data_fifo_status(ctx->sys_sts, (uint8_t)board, false)) > 0) {
+          uint64_t seen_ns = timing_now_ns();
+          if (DAC_DATA_CODE(dac_read_data(ctx->dac_ctrl, (uint8_t)board)) == DAC_DBG_DAC_WRITE) {
+            dac_ns[board] = seen_ns;
+            dac_seen++;
+          }
+        }
+        if (adc_observable[board] && adc_ns[board] == 0 &&
+            FIFO_STS_WORD_COUNT(sys_sts_get_adc_data_fifo_status(ctx->sys_sts, (uint8_t)board, false)) >= 4) {
+          adc_ns[board] = timing_now_ns();
+          adc_seen++;
+        }
+      }
+      now_ns = timing_now_ns();
+    }
+    if (polls > 0) {
+      timing_hist_add(&poll_hist, (double)(now_ns - issue_ns) * 1e-3 / (double)polls);
+    }
+    if (trig_ns == 0) {
+      fprintf(stderr, "Trigger %u: trigger was not observed within %u us, aborting latency test.\n", trig + 1, LATENCY_TIMEOUT_US);
+      break;
+    }
+    if (dac_seen < dac_expected || adc_seen < adc_expected) {
+      timeouts++;
+    }
+
+    // Hardware trigger timestamp (logged by the forced trigger)
+    uint64_t timestamp = 0;
+    if (FIFO_STS_WORD_COUNT(sys_sts_get_trig_data_fifo_status(ctx->sys_sts, false)) >= 2) {
+      timestamp = trigger_read(ctx->trigger_ctrl);
+      if (prev_timestamp != 0) {
+        uint64_t spacing = timestamp - prev_timestamp;
+        if (spacing_min == 0 || spacing < spacing_min) spacing_min = spacing;
+        if (spacing > spacing_max) spacing_max = spacing;
+      }
+      prev_timestamp = timestamp;
+    }
+
+    double issue_us = (double)(trig_ns - issue_ns) * 1e-3;
+    timing_hist_add(&issue_hist, issue_us);
+    for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+      if (!board_used[board]) continue;
+      double dac_us = dac_ns[board] ? (double)(dac_ns[board] - trig_ns) * 1e-3 : -1.0;
+      double adc_us = adc_ns[board] ? (double)(adc_ns[board] - trig_ns) * 1e-3 : -1.0;
+      if (dac_ns[board]) timing_hist_add(&dac_hist[board], dac_us);
+      if (adc_ns[board]) timing_hist_add(&adc_hist[board], adc_us);
+      if (csv != NULL) {
+        fprintf(csv, "%u,%" PRIu64 ",%.3f,%d,%.3f,%.3f\n", trig + 1, timestamp, issue_us, board, dac_us, adc_us);
+      }
+
+      // Drain the rest of this trigger's data so the next iteration starts clean
+      while (FIFO_STS_WORD_COUNT(sys_sts_get_dac_data_fifo_status(ctx->sys_sts, (uint8_t)board, false)) > 0) {
+        dac_read_data(ctx->dac_ctrl, (uint8_t)board);
+      }
+      while (FIFO_STS_WORD_COUNT(sys_sts_get_adc_data_fifo_status(ctx->sys_sts, (uint8_t)board, false)) > 0) {
+        adc_read_word(ctx->adc_ctrl, (uint8_t)board);
+      }
+    }
+  }
+
+  if (csv != NULL) {
+    fclose(csv);
+    set_file_permissions(csv_path, verbose);
+    printf("Per-trigger latencies written to %s\n", csv_path);
+  }
+
+  printf("Latency test results (host-observed, relative to the trigger counter incrementing):\n");
+  printf("  Status poll period: mean %.2f us (observation error per event is up to one poll)\n",
+         timing_hist_mean_us(&poll_hist));
+  latency_hist_print("Force trigger issue -> trigger counted", &issue_hist, trigger_total);
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (!board_used[board]) continue;
+    char name[64];
+    if (dac_observable[board]) {
+      snprintf(name, sizeof(name), "Board %d trigger -> DAC write", board);
+      latency_hist_print(name, &dac_hist[board], trigger_total);
+    }
+    if (adc_observable[board]) {
+      snprintf(name, sizeof(name), "Board %d trigger -> ADC data", board);
+      latency_hist_print(name, &adc_hist[board], trigger_total);
+    }
+  }
+  if (spacing_max != 0) {
+    uint32_t clk_freq_hz = sys_sts_get_clk_freq_hz(ctx->sys_sts, false);
+    printf("  Hardware trigger spacing: %" PRIu64 " - %" PRIu64 " cycles", spacing_min, spacing_max);
+    if (clk_freq_hz != 0) {
+      printf(" (%.1f - %.1f us at %.3f MHz)", (double)spacing_min * 1e6 / clk_freq_hz,
+             (double)spacing_max * 1e6 / clk_freq_hz, clk_freq_hz / 1e6);
+    }
+    printf("\n");
+  }
+  if (timeouts > 0) {
+    printf("  %u trigger(s) timed out waiting for DAC/ADC events.\n", timeouts);
+  }
+  return 0;
+}
+
+// Parse benchmark: one parse of a DAC or ADC command file per simulated board, all on this thread and then
+// one thread per board (the way waveform_test loads files). Parses directly, bypassing the cache.
+typedef struct {
+  const char* path;
+  bool is_adc;
+  int command_count;
+  int result;
+} parse_bench_job_t;
+
+static void* parse_bench_thread(void* arg) {
+  parse_bench_job_t* job = (parse_bench_job_t*)arg;
+  void* commands = NULL;
+  job->result = job->is_adc
+    ? parse_adc_command_file_timed(job->path, (adc_command_t**)&commands, &job->command_count, NULL, NULL)
+    : parse_waveform_file_timed(job->path, (waveform_command_t**)&commands, &job->command_count, NULL, NULL);
+  free(commands);
+  return NULL;
+}
+
+int cmd_parse_bench(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  bool is_adc;
+  if (strcmp(args[0], "dac") == 0) {
+    is_adc = false;
+  } else if (strcmp(args[0], "adc") == 0) {
+    is_adc = true;
+  } else {
+    fprintf(stderr, "Invalid file type: '%s'. Must be \"dac\" or \"adc\".\n", args[0]);
+    return -1;
+  }
+
+  char path[1024];
+  clean_and_expand_path(args[1], path, sizeof(path));
+  struct stat st;
+  if (stat(path, &st) != 0) {
+    fprintf(stderr, "Cannot access '%s': %s\n", path, strerror(errno));
+    return -1;
+  }
+
+  int boards = SHIM_MAX_BOARDS;
+  if (arg_count > 2) {
+    char* endptr;
+    boards = (int)parse_value(args[2], &endptr);
+    if (*endptr != '\0' || boards < 1 || boards > SHIM_MAX_BOARDS) {
+      fprintf(stderr, "Invalid board count: '%s'. Must be 1-%d.\n", args[2], SHIM_MAX_BOARDS);
+      return -1;
+    }
+  }
+
+  parse_bench_job_t jobs[SHIM_MAX_BOARDS];
+  for (int i = 0; i < boards; i++) {
+    jobs[i] = (parse_bench_job_t){.path = path, .is_adc = is_adc, .command_count = 0, .result = -1};
+  }
+
+  // Warm the page cache so both runs read from memory
+  parse_bench_thread(&jobs[0]);
+  if (jobs[0].result != 0) return -1; // Error already printed by the parser
+
+  uint64_t start_ns = timing_now_ns();
+  for (int i = 0; i < boards; i++) parse_bench_thread(&jobs[i]);
+  uint64_t sequential_ns = timing_now_ns() - start_ns;
+
+  pthread_t threads[SHIM_MAX_BOARDS];
+  start_ns = timing_now_ns();
+  for (int i = 0; i < boards; i++) {
+    if (pthread_create(&threads[i], NULL, parse_bench_thread, &jobs[i]) != 0) {
+      fprintf(stderr, "Failed to create parse thread %d\n", i);
+      for (int j = 0; j < i; j++) pthread_join(threads[j], NULL);
+      return -1;
+    }
+  }
+  for (int i = 0; i < boards; i++) pthread_join(threads[i], NULL);
+  uint64_t parallel_ns = timing_now_ns() - start_ns;
+
+  double lines = (double)jobs[0].command_count * boards;
+  double megabytes = (double)st.st_size * boards / 1e6;
+  double sequential_s = sequential_ns / 1e9;
+  double parallel_s = parallel_ns / 1e9;
+  printf("Parse benchmark: %s file '%s' (%d commands, %.2f MB) x %d board%s\n", is_adc ? "ADC" : "DAC", path,
+         jobs[0].command_count, st.st_size / 1e6, boards, boards == 1 ? "" : "s");
+  printf("  Sequential: %8.3f s  %12.0f commands/s  %8.2f MB/s\n", sequential_s, lines / sequential_s,
+         megabytes / sequential_s);
+  printf("  Parallel:   %8.3f s  %12.0f commands/s  %8.2f MB/s\n", parallel_s, lines / parallel_s,
+         megabytes / parallel_s);
+  printf("  Speedup:    %.2fx\n", sequential_s / parallel_s);
+  return 0;
+}
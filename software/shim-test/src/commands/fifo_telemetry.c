@@ -0,0 +1,249 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "fifo_telemetry.h"
+#include "adc_ctrl.h"
+#include "dac_ctrl.h"
+#include "trigger_ctrl.h"
+#include "timing.h"
+
+#define RECORD_HEADER_BYTES 12 // t_ns + hw_status
+
+// Add one FIFO to the recorded set if it is present
+static void add_fifo(fifo_telemetry_t* telemetry, uint8_t id, volatile uint32_t* sts, uint32_t depth) {
+  if (!FIFO_PRESENT(*sts)) return;
+  uint32_t i = telemetry->fifo_count++;
+  telemetry->fifo_id[i] = id;
+  telemetry->fifo_depth[i] = (uint16_t)(depth > 0xFFFF ? 0xFFFF : depth);
+  telemetry->fifo_sts[i] = sts;
+  telemetry->stats[i].min = 0xFFFF;
+}
+
+static const char* fifo_name(uint8_t id, char* buffer, size_t size) {
+  static const char* kinds[4] = {"DAC cmd", "DAC data", "ADC cmd", "ADC data"};
+  if (id == FIFO_TELEMETRY_TRIG_CMD) return "Trig cmd";
+  if (id == FIFO_TELEMETRY_TRIG_DATA) return "Trig data";
+  snprintf(buffer, size, "%s %u", kinds[id % 4], id / 4);
+  return buffer;
+}
+
+static void* fifo_telemetry_thread(void* arg) {
+  fifo_telemetry_t* telemetry = (fifo_telemetry_t*)arg;
+  uint64_t period_ns = 1000000000ull / telemetry->rate_hz;
+  uint64_t deadline_ns = telemetry->start_ns;
+  uint8_t record[RECORD_HEADER_BYTES + 2 * FIFO_TELEMETRY_FIFOS];
+  uint16_t counts[FIFO_TELEMETRY_FIFOS];
+  bool was_running = false;
+  uint64_t halt_sample = 0;
+
+  while (!telemetry->stop) {
+    deadline_ns += period_ns;
+    struct timespec deadline = {
+      .tv_sec = (time_t)(deadline_ns / 1000000000ull),
+      .tv_nsec = (long)(deadline_ns % 1000000000ull)
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {}
+
+    // Read the registers back to back so a sample is as close to a snapshot as the bus allows
+    uint64_t now_ns = timing_now_ns();
+    uint32_t hw_status = *(telemetry->sys_sts->hw_status_reg);
+    for (uint32_t i = 0; i < telemetry->fifo_count; i++) {
+      counts[i] = (uint16_t)FIFO_STS_WORD_COUNT(*(telemetry->fifo_sts[i]));
+    }
+
+    uint64_t t_ns = now_ns - telemetry->start_ns;
+    memcpy(record, &t_ns, sizeof(t_ns));
+    memcpy(record + 8, &hw_status, sizeof(hw_status));
+    memcpy(record + RECORD_HEADER_BYTES, counts, 2 * telemetry->fifo_count);
+
+    pthread_mutex_lock(&telemetry->mutex);
+    uint64_t slot = telemetry->written % telemetry->capacity;
+    memcpy(telemetry->ring + slot * telemetry->record_bytes, record, telemetry->record_bytes);
+    telemetry->written++;
+    if (now_ns > deadline_ns + period_ns) {
+      telemetry->late_samples++;
+      deadline_ns = now_ns; // Resynchronize rather than bursting to catch up
+    }
+    for (uint32_t i = 0; i < telemetry->fifo_count; i++) {
+      fifo_telemetry_stats_t* stats = &telemetry->stats[i];
+      if (counts[i] < stats->min) stats->min = counts[i];
+      if (counts[i] > stats->max) stats->max = counts[i];
+      stats->sum += counts[i];
+      if (counts[i] == 0) stats->empty_samples++;
+    }
+    uint64_t written = telemetry->written;
+    pthread_mutex_unlock(&telemetry->mutex);
+
+    // Dump once, a few samples after the hardware manager leaves the running state
+    bool running = (HW_STS_STATE(hw_status) == S_RUNNING);
+    if (was_running && !running && halt_sample == 0) {
+      halt_sample = written;
+      printf("FIFO telemetry: hardware left the running state (status 0x%07X)\n", HW_STS_CODE(hw_status));
+    }
+    was_running = running;
+    if (halt_sample != 0 && !telemetry->halt_dumped && written >= halt_sample + FIFO_TELEMETRY_POST_HALT) {
+      telemetry->halt_dumped = true;
+      if (telemetry->halt_dump_path[0] != '\0') {
+        int64_t records = fifo_telemetry_dump(telemetry, telemetry->halt_dump_path, FIFO_TELEMETRY_DUMP_HALT);
+        if (records >= 0) {
+          printf("FIFO telemetry: wrote %lld samples to %s\n", (long long)records, telemetry->halt_dump_path);
+        }
+      }
+    }
+  }
+  return NULL;
+}
+
+fifo_telemetry_t* fifo_telemetry_start(struct sys_sts_t* sys_sts, uint32_t rate_hz, uint32_t capacity,
+                                       const char* halt_dump_path, bool verbose) {
+  if (rate_hz == 0 || rate_hz > FIFO_TELEMETRY_MAX_RATE_HZ) {
+    fprintf(stderr, "FIFO telemetry rate must be 1-%u Hz\n", FIFO_TELEMETRY_MAX_RATE_HZ);
+    return NULL;
+  }
+  if (capacity == 0 || capacity > FIFO_TELEMETRY_MAX_SAMPLES) {
+    fprintf(stderr, "FIFO telemetry ring must hold 1-%u samples\n", FIFO_TELEMETRY_MAX_SAMPLES);
+    return NULL;
+  }
+
+  fifo_telemetry_t* telemetry = calloc(1, sizeof(fifo_telemetry_t));
+  if (telemetry == NULL) {
+    fprintf(stderr, "Failed to allocate FIFO telemetry state\n");
+    return NULL;
+  }
+  telemetry->sys_sts = sys_sts;
+  telemetry->verbose = verbose;
+  telemetry->rate_hz = rate_hz;
+  if (halt_dump_path != NULL) {
+    snprintf(telemetry->halt_dump_path, sizeof(telemetry->halt_dump_path), "%s", halt_dump_path);
+  }
+
+  for (uint8_t board = 0; board < SHIM_MAX_BOARDS; board++) {
+    add_fifo(telemetry, 4 * board + 0, sys_sts->dac_cmd_fifo_sts[board], DAC_CMD_FIFO_WORDCOUNT);
+    add_fifo(telemetry, 4 * board + 1, sys_sts->dac_data_fifo_sts[board], DAC_DATA_FIFO_WORDCOUNT);
+    add_fifo(telemetry, 4 * board + 2, sys_sts->adc_cmd_fifo_sts[board], ADC_CMD_FIFO_WORDCOUNT);
+    add_fifo(telemetry, 4 * board + 3, sys_sts->adc_data_fifo_sts[board], ADC_DATA_FIFO_WORDCOUNT);
+  }
+  add_fifo(telemetry, FIFO_TELEMETRY_TRIG_CMD, sys_sts->trig_cmd_fifo_sts, TRIG_CMD_FIFO_WORDCOUNT);
+  add_fifo(telemetry, FIFO_TELEMETRY_TRIG_DATA, sys_sts->trig_data_fifo_sts, TRIG_DATA_FIFO_WORDCOUNT);
+
+  telemetry->record_bytes = RECORD_HEADER_BYTES + 2 * telemetry->fifo_count;
+  telemetry->capacity = capacity;
+  telemetry->ring = malloc((size_t)capacity * telemetry->record_bytes);
+  if (telemetry->ring == NULL) {
+    fprintf(stderr, "Failed to allocate FIFO telemetry ring (%u samples of %u bytes)\n", capacity, telemetry->record_bytes);
+    free(telemetry);
+    return NULL;
+  }
+  if (pthread_mutex_init(&telemetry->mutex, NULL) != 0) {
+    fprintf(stderr, "Failed to initialize FIFO telemetry mutex\n");
+    free(telemetry->ring);
+    free(telemetry);
+    return NULL;
+  }
+
+  telemetry->start_realtime_ns = timing_clock_ns(CLOCK_REALTIME);
+  telemetry->start_ns = timing_now_ns();
+  if (pthread_create(&telemetry->thread, NULL, fifo_telemetry_thread, telemetry) != 0) {
+    fprintf(stderr, "Failed to create FIFO telemetry thread\n");
+    pthread_mutex_destroy(&telemetry->mutex);
+    free(telemetry->ring);
+    free(telemetry);
+    return NULL;
+  }
+
+  if (verbose) {
+    printf("FIFO telemetry: %u FIFOs at %u Hz, %u-sample ring (%u bytes per sample)\n",
+           telemetry->fifo_count, rate_hz, capacity, telemetry->record_bytes);
+  }
+  return telemetry;
+}
+
+void fifo_telemetry_stop(fifo_telemetry_t* telemetry) {
+  if (telemetry == NULL) return;
+  telemetry->stop = true;
+  pthread_join(telemetry->thread, NULL);
+  pthread_mutex_destroy(&telemetry->mutex);
+  free(telemetry->ring);
+  free(telemetry);
+}
+
+int64_t fifo_telemetry_dump(fifo_telemetry_t* telemetry, const char* path, uint32_t reason) {
+  if (telemetry == NULL || path == NULL) return -1;
+
+  fifo_telemetry_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, FIFO_TELEMETRY_MAGIC, sizeof(header.magic));
+  header.version = FIFO_TELEMETRY_VERSION;
+  header.header_bytes = sizeof(fifo_telemetry_header_t);
+  header.record_bytes = telemetry->record_bytes;
+  header.fifo_count = telemetry->fifo_count;
+  header.rate_hz = telemetry->rate_hz;
+  header.reason = reason;
+  header.start_realtime_ns = telemetry->start_realtime_ns;
+  memcpy(header.fifo_id, telemetry->fifo_id, sizeof(header.fifo_id));
+  memcpy(header.fifo_depth, telemetry->fifo_depth, sizeof(header.fifo_depth));
+
+  // Copy the ring oldest-first under the lock, then write without holding it so sampling isn't stalled by I/O
+  size_t ring_bytes = (size_t)telemetry->capacity * telemetry->record_bytes;
+  uint8_t* copy = malloc(ring_bytes);
+  if (copy == NULL) {
+    fprintf(stderr, "Failed to allocate %zu bytes for FIFO telemetry dump\n", ring_bytes);
+    return -1;
+  }
+  pthread_mutex_lock(&telemetry->mutex);
+  uint64_t written = telemetry->written;
+  uint64_t count = written < telemetry->capacity ? written : telemetry->capacity;
+  uint64_t oldest = (written - count) % telemetry->capacity;
+  size_t first = (size_t)((telemetry->capacity - oldest) < count ? (telemetry->capacity - oldest) : count);
+  memcpy(copy, telemetry->ring + oldest * telemetry->record_bytes, first * telemetry->record_bytes);
+  memcpy(copy + first * telemetry->record_bytes, telemetry->ring, (size_t)(count - first) * telemetry->record_bytes);
+  pthread_mutex_unlock(&telemetry->mutex);
+  header.sample_count = count;
+  header.overwritten = written - count;
+
+  FILE* file = fopen(path, "wb");
+  if (file == NULL) {
+    fprintf(stderr, "Failed to open FIFO telemetry dump '%s': %s\n", path, strerror(errno));
+    free(copy);
+    return -1;
+  }
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+            (count == 0 || fwrite(copy, telemetry->record_bytes, (size_t)count, file) == (size_t)count);
+  if (fclose(file) != 0) ok = false;
+  free(copy);
+  if (!ok) {
+    fprintf(stderr, "Failed to write FIFO telemetry dump '%s': %s\n", path, strerror(errno));
+    return -1;
+  }
+  return (int64_t)count;
+}
+
+void fifo_telemetry_print_summary(fifo_telemetry_t* telemetry) {
+  if (telemetry == NULL) return;
+
+  fifo_telemetry_stats_t stats[FIFO_TELEMETRY_FIFOS];
+  pthread_mutex_lock(&telemetry->mutex);
+  uint64_t written = telemetry->written;
+  uint64_t late = telemetry->late_samples;
+  memcpy(stats, telemetry->stats, sizeof(stats));
+  pthread_mutex_unlock(&telemetry->mutex);
+
+  double elapsed_s = (double)(timing_now_ns() - telemetry->start_ns) * 1e-9;
+  printf("FIFO telemetry: %llu samples in %.1f s (%.0f Hz measured, %u Hz requested, %llu late), ring holds %u\n",
+         written, elapsed_s, elapsed_s > 0.0 ? (double)written / elapsed_s : 0.0, telemetry->rate_hz,
+         late, telemetry->capacity);
+  if (written == 0) return;
+
+  printf("  %-10s %6s %6s %8s %6s %9s %7s\n", "FIFO", "Depth", "Min", "Mean", "Max", "Headroom", "Empty");
+  for (uint32_t i = 0; i < telemetry->fifo_count; i++) {
+    char name_buffer[16];
+    uint32_t headroom = telemetry->fifo_depth[i] - stats[i].max;
+    printf("  %-10s %6u %6u %8.1f %6u %9u %6.1f%%\n",
+           fifo_name(telemetry->fifo_id[i], name_buffer, sizeof(name_buffer)), telemetry->fifo_depth[i],
+           stats[i].min, (double)stats[i].sum / (double)written, stats[i].max, headroom,
+           100.0 * (double)stats[i].empty_samples / (double)written);
+  }
+  printf("  Headroom is depth minus the maximum fill seen; Empty is the share of samples with the FIFO empty\n");
+  printf("  (for command FIFOs fed by stream threads, time spent empty while a run is active risks underflow).\n");
+}
@@ -0,0 +1,48 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "file_scan.h"
+
+int mapped_file_open(const char* path, mapped_file_t* file) {
+  file->data = NULL;
+  file->size = 0;
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return -1;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    int err = errno;
+    close(fd);
+    errno = err;
+    return -1;
+  }
+  if (!S_ISREG(st.st_mode)) {
+    close(fd);
+    errno = EINVAL;
+    return -1;
+  }
+  if (st.st_size == 0) {
+    close(fd);
+    return 0; // mmap can't map zero bytes; an empty file is simply no lines
+  }
+
+  void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  int err = errno;
+  close(fd); // The mapping stays valid
+  if (data == MAP_FAILED) {
+    errno = err;
+    return -1;
+  }
+  madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+  file->data = data;
+  file->size = (size_t)st.st_size;
+  return 0;
+}
+
+void mapped_file_close(mapped_file_t* file) {
+  if (file->data != NULL) munmap((void*)file->data, file->size);
+  file->data = NULL;
+  file->size = 0;
+}
@@ -0,0 +1,290 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "live_ring.h"
+#include "timing.h"
+
+// Round up to a power of two within [1, LIVE_RING_MAX_RECORDS]
+static uint32_t ring_capacity(uint32_t records) {
+  uint32_t capacity = 1;
+  if (records > LIVE_RING_MAX_RECORDS) records = LIVE_RING_MAX_RECORDS;
+  while (capacity < records) capacity <<= 1;
+  return capacity;
+}
+
+static uint64_t align64(uint64_t offset) {
+  return (offset + 63) & ~(uint64_t)63;
+}
+
+live_ring_t* live_ring_create(const char* name, uint32_t adc_frames, uint32_t trig_records, bool verbose) {
+  uint32_t adc_capacity = ring_capacity(adc_frames);
+  uint32_t trig_capacity = ring_capacity(trig_records);
+
+  // Lay out the segment: header, control blocks, then each ring's records
+  live_ring_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, LIVE_RING_MAGIC, sizeof(header.magic));
+  header.version = LIVE_RING_VERSION;
+  header.header_bytes = sizeof(live_ring_header_t);
+  header.adc_record_bytes = sizeof(live_adc_record_t);
+  header.trig_record_bytes = sizeof(live_trig_record_t);
+  header.ctrl_offset = align64(sizeof(live_ring_header_t));
+  uint64_t offset = header.ctrl_offset + (LIVE_RING_ADC_RINGS + 1) * sizeof(live_ring_ctrl_t);
+  for (int board = 0; board < LIVE_RING_ADC_RINGS; board++) {
+    header.adc_offset[board] = align64(offset);
+    offset = header.adc_offset[board] + (uint64_t)adc_capacity * sizeof(live_adc_record_t);
+  }
+  header.trig_offset = align64(offset);
+  header.segment_bytes = header.trig_offset + (uint64_t)trig_capacity * sizeof(live_trig_record_t);
+
+  live_ring_t* ring = calloc(1, sizeof(live_ring_t));
+  if (ring == NULL) {
+    fprintf(stderr, "Failed to allocate live ring handle\n");
+    return NULL;
+  }
+  snprintf(ring->name, sizeof(ring->name), "%s", name);
+
+  // Replace any segment left behind by an earlier run so readers never see a stale layout
+  shm_unlink(name);
+  int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to create shared memory segment '%s': %s\n", name, strerror(errno));
+    free(ring);
+    return NULL;
+  }
+  fchmod(fd, 0644); // Readable by local tools regardless of umask
+  if (ftruncate(fd, (off_t)header.segment_bytes) != 0) {
+    fprintf(stderr, "Failed to size shared memory segment '%s' to %llu bytes: %s\n",
+            name, header.segment_bytes, strerror(errno));
+    close(fd);
+    shm_unlink(name);
+    free(ring);
+    return NULL;
+  }
+  void* base = mmap(NULL, header.segment_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    fprintf(stderr, "Failed to map shared memory segment '%s': %s\n", name, strerror(errno));
+    shm_unlink(name);
+    free(ring);
+    return NULL;
+  }
+
+  // ftruncate zero-fills, so only the header and capacities need writing
+  ring->base = (uint8_t*)base;
+  ring->segment_bytes = header.segment_bytes;
+  ring->ctrl = (live_ring_ctrl_t*)(ring->base + header.ctrl_offset);
+  for (int board = 0; board < LIVE_RING_ADC_RINGS; board++) {
+    ring->adc[board] = (live_adc_record_t*)(ring->base + header.adc_offset[board]);
+    ring->ctrl[board].capacity = adc_capacity;
+  }
+  ring->trig = (live_trig_record_t*)(ring->base + header.trig_offset);
+  ring->ctrl[LIVE_RING_ADC_RINGS].capacity = trig_capacity;
+
+  // Magic last, so a reader that checks it sees a complete layout
+  memcpy(ring->base + sizeof(header.magic), (uint8_t*)&header + sizeof(header.magic), sizeof(header) - sizeof(header.magic));
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy(ring->base, header.magic, sizeof(header.magic));
+
+  if (verbose) {
+    printf("Live ring '%s': %llu bytes, %u frames per ADC board, %u triggers\n",
+           name, header.segment_bytes, adc_capacity, trig_capacity);
+  }
+  return ring;
+}
+
+void live_ring_destroy(live_ring_t* ring) {
+  if (ring == NULL) return;
+  munmap(ring->base, ring->segment_bytes);
+  shm_unlink(ring->name);
+  free(ring);
+}
+
+void live_ring_adc_begin(live_ring_t* ring, uint8_t board, const adc_index_schedule_t* schedule) {
+  if (ring == NULL || board >= LIVE_RING_ADC_RINGS) return;
+  ring->adc_state[board].pending_count = 0;
+  ring->adc_state[board].frame = 0;
+  ring->adc_state[board].segment = 0;
+  ring->adc_state[board].segment_end = (schedule != NULL && schedule->frames != NULL) ? schedule->frames[0] : 0;
+  __atomic_add_fetch(&ring->ctrl[board].stream, 1, __ATOMIC_RELEASE);
+}
+
+// Publish one complete frame to a board's ring
+static void publish_adc_frame(live_ring_t* ring, uint8_t board, const adc_index_schedule_t* schedule,
+                              const uint32_t* frame_words, uint64_t now_ns) {
+  live_ring_ctrl_t* ctrl = &ring->ctrl[board];
+  uint64_t frame = ring->adc_state[board].frame++;
+
+  // Advance the trigger segment past any segments that end at or before this frame
+  uint64_t trigger = LIVE_RING_NO_TRIGGER;
+  if (schedule != NULL && schedule->frames != NULL) {
+    while (frame >= ring->adc_state[board].segment_end && ring->adc_state[board].segment + 1 < schedule->segment_count) {
+      ring->adc_state[board].segment++;
+      ring->adc_state[board].segment_end += schedule->frames[ring->adc_state[board].segment];
+    }
+    trigger = ring->adc_state[board].segment;
+  }
+
+  uint64_t seq = ctrl->head + 1;
+  live_adc_record_t* record = &ring->adc[board][(seq - 1) & (ctrl->capacity - 1)];
+  __atomic_store_n(&record->seq, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  record->stream = ctrl->stream;
+  record->board = board;
+  record->frame = frame;
+  record->trigger = trigger;
+  record->publish_ns = now_ns;
+  memcpy(record->samples, frame_words, sizeof(record->samples));
+  __atomic_store_n(&record->seq, seq, __ATOMIC_RELEASE);
+  __atomic_store_n(&ctrl->head, seq, __ATOMIC_RELEASE);
+}
+
+void live_ring_adc_publish(live_ring_t* ring, uint8_t board, const adc_index_schedule_t* schedule,
+                           const uint32_t* words, uint32_t count) {
+  if (ring == NULL || board >= LIVE_RING_ADC_RINGS || count == 0) return;
+  uint64_t now_ns = timing_now_ns();
+  uint32_t i = 0;
+
+  // Finish a frame left over from the previous read
+  uint32_t* pending = ring->adc_state[board].pending;
+  while (ring->adc_state[board].pending_count > 0 && i < count) {
+    pending[ring->adc_state[board].pending_count++] = words[i++];
+    if (ring->adc_state[board].pending_count == ADC_INDEX_WORDS_PER_FRAME) {
+      publish_adc_frame(ring, board, schedule, pending, now_ns);
+      ring->adc_state[board].pending_count = 0;
+      break;
+    }
+  }
+
+  for (; i + ADC_INDEX_WORDS_PER_FRAME <= count; i += ADC_INDEX_WORDS_PER_FRAME) {
+    publish_adc_frame(ring, board, schedule, &words[i], now_ns);
+  }
+
+  while (i < count) {
+    pending[ring->adc_state[board].pending_count++] = words[i++];
+  }
+}
+
+void live_ring_trig_begin(live_ring_t* ring) {
+  if (ring == NULL) return;
+  ring->trig_count = 0;
+  __atomic_add_fetch(&ring->ctrl[LIVE_RING_ADC_RINGS].stream, 1, __ATOMIC_RELEASE);
+}
+
+void live_ring_trig_publish(live_ring_t* ring, uint64_t timestamp) {
+  if (ring == NULL) return;
+  live_ring_ctrl_t* ctrl = &ring->ctrl[LIVE_RING_ADC_RINGS];
+  uint64_t seq = ctrl->head + 1;
+  live_trig_record_t* record = &ring->trig[(seq - 1) & (ctrl->capacity - 1)];
+  __atomic_store_n(&record->seq, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  record->stream = ctrl->stream;
+  record->trigger = ++ring->trig_count;
+  record->timestamp = timestamp;
+  record->publish_ns = timing_now_ns();
+  __atomic_store_n(&record->seq, seq, __ATOMIC_RELEASE);
+  __atomic_store_n(&ctrl->head, seq, __ATOMIC_RELEASE);
+}
+
+int live_ring_attach(const char* name, live_ring_reader_t* reader) {
+  memset(reader, 0, sizeof(*reader));
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to open shared memory segment '%s': %s\n", name, strerror(errno));
+    return -1;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(live_ring_header_t)) {
+    fprintf(stderr, "Shared memory segment '%s' is not a live ring\n", name);
+    close(fd);
+    return -1;
+  }
+  void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    fprintf(stderr, "Failed to map shared memory segment '%s': %s\n", name, strerror(errno));
+    return -1;
+  }
+
+  reader->base = (const uint8_t*)base;
+  reader->segment_bytes = (uint64_t)st.st_size;
+  reader->header = (const live_ring_header_t*)base;
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  if (memcmp(reader->header->magic, LIVE_RING_MAGIC, sizeof(reader->header->magic)) != 0 ||
+      reader->header->version != LIVE_RING_VERSION || reader->header->segment_bytes > reader->segment_bytes) {
+    fprintf(stderr, "Shared memory segment '%s' is not a version %u live ring\n", name, LIVE_RING_VERSION);
+    live_ring_detach(reader);
+    return -1;
+  }
+  reader->ctrl = (const live_ring_ctrl_t*)(reader->base + reader->header->ctrl_offset);
+  return 0;
+}
+
+void live_ring_detach(live_ring_reader_t* reader) {
+  if (reader->base != NULL) {
+    munmap((void*)reader->base, reader->segment_bytes);
+  }
+  memset(reader, 0, sizeof(*reader));
+}
+
+// Copy records from one ring; records start with their volatile uint64_t sequence number
+static int read_ring(const live_ring_ctrl_t* ctrl, const uint8_t* records, size_t record_bytes,
+                     uint64_t* next_seq, void* out, int max, uint64_t* dropped) {
+  uint64_t head = __atomic_load_n(&ctrl->head, __ATOMIC_ACQUIRE);
+  uint64_t capacity = ctrl->capacity;
+  int copied = 0;
+  if (*next_seq == 0) *next_seq = 1;
+
+  while (copied < max && *next_seq <= head) {
+    // Too far behind: the oldest records have been overwritten
+    if (head - *next_seq >= capacity) {
+      uint64_t oldest = head - capacity + 1;
+      if (dropped) *dropped += oldest - *next_seq;
+      *next_seq = oldest;
+    }
+    uint64_t seq = *next_seq;
+    const uint8_t* slot = records + ((seq - 1) & (capacity - 1)) * record_bytes;
+    const volatile uint64_t* slot_seq = (const volatile uint64_t*)slot;
+    uint8_t* dest = (uint8_t*)out + (size_t)copied * record_bytes;
+
+    if (__atomic_load_n(slot_seq, __ATOMIC_ACQUIRE) == seq) {
+      memcpy(dest, slot, record_bytes);
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(slot_seq, __ATOMIC_RELAXED) == seq) {
+        copied++;
+        (*next_seq)++;
+        continue;
+      }
+    }
+    // Lapped while copying; re-read the head and skip to the oldest record still in the ring
+    head = __atomic_load_n(&ctrl->head, __ATOMIC_ACQUIRE);
+    if (head - seq < capacity) {
+      // The slot was overwritten after all, so the whole ring has turned over
+      uint64_t oldest = head >= capacity ? head - capacity + 1 : 1;
+      if (oldest <= seq) oldest = seq + 1;
+      if (dropped) *dropped += oldest - seq;
+      *next_seq = oldest;
+    }
+  }
+  return copied;
+}
+
+int live_ring_read_adc(const live_ring_reader_t* reader, uint8_t board, uint64_t* next_seq,
+                       live_adc_record_t* out, int max, uint64_t* dropped) {
+  if (reader->base == NULL || board >= LIVE_RING_ADC_RINGS) return -1;
+  return read_ring(&reader->ctrl[board], reader->base + reader->header->adc_offset[board],
+                   sizeof(live_adc_record_t), next_seq, out, max, dropped);
+}
+
+int live_ring_read_trig(const live_ring_reader_t* reader, uint64_t* next_seq,
+                        live_trig_record_t* out, int max, uint64_t* dropped) {
+  if (reader->base == NULL) return -1;
+  return read_ring(&reader->ctrl[LIVE_RING_ADC_RINGS], reader->base + reader->header->trig_offset,
+                   sizeof(live_trig_record_t), next_seq, out, max, dropped);
+}
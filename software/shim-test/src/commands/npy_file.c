@@ -0,0 +1,62 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include "npy_file.h"
+
+// Write the fixed-size header: magic, version 1.0, header length, then the dict padded with spaces and a newline
+int npy_write_header(FILE* file, const char* descr, uint64_t rows, uint32_t cols) {
+  char shape[64];
+  if (cols == 0) {
+    snprintf(shape, sizeof(shape), "(%llu,)", (unsigned long long)rows);
+  } else {
+    snprintf(shape, sizeof(shape), "(%llu, %u)", (unsigned long long)rows, cols);
+  }
+
+  char header[NPY_HEADER_BYTES];
+  memset(header, ' ', sizeof(header));
+  memcpy(header, "\x93NUMPY\x01\x00", 8);
+  uint16_t dict_len = NPY_HEADER_BYTES - 10;
+  header[8] = (char)(dict_len & 0xFF);
+  header[9] = (char)(dict_len >> 8);
+  int written = snprintf(header + 10, dict_len, "{'descr': '%s', 'fortran_order': False, 'shape': %s, }", descr, shape);
+  if (written < 0 || written >= dict_len) {
+    fprintf(stderr, "NPY header too long for shape %s\n", shape);
+    return -1;
+  }
+  header[10 + written] = ' '; // Overwrite snprintf's terminator with padding
+  header[NPY_HEADER_BYTES - 1] = '\n';
+
+  if (fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+    fprintf(stderr, "Failed to write NPY header: %s\n", strerror(errno));
+    return -1;
+  }
+  return 0;
+}
+
+int npy_finalize(FILE* file, const char* descr, uint64_t rows, uint32_t cols, uint32_t row_bytes) {
+  if (fflush(file) != 0) {
+    fprintf(stderr, "Failed to flush NPY data: %s\n", strerror(errno));
+    return -1;
+  }
+
+  // A stream stopped mid-row leaves a partial row that the header must not cover
+  off_t data_end = (off_t)(NPY_HEADER_BYTES + rows * row_bytes);
+  if (ftruncate(fileno(file), data_end) != 0) {
+    fprintf(stderr, "Failed to trim NPY data: %s\n", strerror(errno));
+    return -1;
+  }
+
+  if (fseeko(file, 0, SEEK_SET) != 0 || npy_write_header(file, descr, rows, cols) != 0) {
+    fprintf(stderr, "Failed to patch NPY header\n");
+    return -1;
+  }
+  return fseeko(file, data_end, SEEK_SET);
+}
+
+bool npy_path(const char* path) {
+  size_t len = strlen(path);
+  size_t ext_len = strlen(NPY_EXTENSION);
+  return len >= ext_len && strcmp(path + len - ext_len, NPY_EXTENSION) == 0;
+}
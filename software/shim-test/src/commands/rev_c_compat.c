@@ -537,7 +537,6 @@ int cmd_rev_c_compat(const char** args, int arg_count, const command_flag_t* fla
   } else {
     printf("Resetting all buffers\n");
     safe_buffer_reset(ctx, *(ctx->verbose));
-    usleep(10000); // 10ms
   }
 
   // Check that boards 0-3 are connected
@@ -1038,7 +1037,7 @@ int cmd_rev_c_compat(const char** args, int arg_count, const command_flag_t* fla
   if (*(ctx->verbose)) {
     printf("Rev C [VERBOSE]: Resetting trigger count after sync\n");
   }
-  trigger_cmd_reset_count(ctx->trigger_ctrl, *(ctx->verbose));
+  trigger_cmd_reset_count(ctx->trigger_ctrl, false, *(ctx->verbose));
 
   // Set trigger lockout
   if (*(ctx->verbose)) {
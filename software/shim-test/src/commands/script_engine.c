@@ -0,0 +1,395 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "script_engine.h"
+#include "command_handler.h"
+#include "command_helper.h"
+#include "sys_sts.h"
+#include "dac_dma.h"
+#include "timing.h"
+
+// One script step: a single command line, or the lines of a parallel block
+typedef struct {
+  char lines[SCRIPT_MAX_PARALLEL][SCRIPT_LINE_MAX];
+  int line_numbers[SCRIPT_MAX_PARALLEL];
+  int count;
+} script_step_t;
+
+// Arguments and result for one command of a parallel block
+typedef struct {
+  const char* line;
+  command_context_t* ctx;
+  int result;
+} script_thread_data_t;
+
+// Commands of a parallel block that aren't reentrant: they power or reset the system, write the shared
+// buffer reset, control or clock registers, take over the hardware (experiments, calibration), or own
+// process-wide state (logs, traces, telemetry, scheduling, nested scripts). These hold the block's lock
+// exclusively. Every other command holds it shared, so per-board FIFO and stream commands overlap.
+static const char* const script_exclusive_commands[] = {
+  "ctrl_on", "pow_on", "off", "hard_reset", "set_boot_test_skip", "set_debug", "set_cmd_buf_reset",
+  "set_data_buf_reset", "set_thresh_window", "set_thresh_average", "set_thresh_en",
+  "set_clk_fb_mult", "set_clk_fb", "set_clk_fb_div", "set_clk_div", "clk_load_default", "clk_load_user",
+  "clk_set", "clk_optimize", "get_dac_cal", "stop_dac_dma", "dac_zero", "set_dac_cal_init",
+  "toggle_dac_pre_delay", "live_ring_open", "live_ring_close", "fifo_telemetry_start", "fifo_telemetry_stop",
+  "rt_enable", "rt_disable", "trace_start", "trace_stop", "channel_test", "channel_cal", "find_bias",
+  "save_adc_bias", "load_adc_bias", "waveform_test", "fieldmap", "stop_fieldmap", "stop_trigger_monitor",
+  "stop_waveform", "rev_c_compat", "thresh_sim", "latency_test", "log_commands", "stop_log", "load_commands",
+};
+static pthread_rwlock_t script_command_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+// Whether a script line runs a command from script_exclusive_commands
+static bool script_line_exclusive(const char* line) {
+  size_t len = strcspn(line, " \t");
+  for (size_t i = 0; i < sizeof(script_exclusive_commands) / sizeof(script_exclusive_commands[0]); i++) {
+    if (strlen(script_exclusive_commands[i]) == len && strncmp(line, script_exclusive_commands[i], len) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Monotonic time in milliseconds
+static double script_now_ms(void) {
+  return (double)timing_now_ns() / 1e6;
+}
+
+// Strip the newline and surrounding whitespace from a script line in place, returning the trimmed start
+static char* script_trim(char* line) {
+  char* start = line;
+  while (*start == ' ' || *start == '\t') start++;
+  size_t len = strlen(start);
+  while (len > 0 && (start[len - 1] == '\n' || start[len - 1] == '\r' || start[len - 1] == ' ' || start[len - 1] == '\t')) {
+    start[--len] = '\0';
+  }
+  return start;
+}
+
+// Thread body for one command of a parallel block
+static void* script_thread_func(void* arg) {
+  script_thread_data_t* data = (script_thread_data_t*)arg;
+  // wait_* commands only poll status registers and stream flags, so they take no lock
+  bool locked = strncmp(data->line, "wait_", 5) != 0;
+  if (locked) {
+    if (script_line_exclusive(data->line)) {
+      pthread_rwlock_wrlock(&script_command_lock);
+    } else {
+      pthread_rwlock_rdlock(&script_command_lock);
+    }
+  }
+  data->result = execute_command(data->line, data->ctx);
+  if (locked) pthread_rwlock_unlock(&script_command_lock);
+  return NULL;
+}
+
+// Wait for every command FIFO that isn't fed by a stream thread or DMA to drain, then let the last popped
+// command execute. Bounded by SCRIPT_PACE_TIMEOUT_US; returns -1 if a FIFO was still busy.
+static int script_pace(command_context_t* ctx) {
+  uint32_t cmd_mask = SYS_STS_BUF_MASK_TRIG;
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (!ctx->dac_cmd_stream_running[board] && !dac_dma_busy(ctx->dac_dma, (uint8_t)board)) {
+      cmd_mask |= 1U << (2 * board);
+    }
+    if (!ctx->adc_cmd_stream_running[board]) {
+      cmd_mask |= 1U << (2 * board + 1);
+    }
+  }
+  int result = sys_sts_wait_for_fifos_empty(ctx->sys_sts, cmd_mask, 0, SCRIPT_PACE_TIMEOUT_US, false);
+  usleep(SCRIPT_PACE_SETTLE_US);
+  return result;
+}
+
+// Run one step. Returns 0 on success, or -1 with *failed_line set to the first failing line number.
+static int script_run_step(const script_step_t* step, command_context_t* ctx, int* failed_line) {
+  if (step->count == 1) {
+    if (execute_command(step->lines[0], ctx) != 0) {
+      *failed_line = step->line_numbers[0];
+      return -1;
+    }
+    return 0;
+  }
+
+  pthread_t threads[SCRIPT_MAX_PARALLEL];
+  script_thread_data_t data[SCRIPT_MAX_PARALLEL];
+  bool started[SCRIPT_MAX_PARALLEL];
+  for (int i = 0; i < step->count; i++) {
+    data[i].line = step->lines[i];
+    data[i].ctx = ctx;
+    data[i].result = -1;
+    started[i] = (pthread_create(&threads[i], NULL, script_thread_func, &data[i]) == 0);
+    if (!started[i]) {
+      fprintf(stderr, "Failed to start thread for line %d: %s\n", step->line_numbers[i], strerror(errno));
+    }
+  }
+
+  int result = 0;
+  for (int i = 0; i < step->count; i++) {
+    if (started[i]) {
+      pthread_join(threads[i], NULL);
+    }
+    if (data[i].result != 0 && result == 0) {
+      *failed_line = step->line_numbers[i];
+      result = -1;
+    }
+  }
+  return result;
+}
+
+int script_run_file(const char* path, command_context_t* ctx, bool pace) {
+  FILE* file = fopen(path, "r");
+  if (file == NULL) {
+    fprintf(stderr, "Failed to open command file '%s' for reading: %s\n", path, strerror(errno));
+    return -1;
+  }
+
+  // Steps are large (a full parallel block of lines), so keep the one in use off the stack
+  script_step_t* step = malloc(sizeof(script_step_t));
+  if (step == NULL) {
+    fprintf(stderr, "Failed to allocate memory for script step\n");
+    fclose(file);
+    return -1;
+  }
+
+  char raw[SCRIPT_LINE_MAX];
+  int line_number = 0;
+  int steps_run = 0;
+  int commands_executed = 0;
+  bool in_parallel = false;
+  int parallel_start_line = 0;
+  int result = 0;
+  double script_start_ms = script_now_ms();
+
+  step->count = 0;
+  while (fgets(raw, sizeof(raw), file) != NULL) {
+    line_number++;
+    char* line = script_trim(raw);
+
+    // Skip empty lines and lines starting with # (comments)
+    if (strlen(line) == 0 || line[0] == '#') {
+      continue;
+    }
+
+    // Parallel block delimiters
+    if (strcmp(line, "parallel") == 0) {
+      if (in_parallel) {
+        fprintf(stderr, "Line %d: parallel blocks cannot be nested\n", line_number);
+        result = -1;
+        break;
+      }
+      in_parallel = true;
+      parallel_start_line = line_number;
+      step->count = 0;
+      continue;
+    }
+    if (strcmp(line, "end") == 0) {
+      if (!in_parallel) {
+        fprintf(stderr, "Line %d: 'end' without a matching 'parallel'\n", line_number);
+        result = -1;
+        break;
+      }
+      in_parallel = false;
+      if (step->count == 0) {
+        continue;
+      }
+    } else {
+      if (step->count >= SCRIPT_MAX_PARALLEL) {
+        fprintf(stderr, "Line %d: parallel block starting at line %d has more than %d commands\n",
+                line_number, parallel_start_line, SCRIPT_MAX_PARALLEL);
+        result = -1;
+        break;
+      }
+      strcpy(step->lines[step->count], line);
+      step->line_numbers[step->count] = line_number;
+      step->count++;
+      if (in_parallel) {
+        continue; // Run once the block is closed
+      }
+    }
+
+    // Run the step and report its time
+    if (step->count == 1) {
+      printf("Executing line %d: %s\n", step->line_numbers[0], step->lines[0]);
+    } else {
+      printf("Executing parallel block (lines %d-%d, %d commands)\n", parallel_start_line, line_number, step->count);
+    }
+    double step_start_ms = script_now_ms();
+    int failed_line = 0;
+    if (script_run_step(step, ctx, &failed_line) != 0) {
+      fprintf(stderr, "Command failed at line %d\n", failed_line);
+      result = -1;
+      break;
+    }
+    double step_ms = script_now_ms() - step_start_ms;
+    if (step->count == 1) {
+      printf("  line %d done in %.3f ms\n", step->line_numbers[0], step_ms);
+    } else {
+      printf("  parallel block (lines %d-%d) done in %.3f ms\n", parallel_start_line, line_number, step_ms);
+    }
+    steps_run++;
+    commands_executed += step->count;
+    if (pace && script_pace(ctx) != 0) {
+      printf("Note: command FIFOs still busy after line %d, continuing.\n", line_number);
+    }
+    step->count = 0;
+  }
+
+  if (result == 0 && in_parallel) {
+    fprintf(stderr, "Parallel block starting at line %d is missing 'end'\n", parallel_start_line);
+    result = -1;
+  }
+
+  free(step);
+  fclose(file);
+
+  if (result == 0) {
+    printf("Executed %d commands in %d steps from '%s' in %.3f ms.\n",
+           commands_executed, steps_run, path, script_now_ms() - script_start_ms);
+  }
+  return result;
+}
+
+// Parse an optional timeout argument in milliseconds into microseconds
+static int parse_timeout_arg(const char** args, int arg_count, int index, uint32_t* timeout_us) {
+  uint32_t timeout_ms = SCRIPT_DEFAULT_TIMEOUT_MS;
+  if (arg_count > index) {
+    char* endptr;
+    timeout_ms = parse_value(args[index], &endptr);
+    if (*endptr != '\0' || timeout_ms == 0 || timeout_ms > SCRIPT_MAX_TIMEOUT_MS) {
+      fprintf(stderr, "Invalid timeout '%s'. Must be 1-%u ms.\n", args[index], SCRIPT_MAX_TIMEOUT_MS);
+      return -1;
+    }
+  }
+  *timeout_us = timeout_ms * 1000;
+  return 0;
+}
+
+// Parse a board argument ("all" or a board number) into a board mask (bit b for board b)
+static int parse_board_mask_arg(const char* arg, uint32_t* board_mask) {
+  if (strcmp(arg, "all") == 0) {
+    *board_mask = (1U << SHIM_MAX_BOARDS) - 1;
+    return 0;
+  }
+  int board = validate_board_number(arg);
+  if (board < 0) {
+    return -1;
+  }
+  *board_mask = 1U << board;
+  return 0;
+}
+
+int cmd_wait_empty(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  bool dac = strcmp(args[0], "dac") == 0 || strcmp(args[0], "all") == 0;
+  bool adc = strcmp(args[0], "adc") == 0 || strcmp(args[0], "all") == 0;
+  bool trig = strcmp(args[0], "trig") == 0 || strcmp(args[0], "all") == 0;
+  if (!dac && !adc && !trig) {
+    fprintf(stderr, "Invalid FIFO type '%s'. Must be dac, adc, trig or all.\n", args[0]);
+    return -1;
+  }
+
+  uint32_t board_mask;
+  uint32_t timeout_us;
+  if (parse_board_mask_arg(args[1], &board_mask) != 0 || parse_timeout_arg(args, arg_count, 2, &timeout_us) != 0) {
+    return -1;
+  }
+
+  // Build the buffer mask (DAC board b is bit 2b, ADC board b is bit 2b+1, then the trigger)
+  uint32_t cmd_mask = trig ? SYS_STS_BUF_MASK_TRIG : 0;
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (board_mask & (1U << board)) {
+      if (dac) cmd_mask |= 1U << (2 * board);
+      if (adc) cmd_mask |= 1U << (2 * board + 1);
+    }
+  }
+  return sys_sts_wait_for_fifos_empty(ctx->sys_sts, cmd_mask, 0, timeout_us, *(ctx->verbose));
+}
+
+int cmd_wait_triggers(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  char* endptr;
+  uint32_t count = parse_value(args[0], &endptr);
+  if (*endptr != '\0' || count == 0) {
+    fprintf(stderr, "Invalid trigger count '%s'. Must be a positive number.\n", args[0]);
+    return -1;
+  }
+  uint32_t timeout_us;
+  if (parse_timeout_arg(args, arg_count, 1, &timeout_us) != 0) {
+    return -1;
+  }
+
+  uint32_t start_count = sys_sts_get_trig_count(ctx->sys_sts, false);
+  return sys_sts_wait_for_trig_count(ctx->sys_sts, start_count + count, timeout_us, *(ctx->verbose));
+}
+
+int cmd_wait_state(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  char* endptr;
+  uint32_t state = parse_value(args[0], &endptr);
+  if (*endptr != '\0' || state < S_IDLE || state > S_HALTED) {
+    fprintf(stderr, "Invalid state code '%s'. Must be %u-%u (see 'sts').\n", args[0], S_IDLE, S_HALTED);
+    return -1;
+  }
+  uint32_t timeout_us;
+  if (parse_timeout_arg(args, arg_count, 1, &timeout_us) != 0) {
+    return -1;
+  }
+  return sys_sts_wait_for_state(ctx->sys_sts, state, timeout_us, *(ctx->verbose));
+}
+
+// Whether any selected stream thread of a type is still running
+static bool streams_running(command_context_t* ctx, const char* type, uint32_t board_mask) {
+  __sync_synchronize(); // Running flags are cleared by the stream threads
+  if (strcmp(type, "trig") == 0) {
+    return ctx->trig_data_stream_running;
+  }
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (!(board_mask & (1U << board))) continue;
+    if ((strcmp(type, "dac") == 0 && ctx->dac_cmd_stream_running[board]) ||
+        (strcmp(type, "adc") == 0 && ctx->adc_cmd_stream_running[board]) ||
+        (strcmp(type, "dac_debug") == 0 && ctx->dac_debug_stream_running[board]) ||
+        (strcmp(type, "adc_data") == 0 && ctx->adc_data_stream_running[board])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int cmd_wait_stream(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  const char* type = args[0];
+  if (strcmp(type, "dac") != 0 && strcmp(type, "adc") != 0 && strcmp(type, "dac_debug") != 0 &&
+      strcmp(type, "adc_data") != 0 && strcmp(type, "trig") != 0) {
+    fprintf(stderr, "Invalid stream type '%s'. Must be dac, adc, dac_debug, adc_data or trig.\n", type);
+    return -1;
+  }
+
+  uint32_t board_mask;
+  uint32_t timeout_us;
+  if (parse_board_mask_arg(args[1], &board_mask) != 0 || parse_timeout_arg(args, arg_count, 2, &timeout_us) != 0) {
+    return -1;
+  }
+
+  double start_ms = script_now_ms();
+  while (streams_running(ctx, type, board_mask)) {
+    double elapsed_ms = script_now_ms() - start_ms;
+    if (elapsed_ms * 1000.0 >= timeout_us) {
+      fprintf(stderr, "Timed out after %.3f ms waiting for %s stream(s) on %s to finish.\n", elapsed_ms, type, args[1]);
+      return -1;
+    }
+    usleep(1000); // Stream threads finish on file or FIFO timescales, so poll at 1 ms
+  }
+  if (*(ctx->verbose)) {
+    printf("%s stream(s) on %s finished after %.3f ms\n", type, args[1], script_now_ms() - start_ms);
+  }
+  return 0;
+}
+
+int cmd_wait_ms(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  char* endptr;
+  uint32_t ms = parse_value(args[0], &endptr);
+  if (*endptr != '\0' || ms > SCRIPT_MAX_TIMEOUT_MS) {
+    fprintf(stderr, "Invalid delay '%s'. Must be 0-%u ms.\n", args[0], SCRIPT_MAX_TIMEOUT_MS);
+    return -1;
+  }
+  usleep(ms * 1000);
+  return 0;
+}
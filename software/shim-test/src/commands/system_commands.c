@@ -15,6 +15,10 @@
 #include "sys_sts.h"
 #include "sys_ctrl.h"
 #include "clk_ctrl.h"
+#include "live_ring.h"
+#include "fifo_telemetry.h"
+#include "thread_trace.h"
+#include "rt_sched.h"
 
 // Basic system commands
 int cmd_verbose(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
@@ -81,7 +85,7 @@ int cmd_hard_reset(const char** args, int arg_count, const command_flag_t* flags
     ctx->trig_data_stream_running = false;
   }
 
-  for (int board = 0; board < 8; board++) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
     // Stop DAC streams
     if (ctx->dac_cmd_stream_running[board]) {
       printf("    Stopping DAC command stream for board %d\n", board);
@@ -92,6 +96,12 @@ int cmd_hard_reset(const char** args, int arg_count, const command_flag_t* flags
       ctx->dac_cmd_stream_running[board] = false;
     }
 
+    // Stop DAC DMA (an idle or finished engine is just reset)
+    if (dac_dma_busy(ctx->dac_dma, (uint8_t)board)) {
+      printf("    Stopping DAC DMA for board %d\n", board);
+    }
+    dac_dma_stop(ctx->dac_dma, (uint8_t)board, *(ctx->verbose));
+
     // Stop DAC debug streams
     if (ctx->dac_debug_stream_running[board]) {
       printf("    Stopping DAC debug stream for board %d\n", board);
@@ -132,17 +142,21 @@ int cmd_hard_reset(const char** args, int arg_count, const command_flag_t* flags
   sys_ctrl_turn_off(ctx->sys_ctrl, *(ctx->verbose));
   usleep(1000); // 1ms
 
-  // Set buffer resets to 0x1FFFF
-  printf("  Setting buffer resets to 0x1FFFF\n");
-  sys_ctrl_set_cmd_buf_reset(ctx->sys_ctrl, 0x1FFFF, *(ctx->verbose));
-  sys_ctrl_set_data_buf_reset(ctx->sys_ctrl, 0x1FFFF, *(ctx->verbose));
-  usleep(10000); // 10ms
+  // Set all buffer resets
+  printf("  Setting buffer resets to 0x%X\n", SYS_STS_BUF_MASK_ALL);
+  sys_ctrl_set_cmd_buf_reset(ctx->sys_ctrl, SYS_STS_BUF_MASK_ALL, *(ctx->verbose));
+  sys_ctrl_set_data_buf_reset(ctx->sys_ctrl, SYS_STS_BUF_MASK_ALL, *(ctx->verbose));
+  sys_sts_hold_buf_reset(ctx->sys_sts, SYS_STS_BUF_MASK_ALL, SYS_STS_BUF_MASK_ALL, SYS_STS_BUF_RESET_TIMEOUT_US,
+                         *(ctx->verbose));
 
   // Set buffer resets to 0
   printf("  Setting buffer resets to 0\n");
   sys_ctrl_set_cmd_buf_reset(ctx->sys_ctrl, 0, *(ctx->verbose));
   sys_ctrl_set_data_buf_reset(ctx->sys_ctrl, 0, *(ctx->verbose));
-  usleep(10000); // 10ms
+  usleep(SYS_STS_BUF_RESET_SETTLE_US);
+
+  // Turning the system off reset the trigger core, and its logged words are gone
+  trigger_reset_decoder(ctx->trigger_ctrl, true);
 
   printf("Hard reset completed.\n");
 
@@ -203,11 +217,13 @@ int cmd_set_cmd_buf_reset(const char** args, int arg_count, const command_flag_t
     return -1;
   }
 
-  if (value > 0x1FFFF) {
-    fprintf(stderr, "Value out of range: %u (valid range: 0 - 131071)\n", value);
+  if (value > SYS_STS_BUF_MASK_ALL) {
+    fprintf(stderr, "Value out of range: %u (valid range: 0 - %u)\n", value, SYS_STS_BUF_MASK_ALL);
     return -1;
   }
 
+  // A DMA feeding a DAC command buffer would keep refilling it, or resume mid-command after the reset
+  dac_dma_stop_masked(ctx->dac_dma, value, *(ctx->verbose));
   sys_ctrl_set_cmd_buf_reset(ctx->sys_ctrl, value, *(ctx->verbose));
   printf("Command buffer reset register set to 0x%05X (%u).\n", value, value);
   return 0;
@@ -221,12 +237,16 @@ int cmd_set_data_buf_reset(const char** args, int arg_count, const command_flag_
     return -1;
   }
 
-  if (value > 0x1FFFF) {
-    fprintf(stderr, "Value out of range: %u (valid range: 0 - 131071)\n", value);
+  if (value > SYS_STS_BUF_MASK_ALL) {
+    fprintf(stderr, "Value out of range: %u (valid range: 0 - %u)\n", value, SYS_STS_BUF_MASK_ALL);
     return -1;
   }
 
   sys_ctrl_set_data_buf_reset(ctx->sys_ctrl, value, *(ctx->verbose));
+  // Words already logged are dropped, so the trigger decoder can't continue mid-entry
+  if (value & SYS_STS_BUF_MASK_TRIG) {
+    trigger_reset_decoder(ctx->trigger_ctrl, false);
+  }
   printf("Data buffer reset register set to 0x%05X (%u).\n", value, value);
   return 0;
 }
@@ -407,6 +427,274 @@ int cmd_clk_set(const char** args, int arg_count, const command_flag_t* flags, i
   printf("SPI clock set to target frequency %.3f MHz\n", target_freq_mhz);
   return 0;
 }
+
+// Search the MMCM settings for the SPI clock with the shortest weighted DAC/ADC cycle time
+// The default frequency cap is the 50 MHz the timing-calc cores are specified to
+int cmd_clk_optimize(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  char *endptr;
+  double dac_weight = strtod(args[0], &endptr);
+  if (*endptr != '\0' || dac_weight < 0.0) {
+    fprintf(stderr, "Invalid DAC weight for clk_optimize: '%s'. Must be a non-negative number.\n", args[0]);
+    return -1;
+  }
+  double adc_weight = strtod(args[1], &endptr);
+  if (*endptr != '\0' || adc_weight < 0.0) {
+    fprintf(stderr, "Invalid ADC weight for clk_optimize: '%s'. Must be a non-negative number.\n", args[1]);
+    return -1;
+  }
+  double max_freq_mhz = 50.0;
+  if (arg_count >= 3) {
+    max_freq_mhz = strtod(args[2], &endptr);
+    if (*endptr != '\0' || max_freq_mhz <= 0.0) {
+      fprintf(stderr, "Invalid maximum frequency for clk_optimize: '%s'. Must be a positive number in MHz.\n", args[2]);
+      return -1;
+    }
+  }
+
+  if (clk_ctrl_optimize(ctx->clk_ctrl, ctx->sys_sts, dac_weight, adc_weight, max_freq_mhz * 1e6, *(ctx->verbose)) != 0) {
+    fprintf(stderr, "Failed to optimize SPI clock.\n");
+    return -1;
+  }
+  printf("SPI clock optimized. Check clk_freq and get_min_delay_times once the clock has locked.\n");
+  return 0;
+}
+
+// Whether any stream thread that publishes to the live ring is running
+static bool live_ring_streams_running(command_context_t* ctx) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (ctx->adc_data_stream_running[board]) return true;
+  }
+  return ctx->trig_data_stream_running;
+}
+
+// Open the shared-memory live ring; streams started afterwards publish to it
+int cmd_live_ring_open(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  uint32_t adc_frames = LIVE_RING_DEFAULT_FRAMES;
+  uint32_t trig_records = LIVE_RING_DEFAULT_TRIGGERS;
+  char* endptr;
+  if (arg_count >= 1) {
+    adc_frames = parse_value(args[0], &endptr);
+    if (*endptr != '\0' || adc_frames == 0 || adc_frames > LIVE_RING_MAX_RECORDS) {
+      fprintf(stderr, "Invalid frames per board for live_ring_open: '%s'. Must be 1-%u.\n", args[0], LIVE_RING_MAX_RECORDS);
+      return -1;
+    }
+  }
+  if (arg_count >= 2) {
+    trig_records = parse_value(args[1], &endptr);
+    if (*endptr != '\0' || trig_records == 0 || trig_records > LIVE_RING_MAX_RECORDS) {
+      fprintf(stderr, "Invalid trigger count for live_ring_open: '%s'. Must be 1-%u.\n", args[1], LIVE_RING_MAX_RECORDS);
+      return -1;
+    }
+  }
+  if (ctx->live_ring != NULL) {
+    fprintf(stderr, "Live ring is already open. Close it first with live_ring_close.\n");
+    return -1;
+  }
+  if (live_ring_streams_running(ctx)) {
+    fprintf(stderr, "Cannot open the live ring while ADC or trigger data streams are running.\n");
+    return -1;
+  }
+
+  ctx->live_ring = live_ring_create(LIVE_RING_SHM_NAME, adc_frames, trig_records, *(ctx->verbose));
+  if (ctx->live_ring == NULL) {
+    return -1;
+  }
+  printf("Live ring open at /dev/shm%s (%u frames per ADC board, %u triggers). ADC and trigger streams will publish to it.\n",
+         LIVE_RING_SHM_NAME, ctx->live_ring->ctrl[0].capacity, ctx->live_ring->ctrl[LIVE_RING_ADC_RINGS].capacity);
+  return 0;
+}
+
+// Remove the shared-memory live ring
+int cmd_live_ring_close(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  if (ctx->live_ring == NULL) {
+    printf("Live ring is not open.\n");
+    return -1;
+  }
+  if (live_ring_streams_running(ctx)) {
+    fprintf(stderr, "Cannot close the live ring while ADC or trigger data streams are running.\n");
+    return -1;
+  }
+  live_ring_destroy(ctx->live_ring);
+  ctx->live_ring = NULL;
+  printf("Live ring closed.\n");
+  return 0;
+}
+
+// Start sampling FIFO fill levels into an in-memory ring
+int cmd_fifo_telemetry_start(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  uint32_t rate_hz = FIFO_TELEMETRY_DEFAULT_RATE_HZ;
+  uint32_t seconds = FIFO_TELEMETRY_DEFAULT_SECONDS;
+  char* endptr;
+  if (arg_count >= 1) {
+    rate_hz = parse_value(args[0], &endptr);
+    if (*endptr != '\0' || rate_hz == 0 || rate_hz > FIFO_TELEMETRY_MAX_RATE_HZ) {
+      fprintf(stderr, "Invalid rate for fifo_telemetry_start: '%s'. Must be 1-%u Hz.\n", args[0], FIFO_TELEMETRY_MAX_RATE_HZ);
+      return -1;
+    }
+  }
+  if (arg_count >= 2) {
+    seconds = parse_value(args[1], &endptr);
+    if (*endptr != '\0' || seconds == 0) {
+      fprintf(stderr, "Invalid duration for fifo_telemetry_start: '%s'. Must be a positive number of seconds.\n", args[1]);
+      return -1;
+    }
+  }
+  uint64_t capacity = (uint64_t)rate_hz * seconds;
+  if (capacity > FIFO_TELEMETRY_MAX_SAMPLES) {
+    fprintf(stderr, "FIFO telemetry ring of %llu samples is too large (max %u). Lower the rate or duration.\n",
+            capacity, FIFO_TELEMETRY_MAX_SAMPLES);
+    return -1;
+  }
+  char halt_path[1024] = "";
+  if (arg_count >= 3) {
+    clean_and_expand_path(args[2], halt_path, sizeof(halt_path));
+  }
+  if (ctx->fifo_telemetry != NULL) {
+    fprintf(stderr, "FIFO telemetry is already running. Stop it first with fifo_telemetry_stop.\n");
+    return -1;
+  }
+
+  ctx->fifo_telemetry = fifo_telemetry_start(ctx->sys_sts, rate_hz, (uint32_t)capacity,
+                                             arg_count >= 3 ? halt_path : NULL, *(ctx->verbose));
+  if (ctx->fifo_telemetry == NULL) {
+    return -1;
+  }
+  printf("FIFO telemetry started: %u FIFOs at %u Hz, keeping the last %u s.\n", ctx->fifo_telemetry->fifo_count, rate_hz, seconds);
+  if (arg_count >= 3) {
+    printf("The ring will be written to %s when the hardware leaves the running state.\n", halt_path);
+  }
+  return 0;
+}
+
+// Write the FIFO telemetry ring to a file and print the fill summary
+int cmd_fifo_telemetry_dump(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  if (ctx->fifo_telemetry == NULL) {
+    fprintf(stderr, "FIFO telemetry is not running. Start it with fifo_telemetry_start.\n");
+    return -1;
+  }
+  char full_path[1024];
+  clean_and_expand_path(args[0], full_path, sizeof(full_path));
+  int64_t records = fifo_telemetry_dump(ctx->fifo_telemetry, full_path, FIFO_TELEMETRY_DUMP_DEMAND);
+  if (records < 0) {
+    return -1;
+  }
+  set_file_permissions(full_path, *(ctx->verbose));
+  printf("Wrote %lld FIFO telemetry samples to %s\n", (long long)records, full_path);
+  fifo_telemetry_print_summary(ctx->fifo_telemetry);
+  return 0;
+}
+
+// Stop FIFO telemetry and print the fill summary
+int cmd_fifo_telemetry_stop(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  if (ctx->fifo_telemetry == NULL) {
+    printf("FIFO telemetry is not running.\n");
+    return -1;
+  }
+  fifo_telemetry_print_summary(ctx->fifo_telemetry);
+  fifo_telemetry_stop(ctx->fifo_telemetry);
+  ctx->fifo_telemetry = NULL;
+  printf("FIFO telemetry stopped.\n");
+  return 0;
+}
+
+// Enable the real-time profile for stream threads started from now on
+int cmd_rt_enable(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  int fifo_cpu = RT_SCHED_DEFAULT_FIFO_CPU;
+  int io_cpu = RT_SCHED_DEFAULT_IO_CPU;
+  char* endptr;
+  if (arg_count >= 1) {
+    fifo_cpu = (int)parse_value(args[0], &endptr);
+    if (*endptr != '\0') {
+      fprintf(stderr, "Invalid FIFO CPU for rt_enable: '%s'.\n", args[0]);
+      return -1;
+    }
+  }
+  if (arg_count >= 2) {
+    io_cpu = (int)parse_value(args[1], &endptr);
+    if (*endptr != '\0') {
+      fprintf(stderr, "Invalid I/O CPU for rt_enable: '%s'.\n", args[1]);
+      return -1;
+    }
+  }
+  if (rt_sched_enable(fifo_cpu, io_cpu, *(ctx->verbose)) != 0) {
+    return -1;
+  }
+  printf("Real-time profile enabled: stream threads started from now on run SCHED_FIFO on CPU %d; commands and console on CPU %d.\n",
+         fifo_cpu, io_cpu);
+  return 0;
+}
+
+// Disable the real-time profile
+int cmd_rt_disable(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  if (!rt_sched_enabled()) {
+    printf("Real-time profile is not enabled.\n");
+    return -1;
+  }
+  rt_sched_disable(*(ctx->verbose));
+  printf("Real-time profile disabled.\n");
+  return 0;
+}
+
+// Show the real-time profile and worst-case loop timing of each stream thread
+int cmd_rt_status(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  if (arg_count >= 1 && strcmp(args[0], "reset") != 0) {
+    fprintf(stderr, "Invalid argument for rt_status: '%s'. Use 'reset' to clear the statistics after printing.\n", args[0]);
+    return -1;
+  }
+  rt_sched_print_status();
+  if (arg_count >= 1) {
+    rt_sched_reset_stats();
+    printf("Loop timing statistics reset.\n");
+  }
+  return 0;
+}
+
+// Start recording stream and fieldmap thread spans
+int cmd_trace_start(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  uint32_t events = THREAD_TRACE_DEFAULT_EVENTS;
+  char* endptr;
+  if (arg_count >= 1) {
+    events = parse_value(args[0], &endptr);
+    if (*endptr != '\0' || events == 0 || events > THREAD_TRACE_MAX_EVENTS) {
+      fprintf(stderr, "Invalid events per thread for trace_start: '%s'. Must be 1-%u.\n", args[0], THREAD_TRACE_MAX_EVENTS);
+      return -1;
+    }
+  }
+  if (thread_trace_start(events) != 0) {
+    return -1;
+  }
+  printf("Thread tracing started (%u spans per thread, %zu bytes each). Previous trace discarded.\n",
+         events, sizeof(thread_trace_record_t));
+  return 0;
+}
+
+// Stop recording thread spans (the trace is kept for trace_dump)
+int cmd_trace_stop(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  if (!thread_trace_enabled) {
+    printf("Thread tracing is not running.\n");
+    return -1;
+  }
+  thread_trace_stop();
+  thread_trace_print_summary();
+  printf("Thread tracing stopped. Use trace_dump to export it.\n");
+  return 0;
+}
+
+// Export the thread trace as Chrome trace JSON
+int cmd_trace_dump(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  char full_path[1024];
+  clean_and_expand_path(args[0], full_path, sizeof(full_path));
+  int64_t spans = thread_trace_export(full_path);
+  if (spans < 0) {
+    return -1;
+  }
+  set_file_permissions(full_path, *(ctx->verbose));
+  printf("Wrote %lld spans to %s (open in Perfetto or chrome://tracing)\n", (long long)spans, full_path);
+  if (*(ctx->verbose)) {
+    thread_trace_print_summary();
+  }
+  return 0;
+}
   
 
 // Get minimum delay times in SPI clock cycles
@@ -481,19 +769,30 @@ void safe_buffer_reset(command_context_t* ctx, bool verbose) {
     printf("System state: %u %s\n", system_state, system_is_off ? "(OFF)" : "(ON)");
   }
 
+  // Stop every running DAC DMA before looking at the FIFOs: one that reads empty now would refill during the reset.
+  // An engine may stop partway through a command, so its board's command buffer is reset regardless.
   uint32_t cmd_reset_mask = 0;
   uint32_t data_reset_mask = 0;
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (dac_dma_busy(ctx->dac_dma, (uint8_t)board)) {
+      if (verbose) {
+        printf("  Stopping DAC DMA for board %d - will reset its command buffer\n", board);
+      }
+      dac_dma_stop(ctx->dac_dma, (uint8_t)board, verbose);
+      cmd_reset_mask |= (1U << (board * 2));
+    }
+  }
 
-  // Check DAC command and data buffers for boards 0-7
-  // DAC command buffers: bits 0, 2, 4, 6, 8, 10, 12, 14
+  // Check DAC command and data buffers for every board
+  // DAC command buffers: bits 0, 2, 4, ... (2 * board)
   // DAC data buffers: same bits
-  for (int board = 0; board < 8; board++) {
-    uint32_t dac_bit = board * 2;  // 0, 2, 4, 6, 8, 10, 12, 14
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    uint32_t dac_bit = board * 2;
 
     // Check DAC command buffer
     uint32_t dac_cmd_fifo_status = sys_sts_get_dac_cmd_fifo_status(ctx->sys_sts, board, false);
     if (FIFO_PRESENT(dac_cmd_fifo_status)) {
-      if (system_is_off || FIFO_STS_WORD_COUNT(dac_cmd_fifo_status) > 0) {
+      if (system_is_off || FIFO_STS_WORD_COUNT(dac_cmd_fifo_status) > 0 || (cmd_reset_mask & (1U << dac_bit))) {
         cmd_reset_mask |= (1U << dac_bit);
         if (verbose) {
           printf("  DAC board %d command buffer: %s - will reset\n", board,
@@ -519,11 +818,11 @@ void safe_buffer_reset(command_context_t* ctx, bool verbose) {
     }
   }
 
-  // Check ADC command and data buffers for boards 0-7
-  // ADC command buffers: bits 1, 3, 5, 7, 9, 11, 13, 15
+  // Check ADC command and data buffers for every board
+  // ADC command buffers: bits 1, 3, 5, ... (2 * board + 1)
   // ADC data buffers: same bits
-  for (int board = 0; board < 8; board++) {
-    uint32_t adc_bit = board * 2 + 1;  // 1, 3, 5, 7, 9, 11, 13, 15
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    uint32_t adc_bit = board * 2 + 1;
 
     // Check ADC command buffer
     uint32_t adc_cmd_fifo_status = sys_sts_get_adc_cmd_fifo_status(ctx->sys_sts, board, false);
@@ -554,11 +853,11 @@ void safe_buffer_reset(command_context_t* ctx, bool verbose) {
     }
   }
 
-  // Check trigger command and data buffers - bit 16
+  // Check trigger command and data buffers - the bit after the last board
   uint32_t trig_cmd_fifo_status = sys_sts_get_trig_cmd_fifo_status(ctx->sys_sts, false);
   if (FIFO_PRESENT(trig_cmd_fifo_status)) {
     if (system_is_off || FIFO_STS_WORD_COUNT(trig_cmd_fifo_status) > 0) {
-      cmd_reset_mask |= (1U << 16);
+      cmd_reset_mask |= SYS_STS_BUF_MASK_TRIG;
       if (verbose) {
         printf("  Trigger command buffer: %s - will reset\n",
                (FIFO_STS_WORD_COUNT(trig_cmd_fifo_status) > 0 ? "has entries" : "empty"));
@@ -571,7 +870,7 @@ void safe_buffer_reset(command_context_t* ctx, bool verbose) {
   uint32_t trig_data_fifo_status = sys_sts_get_trig_data_fifo_status(ctx->sys_sts, false);
   if (FIFO_PRESENT(trig_data_fifo_status)) {
     if (system_is_off || FIFO_STS_WORD_COUNT(trig_data_fifo_status) > 0) {
-      data_reset_mask |= (1U << 16);
+      data_reset_mask |= SYS_STS_BUF_MASK_TRIG;
       if (verbose) {
         printf("  Trigger data buffer: %s - will reset\n",
                (FIFO_STS_WORD_COUNT(trig_data_fifo_status) > 0 ? "has entries" : "empty"));
@@ -587,8 +886,10 @@ void safe_buffer_reset(command_context_t* ctx, bool verbose) {
       printf("Setting command buffer reset mask: 0x%05X\n", cmd_reset_mask);
     }
     sys_ctrl_set_cmd_buf_reset(ctx->sys_ctrl, cmd_reset_mask, verbose);
-    usleep(1000); // 1ms delay
+    // Hold reset for the minimum pulse width and until the selected buffers read empty
+    sys_sts_hold_buf_reset(ctx->sys_sts, cmd_reset_mask, 0, SYS_STS_BUF_RESET_TIMEOUT_US, verbose);
     sys_ctrl_set_cmd_buf_reset(ctx->sys_ctrl, 0, verbose);
+    usleep(SYS_STS_BUF_RESET_SETTLE_US);
   } else if (verbose) {
     printf("No command buffers need resetting\n");
   }
@@ -598,8 +899,14 @@ void safe_buffer_reset(command_context_t* ctx, bool verbose) {
       printf("Setting data buffer reset mask: 0x%05X\n", data_reset_mask);
     }
     sys_ctrl_set_data_buf_reset(ctx->sys_ctrl, data_reset_mask, verbose);
-    usleep(1000); // 1ms delay
+    // Hold reset for the minimum pulse width and until the selected buffers read empty
+    sys_sts_hold_buf_reset(ctx->sys_sts, 0, data_reset_mask, SYS_STS_BUF_RESET_TIMEOUT_US, verbose);
     sys_ctrl_set_data_buf_reset(ctx->sys_ctrl, 0, verbose);
+    usleep(SYS_STS_BUF_RESET_SETTLE_US);
+    if (data_reset_mask & SYS_STS_BUF_MASK_TRIG) {
+      // With the system off the trigger core was held in reset too
+      trigger_reset_decoder(ctx->trigger_ctrl, system_is_off);
+    }
   } else if (verbose) {
     printf("No data buffers need resetting\n");
   }
@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "thread_trace.h"
+
+typedef struct {
+  char name[THREAD_TRACE_NAME_LEN];
+  thread_trace_record_t* records;  // Owned by the thread that registered the slot
+  uint32_t capacity;
+  pthread_mutex_t ring_mutex;      // Guards swapping the ring buffer against readers copying it
+  volatile uint64_t head;          // Spans recorded this session (written by the owner, release)
+  volatile uint32_t session;       // Session the ring holds
+} thread_trace_slot_t;
+
+volatile bool thread_trace_enabled = false;
+
+static thread_trace_slot_t slots[THREAD_TRACE_MAX_THREADS];
+static uint32_t slot_count = 0;
+static pthread_mutex_t slots_mutex = PTHREAD_MUTEX_INITIALIZER; // Guards slot registration only
+static volatile uint32_t session = 0;
+static volatile uint32_t session_events = THREAD_TRACE_DEFAULT_EVENTS;
+static __thread thread_trace_slot_t* current_slot = NULL;
+
+static const char* event_names[TRACE_EVENT_COUNT] = {"fifo_status", "fifo_batch", "file_write", "sleep"};
+
+void thread_trace_register(const char* name, int index) {
+  char full_name[THREAD_TRACE_NAME_LEN];
+  if (index >= 0) {
+    snprintf(full_name, sizeof(full_name), "%s %d", name, index);
+  } else {
+    snprintf(full_name, sizeof(full_name), "%s", name);
+  }
+
+  pthread_mutex_lock(&slots_mutex);
+  thread_trace_slot_t* slot = NULL;
+  for (uint32_t i = 0; i < slot_count; i++) {
+    if (strcmp(slots[i].name, full_name) == 0) {
+      slot = &slots[i];
+      break;
+    }
+  }
+  if (slot == NULL && slot_count < THREAD_TRACE_MAX_THREADS) {
+    slot = &slots[slot_count];
+    snprintf(slot->name, sizeof(slot->name), "%s", full_name);
+    pthread_mutex_init(&slot->ring_mutex, NULL);
+    slot_count++;
+  }
+  pthread_mutex_unlock(&slots_mutex);
+  current_slot = slot; // NULL if every slot is taken: this thread is not traced
+}
+
+void thread_trace_record(thread_trace_event_t event, uint64_t t0, uint32_t arg) {
+  thread_trace_slot_t* slot = current_slot;
+  if (slot == NULL || !thread_trace_enabled) return;
+  uint64_t t1 = timing_now_ns();
+
+  // First span of a new session: reset the ring (reallocating if the size changed). This is the only
+  // path that takes the ring lock, so an exporter on another thread never copies a freed buffer.
+  uint32_t current_session = session;
+  if (slot->session != current_session) {
+    uint32_t capacity = session_events;
+    pthread_mutex_lock(&slot->ring_mutex);
+    if (slot->capacity != capacity) {
+      thread_trace_record_t* records = malloc((size_t)capacity * sizeof(thread_trace_record_t));
+      if (records == NULL) {
+        pthread_mutex_unlock(&slot->ring_mutex);
+        return;
+      }
+      free(slot->records);
+      slot->records = records;
+      slot->capacity = capacity;
+    }
+    __atomic_store_n(&slot->head, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&slot->session, current_session, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&slot->ring_mutex);
+  }
+
+  uint64_t head = slot->head;
+  thread_trace_record_t* record = &slot->records[head % slot->capacity];
+  uint64_t dur = t1 - t0;
+  record->start_ns = t0;
+  record->dur_ns = dur > UINT32_MAX ? UINT32_MAX : (uint32_t)dur;
+  record->event = (uint16_t)event;
+  record->arg = arg > 0xFFFF ? 0xFFFF : (uint16_t)arg;
+  __atomic_store_n(&slot->head, head + 1, __ATOMIC_RELEASE);
+}
+
+int thread_trace_start(uint32_t events_per_thread) {
+  if (events_per_thread == 0 || events_per_thread > THREAD_TRACE_MAX_EVENTS) {
+    fprintf(stderr, "Trace ring must hold 1-%u events per thread\n", THREAD_TRACE_MAX_EVENTS);
+    return -1;
+  }
+  thread_trace_enabled = false;
+  session_events = events_per_thread;
+  __atomic_add_fetch(&session, 1, __ATOMIC_RELEASE);
+  thread_trace_enabled = true;
+  return 0;
+}
+
+void thread_trace_stop(void) {
+  thread_trace_enabled = false;
+}
+
+// Copy the spans of one slot that are still intact. Returns the count copied into *out (caller frees).
+static uint64_t copy_slot(thread_trace_slot_t* slot, thread_trace_record_t** out) {
+  *out = NULL;
+  // Hold the ring lock so the owner can't swap buffers mid-copy
+  pthread_mutex_lock(&slot->ring_mutex);
+  if (__atomic_load_n(&slot->session, __ATOMIC_ACQUIRE) != session) {
+    pthread_mutex_unlock(&slot->ring_mutex);
+    return 0;
+  }
+  uint32_t capacity = slot->capacity;
+  uint64_t head = __atomic_load_n(&slot->head, __ATOMIC_ACQUIRE);
+  uint64_t count = head < capacity ? head : capacity;
+  thread_trace_record_t* copy = count > 0 ? malloc((size_t)count * sizeof(thread_trace_record_t)) : NULL;
+  if (copy == NULL) {
+    pthread_mutex_unlock(&slot->ring_mutex);
+    return 0;
+  }
+  uint64_t first = head - count;
+  for (uint64_t i = 0; i < count; i++) {
+    copy[i] = slot->records[(first + i) % capacity];
+  }
+  pthread_mutex_unlock(&slot->ring_mutex);
+  // The owner may have lapped the oldest records during the copy (and, with a full ring, may be
+  // rewriting the oldest slot right now); drop those
+  uint64_t new_head = __atomic_load_n(&slot->head, __ATOMIC_ACQUIRE);
+  uint64_t lapped = new_head - head + ((head >= capacity && thread_trace_enabled) ? 1 : 0);
+  if (lapped >= count) {
+    free(copy);
+    return 0;
+  }
+  if (lapped > 0) {
+    memmove(copy, copy + lapped, (size_t)(count - lapped) * sizeof(thread_trace_record_t));
+    count -= lapped;
+  }
+  *out = copy;
+  return count;
+}
+
+int64_t thread_trace_export(const char* path) {
+  FILE* file = fopen(path, "w");
+  if (file == NULL) {
+    fprintf(stderr, "Failed to open trace file '%s': %s\n", path, strerror(errno));
+    return -1;
+  }
+
+  int pid = (int)getpid();
+  int64_t spans = 0;
+  bool first_event = true;
+  fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+  pthread_mutex_lock(&slots_mutex);
+  uint32_t count = slot_count;
+  pthread_mutex_unlock(&slots_mutex);
+  for (uint32_t i = 0; i < count; i++) {
+    thread_trace_record_t* records;
+    uint64_t n = copy_slot(&slots[i], &records);
+    if (n == 0) continue;
+    fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+            first_event ? "" : ",\n", pid, i + 1, slots[i].name);
+    first_event = false;
+    for (uint64_t j = 0; j < n; j++) {
+      const thread_trace_record_t* r = &records[j];
+      const char* name = r->event < TRACE_EVENT_COUNT ? event_names[r->event] : "unknown";
+      fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%llu.%03u,\"dur\":%u.%03u,\"args\":{\"n\":%u}}",
+              name, pid, i + 1, (unsigned long long)(r->start_ns / 1000), (unsigned)(r->start_ns % 1000),
+              r->dur_ns / 1000, r->dur_ns % 1000, r->arg);
+    }
+    spans += (int64_t)n;
+    free(records);
+  }
+
+  fprintf(file, "\n]}\n");
+  if (fclose(file) != 0) {
+    fprintf(stderr, "Failed to write trace file '%s': %s\n", path, strerror(errno));
+    return -1;
+  }
+  return spans;
+}
+
+void thread_trace_print_summary(void) {
+  pthread_mutex_lock(&slots_mutex);
+  uint32_t count = slot_count;
+  pthread_mutex_unlock(&slots_mutex);
+
+  printf("Thread trace: %s, session %u, %u spans per thread\n",
+         thread_trace_enabled ? "recording" : "stopped", session, session_events);
+  printf("  %-16s %10s %10s %12s %12s %12s %12s\n", "Thread", "Spans", "Dropped",
+         "status(ms)", "batch(ms)", "file(ms)", "sleep(ms)");
+  for (uint32_t i = 0; i < count; i++) {
+    thread_trace_record_t* records;
+    uint64_t n = copy_slot(&slots[i], &records);
+    if (n == 0) continue;
+    uint64_t total_ns[TRACE_EVENT_COUNT] = {0};
+    for (uint64_t j = 0; j < n; j++) {
+      if (records[j].event < TRACE_EVENT_COUNT) total_ns[records[j].event] += records[j].dur_ns;
+    }
+    uint64_t head = slots[i].head;
+    printf("  %-16s %10llu %10llu %12.3f %12.3f %12.3f %12.3f\n", slots[i].name,
+           (unsigned long long)n, (unsigned long long)(head > n ? head - n : 0),
+           total_ns[TRACE_FIFO_STATUS] / 1e6, total_ns[TRACE_FIFO_BATCH] / 1e6,
+           total_ns[TRACE_FILE_WRITE] / 1e6, total_ns[TRACE_SLEEP] / 1e6);
+    free(records);
+  }
+}
+
+void thread_trace_cleanup(void) {
+  thread_trace_enabled = false;
+  pthread_mutex_lock(&slots_mutex);
+  for (uint32_t i = 0; i < slot_count; i++) {
+    free(slots[i].records);
+    slots[i].records = NULL;
+    slots[i].capacity = 0;
+    slots[i].session = 0;
+  }
+  pthread_mutex_unlock(&slots_mutex);
+}
@@ -0,0 +1,447 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <time.h>
+#include "threshold_sim.h"
+#include "command_helper.h"
+#include "dac_commands.h"
+#include "waveform_cache.h"
+#include "sys_sts.h"
+
+// DAC value timeline for one board: the cycle at which each update reaches the threshold core
+typedef struct {
+  uint64_t* cycles;      // Cycle of each update (non-decreasing)
+  uint16_t (*vals)[8];   // Absolute channel values of each update (15 bits, as in abs_dac_val_concat)
+  int count;             // Number of updates
+  uint64_t end_cycle;    // Cycle at which the last command finishes
+} dac_timeline_t;
+
+// Walks a timeline in the integrator's 16-cycle tick domain at a given sampling phase
+typedef struct {
+  const dac_timeline_t* timeline;
+  uint32_t phase;       // Cycle offset within each tick at which the core samples
+  int next;             // Next update not yet applied
+  uint64_t next_tick;   // Tick at which the next update is first seen (UINT64_MAX if none)
+  uint16_t cur[8];      // Values seen at the current tick
+} tick_cursor_t;
+
+// Running-sum state of the integrator model
+typedef struct {
+  int64_t sum[8];              // total_sum per channel
+  int64_t max_value;           // thresh_val * (window >> 4)
+  uint32_t sum_phase;          // Cycle offset of the running-sum updates within each tick
+  thresh_sim_result_t* result;
+} integrator_run_t;
+
+// Cycle of the count-th trigger after the given cycle, with triggers every trig_period cycles
+static uint64_t trigger_wait_end(uint64_t cycle, uint32_t count, uint32_t trig_period) {
+  if (count == 0) return cycle;
+  return (cycle / trig_period + count) * trig_period;
+}
+
+// Build the value timeline of a parsed waveform.
+// Updates reach the core dac_latency cycles after their command starts (no DAC pre-delay).
+static int build_timeline(const waveform_command_t* commands, int command_count, const thresh_sim_config_t* config, dac_timeline_t* timeline) {
+  timeline->cycles = malloc(command_count * sizeof(uint64_t));
+  timeline->vals = malloc(command_count * sizeof(*timeline->vals));
+  if (timeline->cycles == NULL || timeline->vals == NULL) {
+    fprintf(stderr, "Failed to allocate memory for threshold simulation timeline\n");
+    free(timeline->cycles);
+    free(timeline->vals);
+    return -1;
+  }
+
+  uint64_t cycle = 0;
+  int count = 0;
+  for (int i = 0; i < command_count; i++) {
+    const waveform_command_t* cmd = &commands[i];
+    bool is_trigger = (cmd->type == DAC_TRIGGER_CMD || cmd->type == DAC_NOOP_TRIGGER_CMD);
+    if (is_trigger && config->trig_period == 0) {
+      fprintf(stderr, "Waveform command %d waits for triggers, but the trigger period is 0\n", i + 1);
+      free(timeline->cycles);
+      free(timeline->vals);
+      return -1;
+    }
+
+    if (cmd->type == DAC_TRIGGER_CMD || cmd->type == DAC_DELAY_CMD) {
+      uint64_t update_cycle = cycle + config->dac_latency;
+      timeline->cycles[count] = update_cycle;
+      for (int ch = 0; ch < 8; ch++) {
+        int32_t val = cmd->ch_vals[ch];
+        timeline->vals[count][ch] = (uint16_t)(val < 0 ? -val : val) & 0x7FFF;
+      }
+      count++;
+
+      if (cmd->type == DAC_TRIGGER_CMD) {
+        // Trigger wait starts after the write completes
+        cycle = trigger_wait_end(update_cycle, cmd->value, config->trig_period);
+      } else {
+        // Delay runs alongside the write, but can't finish before it
+        cycle += (cmd->value > config->dac_latency) ? cmd->value : config->dac_latency;
+      }
+    } else if (cmd->type == DAC_NOOP_TRIGGER_CMD) {
+      cycle = trigger_wait_end(cycle, cmd->value, config->trig_period);
+    } else {
+      cycle += cmd->value;
+    }
+  }
+
+  timeline->count = count;
+  timeline->end_cycle = cycle;
+  return 0;
+}
+
+// First tick whose sample cycle (16 * tick + phase) is at or after the given cycle
+static uint64_t cycle_to_tick(uint64_t cycle, uint32_t phase) {
+  return (cycle <= phase) ? 0 : (cycle - phase + 15) >> 4;
+}
+
+static void cursor_update_next(tick_cursor_t* cursor) {
+  if (cursor->next < cursor->timeline->count) {
+    cursor->next_tick = cycle_to_tick(cursor->timeline->cycles[cursor->next], cursor->phase);
+  } else {
+    cursor->next_tick = UINT64_MAX;
+  }
+}
+
+static void cursor_init(tick_cursor_t* cursor, const dac_timeline_t* timeline, uint32_t phase) {
+  cursor->timeline = timeline;
+  cursor->phase = phase;
+  cursor->next = 0;
+  memset(cursor->cur, 0, sizeof(cursor->cur));
+  cursor_update_next(cursor);
+}
+
+// Apply all updates seen at or before the given tick
+static void cursor_seek(tick_cursor_t* cursor, uint64_t tick) {
+  while (cursor->next_tick <= tick) {
+    memcpy(cursor->cur, cursor->timeline->vals[cursor->next], sizeof(cursor->cur));
+    cursor->next++;
+    cursor_update_next(cursor);
+  }
+}
+
+// Simulate threshold_timer: a per-channel saturating up/down counter of cycles spent above thresh_val.
+// Constant-value segments are handled in closed form.
+static void sim_timer(const dac_timeline_t* timeline, const thresh_sim_config_t* config, thresh_sim_result_t* result) {
+  uint64_t window = config->window;
+  uint16_t thresh = config->thresh_val & 0x7FFF;
+  uint64_t timer[8] = {0};
+  uint16_t cur[8] = {0};
+  uint64_t seg_start = 0;
+
+  result->limit = window;
+
+  for (int i = 0; i <= timeline->count; i++) {
+    uint64_t seg_end = (i < timeline->count) ? timeline->cycles[i] : result->sim_cycles;
+    if (seg_end > seg_start) {
+      uint64_t len = seg_end - seg_start;
+      for (int ch = 0; ch < 8; ch++) {
+        if (cur[ch] > thresh) {
+          // Counts up once per cycle until the window, then flags on the next cycle still above
+          uint64_t to_full = window - timer[ch];
+          if (!result->violated[ch] && len > to_full) {
+            result->violated[ch] = true;
+            result->violation_cycle[ch] = seg_start + to_full;
+          }
+          uint64_t steps = (len < to_full) ? len : to_full;
+          timer[ch] += steps;
+          if (timer[ch] > result->peak[ch]) {
+            result->peak[ch] = timer[ch];
+            result->peak_cycle[ch] = seg_start + steps;
+          }
+        } else {
+          timer[ch] = (timer[ch] > len) ? timer[ch] - len : 0;
+        }
+      }
+      seg_start = seg_end;
+    }
+    if (i < timeline->count) {
+      memcpy(cur, timeline->vals[i], sizeof(cur));
+    }
+  }
+}
+
+// Advance one channel's running sum over ticks [first, last] with a constant per-tick delta
+static void sum_piece(integrator_run_t* run, int ch, uint64_t first, uint64_t last, int64_t delta) {
+  thresh_sim_result_t* result = run->result;
+  int64_t start = run->sum[ch];
+  int64_t end = start + delta * (int64_t)(last - first + 1);
+
+  if (!result->violated[ch]) {
+    uint64_t hit = UINT64_MAX;
+    if (start + delta > run->max_value) {
+      hit = first;
+    } else if (delta > 0 && end > run->max_value) {
+      hit = first + (uint64_t)((run->max_value - start) / delta);
+    }
+    if (hit != UINT64_MAX) {
+      // Sum delta registers one cycle after its tick, the total one cycle after that, then the compare
+      result->violated[ch] = true;
+      result->violation_cycle[ch] = (hit << 4) + run->sum_phase + 2;
+    }
+  }
+
+  int64_t top = (delta > 0) ? end : start + delta;
+  uint64_t top_tick = (delta > 0) ? last : first;
+  if (top > 0 && (uint64_t)top > result->peak[ch]) {
+    result->peak[ch] = (uint64_t)top;
+    result->peak_cycle[ch] = (top_tick << 4) + run->sum_phase + 2;
+  }
+
+  run->sum[ch] = end;
+}
+
+// Integrate the running sums over ticks [first, last]. Each channel removes out[ch] per tick,
+// plus one more from split[ch] onward (the remainder ticks at the end of a chunk period).
+static void integrate_ticks(integrator_run_t* run, tick_cursor_t* cursor, uint64_t first, uint64_t last,
+                            const int64_t out[8], const uint64_t split[8]) {
+  uint64_t a = first;
+  while (a <= last) {
+    cursor_seek(cursor, a);
+    uint64_t b = (cursor->next_tick - 1 < last) ? cursor->next_tick - 1 : last;
+    for (int ch = 0; ch < 8; ch++) {
+      int64_t delta = (int64_t)cursor->cur[ch] - out[ch];
+      if (split[ch] > a) {
+        sum_piece(run, ch, a, (split[ch] - 1 < b) ? split[ch] - 1 : b, delta);
+      }
+      if (split[ch] <= b) {
+        sum_piece(run, ch, (split[ch] > a) ? split[ch] : a, b, delta - 1);
+      }
+    }
+    a = b + 1;
+  }
+}
+
+// Sum chunk samples over ticks [first, last]
+static void accumulate_chunk(tick_cursor_t* cursor, uint64_t first, uint64_t last, int64_t chunk[8]) {
+  memset(chunk, 0, 8 * sizeof(int64_t));
+  uint64_t a = first;
+  while (a <= last) {
+    cursor_seek(cursor, a);
+    uint64_t b = (cursor->next_tick - 1 < last) ? cursor->next_tick - 1 : last;
+    for (int ch = 0; ch < 8; ch++) {
+      chunk[ch] += (int64_t)cursor->cur[ch] * (int64_t)(b - a + 1);
+    }
+    a = b + 1;
+  }
+}
+
+// Simulate threshold_integrator. This follows the RUNNING state of threshold_integrator.v:
+// - Chunk samples are taken every 16 cycles where inflow_chunk_timer[3:0] == 0 (phase 15). The first chunk
+//   holds 2^chunk_width - 1 samples, later chunks 2^chunk_width.
+// - The running sum updates every 16 cycles where outflow_timer[3:0] == 0 (phase (window - 1) mod 16),
+//   adding the current sample and removing chunk >> chunk_width, plus one over the last (chunk & mask) ticks
+//   of each chunk period. Nothing is removed until outflow_timer first reaches 0 at cycle window - 1.
+// Everything is piecewise linear between DAC updates and chunk period edges, so it is evaluated per piece,
+// and chunk periods whose inflow and outflow are the same constant value (net zero) are skipped in bulk.
+static void sim_integrator(const dac_timeline_t* timeline, const thresh_sim_config_t* config, thresh_sim_result_t* result) {
+  uint64_t window = config->window;
+  integrator_run_t run = {
+    .sum = {0},
+    .max_value = (int64_t)(config->thresh_val & 0x7FFF) * (int64_t)(window >> 4),
+    .sum_phase = (uint32_t)((window - 1) & 0xF),
+    .result = result
+  };
+  result->limit = (uint64_t)run.max_value;
+
+  // Window too small is disallowed, and the core goes straight to OUT_OF_BOUNDS
+  if (window < 2048) {
+    result->window_too_small = true;
+    for (int ch = 0; ch < 8; ch++) {
+      result->violated[ch] = true;
+      result->violation_cycle[ch] = 0;
+    }
+    return;
+  }
+
+  // Chunk width from the MSB index of the window, as in CALC_CHUNK_WIDTH
+  uint32_t chunk_width = 1;
+  for (uint32_t w = (uint32_t)(window >> 12); w != 0; w >>= 1) {
+    chunk_width++;
+  }
+  uint64_t chunk_ticks = 1ULL << chunk_width;
+  uint64_t first_outflow_tick = ((window - 1) >> 4) + 1;
+  if (result->sim_cycles <= run.sum_phase) return;
+  uint64_t last_tick = (result->sim_cycles - 1 - run.sum_phase) >> 4;
+
+  tick_cursor_t sum_cursor;
+  tick_cursor_t chunk_cursor;
+  cursor_init(&sum_cursor, timeline, run.sum_phase);
+  cursor_init(&chunk_cursor, timeline, 15);
+
+  // Fill the window before anything flows out
+  int64_t out[8] = {0};
+  uint64_t split[8];
+  for (int ch = 0; ch < 8; ch++) split[ch] = UINT64_MAX;
+  integrate_ticks(&run, &sum_cursor, 0, (first_outflow_tick - 1 < last_tick) ? first_outflow_tick - 1 : last_tick, out, split);
+
+  for (uint64_t k = 0; first_outflow_tick + k * chunk_ticks <= last_tick; k++) {
+    uint64_t base = first_outflow_tick + k * chunk_ticks;
+    uint64_t end = base + chunk_ticks - 1;
+    if (end > last_tick) end = last_tick;
+    uint64_t first_sample = (k == 0) ? 0 : k * chunk_ticks - 1;
+    uint64_t last_sample = (k + 1) * chunk_ticks - 2;
+
+    int64_t chunk[8];
+    cursor_seek(&chunk_cursor, first_sample);
+    int chunk_next = chunk_cursor.next;
+    accumulate_chunk(&chunk_cursor, first_sample, last_sample, chunk);
+    bool chunk_constant = (chunk_cursor.next == chunk_next);
+
+    for (int ch = 0; ch < 8; ch++) {
+      out[ch] = chunk[ch] >> chunk_width;
+      split[ch] = base + chunk_ticks - (uint64_t)(chunk[ch] & (int64_t)(chunk_ticks - 1));
+    }
+    cursor_seek(&sum_cursor, base);
+    int sum_next = sum_cursor.next;
+    integrate_ticks(&run, &sum_cursor, base, end, out, split);
+    bool sum_constant = (sum_cursor.next == sum_next);
+
+    // A full-length period with one constant value in and out nets to zero, and every following period
+    // that stays clear of updates repeats it exactly, so those are skipped
+    if (k > 0 && chunk_constant && sum_constant && end == base + chunk_ticks - 1 &&
+        memcmp(chunk_cursor.cur, sum_cursor.cur, sizeof(chunk_cursor.cur)) == 0) {
+      uint64_t skip = (chunk_cursor.next_tick - 1 - last_sample) / chunk_ticks;
+      uint64_t sum_skip = (sum_cursor.next_tick - 1 - end) / chunk_ticks;
+      uint64_t tail_skip = (last_tick - end) / chunk_ticks;
+      if (sum_skip < skip) skip = sum_skip;
+      if (tail_skip < skip) skip = tail_skip;
+      k += skip;
+    }
+  }
+}
+
+// Simulate a parsed waveform through the threshold core
+int thresh_sim_run(const waveform_command_t* commands, int command_count, const thresh_sim_config_t* config, thresh_sim_result_t* result) {
+  memset(result, 0, sizeof(*result));
+  if (config->core != THRESH_SIM_TIMER && config->core != THRESH_SIM_INTEGRATOR) {
+    fprintf(stderr, "Invalid threshold core for simulation: %d\n", config->core);
+    return -1;
+  }
+
+  dac_timeline_t timeline;
+  if (build_timeline(commands, command_count, config, &timeline) != 0) {
+    return -1;
+  }
+
+  // DAC values hold after the last command, so keep going for a full window past it
+  result->end_cycle = timeline.end_cycle;
+  result->sim_cycles = timeline.end_cycle + (uint64_t)config->window + 32;
+
+  if (config->core == THRESH_SIM_TIMER) {
+    sim_timer(&timeline, config, result);
+  } else {
+    sim_integrator(&timeline, config, result);
+  }
+
+  free(timeline.cycles);
+  free(timeline.vals);
+  return 0;
+}
+
+// Threshold simulation command: <timer|integrator> <window> <thresh_average> <trig_period> <board0_file> [board1_file ... board7_file]
+int cmd_thresh_sim(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  thresh_sim_config_t config;
+  if (strcmp(args[0], "timer") == 0) {
+    config.core = THRESH_SIM_TIMER;
+  } else if (strcmp(args[0], "integrator") == 0) {
+    config.core = THRESH_SIM_INTEGRATOR;
+  } else {
+    fprintf(stderr, "Invalid threshold core for thresh_sim: '%s'. Must be 'timer' or 'integrator'.\n", args[0]);
+    return -1;
+  }
+
+  char* endptr;
+  config.window = parse_value(args[1], &endptr);
+  if (*endptr != '\0') {
+    fprintf(stderr, "Invalid window for thresh_sim: '%s'. Must be a number.\n", args[1]);
+    return -1;
+  }
+  config.thresh_val = parse_value(args[2], &endptr);
+  if (*endptr != '\0' || config.thresh_val > 0x7FFF) {
+    fprintf(stderr, "Invalid threshold average for thresh_sim: '%s'. Must be 0 - 32767.\n", args[2]);
+    return -1;
+  }
+  config.trig_period = parse_value(args[3], &endptr);
+  if (*endptr != '\0') {
+    fprintf(stderr, "Invalid trigger period for thresh_sim: '%s'. Must be a number of cycles.\n", args[3]);
+    return -1;
+  }
+  config.dac_latency = sys_sts_get_dac_min_delay_time(ctx->sys_sts, *(ctx->verbose));
+  double clk_freq_hz = (double)sys_sts_get_clk_freq_hz(ctx->sys_sts, *(ctx->verbose));
+  if (clk_freq_hz <= 0) clk_freq_hz = 1.0; // Report times in cycles if the clock is unknown
+
+  int board_count = arg_count - 4;
+  printf("Simulating threshold %s: window %u cycles, threshold average %u, trigger period %u cycles, DAC latency %u cycles\n",
+         config.core == THRESH_SIM_TIMER ? "timer" : "integrator", config.window, config.thresh_val,
+         config.trig_period, config.dac_latency);
+
+  struct timespec start_time, end_time;
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+  int boards_tripped = 0;
+  int channels_tripped = 0;
+  for (int board = 0; board < board_count; board++) {
+    char resolved_path[1024];
+    if (resolve_file_pattern(args[4 + board], resolved_path, sizeof(resolved_path)) != 0) {
+      return -1;
+    }
+    char full_path[1024];
+    clean_and_expand_path(resolved_path, full_path, sizeof(full_path));
+
+    waveform_command_t* commands = NULL;
+    waveform_file_info_t info;
+    if (waveform_cache_get_dac(ctx, full_path, true, *(ctx->verbose), &commands, &info) != 0) {
+      return -1; // Error already printed by parse_waveform_file
+    }
+    int command_count = info.command_count;
+
+    thresh_sim_result_t result;
+    int sim_result = thresh_sim_run(commands, command_count, &config, &result);
+    free(commands);
+    if (sim_result != 0) {
+      return -1;
+    }
+
+    printf("Board %d: '%s' (%d commands, %.6f s)\n", board, full_path, command_count, result.end_cycle / clk_freq_hz);
+    if (result.window_too_small) {
+      printf("  Window %u is below the integrator minimum of 2048 cycles -- the core trips on enable\n", config.window);
+    }
+
+    uint64_t first_trip = UINT64_MAX;
+    for (int ch = 0; ch < 8; ch++) {
+      double peak_percent = result.limit ? (double)result.peak[ch] / result.limit * 100.0 : 0.0;
+      if (result.violated[ch]) {
+        printf("  Channel %2d: VIOLATION at cycle %llu (%.6f s)\n", board * 8 + ch,
+               (unsigned long long)result.violation_cycle[ch], result.violation_cycle[ch] / clk_freq_hz);
+        if (result.violation_cycle[ch] < first_trip) first_trip = result.violation_cycle[ch];
+        channels_tripped++;
+      } else if (*(ctx->verbose) || peak_percent >= 90.0) {
+        printf("  Channel %2d: OK, peak %.1f%% of limit at %.6f s\n", board * 8 + ch,
+               peak_percent, result.peak_cycle[ch] / clk_freq_hz);
+      }
+    }
+
+    if (first_trip != UINT64_MAX) {
+      printf("  Board %d would trip at cycle %llu (%.6f s)\n", board, (unsigned long long)first_trip, first_trip / clk_freq_hz);
+      boards_tripped++;
+    } else {
+      printf("  No violations\n");
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end_time);
+  double elapsed = (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+
+  if (boards_tripped > 0) {
+    printf("Threshold simulation: %d channel%s on %d board%s would trip (simulated in %.3f s)\n",
+           channels_tripped, channels_tripped == 1 ? "" : "s", boards_tripped, boards_tripped == 1 ? "" : "s", elapsed);
+  } else {
+    printf("Threshold simulation: no violations on %d board%s (simulated in %.3f s)\n",
+           board_count, board_count == 1 ? "" : "s", elapsed);
+  }
+  return 0;
+}
@@ -14,6 +14,10 @@
 #include "command_helper.h"
 #include "sys_sts.h"
 #include "trigger_ctrl.h"
+#include "npy_file.h"
+#include "live_ring.h"
+#include "thread_trace.h"
+#include "rt_sched.h"
 
 // Global trigger monitor control
 static volatile bool g_trigger_monitor_should_stop = false;
@@ -91,8 +95,9 @@ int cmd_trig_cancel(const char** args, int arg_count, const command_flag_t* flag
 }
 
 int cmd_trig_reset_count(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
-  trigger_cmd_reset_count(ctx->trigger_ctrl, *(ctx->verbose));
-  printf("Trigger reset count command sent.\n");
+  bool delta = (arg_count > 0 && strcmp(args[0], "delta") == 0);
+  trigger_cmd_reset_count(ctx->trigger_ctrl, delta, *(ctx->verbose));
+  printf("Trigger reset count command sent (%s timestamp logging).\n", delta ? "delta" : "absolute");
   return 0;
 }
 
@@ -158,6 +163,47 @@ int cmd_trig_expect_ext(const char** args, int arg_count, const command_flag_t*
   return 0;
 }
 
+int cmd_trig_set_period(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  char* endptr;
+  uint32_t cycles = parse_value(args[0], &endptr);
+  if (*endptr != '\0') {
+    fprintf(stderr, "Invalid period cycles for trig_set_period: '%s'. Must be a number.\n", args[0]);
+    return -1;
+  }
+
+  if (cycles < TRIG_PERIOD_MIN || cycles > TRIG_CMD_PERIODIC_VALUE_MASK) {
+    fprintf(stderr, "Period cycles out of range: %u (valid range: %u - 134217727)\n", cycles, TRIG_PERIOD_MIN);
+    return -1;
+  }
+
+  trigger_cmd_set_period(ctx->trigger_ctrl, cycles, *(ctx->verbose));
+  printf("Trigger set period command sent with %u cycles.\n", cycles);
+  return 0;
+}
+
+int cmd_trig_periodic(const char** args, int arg_count, const command_flag_t* flags, int flag_count, command_context_t* ctx) {
+  char* endptr;
+  uint32_t count = parse_value(args[0], &endptr);
+  if (*endptr != '\0') {
+    fprintf(stderr, "Invalid count for trig_periodic: '%s'. Must be a number.\n", args[0]);
+    return -1;
+  }
+
+  if (count > TRIG_CMD_PERIODIC_VALUE_MASK) {
+    fprintf(stderr, "Count out of range: %u (valid range: 0 - 134217727)\n", count);
+    return -1;
+  }
+
+  bool log = (arg_count > 1 && strcmp(args[1], "log") == 0);
+  trigger_cmd_periodic(ctx->trigger_ctrl, count, log, *(ctx->verbose));
+  if (count == 0) {
+    printf("Trigger periodic command sent, triggering until trig_cancel%s.\n", log ? " with logging" : "");
+  } else {
+    printf("Trigger periodic command sent with count %u%s.\n", count, log ? " with logging" : "");
+  }
+  return 0;
+}
+
 // Thread function for trigger data streaming
 static void* trigger_data_stream_thread(void* arg) {
   trigger_data_stream_params_t* stream_data = (trigger_data_stream_params_t*)arg;
@@ -166,11 +212,15 @@ static void* trigger_data_stream_thread(void* arg) {
   uint64_t sample_count = stream_data->sample_count;
   volatile bool* should_stop = stream_data->should_stop;
   bool binary_mode = stream_data->binary_mode;
+  bool npy_mode = stream_data->npy_mode;
+  live_ring_t* live_ring = ctx->live_ring; // Fixed for the stream (the ring can't close while it runs)
   bool verbose = *(ctx->verbose);
+  thread_trace_register("Trig data", -1);
+  rt_sched_thread_enter(RT_CLASS_FIFO_DATA, "Trig data", -1);
 
   if (verbose) {
     printf("Trigger Stream Thread: Starting to write %llu samples to file '%s' (%s format)\n",
-           sample_count, file_path, binary_mode ? "binary" : "ASCII");
+           sample_count, file_path, npy_mode ? "NPY" : (binary_mode ? "binary" : "ASCII"));
   }
 
   // Open file for writing (binary or text mode based on format)
@@ -181,53 +231,93 @@ static void* trigger_data_stream_thread(void* arg) {
     goto cleanup;
   }
 
+  // NPY: the sample count is patched in when the stream closes
+  if (npy_mode && npy_write_header(file, NPY_DESCR_UINT64, 0, 0) != 0) {
+    fclose(file);
+    file = NULL;
+    goto cleanup;
+  }
+
   uint64_t samples_written = 0;
+  live_ring_trig_begin(live_ring);
 
   while (samples_written < sample_count && !(*should_stop)) {
+    rt_sched_loop_tick();
     // Check trigger data FIFO status
+    uint64_t trace_t0 = thread_trace_begin();
     uint32_t data_status = sys_sts_get_trig_data_fifo_status(ctx->sys_sts, false);
+    thread_trace_end(TRACE_FIFO_STATUS, trace_t0, FIFO_STS_WORD_COUNT(data_status));
 
     if (FIFO_PRESENT(data_status) == 0) {
       fprintf(stderr, "Trigger Stream Thread: Data FIFO not present, stopping stream\n");
       break;
     }
 
-    // Check if there are at least 2 words available for a sample
+    // Read the words present: one per delta-logged trigger, two per absolute (or long delta) one.
+    // A timestamp split across batches is completed on the next pass.
     uint32_t fifo_count = FIFO_STS_WORD_COUNT(data_status);
-    if (fifo_count >= 2) {
-      // Read 64-bit trigger data (2 words)
-      uint64_t trigger_data = trigger_read(ctx->trigger_ctrl);
-
-      // Write data based on format mode
-      if (binary_mode) {
-        // Binary mode: write raw 64-bit value directly
-        size_t written = fwrite(&trigger_data, sizeof(uint64_t), 1, file);
-        if (written != 1) {
-          fprintf(stderr, "Trigger Stream Thread: Failed to write to file: %s\n", strerror(errno));
-          break;
-        }
-      } else {
-        // ASCII mode: write one trigger sample per line
-        fprintf(file, "0x%016" PRIx64 "\n", trigger_data);
+    if (fifo_count > 0) {
+      uint32_t words_to_read = fifo_count;
+      if (words_to_read > 256) {
+        words_to_read = 256;
       }
 
-      // Flush the file to ensure data is written
-      fflush(file);
-
-      samples_written++;
+      // Decode the batch (stopping once the requested sample count is reached)
+      uint64_t batch[256];
+      uint32_t samples_in_batch = 0;
+      uint32_t words_read = 0;
+      trace_t0 = thread_trace_begin();
+      while (words_read < words_to_read && samples_written + samples_in_batch < sample_count) {
+        uint32_t word = trigger_read_word(ctx->trigger_ctrl);
+        words_read++;
+        if (trigger_decode_word(ctx->trigger_ctrl, word, &batch[samples_in_batch])) {
+          samples_in_batch++;
+        }
+      }
+      thread_trace_end(TRACE_FIFO_BATCH, trace_t0, words_read);
+      for (uint32_t i = 0; i < samples_in_batch; i++) {
+        live_ring_trig_publish(live_ring, batch[i]);
+      }
 
-      if (verbose && samples_written % 1000 == 0) {
-        printf("Trigger Stream Thread: Written %llu/%llu samples (%.1f%%)\n",
-               samples_written, sample_count,
-               (double)samples_written / sample_count * 100.0);
+      if (samples_in_batch > 0) {
+        // Write data based on format mode, then flush once per batch to ensure data is written
+        trace_t0 = thread_trace_begin();
+        if (binary_mode) {
+          // Binary mode: write raw 64-bit values directly
+          size_t written = fwrite(batch, sizeof(uint64_t), samples_in_batch, file);
+          if (written != samples_in_batch) {
+            fprintf(stderr, "Trigger Stream Thread: Failed to write to file: %s\n", strerror(errno));
+            break;
+          }
+        } else {
+          // ASCII mode: write one trigger sample per line
+          for (uint32_t i = 0; i < samples_in_batch; i++) {
+            fprintf(file, "0x%016" PRIx64 "\n", batch[i]);
+          }
+        }
+        fflush(file);
+        thread_trace_end(TRACE_FILE_WRITE, trace_t0, samples_in_batch);
+
+        uint64_t samples_before = samples_written;
+        samples_written += samples_in_batch;
+        if (verbose && samples_written / 1000 != samples_before / 1000) {
+          printf("Trigger Stream Thread: Written %llu/%llu samples (%.1f%%)\n",
+                 samples_written, sample_count,
+                 (double)samples_written / sample_count * 100.0);
+        }
       }
     } else {
       // Not enough data available, sleep briefly
-      usleep(10000); // 10ms
+      trace_t0 = thread_trace_begin();
+      rt_sched_usleep(10000); // 10ms
+      thread_trace_end(TRACE_SLEEP, trace_t0, 10000);
     }
   }
 
   if (file) {
+    if (npy_mode && npy_finalize(file, NPY_DESCR_UINT64, samples_written, 0, sizeof(uint64_t)) != 0) {
+      fprintf(stderr, "Trigger Stream Thread: Failed to finalize NPY file '%s'\n", file_path);
+    }
     fclose(file);
   }
 
@@ -256,6 +346,11 @@ int cmd_stream_trig_data_to_file(const char** args, int arg_count, const command
 
   // Check for binary mode flag
   bool binary_mode = has_flag(flags, flag_count, FLAG_BIN);
+  bool npy_mode = has_flag(flags, flag_count, FLAG_NPY);
+  if (binary_mode && npy_mode) {
+    fprintf(stderr, "stream_trig_data_to_file: --bin and --npy are mutually exclusive.\n");
+    return -1;
+  }
 
   // Check if stream is already running
   if (ctx->trig_data_stream_running) {
@@ -265,7 +360,7 @@ int cmd_stream_trig_data_to_file(const char** args, int arg_count, const command
 
   if (*(ctx->verbose)) {
     printf("Setting up trigger data streaming: %llu samples, %s mode\n",
-           sample_count, binary_mode ? "binary" : "ASCII");
+           sample_count, npy_mode ? "NPY" : (binary_mode ? "binary" : "ASCII"));
   }
 
   // Check trigger data FIFO presence
@@ -294,7 +389,9 @@ int cmd_stream_trig_data_to_file(const char** args, int arg_count, const command
   // Check if there's a dot after the last slash (or no slash at all)
   if (dot == NULL || (slash != NULL && dot < slash)) {
     // No extension found, add default
-    if (binary_mode) {
+    if (npy_mode) {
+      strcat(final_path, NPY_EXTENSION);
+    } else if (binary_mode) {
       strcat(final_path, ".dat");
     } else {
       strcat(final_path, ".csv");
@@ -302,6 +399,14 @@ int cmd_stream_trig_data_to_file(const char** args, int arg_count, const command
   }
   // If extension exists, user specified it explicitly, so keep it
 
+  // An .npy path selects NPY output even without the flag
+  if (!binary_mode && npy_path(final_path)) {
+    npy_mode = true;
+  }
+  if (npy_mode) {
+    binary_mode = true;
+  }
+
   if (*(ctx->verbose)) {
     printf("Final output file path: %s\n", final_path);
   }
@@ -322,6 +427,7 @@ int cmd_stream_trig_data_to_file(const char** args, int arg_count, const command
   stream_data->sample_count = sample_count;
   stream_data->should_stop = &(ctx->trig_data_stream_stop);
   stream_data->binary_mode = binary_mode;
+  stream_data->npy_mode = npy_mode;
 
   if (*(ctx->verbose)) {
     printf("Initialized trigger stream parameters\n");
@@ -349,7 +455,7 @@ int cmd_stream_trig_data_to_file(const char** args, int arg_count, const command
   if (*(ctx->verbose)) {
     printf("Created trigger data streaming thread successfully\n");
     printf("Started trigger data streaming to file '%s' (%llu samples, %s format)\n",
-           final_path, sample_count, binary_mode ? "binary" : "ASCII");
+           final_path, sample_count, npy_mode ? "NPY" : (binary_mode ? "binary" : "ASCII"));
   }
   return 0;
 }
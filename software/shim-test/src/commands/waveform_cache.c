@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "waveform_cache.h"
+#include "sys_sts.h"
+
+typedef struct {
+  bool used;
+  bool is_adc;
+  char path[1024];
+  off_t size;
+  struct timespec mtime;
+  uint32_t timing_clk_hz;     // SPI clock the timing checks ran at (0 = not checked)
+  void* commands;
+  size_t command_size;
+  waveform_file_info_t info;
+  uint64_t last_use;
+} cache_entry_t;
+
+struct waveform_cache {
+  pthread_mutex_t mutex;
+  cache_entry_t entries[WAVEFORM_CACHE_MAX_ENTRIES];
+  uint64_t use_counter;
+};
+
+static struct waveform_cache* get_cache(command_context_t* ctx) {
+  if (ctx->waveform_cache == NULL) {
+    struct waveform_cache* cache = calloc(1, sizeof(struct waveform_cache));
+    if (cache == NULL) return NULL; // Callers fall back to parsing every time
+    pthread_mutex_init(&cache->mutex, NULL);
+    ctx->waveform_cache = cache;
+  }
+  return ctx->waveform_cache;
+}
+
+// Triggers waited on per pass, counted the way the trigger stream expects them
+static int count_triggers(bool is_adc, const void* commands, int command_count) {
+  int trigger_count = 0;
+  for (int i = 0; i < command_count; i++) {
+    bool is_trigger;
+    uint32_t value;
+    if (is_adc) {
+      const adc_command_t* cmd = &((const adc_command_t*)commands)[i];
+      is_trigger = (cmd->type == ADC_TRIGGER_CMD || cmd->type == ADC_NOOP_TRIGGER_CMD);
+      value = cmd->value;
+    } else {
+      const waveform_command_t* cmd = &((const waveform_command_t*)commands)[i];
+      is_trigger = (cmd->type == DAC_TRIGGER_CMD || cmd->type == DAC_NOOP_TRIGGER_CMD);
+      value = cmd->value;
+    }
+    if (is_trigger) trigger_count += value > 0 ? (int)value : 1;
+  }
+  return trigger_count;
+}
+
+// Find a current entry for path, or the slot to reuse for it (this path's stale entry or the least recently used)
+// Call with the mutex held
+static cache_entry_t* cache_lookup(struct waveform_cache* cache, bool is_adc, const char* path, const struct stat* st,
+                                   bool check_timing, uint32_t clk_freq_hz, cache_entry_t** slot) {
+  cache_entry_t* lru = NULL;
+  for (int i = 0; i < WAVEFORM_CACHE_MAX_ENTRIES; i++) {
+    cache_entry_t* e = &cache->entries[i];
+    if (e->used && e->is_adc == is_adc && strcmp(e->path, path) == 0) {
+      *slot = e;
+      if (e->size == st->st_size && e->mtime.tv_sec == st->st_mtim.tv_sec &&
+          e->mtime.tv_nsec == st->st_mtim.tv_nsec &&
+          (!check_timing || (e->timing_clk_hz != 0 && e->timing_clk_hz == clk_freq_hz))) {
+        return e;
+      }
+      return NULL;
+    }
+    if (lru == NULL || (lru->used && (!e->used || e->last_use < lru->last_use))) lru = e;
+  }
+  *slot = lru;
+  return NULL;
+}
+
+// Hand out a copy of a command array the caller owns
+static int copy_commands(bool is_adc, const void* source, int command_count, void** commands) {
+  size_t command_size = is_adc ? sizeof(adc_command_t) : sizeof(waveform_command_t);
+  *commands = malloc((size_t)command_count * command_size);
+  if (*commands == NULL) {
+    fprintf(stderr, "Failed to allocate memory for %s commands\n", is_adc ? "ADC" : "waveform");
+    return -1;
+  }
+  memcpy(*commands, source, (size_t)command_count * command_size);
+  return 0;
+}
+
+static void print_timing(bool is_adc, const char* path, const waveform_file_info_t* info) {
+  const command_file_timing_t* t = &info->timing;
+  print_file_timing(is_adc ? "ADC command" : "Waveform", path, t->min_delay, t->shortest_delay, t->trigger_spacing,
+                    t->clk_freq_hz);
+}
+
+// Look up a file, parsing it on a miss. Parsing runs without the mutex held, so several threads can parse
+// different files at once; if two parse the same file, the last one to finish is kept.
+// Messages are printed only when verbose; errors are always printed.
+static int cache_get(command_context_t* ctx, struct waveform_cache* cache, bool is_adc, const char* path,
+                     bool check_timing, bool verbose, void** commands, waveform_file_info_t* info) {
+  uint32_t clk_freq_hz = check_timing ? sys_sts_get_clk_freq_hz(ctx->sys_sts, false) : 0;
+  struct stat st;
+  bool have_stat = (stat(path, &st) == 0);
+
+  if (cache != NULL && have_stat) {
+    pthread_mutex_lock(&cache->mutex);
+    cache_entry_t* slot;
+    cache_entry_t* entry = cache_lookup(cache, is_adc, path, &st, check_timing, clk_freq_hz, &slot);
+    if (entry != NULL) {
+      int result = 0;
+      if (commands != NULL) result = copy_commands(is_adc, entry->commands, entry->info.command_count, commands);
+      if (result == 0) {
+        if (info != NULL) *info = entry->info;
+        if (verbose) {
+          printf("Using cached parse of '%s' (%d commands)\n", path, entry->info.command_count);
+          if (check_timing) print_timing(is_adc, path, &entry->info);
+        }
+        entry->last_use = ++cache->use_counter;
+      }
+      pthread_mutex_unlock(&cache->mutex);
+      return result;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+  }
+
+  // Miss: parse without holding the mutex
+  void* parsed = NULL;
+  int parsed_count = 0;
+  waveform_file_info_t parsed_info = {0};
+  struct sys_sts_t* sys_sts = check_timing ? ctx->sys_sts : NULL;
+  int result = is_adc
+    ? parse_adc_command_file_timed(path, (adc_command_t**)&parsed, &parsed_count, sys_sts, &parsed_info.timing)
+    : parse_waveform_file_timed(path, (waveform_command_t**)&parsed, &parsed_count, sys_sts, &parsed_info.timing);
+  if (result != 0) return -1; // Error already printed by the parser
+  parsed_info.command_count = parsed_count;
+  parsed_info.trigger_count = count_triggers(is_adc, parsed, parsed_count);
+  parsed_info.adc_words_per_pass = is_adc ? adc_words_per_pass((adc_command_t*)parsed, parsed_count) : 0;
+  if (verbose && check_timing) print_timing(is_adc, path, &parsed_info);
+
+  if (commands != NULL && copy_commands(is_adc, parsed, parsed_count, commands) != 0) {
+    free(parsed);
+    return -1;
+  }
+  if (info != NULL) *info = parsed_info;
+
+  if (cache == NULL || !have_stat) {
+    free(parsed);
+    return 0;
+  }
+
+  // Keep the fresh parse (replacing this path's entry, if another thread got there first, or the LRU one)
+  pthread_mutex_lock(&cache->mutex);
+  cache_entry_t* slot;
+  cache_lookup(cache, is_adc, path, &st, check_timing, clk_freq_hz, &slot);
+  free(slot->commands);
+  slot->used = true;
+  slot->is_adc = is_adc;
+  snprintf(slot->path, sizeof(slot->path), "%s", path);
+  slot->size = st.st_size;
+  slot->mtime = st.st_mtim;
+  slot->timing_clk_hz = clk_freq_hz;
+  slot->commands = parsed;
+  slot->command_size = is_adc ? sizeof(adc_command_t) : sizeof(waveform_command_t);
+  slot->info = parsed_info;
+  slot->last_use = ++cache->use_counter;
+  pthread_mutex_unlock(&cache->mutex);
+  return 0;
+}
+
+int waveform_cache_get_dac(command_context_t* ctx, const char* path, bool check_timing, bool verbose,
+                           waveform_command_t** commands, waveform_file_info_t* info) {
+  return cache_get(ctx, get_cache(ctx), false, path, check_timing, verbose, (void**)commands, info);
+}
+
+int waveform_cache_get_adc(command_context_t* ctx, const char* path, bool check_timing, bool verbose,
+                           adc_command_t** commands, waveform_file_info_t* info) {
+  return cache_get(ctx, get_cache(ctx), true, path, check_timing, verbose, (void**)commands, info);
+}
+
+static void* load_thread(void* arg) {
+  waveform_cache_load_t* load = (waveform_cache_load_t*)arg;
+  load->result = cache_get(load->ctx, load->ctx->waveform_cache, load->is_adc, load->path, load->check_timing, false,
+                           NULL, &load->info);
+  return NULL;
+}
+
+int waveform_cache_load_parallel(command_context_t* ctx, waveform_cache_load_t* loads, int load_count) {
+  get_cache(ctx); // Create it here, not racing in the threads
+  pthread_t threads[WAVEFORM_CACHE_MAX_ENTRIES];
+  bool started[WAVEFORM_CACHE_MAX_ENTRIES] = {false};
+  int failures = 0;
+
+  for (int i = 0; i < load_count; i++) {
+    loads[i].ctx = ctx;
+    loads[i].result = -1;
+    // Past the thread limit (or if a thread can't start), load on this thread instead
+    if (i < WAVEFORM_CACHE_MAX_ENTRIES && pthread_create(&threads[i], NULL, load_thread, &loads[i]) == 0) {
+      started[i] = true;
+    } else {
+      load_thread(&loads[i]);
+    }
+  }
+  for (int i = 0; i < load_count; i++) {
+    if (i < WAVEFORM_CACHE_MAX_ENTRIES && started[i]) pthread_join(threads[i], NULL);
+    if (loads[i].result != 0) failures++;
+  }
+  return failures == 0 ? 0 : -1;
+}
+
+void waveform_cache_destroy(struct waveform_cache* cache) {
+  if (cache == NULL) return;
+  for (int i = 0; i < WAVEFORM_CACHE_MAX_ENTRIES; i++) {
+    free(cache->entries[i].commands);
+  }
+  pthread_mutex_destroy(&cache->mutex);
+  free(cache);
+}
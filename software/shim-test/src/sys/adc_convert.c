@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "adc_convert.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ADC_CONVERT_USE_NEON 1
+#endif
+
+// Initialize with no bias correction and <full_scale_amps> at ADC_CONVERT_FULL_SCALE counts
+void adc_convert_init(adc_convert_t* conv, double full_scale_amps) {
+  float scale = (float)(full_scale_amps / (double)ADC_CONVERT_FULL_SCALE);
+  for (int ch = 0; ch < ADC_CONVERT_MAX_CHANNELS; ch++) {
+    conv->offset_q[ch] = 0;
+    conv->scale[ch] = scale;
+  }
+}
+
+// Set the bias (in ADC counts) subtracted from a channel, rounded to the nearest Q16 step
+void adc_convert_set_bias(adc_convert_t* conv, int channel, double bias_counts) {
+  if (channel < 0 || channel >= ADC_CONVERT_MAX_CHANNELS) {
+    fprintf(stderr, "ADC conversion channel %d out of range (0-%d)\n", channel, ADC_CONVERT_MAX_CHANNELS - 1);
+    return;
+  }
+  // Clamp so the Q16 offset fits in 32 bits
+  if (bias_counts > (double)ADC_CONVERT_FULL_SCALE) bias_counts = (double)ADC_CONVERT_FULL_SCALE;
+  if (bias_counts < -(double)ADC_CONVERT_FULL_SCALE) bias_counts = -(double)ADC_CONVERT_FULL_SCALE;
+  double scaled = bias_counts * (double)(1 << ADC_CONVERT_OFFSET_BITS);
+  conv->offset_q[channel] = (int32_t)(scaled + (scaled >= 0 ? 0.5 : -0.5));
+}
+
+// Set the bias for channels [0, count) from bias/valid arrays
+void adc_convert_load_bias(adc_convert_t* conv, const double* bias, const bool* valid, int count) {
+  if (count > ADC_CONVERT_MAX_CHANNELS) count = ADC_CONVERT_MAX_CHANNELS;
+  for (int ch = 0; ch < count; ch++) {
+    if (valid[ch]) {
+      adc_convert_set_bias(conv, ch, bias[ch]);
+    } else {
+      conv->offset_q[ch] = 0;
+    }
+  }
+}
+
+// Scalar equivalent of the NEON saturating subtract (vqsubq_s32) and rounding narrow (vqrshrn_n_s32)
+static inline int16_t correct_sample(int16_t sample, int32_t offset_q) {
+  int64_t value = ((int64_t)sample << ADC_CONVERT_OFFSET_BITS) - offset_q;
+  if (value > INT32_MAX) value = INT32_MAX;
+  if (value < INT32_MIN) value = INT32_MIN;
+  value = (value + (1 << (ADC_CONVERT_OFFSET_BITS - 1))) >> ADC_CONVERT_OFFSET_BITS;
+  if (value > INT16_MAX) value = INT16_MAX;
+  if (value < INT16_MIN) value = INT16_MIN;
+  return (int16_t)value;
+}
+
+// Bias-corrected sample, rounded and saturated to int16
+int16_t adc_convert_sample(const adc_convert_t* conv, int channel, int16_t sample) {
+  return correct_sample(sample, conv->offset_q[channel]);
+}
+
+// Bias-corrected sample without rounding
+double adc_convert_counts(const adc_convert_t* conv, int channel, int16_t sample) {
+  return (double)sample - (double)conv->offset_q[channel] / (double)(1 << ADC_CONVERT_OFFSET_BITS);
+}
+
+// Bias-corrected sample in amps
+double adc_convert_amps(const adc_convert_t* conv, int channel, int16_t sample) {
+  return (double)((float)correct_sample(sample, conv->offset_q[channel]) * conv->scale[channel]);
+}
+
+#ifdef ADC_CONVERT_USE_NEON
+// Correct 8 samples in one pass: widen to Q16, saturating subtract, rounding saturating narrow
+static inline int16x8_t correct_frame_neon(const int32_t* offset_q, const uint32_t* words) {
+  int16x8_t samples = vreinterpretq_s16_u32(vld1q_u32(words));
+  int32x4_t lo = vqsubq_s32(vshll_n_s16(vget_low_s16(samples), ADC_CONVERT_OFFSET_BITS), vld1q_s32(offset_q));
+  int32x4_t hi = vqsubq_s32(vshll_n_s16(vget_high_s16(samples), ADC_CONVERT_OFFSET_BITS), vld1q_s32(offset_q + 4));
+  return vcombine_s16(vqrshrn_n_s32(lo, ADC_CONVERT_OFFSET_BITS), vqrshrn_n_s32(hi, ADC_CONVERT_OFFSET_BITS));
+}
+#endif
+
+// Correct one 8-channel frame
+void adc_convert_frame(const adc_convert_t* conv, int first_channel, const uint32_t* words, int16_t* out) {
+  const int32_t* offset_q = &conv->offset_q[first_channel];
+#ifdef ADC_CONVERT_USE_NEON
+  vst1q_s16(out, correct_frame_neon(offset_q, words));
+#else
+  for (int i = 0; i < ADC_CONVERT_FRAME_WORDS; i++) {
+    out[2 * i] = correct_sample(adc_word_sample_lo(words[i]), offset_q[2 * i]);
+    out[2 * i + 1] = correct_sample(adc_word_sample_hi(words[i]), offset_q[2 * i + 1]);
+  }
+#endif
+}
+
+// Convert one 8-channel frame to amps
+void adc_convert_frame_amps(const adc_convert_t* conv, int first_channel, const uint32_t* words, float* out) {
+  const float* scale = &conv->scale[first_channel];
+#ifdef ADC_CONVERT_USE_NEON
+  int16x8_t corrected = correct_frame_neon(&conv->offset_q[first_channel], words);
+  vst1q_f32(out, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(corrected))), vld1q_f32(scale)));
+  vst1q_f32(out + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(corrected))), vld1q_f32(scale + 4)));
+#else
+  int16_t corrected[ADC_CONVERT_FRAME_CHANNELS];
+  adc_convert_frame(conv, first_channel, words, corrected);
+  for (int i = 0; i < ADC_CONVERT_FRAME_CHANNELS; i++) {
+    out[i] = (float)corrected[i] * scale[i];
+  }
+#endif
+}
+
+// Correct consecutive frames in place
+void adc_convert_frames_in_place(const adc_convert_t* conv, int first_channel, uint32_t* words, uint32_t frame_count) {
+  for (uint32_t frame = 0; frame < frame_count; frame++, words += ADC_CONVERT_FRAME_WORDS) {
+#ifdef ADC_CONVERT_USE_NEON
+    vst1q_u32(words, vreinterpretq_u32_s16(correct_frame_neon(&conv->offset_q[first_channel], words)));
+#else
+    int16_t corrected[ADC_CONVERT_FRAME_CHANNELS];
+    adc_convert_frame(conv, first_channel, words, corrected);
+    for (int i = 0; i < ADC_CONVERT_FRAME_WORDS; i++) {
+      words[i] = (uint32_t)(uint16_t)corrected[2 * i] | ((uint32_t)(uint16_t)corrected[2 * i + 1] << 16);
+    }
+#endif
+  }
+}
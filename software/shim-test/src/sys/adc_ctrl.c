@@ -10,12 +10,15 @@ struct adc_ctrl_t create_adc_ctrl(bool verbose) {
   struct adc_ctrl_t adc_ctrl;
 
   // Map ADC FIFO for each board
-  for (int board = 0; board < 8; board++) {
-    adc_ctrl.buffer[board] = map_32bit_memory(ADC_FIFO(board), 1, "ADC FIFO", verbose);
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    adc_ctrl.buffer[board] = map_32bit_memory(ADC_FIFO(board), ADC_FIFO_WINDOW_WORDS, "ADC FIFO", verbose);
     if (adc_ctrl.buffer[board] == NULL) {
       fprintf(stderr, "Failed to map ADC FIFO access for board %d\n", board);
       exit(EXIT_FAILURE);
     }
+    for (int i = 0; i < 8; i++) {
+      adc_ctrl.channel_order[board][i] = (uint8_t)i;
+    }
   }
 
   return adc_ctrl;
@@ -23,8 +26,8 @@ struct adc_ctrl_t create_adc_ctrl(bool verbose) {
 
 // Read ADC sample pair word from a specific board
 uint32_t adc_read_word(struct adc_ctrl_t *adc_ctrl, uint8_t board) {
-  if (board > 7) {
-    fprintf(stderr, "Invalid ADC board: %d. Must be 0-7.\n", board);
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid ADC board: %d. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
     return 0; // Return 0 for invalid board
   }
 
@@ -41,179 +44,161 @@ uint32_t adc_read_word(struct adc_ctrl_t *adc_ctrl, uint8_t board) {
   return value;
 }
 
-// Interpret and format ADC value as debug information
-char* adc_format_debug(uint32_t adc_value, bool verbose) {
-  static char buffer[512];  // Static buffer for return string
-  char temp_buffer[256];
-  buffer[0] = '\0';  // Initialize as empty string
+// Read a block of ADC data words from a specific board
+void adc_read_words(struct adc_ctrl_t *adc_ctrl, uint8_t board, uint32_t *words, size_t count) {
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid ADC board: %d. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
+    memset(words, 0, count * sizeof(uint32_t));
+    return;
+  }
 
-  if (verbose) {
-    snprintf(temp_buffer, sizeof(temp_buffer), "ADC Debug word: 0x%08" PRIx32 "\n", adc_value);
-    strcat(buffer, temp_buffer);
+  fifo_window_read(adc_ctrl->buffer[board], ADC_FIFO_WINDOW_WORDS, words, count);
+}
+
+// Name of an ADC core state (NULL if unknown)
+const char* adc_state_name(uint8_t state_code) {
+  switch (state_code) {
+    case ADC_STATE_RESET:     return "RESET";
+    case ADC_STATE_INIT:      return "Init";
+    case ADC_STATE_SET_OTF:   return "Set OTF mode";
+    case ADC_STATE_REQ_RD:    return "Request Read";
+    case ADC_STATE_TEST_RD:   return "Test Read";
+    case ADC_STATE_IDLE:      return "Idle";
+    case ADC_STATE_DELAY:     return "Delay Wait";
+    case ADC_STATE_TRIG_WAIT: return "Trigger Wait";
+    case ADC_STATE_ADC_RD:    return "ADC Read";
+    case ADC_STATE_ADC_RD_CH: return "ADC Read Channel";
+    case ADC_STATE_ERROR:     return "ERROR";
+    default:                  return NULL;
   }
+}
+
+// Name of an ADC command code
+const char* adc_cmd_name(uint8_t cmd_code) {
+  switch (cmd_code) {
+    case ADC_CMD_NO_OP:     return "NO_OP";
+    case ADC_CMD_SET_ORD:   return "SET_ORD";
+    case ADC_CMD_ADC_RD:    return "ADC_RD";
+    case ADC_CMD_ADC_RD_CH: return "ADC_RD_CH";
+    case ADC_CMD_CANCEL:    return "CANCEL";
+    default:                return "Unknown Command";
+  }
+}
 
-  uint8_t debug_code = ADC_DBG(adc_value);
-  switch (debug_code) {
-    case ADC_DBG_MISO_DATA: {
-      int16_t signed_val = (int16_t)(adc_value & 0xFFFF);
-      snprintf(temp_buffer, sizeof(temp_buffer), "Debug: Startup test MISO Data = 0x%04" PRIx32 " (signed: %" PRId16 ")", adc_value & 0xFFFF, signed_val);
-      strcat(buffer, temp_buffer);
+// Decode an ADC debug word into its fields
+adc_debug_decoded_t adc_decode_debug(uint32_t adc_value) {
+  adc_debug_decoded_t d = {0};
+  d.code = ADC_DBG(adc_value);
+  switch (d.code) {
+    case ADC_DBG_MISO_DATA:
+      d.value = (int16_t)(adc_value & 0xFFFF);
       break;
-    }
-    case ADC_DBG_STATE_TRANSITION: {
-      uint8_t from_state = (adc_value >> 4) & 0x0F;
-      uint8_t to_state = adc_value & 0x0F;
-      char from_state_str[64];  // Local copy to avoid static buffer overwrite
-      strcpy(from_state_str, adc_format_state(from_state, verbose));  // Copy the first result
-      char to_state_str[64];  // Local copy to avoid static buffer overwrite
-      strcpy(to_state_str, adc_format_state(to_state, verbose));  // Copy the second
-      snprintf(temp_buffer, sizeof(temp_buffer), "Debug: State Transition from %s to %s", from_state_str, to_state_str);
-      strcat(buffer, temp_buffer);
+    case ADC_DBG_STATE_TRANSITION:
+      d.from_state = (adc_value >> 4) & 0x0F;
+      d.to_state = adc_value & 0x0F;
       break;
-    }
-    case ADC_DBG_REPEAT: {
-      char cmd_str[32];
-      switch (ADC_DBG_COMMAND(adc_value)) {
-        case ADC_CMD_NO_OP:
-          strcpy(cmd_str, "NO_OP");
-          break;
-        case ADC_CMD_SET_ORD:
-          strcpy(cmd_str, "SET_ORD");
-          break;
-        case ADC_CMD_ADC_RD:
-          strcpy(cmd_str, "ADC_RD");
-          break;
-        case ADC_CMD_ADC_RD_CH:
-          strcpy(cmd_str, "ADC_RD_CH");
-          break;
-        case ADC_CMD_CANCEL:
-          strcpy(cmd_str, "CANCEL");
-          break;
-        default:
-          strcpy(cmd_str, "Unknown Command");
-          break;
-      }
-      if (ADC_DBG_REPEAT_BIT(adc_value)) {
-        snprintf(temp_buffer, sizeof(temp_buffer), "Debug: Repeat (Count = %d) command %s with Repeat Bit set",
-                 adc_value & 0xFFFF, cmd_str);
-      } else {
-        snprintf(temp_buffer, sizeof(temp_buffer), "Debug: Repeat (Count = %d) command %s with Repeat Bit clear",
-                 adc_value & 0xFFFF, cmd_str);
-      }
-      strcat(buffer, temp_buffer);
+    case ADC_DBG_REPEAT:
+      d.command = ADC_DBG_COMMAND(adc_value);
+      d.flag = ADC_DBG_REPEAT_BIT(adc_value);
+      d.value = (int32_t)(adc_value & 0xFFFF);
       break;
-    }
-    case ADC_DBG_N_CS_TIMER: {
-      snprintf(temp_buffer, sizeof(temp_buffer), "Debug: Starting ~CS timer with value = %d", adc_value & 0x0FFF);
-      strcat(buffer, temp_buffer);
+    case ADC_DBG_N_CS_TIMER:
+      d.value = (int32_t)(adc_value & 0x0FFF);
       break;
-    }
-    case ADC_DBG_SPI_BIT: {
-      snprintf(temp_buffer, sizeof(temp_buffer), "Debug: Starting SPI command at bit = %d", adc_value & 0x1F);
-      strcat(buffer, temp_buffer);
+    case ADC_DBG_SPI_BIT:
+      d.value = (int32_t)(adc_value & 0x1F);
       break;
-    }
-    case ADC_DBG_CMD_DONE: {
-      if (ADC_DBG_NEXT_CMD_READY(adc_value)) {
-        char cmd_str[32];
-        switch (ADC_DBG_COMMAND(adc_value)) {
-          case ADC_CMD_NO_OP:
-            strcpy(cmd_str, "NO_OP");
-            break;
-          case ADC_CMD_SET_ORD:
-            strcpy(cmd_str, "SET_ORD");
-            break;
-          case ADC_CMD_ADC_RD:
-            strcpy(cmd_str, "ADC_RD");
-            break;
-          case ADC_CMD_ADC_RD_CH:
-            strcpy(cmd_str, "ADC_RD_CH");
-            break;
-          case ADC_CMD_CANCEL:
-            strcpy(cmd_str, "CANCEL");
-            break;
-          default:
-            strcpy(cmd_str, "Unknown Command");
-            break;
-        }
-        snprintf(temp_buffer, sizeof(temp_buffer), "Debug: Command Done with next command ready: %s -- Remaining repeat count: %d",
-                 cmd_str, adc_value & 0xFFFF);
-      } else {
-        snprintf(temp_buffer, sizeof(temp_buffer), "Debug: Command Done with no next command ready -- Remaining repeat count: %d",
-                 adc_value & 0xFFFF);
-      }
-      strcat(buffer, temp_buffer);
+    case ADC_DBG_CMD_DONE:
+      d.command = ADC_DBG_COMMAND(adc_value);
+      d.flag = ADC_DBG_NEXT_CMD_READY(adc_value);
+      d.value = (int32_t)(adc_value & 0xFFFF);
       break;
-    }
-    default: {
-      snprintf(temp_buffer, sizeof(temp_buffer), "Debug: Unknown code %d with value 0x%08" PRIx32 "", debug_code, adc_value);
-      strcat(buffer, temp_buffer);
+    default:
+      d.value = (int32_t)adc_value;
       break;
-    }
   }
-
-  return buffer;
+  return d;
 }
 
-// Interpret and format the ADC state
-char* adc_format_state(uint8_t state_code, bool verbose) {
-  static char buffer[64];  // Static buffer for return string
-  buffer[0] = '\0';  // Initialize as empty string
+// Format the ADC state into a caller-provided buffer
+int adc_format_state_r(uint8_t state_code, bool verbose, char* buf, size_t size) {
+  const char* name = adc_state_name(state_code);
+  const char* prefix = verbose ? "ADC State code: " : "";
+  if (name == NULL) {
+    return verbose ? snprintf(buf, size, "%s%d\nUnknown State: %d", prefix, state_code, state_code)
+                   : snprintf(buf, size, "Unknown State: %d", state_code);
+  }
+  return verbose ? snprintf(buf, size, "%s%d\n%s", prefix, state_code, name) : snprintf(buf, size, "%s", name);
+}
 
+// Format an ADC debug word into a caller-provided buffer. Returns the length snprintf would have written.
+int adc_format_debug_r(uint32_t adc_value, bool verbose, char* buf, size_t size) {
+  int len = 0;
   if (verbose) {
-    char temp[32];
-    snprintf(temp, sizeof(temp), "ADC State code: %d\n", state_code);
-    strcat(buffer, temp);
+    len = snprintf(buf, size, "ADC Debug word: 0x%08" PRIx32 "\n", adc_value);
+    if (len < 0) return len;
+    if ((size_t)len >= size) len = size > 0 ? (int)size - 1 : 0;
   }
-
-  switch (state_code) {
-    case ADC_STATE_RESET:
-      strcat(buffer, "RESET");
-      break;
-    case ADC_STATE_INIT:
-      strcat(buffer, "Init");
-      break;
-    case ADC_STATE_SET_OTF:
-      strcat(buffer, "Set OTF mode");
-      break;
-    case ADC_STATE_REQ_RD:
-      strcat(buffer, "Request Read");
+  char* out = buf + len;
+  size_t room = size - (size_t)len;
+
+  adc_debug_decoded_t d = adc_decode_debug(adc_value);
+  int n;
+  switch (d.code) {
+    case ADC_DBG_MISO_DATA:
+      n = snprintf(out, room, "Debug: Startup test MISO Data = 0x%04" PRIx32 " (signed: %d)", adc_value & 0xFFFF, (int)d.value);
       break;
-    case ADC_STATE_TEST_RD:
-      strcat(buffer, "Test Read");
-      break;
-    case ADC_STATE_IDLE:
-      strcat(buffer, "Idle");
-      break;
-    case ADC_STATE_DELAY:
-      strcat(buffer, "Delay Wait");
+    case ADC_DBG_STATE_TRANSITION: {
+      char from_state_str[64];
+      char to_state_str[64];
+      adc_format_state_r(d.from_state, verbose, from_state_str, sizeof(from_state_str));
+      adc_format_state_r(d.to_state, verbose, to_state_str, sizeof(to_state_str));
+      n = snprintf(out, room, "Debug: State Transition from %s to %s", from_state_str, to_state_str);
       break;
-    case ADC_STATE_TRIG_WAIT:
-      strcat(buffer, "Trigger Wait");
+    }
+    case ADC_DBG_REPEAT:
+      n = snprintf(out, room, "Debug: Repeat (Count = %d) command %s with Repeat Bit %s",
+                   (int)d.value, adc_cmd_name(d.command), d.flag ? "set" : "clear");
       break;
-    case ADC_STATE_ADC_RD:
-      strcat(buffer, "ADC Read");
+    case ADC_DBG_N_CS_TIMER:
+      n = snprintf(out, room, "Debug: Starting ~CS timer with value = %d", (int)d.value);
       break;
-    case ADC_STATE_ADC_RD_CH:
-      strcat(buffer, "ADC Read Channel");
+    case ADC_DBG_SPI_BIT:
+      n = snprintf(out, room, "Debug: Starting SPI command at bit = %d", (int)d.value);
       break;
-    case ADC_STATE_ERROR:
-      strcat(buffer, "ERROR");
+    case ADC_DBG_CMD_DONE:
+      if (d.flag) {
+        n = snprintf(out, room, "Debug: Command Done with next command ready: %s -- Remaining repeat count: %d",
+                     adc_cmd_name(d.command), (int)d.value);
+      } else {
+        n = snprintf(out, room, "Debug: Command Done with no next command ready -- Remaining repeat count: %d",
+                     (int)d.value);
+      }
       break;
-    default: {
-      char temp[32];
-      snprintf(temp, sizeof(temp), "Unknown State: %d", state_code);
-      strcat(buffer, temp);
+    default:
+      n = snprintf(out, room, "Debug: Unknown code %d with value 0x%08" PRIx32 "", d.code, adc_value);
       break;
-    }
   }
+  return n < 0 ? n : len + n;
+}
 
+// Interpret and format ADC value as debug information (per-thread buffer)
+char* adc_format_debug(uint32_t adc_value, bool verbose) {
+  static __thread char buffer[512];
+  adc_format_debug_r(adc_value, verbose, buffer, sizeof(buffer));
+  return buffer;
+}
+
+// Interpret and format the ADC state (per-thread buffer)
+char* adc_format_state(uint8_t state_code, bool verbose) {
+  static __thread char buffer[64];
+  adc_format_state_r(state_code, verbose, buffer, sizeof(buffer));
   return buffer;
 }
 
 // Interpret and format an ADC command word by decoding command-specific fields
 char* adc_format_command(uint32_t cmd_word, bool verbose) {
-  static char buffer[512];  // Static buffer for return string
+  static __thread char buffer[512];  // Static buffer for return string
   char temp[160];
   uint8_t cmd_code = (uint8_t)((cmd_word >> ADC_CMD_CMD_LSB) & 0x7);
   uint8_t trig = (uint8_t)((cmd_word >> ADC_CMD_TRIG_BIT) & 0x1);
@@ -283,8 +268,8 @@ char* adc_format_command(uint32_t cmd_word, bool verbose) {
 
 // ADC command word functions
 void adc_cmd_noop(struct adc_ctrl_t *adc_ctrl, uint8_t board, adc_wait_mode_t trig, adc_continue_mode_t cont, uint32_t value, bool verbose) {
-  if (board > 7) {
-    fprintf(stderr, "Invalid ADC board: %d. Must be 0-7.\n", board);
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid ADC board: %d. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
     return;
   }
   if (value > 0x1FFFFFF) {
@@ -303,8 +288,8 @@ void adc_cmd_noop(struct adc_ctrl_t *adc_ctrl, uint8_t board, adc_wait_mode_t tr
 }
 
 void adc_cmd_adc_rd(struct adc_ctrl_t *adc_ctrl, uint8_t board, adc_wait_mode_t trig, adc_continue_mode_t cont, uint32_t value, uint32_t repeat_count, bool verbose) {
-  if (board > 7) {
-    fprintf(stderr, "Invalid ADC board: %d. Must be 0-7.\n", board);
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid ADC board: %d. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
     return;
   }
   if (value > 0x1FFFFFF) {
@@ -331,8 +316,8 @@ void adc_cmd_adc_rd(struct adc_ctrl_t *adc_ctrl, uint8_t board, adc_wait_mode_t
 }
 
 void adc_cmd_adc_rd_ch(struct adc_ctrl_t *adc_ctrl, uint8_t board, uint8_t ch, uint32_t repeat_count, bool verbose) {
-  if (board > 7) {
-    fprintf(stderr, "Invalid ADC board: %d. Must be 0-7.\n", board);
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid ADC board: %d. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
     return;
   }
   if (ch > 7) {
@@ -358,8 +343,8 @@ void adc_cmd_adc_rd_ch(struct adc_ctrl_t *adc_ctrl, uint8_t board, uint8_t ch, u
 }
 
 void adc_cmd_set_ord(struct adc_ctrl_t *adc_ctrl, uint8_t board, uint8_t channel_order[8], bool verbose) {
-  if (board > 7) {
-    fprintf(stderr, "Invalid ADC board: %d. Must be 0-7.\n", board);
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid ADC board: %d. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
     return;
   }
   // Validate channel order values (duplicates are okay, just must be 0-7)
@@ -386,11 +371,12 @@ void adc_cmd_set_ord(struct adc_ctrl_t *adc_ctrl, uint8_t board, uint8_t channel
            channel_order[4], channel_order[5], channel_order[6], channel_order[7]);
   }
   *(adc_ctrl->buffer[board]) = cmd_word;
+  memmove(adc_ctrl->channel_order[board], channel_order, 8);
 }
 
 void adc_cmd_cancel(struct adc_ctrl_t *adc_ctrl, uint8_t board, bool verbose) {
-  if (board > 7) {
-    fprintf(stderr, "Invalid ADC board: %d. Must be 0-7.\n", board);
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid ADC board: %d. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
     return;
   }
 
@@ -402,9 +388,21 @@ void adc_cmd_cancel(struct adc_ctrl_t *adc_ctrl, uint8_t board, bool verbose) {
   *(adc_ctrl->buffer[board]) = cmd_word;
 }
 
+// Model of ads816x_adc_timing_calc for the ADS8168 (ADS_MODEL_ID 8 in the block design).
+// Times are in units of 2^-30 s ("NiS"), rounded up like the core.
+// n_cs high time = min(255, max(ceil(f * 709 NiS), ceil(f * 1074 NiS) - 16, 3)), min delay = 9 * (n_cs + 16)
+uint32_t adc_calc_min_delay_time(uint32_t spi_clk_freq_hz) {
+  uint64_t conv_cycles = ((uint64_t)spi_clk_freq_hz * 709 + 0x3FFFFFFF) >> 30;
+  uint64_t cycle_cycles = ((uint64_t)spi_clk_freq_hz * 1074 + 0x3FFFFFFF) >> 30;
+  uint64_t n_cs_high_time = (conv_cycles < 3) ? 3 : conv_cycles;
+  if (cycle_cycles > 16 && cycle_cycles - 16 > n_cs_high_time) n_cs_high_time = cycle_cycles - 16;
+  if (n_cs_high_time > 255) n_cs_high_time = 255;
+  return (uint32_t)((n_cs_high_time + 16) * 9);
+}
+
 // Convert and format a single ADC sample from a 32-bit word (low 16 bits)
 char* adc_format_single(uint32_t data_word, bool verbose) {
-  static char buffer[64];  // Static buffer for return string
+  static __thread char buffer[64];  // Static buffer for return string
   char temp_buffer[32];
   buffer[0] = '\0';  // Initialize as empty string
 
@@ -422,7 +420,7 @@ char* adc_format_single(uint32_t data_word, bool verbose) {
 
 // Convert and format a pair of ADC samples from a 32-bit word
 char* adc_format_pair(uint32_t data_word, bool verbose) {
-  static char buffer[64];  // Static buffer for return string
+  static __thread char buffer[64];  // Static buffer for return string
   char temp_buffer[32];
   buffer[0] = '\0';  // Initialize as empty string
 
@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include "clk_ctrl.h"
 #include "sys_sts.h"
+#include "dac_ctrl.h"
+#include "adc_ctrl.h"
 #include "map_memory.h"
 
 #define CLK_RESET_KEY        ((uint32_t)0x0000000A)
@@ -27,6 +29,7 @@
 #define CLK_FB_FREQ_MAX_HZ   (1200000000.0)
 
 #define CLK_MAX_FREQ_HZ      (100000000.0) // 100 MHz max frequency for SPI system
+#define CLK_OPT_FREQ_MARGIN  (1e-4) // Relative margin on the measured frequency when modeling the timing-calc cores
 
 #define CLK_FB_MULT_WHOLE(encoded) (((encoded) & CLK_FB_MULT_WHOLE_MASK) >> CLK_FB_MULT_WHOLE_SHIFT)
 #define CLK_FB_MULT_FRAC(encoded)  (((encoded) & CLK_FB_MULT_FRAC_MASK) >> CLK_FB_MULT_FRAC_SHIFT)
@@ -527,3 +530,123 @@ int clk_ctrl_set_target_freq(struct clk_ctrl_t *clk_ctrl, struct sys_sts_t *sys_
 
   return 0;
 }
+
+// Greatest common divisor (used to skip duplicate feedback ratios)
+static uint32_t gcd_u32(uint32_t a, uint32_t b) {
+  while (b != 0) {
+    uint32_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+// Weighted DAC/ADC cycle time in seconds at a given SPI clock frequency.
+// Cycle counts are taken slightly above the nominal frequency so a measured frequency a few ppm high
+// doesn't push the timing-calc cores over a rounding step.
+static double weighted_cycle_time(double freq_hz, double dac_weight, double adc_weight) {
+  uint32_t model_freq_hz = (uint32_t)pos_ceil(freq_hz * (1.0 + CLK_OPT_FREQ_MARGIN));
+  return (dac_weight * (double)dac_calc_min_delay_time(model_freq_hz) +
+          adc_weight * (double)adc_calc_min_delay_time(model_freq_hz)) / freq_hz;
+}
+
+// Search all legal MMCM settings for the one minimizing the weighted DAC/ADC minimum cycle time and load it
+int clk_ctrl_optimize(struct clk_ctrl_t *clk_ctrl, struct sys_sts_t *sys_sts, double dac_weight, double adc_weight,
+                      double max_freq_hz, bool verbose) {
+  if (dac_weight < 0.0 || adc_weight < 0.0 || (dac_weight + adc_weight) <= 0.0) {
+    fprintf(stderr, "Invalid workload weights: DAC %.3f, ADC %.3f. Must be non-negative and not both zero.\n",
+            dac_weight, adc_weight);
+    return -1;
+  }
+  if (max_freq_hz <= 0.0 || max_freq_hz > CLK_MAX_FREQ_HZ) {
+    fprintf(stderr, "Invalid maximum frequency: %.6f Hz. Must be in (0, %.0f] Hz.\n", max_freq_hz, CLK_MAX_FREQ_HZ);
+    return -1;
+  }
+
+  uint32_t source_clk_freq_hz = sys_sts_get_source_clk_freq_hz(sys_sts, verbose);
+  if (source_clk_freq_hz == 0) {
+    fprintf(stderr, "Invalid source clock frequency: 0 Hz. Cannot optimize SPI clock.\n");
+    return -1;
+  }
+
+  double best_cost = 0.0;
+  double best_freq_hz = 0.0;
+  uint32_t best_clk_fb_mult_8 = 0;
+  uint8_t  best_clk_fb_div    = 0;
+  uint32_t best_clk_div_8     = 0;
+  uint32_t candidates = 0;
+
+  // Enumerate every reduced fb_mult_8 / fb_div ratio in the VCO range (non-reduced pairs give the same VCO),
+  // then every clk_div_8 down to half the maximum frequency. Below that the fixed minimum n_cs high times
+  // of both cores dominate and the cycle time only grows as the clock slows.
+  for (uint32_t fb_div = 1; fb_div <= 255; fb_div++) {
+    uint32_t fb_mult_8_min = (uint32_t)pos_ceil(
+        (CLK_FB_FREQ_MIN_HZ * (double)fb_div * 8.0) / (double)source_clk_freq_hz);
+    uint32_t fb_mult_8_max = (uint32_t)pos_floor(
+        (CLK_FB_FREQ_MAX_HZ * (double)fb_div * 8.0) / (double)source_clk_freq_hz);
+    if (fb_mult_8_max > 2047) fb_mult_8_max = 2047;
+
+    for (uint32_t fb_mult_8 = fb_mult_8_min; fb_mult_8 <= fb_mult_8_max; fb_mult_8++) {
+      if (gcd_u32(fb_mult_8, fb_div) != 1) continue;
+      double vco_freq = (double)source_clk_freq_hz * ((double)fb_mult_8 / 8.0) / (double)fb_div;
+      if (vco_freq < CLK_FB_FREQ_MIN_HZ || vco_freq > CLK_FB_FREQ_MAX_HZ) continue;
+
+      uint32_t clk_div_8_min = (uint32_t)pos_ceil(vco_freq * 8.0 / max_freq_hz);
+      if (clk_div_8_min < 1) clk_div_8_min = 1;
+
+      for (uint32_t clk_div_8 = clk_div_8_min; clk_div_8 <= 2047; clk_div_8++) {
+        double freq_hz = vco_freq * 8.0 / (double)clk_div_8;
+        if (freq_hz > max_freq_hz) continue;
+        if (freq_hz < max_freq_hz / 2.0) break;
+
+        double cost = weighted_cycle_time(freq_hz, dac_weight, adc_weight);
+        candidates++;
+
+        // Prefer the lower frequency on ties
+        if (best_clk_fb_div == 0 || cost < best_cost ||
+            (cost == best_cost && freq_hz < best_freq_hz)) {
+          best_cost          = cost;
+          best_freq_hz       = freq_hz;
+          best_clk_fb_mult_8 = fb_mult_8;
+          best_clk_fb_div    = (uint8_t)fb_div;
+          best_clk_div_8     = clk_div_8;
+        }
+      }
+    }
+  }
+
+  if (best_clk_fb_div == 0) {
+    fprintf(stderr, "No feasible SPI clock configuration found at or below %.6f MHz with source clock %.6f MHz.\n",
+            max_freq_hz / 1e6, ((double)source_clk_freq_hz) / 1e6);
+    return -1;
+  }
+
+  double best_clk_fb_mult = (double)best_clk_fb_mult_8 / 8.0;
+  double best_clk_div     = (double)best_clk_div_8     / 8.0;
+  uint32_t best_model_freq_hz = (uint32_t)pos_ceil(best_freq_hz * (1.0 + CLK_OPT_FREQ_MARGIN));
+  uint32_t dac_min_delay = dac_calc_min_delay_time(best_model_freq_hz);
+  uint32_t adc_min_delay = adc_calc_min_delay_time(best_model_freq_hz);
+
+  printf("Optimal SPI clock (DAC weight %.3f, ADC weight %.3f, %u candidates):\n", dac_weight, adc_weight, candidates);
+  printf("  Frequency:   %.6f MHz\n", best_freq_hz / 1e6);
+  printf("  DAC update:  %u cycles (%.3f us, %.2f kHz)\n",
+         dac_min_delay, dac_min_delay / best_freq_hz * 1e6, best_freq_hz / dac_min_delay / 1e3);
+  printf("  ADC read:    %u cycles (%.3f us, %.2f kHz)\n",
+         adc_min_delay, adc_min_delay / best_freq_hz * 1e6, best_freq_hz / adc_min_delay / 1e3);
+  if (verbose) {
+    double vco_freq = (double)source_clk_freq_hz * best_clk_fb_mult / (double)best_clk_fb_div;
+    printf("  clk_fb_mult: %.3f\n", best_clk_fb_mult);
+    printf("  clk_fb_div:  %u\n",   best_clk_fb_div);
+    printf("  clk_div:     %.3f\n", best_clk_div);
+    printf("  VCO freq:    %.3f MHz (bounds: %.0f-%.0f MHz)\n",
+           vco_freq / 1e6, CLK_FB_FREQ_MIN_HZ / 1e6, CLK_FB_FREQ_MAX_HZ / 1e6);
+  }
+
+  if (clk_ctrl_set_clk_fb(clk_ctrl, sys_sts, best_clk_fb_mult, best_clk_fb_div, verbose) != 0) {
+    return -1;
+  }
+  clk_ctrl_set_clk_div(clk_ctrl, best_clk_div, verbose);
+  clk_ctrl_load_user(clk_ctrl, verbose);
+
+  return 0;
+}
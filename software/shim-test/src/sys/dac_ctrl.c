@@ -3,6 +3,7 @@
 #include <string.h>
 #include <inttypes.h> // For PRIx32 format specifier
 #include "dac_ctrl.h"
+#include "dac_dma.h"
 #include "map_memory.h"
 
 // Create DAC control structure for all boards
@@ -10,172 +11,187 @@ struct dac_ctrl_t create_dac_ctrl(bool verbose) {
   struct dac_ctrl_t dac_ctrl;
 
   // Map DAC FIFO for each board
-  for (int board = 0; board < 8; board++) {
-    dac_ctrl.buffer[board] = map_32bit_memory(DAC_FIFO(board), 1, "DAC FIFO", verbose);
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    dac_ctrl.buffer[board] = map_32bit_memory(DAC_FIFO(board), DAC_FIFO_WINDOW_WORDS, "DAC FIFO", verbose);
     if (dac_ctrl.buffer[board] == NULL) {
       fprintf(stderr, "Failed to map DAC FIFO access for board %d\n", board);
       exit(EXIT_FAILURE);
     }
   }
+  dac_ctrl.dma = NULL; // Attached by the caller once DMA is mapped
 
   return dac_ctrl;
 }
 
+// Whether the CPU may write commands to a board: valid board, and no DMA stream feeding its FIFO.
+// The FIFO interleaves writers word by word, so a CPU command could otherwise land inside a DMA'd DAC_WR frame.
+static bool dac_cmd_writable(struct dac_ctrl_t *dac_ctrl, uint8_t board) {
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid DAC board: %d. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
+    return false;
+  }
+  if (dac_ctrl->dma != NULL && dac_dma_busy(dac_ctrl->dma, board)) {
+    fprintf(stderr, "DAC DMA is streaming to board %d; stop it before sending other DAC commands.\n", board);
+    return false;
+  }
+  return true;
+}
+
 // Read DAC data from a specific board
 uint32_t dac_read_data(struct dac_ctrl_t *dac_ctrl, uint8_t board) {
-  if (board > 7) {
-    fprintf(stderr, "Invalid DAC board: %d. Must be 0-7.\n", board);
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid DAC board: %d. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
     return 0; // Return 0 for invalid board
   }
 
   return *(dac_ctrl->buffer[board]);
 }
 
-// Interpret and format DAC data word as calibration or debug information
-char* dac_format_data(uint32_t dac_value, bool verbose) {
-  static char buffer[512];  // Static buffer for return string
-  char temp_buffer[256];
-  buffer[0] = '\0';  // Initialize as empty string
+// Write a block of command words to a specific board
+void dac_write_words(struct dac_ctrl_t *dac_ctrl, uint8_t board, const uint32_t *words, size_t count) {
+  if (!dac_cmd_writable(dac_ctrl, board)) return;
 
-  if (verbose) {
-    snprintf(temp_buffer, sizeof(temp_buffer), "DAC Data word: 0x%08X\n", dac_value);
-    strcat(buffer, temp_buffer);
+  fifo_window_write(dac_ctrl->buffer[board], DAC_FIFO_WINDOW_WORDS, words, count);
+}
+
+// Name of a DAC core state (NULL if unknown)
+const char* dac_state_name(uint8_t state_code) {
+  switch (state_code) {
+    case DAC_STATE_RESET:          return "RESET";
+    case DAC_STATE_INIT:           return "Init";
+    case DAC_STATE_TEST_WR:        return "Test Write";
+    case DAC_STATE_REQ_RD:         return "Request Read";
+    case DAC_STATE_TEST_RD:        return "Test Read";
+    case DAC_STATE_SET_MID:        return "Set Midrange";
+    case DAC_STATE_IDLE:           return "Idle";
+    case DAC_STATE_DELAY:          return "Delay Wait";
+    case DAC_STATE_TRIG_WAIT:      return "Trigger Wait";
+    case DAC_STATE_DAC_WR:         return "DAC Write";
+    case DAC_STATE_DAC_WR_CH:      return "DAC Write Channel";
+    case DAC_STATE_PRE_DELAY_WAIT: return "Pre-Delay Wait";
+    case DAC_STATE_ERROR:          return "ERROR";
+    default:                       return NULL;
   }
+}
 
-  uint8_t data_code = DAC_DATA_CODE(dac_value);
-  switch (data_code) {
-    case DAC_DBG_MISO_DATA: {
-      snprintf(temp_buffer, sizeof(temp_buffer), "Debug: MISO Data = 0x%04X", dac_value & 0xFFFF);
-      strcat(buffer, temp_buffer);
+// Name of a 4-bit AD5676 SPI command
+const char* dac_spi_cmd_name(uint8_t spi_cmd) {
+  switch (spi_cmd) {
+    case DAC_SPI_CMD_NO_OP:            return "NO_OP";
+    case DAC_SPI_CMD_DAC_WR_LDAC_WAIT: return "DAC_WR_LDAC_WAIT";
+    case DAC_SPI_CMD_DAC_WR_IMMEDIATE: return "DAC_WR_IMMEDIATE";
+    case DAC_SPI_CMD_REQ_RD:           return "REQ_RD";
+    default:                           return "Unknown Command";
+  }
+}
+
+// Decode a DAC data word into its fields
+dac_data_decoded_t dac_decode_data(uint32_t dac_value) {
+  dac_data_decoded_t d = {0};
+  d.code = DAC_DATA_CODE(dac_value);
+  switch (d.code) {
+    case DAC_DBG_MISO_DATA:
+      d.value = (int32_t)(dac_value & 0xFFFF);
       break;
-    }
-    case DAC_DBG_STATE_TRANSITION: {
-      uint8_t from_state = (dac_value >> 4) & 0x0F;
-      uint8_t to_state = dac_value & 0x0F;
-      char from_state_str[64];  // Local copy to avoid static buffer overwrite
-      strcpy(from_state_str, dac_format_state(from_state, verbose));  // Copy the first result
-      char to_state_str[64];  // Local copy to avoid static buffer overwrite
-      strcpy(to_state_str, dac_format_state(to_state, verbose));  // Copy the second result
-      snprintf(temp_buffer, sizeof(temp_buffer), "Debug: State Transition from %s to %s", from_state_str, to_state_str);
-      strcat(buffer, temp_buffer);
+    case DAC_DBG_STATE_TRANSITION:
+      d.from_state = (dac_value >> 4) & 0x0F;
+      d.to_state = dac_value & 0x0F;
       break;
-    }
-    case DAC_DBG_N_CS_TIMER: {
-      snprintf(temp_buffer, sizeof(temp_buffer), "Debug: n_cs Timer = %d", dac_value & 0x0FFF);
-      strcat(buffer, temp_buffer);
+    case DAC_DBG_N_CS_TIMER:
+      d.value = (int32_t)(dac_value & 0x0FFF);
       break;
-    }
-    case DAC_DBG_SPI_BIT: {
-      snprintf(temp_buffer, sizeof(temp_buffer), "Debug: SPI Bit Counter = %d", dac_value & 0x1F);
-      strcat(buffer, temp_buffer);
+    case DAC_DBG_SPI_BIT:
+      d.value = (int32_t)(dac_value & 0x1F);
       break;
-    }
-    case DAC_DBG_DAC_WRITE: {
-      char cmd_str[32];
-      switch (DAC_SPI_CMD_WORD(dac_value)) {
-        case DAC_SPI_CMD_NO_OP:
-          strcpy(cmd_str, "NO_OP");
-          break;
-        case DAC_SPI_CMD_DAC_WR_LDAC_WAIT:
-          strcpy(cmd_str, "DAC_WR_LDAC_WAIT");
-          break;
-        case DAC_SPI_CMD_DAC_WR_IMMEDIATE:
-          strcpy(cmd_str, "DAC_WR_IMMEDIATE");
-          break;
-        case DAC_SPI_CMD_REQ_RD:
-          strcpy(cmd_str, "REQ_RD");
-          break;
-        default:
-          strcpy(cmd_str, "Unknown Command");
-          break;
-      }
-      snprintf(temp_buffer, sizeof(temp_buffer), "Debug: DAC SPI Word Writing = 0x%06X\n  Command: %s to Register: %1d, Data: %05d",
-               dac_value & 0xFFFFFF, cmd_str, DAC_SPI_REG_ADDR(dac_value), DAC_SPI_DATA(dac_value));
-      strcat(buffer, temp_buffer);
+    case DAC_DBG_DAC_WRITE:
+      d.spi_cmd = DAC_SPI_CMD_WORD(dac_value);
+      d.spi_reg = DAC_SPI_REG_ADDR(dac_value);
+      d.value = (int32_t)DAC_SPI_DATA(dac_value);
       break;
-    }
-    case DAC_CAL_DATA: {
-      uint8_t channel = DAC_CAL_DATA_CH(dac_value);
-      int16_t cal_value = DAC_CAL_DATA_VAL(dac_value);
-      snprintf(temp_buffer, sizeof(temp_buffer), "Calibration: Channel %d = %d", channel, cal_value);
-      strcat(buffer, temp_buffer);
+    case DAC_CAL_DATA:
+      d.channel = DAC_CAL_DATA_CH(dac_value);
+      d.value = DAC_CAL_DATA_VAL(dac_value);
       break;
-    }
-    default: {
-      snprintf(temp_buffer, sizeof(temp_buffer), "Data: Unknown code %d with value 0x%08" PRIx32 "", data_code, dac_value);
-      strcat(buffer, temp_buffer);
+    default:
+      d.value = (int32_t)dac_value;
       break;
-    }
   }
-
-  return buffer;
+  return d;
 }
 
-// Interpret and format the DAC state
-char* dac_format_state(uint8_t state_code, bool verbose) {
-  static char buffer[64];  // Static buffer for return string
-  buffer[0] = '\0';  // Initialize as empty string
+// Format the DAC state into a caller-provided buffer
+int dac_format_state_r(uint8_t state_code, bool verbose, char* buf, size_t size) {
+  const char* name = dac_state_name(state_code);
+  const char* prefix = verbose ? "DAC State code: " : "";
+  if (name == NULL) {
+    return verbose ? snprintf(buf, size, "%s%d\nUnknown State: %d", prefix, state_code, state_code)
+                   : snprintf(buf, size, "Unknown State: %d", state_code);
+  }
+  return verbose ? snprintf(buf, size, "%s%d\n%s", prefix, state_code, name) : snprintf(buf, size, "%s", name);
+}
 
+// Format a DAC data word into a caller-provided buffer. Returns the length snprintf would have written.
+int dac_format_data_r(uint32_t dac_value, bool verbose, char* buf, size_t size) {
+  int len = 0;
   if (verbose) {
-    char temp[32];
-    snprintf(temp, sizeof(temp), "DAC State code: %d\n", state_code);
-    strcat(buffer, temp);
+    len = snprintf(buf, size, "DAC Data word: 0x%08X\n", dac_value);
+    if (len < 0) return len;
+    if ((size_t)len >= size) len = size > 0 ? (int)size - 1 : 0;
   }
-
-  switch (state_code) {
-    case DAC_STATE_RESET:
-      strcat(buffer, "RESET");
-      break;
-    case DAC_STATE_INIT:
-      strcat(buffer, "Init");
-      break;
-    case DAC_STATE_TEST_WR:
-      strcat(buffer, "Test Write");
-      break;
-    case DAC_STATE_REQ_RD:
-      strcat(buffer, "Request Read");
-      break;
-    case DAC_STATE_TEST_RD:
-      strcat(buffer, "Test Read");
-      break;
-    case DAC_STATE_SET_MID:
-      strcat(buffer, "Set Midrange");
-      break;
-    case DAC_STATE_IDLE:
-      strcat(buffer, "Idle");
+  char* out = buf + len;
+  size_t room = size - (size_t)len;
+
+  dac_data_decoded_t d = dac_decode_data(dac_value);
+  int n;
+  switch (d.code) {
+    case DAC_DBG_MISO_DATA:
+      n = snprintf(out, room, "Debug: MISO Data = 0x%04X", (unsigned)d.value);
       break;
-    case DAC_STATE_DELAY:
-      strcat(buffer, "Delay Wait");
-      break;
-    case DAC_STATE_TRIG_WAIT:
-      strcat(buffer, "Trigger Wait");
+    case DAC_DBG_STATE_TRANSITION: {
+      char from_state_str[64];
+      char to_state_str[64];
+      dac_format_state_r(d.from_state, verbose, from_state_str, sizeof(from_state_str));
+      dac_format_state_r(d.to_state, verbose, to_state_str, sizeof(to_state_str));
+      n = snprintf(out, room, "Debug: State Transition from %s to %s", from_state_str, to_state_str);
       break;
-    case DAC_STATE_DAC_WR:
-      strcat(buffer, "DAC Write");
+    }
+    case DAC_DBG_N_CS_TIMER:
+      n = snprintf(out, room, "Debug: n_cs Timer = %d", (int)d.value);
       break;
-    case DAC_STATE_DAC_WR_CH:
-      strcat(buffer, "DAC Write Channel");
+    case DAC_DBG_SPI_BIT:
+      n = snprintf(out, room, "Debug: SPI Bit Counter = %d", (int)d.value);
       break;
-    case DAC_STATE_PRE_DELAY_WAIT:
-      strcat(buffer, "Pre-Delay Wait");
+    case DAC_DBG_DAC_WRITE:
+      n = snprintf(out, room, "Debug: DAC SPI Word Writing = 0x%06X\n  Command: %s to Register: %1d, Data: %05d",
+                   dac_value & 0xFFFFFF, dac_spi_cmd_name(d.spi_cmd), d.spi_reg, (int)d.value);
       break;
-    case DAC_STATE_ERROR:
-      strcat(buffer, "ERROR");
+    case DAC_CAL_DATA:
+      n = snprintf(out, room, "Calibration: Channel %d = %d", d.channel, (int)d.value);
       break;
-    default: {
-      char temp[32];
-      snprintf(temp, sizeof(temp), "Unknown State: %d", state_code);
-      strcat(buffer, temp);
+    default:
+      n = snprintf(out, room, "Data: Unknown code %d with value 0x%08" PRIx32 "", d.code, dac_value);
       break;
-    }
   }
+  return n < 0 ? n : len + n;
+}
 
+// Interpret and format DAC data word as calibration or debug information (per-thread buffer)
+char* dac_format_data(uint32_t dac_value, bool verbose) {
+  static __thread char buffer[512];
+  dac_format_data_r(dac_value, verbose, buffer, sizeof(buffer));
+  return buffer;
+}
+
+// Interpret and format the DAC state (per-thread buffer)
+char* dac_format_state(uint8_t state_code, bool verbose) {
+  static __thread char buffer[64];
+  dac_format_state_r(state_code, verbose, buffer, sizeof(buffer));
   return buffer;
 }
 
 // Interpret and format a DAC command word by decoding command-specific fields
 char* dac_format_command(uint32_t cmd_word, bool verbose) {
-  static char buffer[512];  // Static buffer for return string
+  static __thread char buffer[512];  // Static buffer for return string
   char temp[128];
   uint8_t cmd_code = (cmd_word >> DAC_CMD_CMD_LSB) & 0x7;
   uint8_t trig = (cmd_word >> DAC_CMD_TRIG_BIT) & 0x1;
@@ -248,21 +264,48 @@ char* dac_format_command(uint32_t cmd_word, bool verbose) {
   return buffer;
 }
 
+// Model of ad5676_dac_timing_calc. Times are in units of 2^-30 s ("NiS"), rounded up like the core.
+// n_cs high time = min(31, max(ceil(f * 892 NiS) - 24, ceil(f * 33 NiS), 3)), min delay = 8 * (n_cs + 24)
+uint32_t dac_calc_min_delay_time(uint32_t spi_clk_freq_hz) {
+  uint64_t update_cycles = ((uint64_t)spi_clk_freq_hz * 892 + 0x3FFFFFFF) >> 30;
+  uint64_t min_high_cycles = ((uint64_t)spi_clk_freq_hz * 33 + 0x3FFFFFFF) >> 30;
+  uint64_t n_cs_high_time = (update_cycles > 24) ? update_cycles - 24 : 0;
+  if (min_high_cycles < 3) min_high_cycles = 3;
+  if (n_cs_high_time < min_high_cycles) n_cs_high_time = min_high_cycles;
+  if (n_cs_high_time > 31) n_cs_high_time = 31;
+  return (uint32_t)((n_cs_high_time + 24) << 3);
+}
+
+// Encode a NO_OP command word
+uint32_t dac_encode_noop(dac_wait_mode_t trig, dac_continue_mode_t cont, dac_ldac_mode_t ldac, uint32_t value) {
+  return (DAC_CMD_NO_OP  << DAC_CMD_CMD_LSB ) |
+         ((ldac == DAC_LDAC ? 1 : 0) << DAC_CMD_LDAC_BIT) |
+         ((trig == DAC_TRIGGER_WAIT ? 1 : 0) << DAC_CMD_TRIG_BIT) |
+         ((cont == DAC_CONTINUE ? 1 : 0) << DAC_CMD_CONT_BIT) |
+         (value & 0x1FFFFFF);
+}
+
+// Encode a DAC_WR command word and its four channel pair words
+void dac_encode_dac_wr(const int16_t ch_vals[8], dac_wait_mode_t trig, dac_continue_mode_t cont, dac_ldac_mode_t ldac, uint32_t value, uint32_t words[DAC_WR_WORDS]) {
+  words[0] = (DAC_CMD_DAC_WR << DAC_CMD_CMD_LSB ) |
+             ((trig == DAC_TRIGGER_WAIT ? 1 : 0) << DAC_CMD_TRIG_BIT) |
+             ((cont == DAC_CONTINUE ? 1 : 0) << DAC_CMD_CONT_BIT) |
+             ((ldac == DAC_LDAC ? 1 : 0) << DAC_CMD_LDAC_BIT) |
+             (value & 0x1FFFFFF);
+  // Each word contains two channels: [31:16] = ch N+1, [15:0] = ch N
+  for (int i = 0; i < 8; i += 2) {
+    words[1 + i/2] = ((uint32_t)(uint16_t)ch_vals[i + 1] << 16) | (uint32_t)(uint16_t)ch_vals[i];
+  }
+}
+
 // DAC command word functions
 void dac_cmd_noop(struct dac_ctrl_t *dac_ctrl, uint8_t board, dac_wait_mode_t trig, dac_continue_mode_t cont, dac_ldac_mode_t ldac, uint32_t value, bool verbose) {
-  if (board > 7) {
-    fprintf(stderr, "Invalid DAC board: %d. Must be 0-7.\n", board);
-    return;
-  }
+  if (!dac_cmd_writable(dac_ctrl, board)) return;
   if (value > 0x1FFFFFF) {
     fprintf(stderr, "Invalid command value: %u. Must be 0 to 33554431 (25-bit value).\n", value);
     return;
   }
-  uint32_t cmd_word = (DAC_CMD_NO_OP  << DAC_CMD_CMD_LSB ) |
-                      ((ldac == DAC_LDAC ? 1 : 0) << DAC_CMD_LDAC_BIT) |
-                      ((trig == DAC_TRIGGER_WAIT ? 1 : 0) << DAC_CMD_TRIG_BIT) |
-                      ((cont == DAC_CONTINUE ? 1 : 0) << DAC_CMD_CONT_BIT) |
-                      (value & 0x1FFFFFF);
+  uint32_t cmd_word = dac_encode_noop(trig, cont, ldac, value);
 
   if (verbose) {
     printf("DAC[%d] NO_OP command word: 0x%08X\n", board, cmd_word);
@@ -271,45 +314,28 @@ void dac_cmd_noop(struct dac_ctrl_t *dac_ctrl, uint8_t board, dac_wait_mode_t tr
 }
 
 void dac_cmd_dac_wr(struct dac_ctrl_t *dac_ctrl, uint8_t board, int16_t ch_vals[8], dac_wait_mode_t trig, dac_continue_mode_t cont, dac_ldac_mode_t ldac, uint32_t value, bool verbose) {
-  if (board > 7) {
-    fprintf(stderr, "Invalid DAC board: %d. Must be 0-7.\n", board);
-    return;
-  }
+  if (!dac_cmd_writable(dac_ctrl, board)) return;
   if (value > 0x1FFFFFF) {
     fprintf(stderr, "Invalid command value: %u. Must be 0 to 33554431 (25-bit value).\n", value);
     return;
   }
 
-  uint32_t cmd_word = (DAC_CMD_DAC_WR << DAC_CMD_CMD_LSB ) |
-                      ((trig == DAC_TRIGGER_WAIT ? 1 : 0) << DAC_CMD_TRIG_BIT) |
-                      ((cont == DAC_CONTINUE ? 1 : 0) << DAC_CMD_CONT_BIT) |
-                      ((ldac == DAC_LDAC ? 1 : 0) << DAC_CMD_LDAC_BIT) |
-                      (value & 0x1FFFFFF);
+  // Command word and channel values go out as one 5-word block
+  uint32_t words[DAC_WR_WORDS];
+  dac_encode_dac_wr(ch_vals, trig, cont, ldac, value, words);
 
   if (verbose) {
-    printf("DAC[%d] DAC_WR command word: 0x%08X\n", board, cmd_word);
-  }
-  *(dac_ctrl->buffer[board]) = cmd_word;
-
-  // Write channel values
-  for (int i = 0; i < 8; i += 2) {
-    // Each word contains two channels: [31:16] = ch N+1, [15:0] = ch N
-    int16_t val0 = ch_vals[i];
-    int16_t val1 = ch_vals[i + 1];
-    uint32_t word = (((uint32_t)(uint16_t)val1 << 16) & 0xFFFF0000) | (((uint32_t)(uint16_t)val0) & 0x0000FFFF);
-    if (verbose) {
+    printf("DAC[%d] DAC_WR command word: 0x%08X\n", board, words[0]);
+    for (int i = 0; i < 8; i += 2) {
       printf("DAC[%d] Channel data word %d: 0x%08X (ch%d=0x%04X, ch%d=0x%04X)\n",
-             board, i/2, word, i, val0, i+1, val1);
+             board, i/2, words[1 + i/2], i, (uint16_t)ch_vals[i], i+1, (uint16_t)ch_vals[i + 1]);
     }
-    *(dac_ctrl->buffer[board]) = word;
   }
+  fifo_window_write(dac_ctrl->buffer[board], DAC_FIFO_WINDOW_WORDS, words, DAC_WR_WORDS);
 }
 
 void dac_cmd_dac_wr_ch(struct dac_ctrl_t *dac_ctrl, uint8_t board, uint8_t ch, int16_t ch_val, bool verbose) {
-  if (board > 7) {
-    fprintf(stderr, "Invalid DAC board: %d. Must be 0-7.\n", board);
-    return;
-  }
+  if (!dac_cmd_writable(dac_ctrl, board)) return;
   if (ch > 7) {
     fprintf(stderr, "Invalid DAC channel: %d. Must be 0-7.\n", ch);
     return;
@@ -327,10 +353,7 @@ void dac_cmd_dac_wr_ch(struct dac_ctrl_t *dac_ctrl, uint8_t board, uint8_t ch, i
 }
 
 void dac_cmd_set_cal(struct dac_ctrl_t *dac_ctrl, uint8_t board, uint8_t ch, int16_t cal, bool verbose) {
-  if (board > 7) {
-    fprintf(stderr, "Invalid DAC board: %d. Must be 0-7.\n", board);
-    return;
-  }
+  if (!dac_cmd_writable(dac_ctrl, board)) return;
   if (ch > 7) {
     fprintf(stderr, "Invalid channel: %d. Must be 0-7.\n", ch);
     return;
@@ -348,10 +371,7 @@ void dac_cmd_set_cal(struct dac_ctrl_t *dac_ctrl, uint8_t board, uint8_t ch, int
 }
 
 void dac_cmd_get_cal(struct dac_ctrl_t *dac_ctrl, uint8_t board, uint8_t channel, bool verbose) {
-  if (board > 7) {
-    fprintf(stderr, "Invalid DAC board: %d. Must be 0-7.\n", board);
-    return;
-  }
+  if (!dac_cmd_writable(dac_ctrl, board)) return;
   if (channel > 7) {
     fprintf(stderr, "Invalid channel: %d. Must be 0-7.\n", channel);
     return;
@@ -368,10 +388,7 @@ void dac_cmd_get_cal(struct dac_ctrl_t *dac_ctrl, uint8_t board, uint8_t channel
 }
 
 void dac_cmd_zero(struct dac_ctrl_t *dac_ctrl, uint8_t board, bool verbose) {
-  if (board > 7) {
-    fprintf(stderr, "Invalid DAC board: %d. Must be 0-7.\n", board);
-    return;
-  }
+  if (!dac_cmd_writable(dac_ctrl, board)) return;
 
   uint32_t cmd_word = (DAC_CMD_ZERO << DAC_CMD_CMD_LSB);
   if (verbose) {
@@ -381,10 +398,7 @@ void dac_cmd_zero(struct dac_ctrl_t *dac_ctrl, uint8_t board, bool verbose) {
 }
 
 void dac_cmd_cancel(struct dac_ctrl_t *dac_ctrl, uint8_t board, bool verbose) {
-  if (board > 7) {
-    fprintf(stderr, "Invalid DAC board: %d. Must be 0-7.\n", board);
-    return;
-  }
+  if (!dac_cmd_writable(dac_ctrl, board)) return;
 
   uint32_t cmd_word = (DAC_CMD_CANCEL << DAC_CMD_CMD_LSB);
   if (verbose) {
@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h> // For usleep
+#include <inttypes.h> // For PRIx32 format specifier
+#include "dac_dma.h"
+#include "map_memory.h"
+
+// Scatter-gather descriptor layout (32-bit word offsets, one descriptor per DAC_DMA_DESC_STRIDE bytes)
+#define DESC_NXTDESC         0
+#define DESC_NXTDESC_MSB     1
+#define DESC_BUFFER          2
+#define DESC_BUFFER_MSB      3
+#define DESC_CONTROL         6
+#define DESC_STATUS          7
+#define DESC_CONTROL_SOF     (uint32_t) (1 << 27)
+#define DESC_CONTROL_EOF     (uint32_t) (1 << 26)
+
+// Bound on a halt or soft reset taking effect
+#define DAC_DMA_TIMEOUT_US   10000
+
+// Physical address of a board's descriptor / command word
+static uint32_t desc_addr(uint8_t board, uint32_t index) {
+  return DAC_DMA_BOARD_MEM(board) + index * DAC_DMA_DESC_STRIDE;
+}
+static uint32_t data_addr(uint8_t board, size_t word) {
+  return DAC_DMA_BOARD_MEM(board) + DAC_DMA_DESC_BYTES + (uint32_t)(word * 4);
+}
+
+// Poll the status or control register until (reg & mask) == value. Returns 0, or -1 on timeout.
+static int wait_for_reg(volatile uint32_t *reg, uint32_t mask, uint32_t value) {
+  for (int waited = 0; waited < DAC_DMA_TIMEOUT_US; waited += 10) {
+    if ((*reg & mask) == value) return 0;
+    usleep(10);
+  }
+  return ((*reg & mask) == value) ? 0 : -1;
+}
+
+// Create DAC DMA structure for all boards
+struct dac_dma_t create_dac_dma(bool verbose) {
+  struct dac_dma_t dac_dma;
+
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    dac_dma.regs[board] = map_32bit_memory(DAC_DMA(board), DAC_DMA_WORDCOUNT, "DAC DMA", verbose);
+    dac_dma.mem[board] = map_32bit_memory(DAC_DMA_BOARD_MEM(board), DAC_DMA_BOARD_BYTES / 4, "DAC DMA memory", verbose);
+    if (dac_dma.regs[board] == NULL || dac_dma.mem[board] == NULL) {
+      // DMA is optional: the FIFOs can still be streamed from software without it
+      fprintf(stderr, "Warning: failed to map DAC DMA for board %d; DMA streaming is unavailable.\n", board);
+      dac_dma.regs[board] = NULL;
+      dac_dma.mem[board] = NULL;
+    }
+  }
+
+  return dac_dma;
+}
+
+// Whether DMA is available for a board
+bool dac_dma_available(struct dac_dma_t *dac_dma, uint8_t board) {
+  return board < SHIM_MAX_BOARDS && dac_dma->regs[board] != NULL && dac_dma->mem[board] != NULL;
+}
+
+// Copy command words into a board's DMA buffer (after the descriptor ring)
+int dac_dma_load(struct dac_dma_t *dac_dma, uint8_t board, const uint32_t *words, size_t count) {
+  if (!dac_dma_available(dac_dma, board)) {
+    fprintf(stderr, "DAC DMA is not available for board %d.\n", board);
+    return -1;
+  }
+  if (count > DAC_DMA_DATA_WORDS) {
+    fprintf(stderr, "DAC DMA buffer for board %d holds %u words; %zu requested.\n", board, DAC_DMA_DATA_WORDS, count);
+    return -1;
+  }
+
+  // The region is mapped uncached, so copy whole words rather than trust memcpy's access sizes
+  volatile uint32_t *data = dac_dma->mem[board] + DAC_DMA_DESC_BYTES / 4;
+  for (size_t i = 0; i < count; i++) {
+    data[i] = words[i];
+  }
+  return 0;
+}
+
+// Append descriptors covering count words of the data area starting at word first.
+// Returns the new descriptor count, or -1 if the ring is full (one slot is kept free for the cyclic tail pointer).
+static int add_descriptors(struct dac_dma_t *dac_dma, uint8_t board, int desc_count, size_t first, size_t count) {
+  while (count > 0) {
+    if (desc_count >= (int)DAC_DMA_DESC_COUNT - 1) return -1;
+    size_t chunk = count < DAC_DMA_DESC_MAX_WORDS ? count : DAC_DMA_DESC_MAX_WORDS;
+    volatile uint32_t *desc = dac_dma->mem[board] + desc_count * (DAC_DMA_DESC_STRIDE / 4);
+    for (uint32_t i = 0; i < DAC_DMA_DESC_STRIDE / 4; i++) desc[i] = 0;
+    desc[DESC_NXTDESC] = desc_addr(board, (uint32_t)desc_count + 1);
+    desc[DESC_BUFFER] = data_addr(board, first);
+    desc[DESC_CONTROL] = (uint32_t)(chunk * 4) | DESC_CONTROL_SOF | DESC_CONTROL_EOF;
+    desc_count++;
+    first += chunk;
+    count -= chunk;
+  }
+  return desc_count;
+}
+
+// Build the descriptor ring and start the engine
+int dac_dma_start(struct dac_dma_t *dac_dma, uint8_t board, size_t pass_words, size_t tail_words, uint32_t iterations, bool verbose) {
+  if (!dac_dma_available(dac_dma, board)) {
+    fprintf(stderr, "DAC DMA is not available for board %d.\n", board);
+    return -1;
+  }
+  if (pass_words == 0 || tail_words > pass_words || pass_words + tail_words > DAC_DMA_DATA_WORDS) {
+    fprintf(stderr, "Invalid DAC DMA buffer layout for board %d: %zu pass words, %zu tail words.\n",
+            board, pass_words, tail_words);
+    return -1;
+  }
+  if (dac_dma_busy(dac_dma, board)) {
+    fprintf(stderr, "DAC DMA for board %d is already running.\n", board);
+    return -1;
+  }
+
+  // Reset the engine so it accepts a new current descriptor
+  volatile uint32_t *regs = dac_dma->regs[board];
+  regs[DAC_DMA_MM2S_DMACR] = DAC_DMA_DMACR_RESET;
+  if (wait_for_reg(&regs[DAC_DMA_MM2S_DMACR], DAC_DMA_DMACR_RESET, 0) != 0) {
+    fprintf(stderr, "DAC DMA for board %d did not come out of reset.\n", board);
+    return -1;
+  }
+
+  // Cyclic: one pass, looped by the hardware. Otherwise every pass but the last, then the last pass ending with the tail.
+  bool cyclic = (iterations == 0);
+  int desc_count = 0;
+  if (cyclic) {
+    desc_count = add_descriptors(dac_dma, board, desc_count, 0, pass_words);
+  } else {
+    for (uint32_t i = 0; i + 1 < iterations && desc_count >= 0; i++) {
+      desc_count = add_descriptors(dac_dma, board, desc_count, 0, pass_words);
+    }
+    if (desc_count >= 0) desc_count = add_descriptors(dac_dma, board, desc_count, 0, pass_words - tail_words);
+    if (desc_count >= 0) desc_count = add_descriptors(dac_dma, board, desc_count, pass_words, tail_words);
+  }
+  if (desc_count < 0) {
+    fprintf(stderr, "DAC DMA for board %d: %u iterations of %zu words need more than %u descriptors. "
+            "Use fewer iterations, or 0 to loop until stopped.\n", board, iterations, pass_words, DAC_DMA_DESC_COUNT - 1);
+    return -1;
+  }
+  // Close the ring
+  dac_dma->mem[board][(desc_count - 1) * (DAC_DMA_DESC_STRIDE / 4) + DESC_NXTDESC] = desc_addr(board, 0);
+
+  if (verbose) {
+    if (cyclic) {
+      printf("DAC DMA[%d]: %d descriptor%s, %zu words per pass, looping until stopped\n",
+             board, desc_count, desc_count == 1 ? "" : "s", pass_words);
+    } else {
+      printf("DAC DMA[%d]: %d descriptor%s, %zu words per pass, %u pass%s\n",
+             board, desc_count, desc_count == 1 ? "" : "s", pass_words, iterations, iterations == 1 ? "" : "es");
+    }
+  }
+
+  __sync_synchronize(); // Descriptors and data are in memory before the engine starts
+  regs[DAC_DMA_MM2S_CURDESC] = desc_addr(board, 0);
+  regs[DAC_DMA_MM2S_DMACR] = DAC_DMA_DMACR_RS | (cyclic ? DAC_DMA_DMACR_CYCLIC : 0);
+  if (wait_for_reg(&regs[DAC_DMA_MM2S_DMASR], DAC_DMA_DMASR_HALTED, 0) != 0) {
+    fprintf(stderr, "DAC DMA for board %d did not start (status 0x%08" PRIx32 ").\n", board, regs[DAC_DMA_MM2S_DMASR]);
+    return -1;
+  }
+  // Writing the tail pointer starts the fetch. In cyclic mode it must point outside the ring.
+  regs[DAC_DMA_MM2S_TAILDESC] = desc_addr(board, cyclic ? (uint32_t)desc_count : (uint32_t)desc_count - 1);
+  return 0;
+}
+
+// Halt and reset the engine
+void dac_dma_stop(struct dac_dma_t *dac_dma, uint8_t board, bool verbose) {
+  if (!dac_dma_available(dac_dma, board)) return;
+  volatile uint32_t *regs = dac_dma->regs[board];
+
+  regs[DAC_DMA_MM2S_DMACR] = 0;
+  if (wait_for_reg(&regs[DAC_DMA_MM2S_DMASR], DAC_DMA_DMASR_HALTED, DAC_DMA_DMASR_HALTED) != 0 && verbose) {
+    printf("DAC DMA[%d]: did not halt cleanly, resetting\n", board);
+  }
+  regs[DAC_DMA_MM2S_DMACR] = DAC_DMA_DMACR_RESET;
+  if (wait_for_reg(&regs[DAC_DMA_MM2S_DMACR], DAC_DMA_DMACR_RESET, 0) != 0) {
+    fprintf(stderr, "DAC DMA for board %d did not come out of reset.\n", board);
+  } else if (verbose) {
+    printf("DAC DMA[%d]: stopped\n", board);
+  }
+}
+
+// Stop the engine of every board whose DAC command buffer bit (2 * board) is set in a buffer reset mask
+void dac_dma_stop_masked(struct dac_dma_t *dac_dma, uint32_t cmd_buf_mask, bool verbose) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    if (cmd_buf_mask & (1U << (board * 2))) {
+      dac_dma_stop(dac_dma, (uint8_t)board, verbose);
+    }
+  }
+}
+
+// MM2S status register
+uint32_t dac_dma_status(struct dac_dma_t *dac_dma, uint8_t board) {
+  if (!dac_dma_available(dac_dma, board)) return DAC_DMA_DMASR_HALTED;
+  return dac_dma->regs[board][DAC_DMA_MM2S_DMASR];
+}
+
+// Whether the engine is running and hasn't yet finished its descriptors
+bool dac_dma_busy(struct dac_dma_t *dac_dma, uint8_t board) {
+  uint32_t status = dac_dma_status(dac_dma, board);
+  return (status & (DAC_DMA_DMASR_HALTED | DAC_DMA_DMASR_IDLE)) == 0;
+}
+
+// Format the MM2S status register (per-thread buffer)
+char* dac_dma_format_status(uint32_t status) {
+  static __thread char buffer[256];
+  const char* state = (status & DAC_DMA_DMASR_HALTED) ? "Halted" : (status & DAC_DMA_DMASR_IDLE) ? "Idle (done)" : "Running";
+  int len = snprintf(buffer, sizeof(buffer), "%s (status 0x%08" PRIx32 ")", state, status);
+  if (status & DAC_DMA_DMASR_ERR_MASK) {
+    snprintf(buffer + len, sizeof(buffer) - (size_t)len, " errors:%s%s%s%s%s%s",
+             (status & (1 << 4)) ? " DMAIntErr" : "", (status & (1 << 5)) ? " DMASlvErr" : "",
+             (status & (1 << 6)) ? " DMADecErr" : "", (status & (1 << 8)) ? " SGIntErr" : "",
+             (status & (1 << 9)) ? " SGSlvErr" : "", (status & (1 << 10)) ? " SGDecErr" : "");
+  }
+  return buffer;
+}
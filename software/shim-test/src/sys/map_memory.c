@@ -6,6 +6,10 @@
 #include <stdlib.h> // For exit function and NULL definition etc.
 #include <sys/mman.h> // For mmap function
 #include <unistd.h> // For sysconf function
+#if defined(__ARM_NEON)
+#include <arm_neon.h> // For 128-bit block loads and stores
+#endif
+#include "map_memory.h"
 
 // Map a 32-bit memory region
 uint32_t *map_32bit_memory(uint32_t base_addr, size_t wordcount, char *name, bool verbose) {
@@ -49,3 +53,45 @@ uint32_t *map_32bit_memory(uint32_t base_addr, size_t wordcount, char *name, boo
   // Return the pointer to the mapped memory region
   return mapped_memory;
 }
+
+// Copy words into an aliased FIFO window. With NEON, four words go out per 128-bit store, which the
+// interconnect can turn into a burst; the tail (and everything without NEON) is written one word at a time.
+// memcpy isn't used: it may split or widen accesses, and the FIFO pushes a whole word per beat.
+void fifo_window_write(volatile uint32_t *window, size_t window_words, const uint32_t *words, size_t count) {
+  while (count > 0) {
+    size_t chunk = count < window_words ? count : window_words;
+    size_t i = 0;
+#if defined(__ARM_NEON)
+    uint32_t *dst = (uint32_t *)window;
+    for (; i + 4 <= chunk; i += 4) {
+      vst1q_u32(dst + i, vld1q_u32(words + i));
+    }
+    __asm__ volatile("" ::: "memory"); // Keep the block stores ahead of the tail and the next chunk
+#endif
+    for (; i < chunk; i++) {
+      window[i] = words[i];
+    }
+    words += chunk;
+    count -= chunk;
+  }
+}
+
+// Copy words out of an aliased FIFO window (see fifo_window_write)
+void fifo_window_read(volatile uint32_t *window, size_t window_words, uint32_t *words, size_t count) {
+  while (count > 0) {
+    size_t chunk = count < window_words ? count : window_words;
+    size_t i = 0;
+#if defined(__ARM_NEON)
+    const uint32_t *src = (const uint32_t *)window;
+    for (; i + 4 <= chunk; i += 4) {
+      vst1q_u32(words + i, vld1q_u32(src + i));
+    }
+    __asm__ volatile("" ::: "memory"); // Every chunk rereads the same addresses; don't let them be merged
+#endif
+    for (; i < chunk; i++) {
+      words[i] = window[i];
+    }
+    words += chunk;
+    count -= chunk;
+  }
+}
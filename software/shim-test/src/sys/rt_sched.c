@@ -0,0 +1,224 @@
+#define _GNU_SOURCE // pthread_setaffinity_np, CPU_SET
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <malloc.h>
+#include <sys/mman.h>
+#include "rt_sched.h"
+#include "timing.h"
+
+// SCHED_FIFO priority per class. Experiment loops stay below the default threaded-IRQ priority (50).
+static const int class_priority[RT_CLASS_COUNT] = {80, 70, 60, 40};
+static const char* class_names[RT_CLASS_COUNT] = {"control", "FIFO cmd", "FIFO data", "experiment"};
+
+static volatile bool rt_enabled = false;
+static int rt_fifo_cpu = RT_SCHED_DEFAULT_FIFO_CPU;
+static int rt_io_cpu = RT_SCHED_DEFAULT_IO_CPU;
+
+static rt_sched_thread_stats_t threads[RT_SCHED_MAX_THREADS];
+static uint32_t thread_count = 0;
+static pthread_mutex_t threads_mutex = PTHREAD_MUTEX_INITIALIZER; // Guards slot registration only
+static __thread rt_sched_thread_stats_t* current_thread = NULL;
+
+// Pin a thread to one CPU, or to every online CPU if cpu < 0
+static int pin_thread(pthread_t thread, int cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (cpu < 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    for (long i = 0; i < cpus && i < CPU_SETSIZE; i++) CPU_SET(i, &set);
+  } else {
+    CPU_SET(cpu, &set);
+  }
+  return pthread_setaffinity_np(thread, sizeof(set), &set);
+}
+
+// Touch the stack the thread's loop will use so it is resident (and locked) before the loop starts
+static void __attribute__((noinline)) prefault_stack(void) {
+  volatile uint8_t stack[RT_SCHED_STACK_PREFAULT];
+  memset((uint8_t*)stack, 0, sizeof(stack));
+}
+
+int rt_sched_enable(int fifo_cpu, int io_cpu, bool verbose) {
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  if (fifo_cpu < 0 || fifo_cpu >= cpus || io_cpu < 0 || io_cpu >= cpus) {
+    fprintf(stderr, "CPUs must be 0-%ld (FIFO CPU %d, I/O CPU %d)\n", cpus - 1, fifo_cpu, io_cpu);
+    return -1;
+  }
+  if (fifo_cpu == io_cpu && cpus > 1) {
+    fprintf(stderr, "Warning: FIFO and I/O threads share CPU %d\n", fifo_cpu);
+  }
+
+  // Keep freed heap memory in the process so buffers reused by later streams are never faulted in again
+  mallopt(M_TRIM_THRESHOLD, -1);
+  mallopt(M_MMAP_MAX, 0);
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+    fprintf(stderr, "Failed to lock memory (mlockall): %s. Run as root or raise RLIMIT_MEMLOCK.\n", strerror(errno));
+    mallopt(M_TRIM_THRESHOLD, 128 * 1024);
+    mallopt(M_MMAP_MAX, 65536);
+    return -1;
+  }
+
+  int err = pin_thread(pthread_self(), io_cpu);
+  if (err != 0) {
+    fprintf(stderr, "Failed to pin the command thread to CPU %d: %s\n", io_cpu, strerror(err));
+    munlockall();
+    return -1;
+  }
+
+  rt_fifo_cpu = fifo_cpu;
+  rt_io_cpu = io_cpu;
+  rt_enabled = true;
+  rt_sched_reset_stats();
+  if (verbose) {
+    printf("Real-time profile: FIFO threads on CPU %d (SCHED_FIFO %d-%d), command thread on CPU %d, memory locked\n",
+           fifo_cpu, class_priority[RT_CLASS_COUNT - 1], class_priority[0], io_cpu);
+  }
+  return 0;
+}
+
+void rt_sched_disable(bool verbose) {
+  if (!rt_enabled) return;
+  rt_enabled = false;
+  munlockall();
+  mallopt(M_TRIM_THRESHOLD, 128 * 1024); // glibc defaults
+  mallopt(M_MMAP_MAX, 65536);
+  pin_thread(pthread_self(), -1);
+  if (verbose) {
+    printf("Real-time profile disabled (running real-time threads keep their scheduling until they exit)\n");
+  }
+}
+
+bool rt_sched_enabled(void) {
+  return rt_enabled;
+}
+
+void rt_sched_thread_enter(rt_class_t rt_class, const char* name, int index) {
+  char full_name[RT_SCHED_NAME_LEN];
+  if (index >= 0) {
+    snprintf(full_name, sizeof(full_name), "%s %d", name, index);
+  } else {
+    snprintf(full_name, sizeof(full_name), "%s", name);
+  }
+
+  // Reuse the slot of an earlier thread with the same name, so restarted streams accumulate
+  pthread_mutex_lock(&threads_mutex);
+  rt_sched_thread_stats_t* slot = NULL;
+  for (uint32_t i = 0; i < thread_count; i++) {
+    if (strcmp(threads[i].name, full_name) == 0) {
+      slot = &threads[i];
+      break;
+    }
+  }
+  if (slot == NULL && thread_count < RT_SCHED_MAX_THREADS) {
+    slot = &threads[thread_count++];
+    memset(slot, 0, sizeof(*slot));
+    snprintf(slot->name, sizeof(slot->name), "%s", full_name);
+  }
+  pthread_mutex_unlock(&threads_mutex);
+  current_thread = slot;
+  if (slot == NULL) return;
+
+  slot->rt_class = rt_class;
+  slot->realtime = false;
+  slot->cpu = -1;
+  slot->priority = 0;
+  slot->last_ns = 0; // Don't count the time since the previous thread with this name stopped
+
+  if (!rt_enabled) return;
+  struct sched_param param = {.sched_priority = class_priority[rt_class]};
+  int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+  if (err != 0) {
+    fprintf(stderr, "%s: failed to set SCHED_FIFO priority %d: %s\n", full_name, param.sched_priority, strerror(err));
+  } else {
+    slot->priority = param.sched_priority;
+  }
+  err = pin_thread(pthread_self(), rt_fifo_cpu);
+  if (err != 0) {
+    fprintf(stderr, "%s: failed to pin to CPU %d: %s\n", full_name, rt_fifo_cpu, strerror(err));
+  } else {
+    slot->cpu = rt_fifo_cpu;
+  }
+  prefault_stack();
+  slot->realtime = (slot->priority != 0 && slot->cpu >= 0);
+}
+
+void rt_sched_loop_tick(void) {
+  rt_sched_thread_stats_t* slot = current_thread;
+  if (slot == NULL) return;
+  uint64_t t = timing_now_ns();
+  if (slot->last_ns != 0) {
+    uint64_t gap = t - slot->last_ns;
+    if (gap > slot->max_gap_ns) slot->max_gap_ns = gap;
+    slot->sum_gap_ns += gap;
+    slot->iterations++;
+  }
+  slot->last_ns = t;
+}
+
+void rt_sched_usleep(uint32_t usec) {
+  rt_sched_thread_stats_t* slot = current_thread;
+  if (slot == NULL) {
+    usleep(usec);
+    return;
+  }
+  uint64_t start = timing_now_ns();
+  usleep(usec);
+  uint64_t slept = timing_now_ns() - start;
+  uint64_t requested = (uint64_t)usec * 1000;
+  uint64_t late = slept > requested ? slept - requested : 0;
+  if (late > slot->max_wake_late_ns) slot->max_wake_late_ns = late;
+  slot->sleeps++;
+}
+
+void rt_sched_reset_stats(void) {
+  pthread_mutex_lock(&threads_mutex);
+  for (uint32_t i = 0; i < thread_count; i++) {
+    threads[i].iterations = 0;
+    threads[i].max_gap_ns = 0;
+    threads[i].sum_gap_ns = 0;
+    threads[i].sleeps = 0;
+    threads[i].max_wake_late_ns = 0;
+    threads[i].last_ns = 0;
+  }
+  pthread_mutex_unlock(&threads_mutex);
+}
+
+void rt_sched_print_status(void) {
+  if (rt_enabled) {
+    printf("Real-time profile: enabled (FIFO threads on CPU %d, command thread on CPU %d, memory locked)\n",
+           rt_fifo_cpu, rt_io_cpu);
+  } else {
+    printf("Real-time profile: disabled\n");
+  }
+
+  pthread_mutex_lock(&threads_mutex);
+  uint32_t count = thread_count;
+  pthread_mutex_unlock(&threads_mutex);
+  if (count == 0) {
+    printf("  No servicing threads have run yet.\n");
+    return;
+  }
+
+  // The gap is the time between loop iterations (including the loop's own sleep), i.e. the longest
+  // the thread left its FIFO unserviced. The wake latency is how far past its requested sleep it woke.
+  printf("  %-16s %-10s %-12s %12s %12s %12s %13s\n", "Thread", "Class", "Scheduling", "Iterations",
+         "Mean gap us", "Worst gap us", "Worst wake us");
+  for (uint32_t i = 0; i < count; i++) {
+    const rt_sched_thread_stats_t* t = &threads[i];
+    char sched[16];
+    if (t->realtime) {
+      snprintf(sched, sizeof(sched), "FIFO %d/cpu%d", t->priority, t->cpu);
+    } else {
+      snprintf(sched, sizeof(sched), "other");
+    }
+    double mean_us = t->iterations > 0 ? (double)t->sum_gap_ns / (double)t->iterations * 1e-3 : 0.0;
+    printf("  %-16s %-10s %-12s %12llu %12.1f %12.1f %13.1f\n", t->name, class_names[t->rt_class], sched,
+           (unsigned long long)t->iterations, mean_us, (double)t->max_gap_ns * 1e-3,
+           (double)t->max_wake_late_ns * 1e-3);
+  }
+}
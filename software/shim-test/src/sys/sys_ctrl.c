@@ -178,3 +178,8 @@ void sys_ctrl_toggle_dac_pre_delay(struct sys_ctrl_t *sys_ctrl, bool verbose) {
     printf("DAC pre-delay bit set to 0x%08" PRIx32 "\n", *(sys_ctrl->do_dac_pre_delay));
   }
 }
+
+// Whether the DAC pre-delay bit is set
+bool sys_ctrl_get_dac_pre_delay(struct sys_ctrl_t *sys_ctrl) {
+  return (*(sys_ctrl->do_dac_pre_delay) & 0x1) != 0;
+}
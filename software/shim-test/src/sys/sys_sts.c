@@ -6,6 +6,7 @@
 #include <pthread.h> // For pthread functions
 #include "sys_sts.h"
 #include "map_memory.h"
+#include "timing.h"
 
 // Function to create system status structure
 struct sys_sts_t create_sys_sts(bool verbose) {
@@ -22,7 +23,7 @@ struct sys_sts_t create_sys_sts(bool verbose) {
   sys_sts.hw_status_reg = sys_sts_ptr + HW_STS_REG_OFFSET;
 
   // Initialize FIFO status pointers for each board
-  for (int i = 0; i < 8; i++) {
+  for (int i = 0; i < SHIM_MAX_BOARDS; i++) {
     sys_sts.dac_cmd_fifo_sts[i] = sys_sts_ptr + DAC_CMD_FIFO_STS_OFFSET(i);
     sys_sts.dac_data_fifo_sts[i] = sys_sts_ptr + DAC_DATA_FIFO_STS_OFFSET(i);
     sys_sts.adc_cmd_fifo_sts[i] = sys_sts_ptr + ADC_CMD_FIFO_STS_OFFSET(i);
@@ -50,7 +51,7 @@ struct sys_sts_t create_sys_sts(bool verbose) {
   sys_sts.adc_min_delay_time = sys_sts_ptr + DEBUG_ADC_MIN_DELAY_TIME_OFFSET;
 
   // Initialize last command and command counter registers for each board
-  for (int i = 0; i < 8; i++) {
+  for (int i = 0; i < SHIM_MAX_BOARDS; i++) {
     sys_sts.last_received_dac_cmd[i] = sys_sts_ptr + DAC_LAST_RECEIVED_CMD_OFFSET(i);
     sys_sts.last_received_adc_cmd[i] = sys_sts_ptr + ADC_LAST_RECEIVED_CMD_OFFSET(i);
     sys_sts.dac_cmds_since_reset[i] = sys_sts_ptr + DAC_CMDS_SINCE_RESET_OFFSET(i);
@@ -96,226 +97,126 @@ uint32_t get_fifo_status(volatile uint32_t *fifo_sts_ptr, const char *fifo_name,
   return *fifo_sts_ptr;
 }
 
-// Interpret and print hardware status
-void print_hw_status(uint32_t hw_status, bool verbose) {
-  bool print_status = verbose;
-  bool print_board_number = verbose;
-  if (verbose) printf("Raw hardware state code: 0x%01" PRIx32 "\n", HW_STS_STATE(hw_status));
-  switch (HW_STS_STATE(hw_status)) {
-    case S_IDLE:
-      printf("State: Idle (Waiting For Control Board Enable)\n");
-      break;
-    case S_CONFIRM_SPI_RST:
-      printf("State: Confirm SPI Reset\n");
-      break;
-    case S_POWER_ON_CRTL_BRD:
-      printf("State: Power On Control Board\n");
-      break;
-    case S_CONFIRM_SPI_START:
-      printf("State: Confirm SPI Start\n");
-      break;
-    case S_WAIT_FOR_POW_EN:
-      printf("State: Waiting For Power Board Enable\n");
-      break;
-    case S_POWER_ON_AMP_BRD:
-      printf("State: Power On Amplifier Board\n");
-      break;
-    case S_AMP_POWER_WAIT:
-      printf("State: Amplifier Power Wait\n");
-      break;
-    case S_RUNNING:
-      printf("State: Running\n");
-      break;
-    case S_HALTING:
-      printf("State: Halting\n");
-      print_status = true;
-      break;
-    case S_HALTED:
-      printf("State: Halted\n");
-      print_status = true;
-      break;
-    default:
-      printf("State: Unknown (0x%01" PRIx32 ")\n", HW_STS_STATE(hw_status));
-      break;
+// Name of a hardware manager state (NULL if unknown)
+const char* hw_state_name(uint32_t state) {
+  switch (state) {
+    case S_IDLE: return "Idle (Waiting For Control Board Enable)";
+    case S_CONFIRM_SPI_RST: return "Confirm SPI Reset";
+    case S_POWER_ON_CRTL_BRD: return "Power On Control Board";
+    case S_CONFIRM_SPI_START: return "Confirm SPI Start";
+    case S_WAIT_FOR_POW_EN: return "Waiting For Power Board Enable";
+    case S_POWER_ON_AMP_BRD: return "Power On Amplifier Board";
+    case S_AMP_POWER_WAIT: return "Amplifier Power Wait";
+    case S_RUNNING: return "Running";
+    case S_HALTING: return "Halting";
+    case S_HALTED: return "Halted";
+    default: return NULL;
   }
-  if (verbose) printf("Raw hardware status code: 0x07%" PRIx32 "\n", HW_STS_CODE(hw_status));
+}
+
+// Description of a hardware status code (NULL if unknown). *has_board is set if the status reports a board number.
+const char* hw_status_code_name(uint32_t code, bool* has_board) {
+  bool board = false;
+  const char* name = NULL;
+  switch (code) {
+    case STS_EMPTY: name = "Empty"; break;
+    case STS_OK: name = "OK"; break;
+    case STS_PS_SHUTDOWN: name = "Processing system shutdown"; break;
+    case STS_SPI_RESET_TIMEOUT: name = "SPI initialization timeout"; break;
+    case STS_SPI_START_TIMEOUT: name = "SPI start timeout"; break;
+    case STS_LOCK_VIOL: name = "Configuration lock violation"; break;
+    case STS_CTRL_EN_OOB: name = "Control board enable register out of bounds"; break;
+    case STS_POW_EN_OOB: name = "Power board enable register out of bounds"; break;
+    case STS_CMD_BUF_RESET_OOB: name = "Command buffer reset out of bounds"; break;
+    case STS_DATA_BUF_RESET_OOB: name = "Data buffer reset out of bounds"; break;
+    case STS_THRESH_VAL_OOB: name = "Threshold average out of bounds"; break;
+    case STS_THRESH_WINDOW_OOB: name = "Threshold window out of bounds"; break;
+    case STS_THRESH_EN_OOB: name = "Threshold enable register out of bounds"; break;
+    case STS_BOOT_TEST_SKIP_OOB: name = "Boot test skip out of bounds"; break;
+    case STS_DEBUG_OOB: name = "Debug out of bounds"; break;
+    case STS_DAC_CAL_INIT_OOB: name = "DAC calibration initial value out of bounds"; break;
+    case STS_CLK_LOCKED_FAIL: name = "SPI clock manager PLL not locked"; break;
+    case STS_CLK_RECONF_IN_PROG: name = "SPI clock reconfiguration in progress"; break;
+    case STS_CLK_DIV_0: name = "SPI clock divided by zero"; break;
+    case STS_CLK_OOB: name = "SPI clock frequency out of bounds"; break;
+    case STS_SHUTDOWN_SENSE: name = "Shutdown sense detected"; board = true; break;
+    case STS_EXT_SHUTDOWN: name = "External shutdown triggered"; break;
+    case STS_OVER_THRESH: name = "DAC over threshold"; board = true; break;
+    case STS_THRESH_UNDERFLOW: name = "DAC threshold FIFO underflow"; board = true; break;
+    case STS_THRESH_OVERFLOW: name = "DAC threshold FIFO overflow"; board = true; break;
+    case STS_BAD_TRIG_CMD: name = "Bad trigger command"; break;
+    case STS_TRIG_CMD_BUF_OVERFLOW: name = "Trigger command buffer overflow"; break;
+    case STS_TRIG_DATA_BUF_UNDERFLOW: name = "Trigger data buffer underflow"; break;
+    case STS_TRIG_DATA_BUF_OVERFLOW: name = "Trigger data buffer overflow"; break;
+    case STS_DAC_BOOT_FAIL: name = "DAC boot failure"; board = true; break;
+    case STS_BAD_DAC_CMD: name = "Bad DAC command"; board = true; break;
+    case STS_DAC_CAL_OOB: name = "DAC calibration out of bounds"; board = true; break;
+    case STS_DAC_VAL_OOB: name = "DAC value out of bounds"; board = true; break;
+    case STS_DAC_CMD_BUF_UNDERFLOW: name = "DAC command buffer underflow"; board = true; break;
+    case STS_DAC_CMD_BUF_OVERFLOW: name = "DAC command buffer overflow"; board = true; break;
+    case STS_DAC_DATA_BUF_UNDERFLOW: name = "DAC data buffer underflow"; board = true; break;
+    case STS_DAC_DATA_BUF_OVERFLOW: name = "DAC data buffer overflow"; board = true; break;
+    case STS_UNEXP_DAC_TRIG: name = "Unexpected DAC trigger"; board = true; break;
+    case STS_LDAC_MISALIGN: name = "LDAC misalignment error"; board = true; break;
+    case STS_DAC_DELAY_TOO_SHORT: name = "DAC delay too short"; board = true; break;
+    case STS_ADC_BOOT_FAIL: name = "ADC boot failure"; board = true; break;
+    case STS_BAD_ADC_CMD: name = "Bad ADC command"; board = true; break;
+    case STS_ADC_CMD_BUF_UNDERFLOW: name = "ADC command buffer underflow"; board = true; break;
+    case STS_ADC_CMD_BUF_OVERFLOW: name = "ADC command buffer overflow"; board = true; break;
+    case STS_ADC_DATA_BUF_UNDERFLOW: name = "ADC data buffer underflow"; board = true; break;
+    case STS_ADC_DATA_BUF_OVERFLOW: name = "ADC data buffer overflow"; board = true; break;
+    case STS_UNEXP_ADC_TRIG: name = "Unexpected ADC trigger"; board = true; break;
+    case STS_ADC_DELAY_TOO_SHORT: name = "ADC delay too short"; board = true; break;
+    default: break;
+  }
+  if (has_board != NULL) *has_board = board;
+  return name;
+}
+
+// Format hardware status into a caller-provided buffer (same text as print_hw_status). Returns the length
+// snprintf would have written.
+int hw_status_format(uint32_t hw_status, bool verbose, char* buf, size_t size) {
+  uint32_t state = HW_STS_STATE(hw_status);
+  uint32_t code = HW_STS_CODE(hw_status);
+  bool print_status = verbose || state == S_HALTING || state == S_HALTED;
+  bool has_board = false;
+  const char* state_name = hw_state_name(state);
+  const char* code_name = hw_status_code_name(code, &has_board);
+  size_t len = 0;
+  int n;
+
+#define HW_STATUS_APPEND(...) \
+  do { \
+    n = snprintf(buf + (len < size ? len : size), len < size ? size - len : 0, __VA_ARGS__); \
+    if (n > 0) len += (size_t)n; \
+  } while (0)
+
+  if (verbose) HW_STATUS_APPEND("Raw hardware state code: 0x%01" PRIx32 "\n", state);
+  if (state_name != NULL) {
+    HW_STATUS_APPEND("State: %s\n", state_name);
+  } else {
+    HW_STATUS_APPEND("State: Unknown (0x%01" PRIx32 ")\n", state);
+  }
+  if (verbose) HW_STATUS_APPEND("Raw hardware status code: 0x07%" PRIx32 "\n", code);
   if (print_status) {
-    switch (HW_STS_CODE(hw_status)) {
-      case STS_EMPTY:
-        printf("Status: Empty\n");
-        break;
-      case STS_OK:
-        printf("Status: OK\n");
-        break;
-      case STS_PS_SHUTDOWN:
-        printf("Status: Processing system shutdown\n");
-        break;
-      case STS_SPI_RESET_TIMEOUT:
-        printf("Status: SPI initialization timeout\n");
-        break;
-      case STS_SPI_START_TIMEOUT:
-        printf("Status: SPI start timeout\n");
-        break;
-      case STS_LOCK_VIOL:
-        printf("Status: Configuration lock violation\n");
-        break;
-      case STS_CTRL_EN_OOB:
-        printf("Status: Control board enable register out of bounds\n");
-        break;
-      case STS_POW_EN_OOB:
-        printf("Status: Power board enable register out of bounds\n");
-        break;
-      case STS_CMD_BUF_RESET_OOB:
-        printf("Status: Command buffer reset out of bounds\n");
-        break;
-      case STS_DATA_BUF_RESET_OOB:
-        printf("Status: Data buffer reset out of bounds\n");
-        break;
-      case STS_THRESH_VAL_OOB:
-        printf("Status: Threshold average out of bounds\n");
-        break;
-      case STS_THRESH_WINDOW_OOB:
-        printf("Status: Threshold window out of bounds\n");
-        break;
-      case STS_THRESH_EN_OOB:
-        printf("Status: Threshold enable register out of bounds\n");
-        break;
-      case STS_BOOT_TEST_SKIP_OOB:
-        printf("Status: Boot test skip out of bounds\n");
-        break;
-      case STS_DEBUG_OOB:
-        printf("Status: Debug out of bounds\n");
-        break;
-      case STS_DAC_CAL_INIT_OOB:
-        printf("Status: DAC calibration initial value out of bounds\n");
-        break;
-      case STS_CLK_LOCKED_FAIL:
-        printf("Status: SPI clock manager PLL not locked\n");
-        break;
-      case STS_CLK_RECONF_IN_PROG:
-        printf("Status: SPI clock reconfiguration in progress\n");
-        break;
-      case STS_CLK_DIV_0:
-        printf("Status: SPI clock divided by zero\n");
-        break;
-      case STS_CLK_OOB:
-        printf("Status: SPI clock frequency out of bounds\n");
-        break;
-      case STS_SHUTDOWN_SENSE:
-        printf("Status: Shutdown sense detected\n");
-        print_board_number = true;
-        break;
-      case STS_EXT_SHUTDOWN:
-        printf("Status: External shutdown triggered\n");
-        break;
-      case STS_OVER_THRESH:
-        printf("Status: DAC over threshold\n");
-        print_board_number = true;
-        break;
-      case STS_THRESH_UNDERFLOW:
-        printf("Status: DAC threshold FIFO underflow\n");
-        print_board_number = true;
-        break;
-      case STS_THRESH_OVERFLOW:
-        printf("Status: DAC threshold FIFO overflow\n");
-        print_board_number = true;
-        break;
-      case STS_BAD_TRIG_CMD:
-        printf("Status: Bad trigger command\n");
-        break;
-      case STS_TRIG_CMD_BUF_OVERFLOW:
-        printf("Status: Trigger command buffer overflow\n");
-        break;
-      case STS_TRIG_DATA_BUF_UNDERFLOW:
-        printf("Status: Trigger data buffer underflow\n");
-        break;
-      case STS_TRIG_DATA_BUF_OVERFLOW:
-        printf("Status: Trigger data buffer overflow\n");
-        break;
-      case STS_DAC_BOOT_FAIL:
-        printf("Status: DAC boot failure\n");
-        print_board_number = true;
-        break;
-      case STS_BAD_DAC_CMD:
-        printf("Status: Bad DAC command\n");
-        print_board_number = true;
-        break;
-      case STS_DAC_CAL_OOB:
-        printf("Status: DAC calibration out of bounds\n");
-        print_board_number = true;
-        break;
-      case STS_DAC_VAL_OOB:
-        printf("Status: DAC value out of bounds\n");
-        print_board_number = true;
-        break;
-      case STS_DAC_CMD_BUF_UNDERFLOW:
-        printf("Status: DAC command buffer underflow\n");
-        print_board_number = true;
-        break;
-      case STS_DAC_CMD_BUF_OVERFLOW:
-        printf("Status: DAC command buffer overflow\n");
-        print_board_number = true;
-        break;
-      case STS_DAC_DATA_BUF_UNDERFLOW:
-        printf("Status: DAC data buffer underflow\n");
-        print_board_number = true;
-        break;
-      case STS_DAC_DATA_BUF_OVERFLOW:
-        printf("Status: DAC data buffer overflow\n");
-        print_board_number = true;
-        break;
-      case STS_UNEXP_DAC_TRIG:
-        printf("Status: Unexpected DAC trigger\n");
-        print_board_number = true;
-        break;
-      case STS_LDAC_MISALIGN:
-        printf("Status: LDAC misalignment error\n");
-        print_board_number = true;
-        break;
-      case STS_DAC_DELAY_TOO_SHORT:
-        printf("Status: DAC delay too short\n");
-        print_board_number = true;
-        break;
-      case STS_ADC_BOOT_FAIL:
-        printf("Status: ADC boot failure\n");
-        print_board_number = true;
-        break;
-      case STS_BAD_ADC_CMD:
-        printf("Status: Bad ADC command\n");
-        print_board_number = true;
-        break;
-      case STS_ADC_CMD_BUF_UNDERFLOW:
-        printf("Status: ADC command buffer underflow\n");
-        print_board_number = true;
-        break;
-      case STS_ADC_CMD_BUF_OVERFLOW:
-        printf("Status: ADC command buffer overflow\n");
-        print_board_number = true;
-        break;
-      case STS_ADC_DATA_BUF_UNDERFLOW:
-        printf("Status: ADC data buffer underflow\n");
-        print_board_number = true;
-        break;
-      case STS_ADC_DATA_BUF_OVERFLOW:
-        printf("Status: ADC data buffer overflow\n");
-        print_board_number = true;
-        break;
-      case STS_UNEXP_ADC_TRIG:
-        printf("Status: Unexpected ADC trigger\n");
-        print_board_number = true;
-        break;
-      case STS_ADC_DELAY_TOO_SHORT:
-        printf("Status: ADC delay too short\n");
-        print_board_number = true;
-        break;
-      default:
-        printf("Status: Unknown (0x%07" PRIx32 ")\n", HW_STS_CODE(hw_status));
-        break;
+    if (code_name != NULL) {
+      HW_STATUS_APPEND("Status: %s\n", code_name);
+    } else {
+      HW_STATUS_APPEND("Status: Unknown (0x%07" PRIx32 ")\n", code);
     }
   }
-  if (print_board_number) {
-    printf("Board Number: %u\n", HW_STS_BOARD(hw_status));
+  if (verbose || (print_status && has_board)) {
+    HW_STATUS_APPEND("Board Number: %u\n", HW_STS_BOARD(hw_status));
   }
+#undef HW_STATUS_APPEND
+  return (int)len;
+}
+
+// Interpret and print hardware status (one write, so output from several threads doesn't interleave)
+void print_hw_status(uint32_t hw_status, bool verbose) {
+  char buffer[512];
+  hw_status_format(hw_status, verbose, buffer, sizeof(buffer));
+  fputs(buffer, stdout);
 }
 
 // Print SPI clock frequency in Hz and MHz
@@ -372,8 +273,8 @@ void print_debug_register(struct sys_sts_t *sys_sts) {
 
 // Get DAC command FIFO status for a specific board
 uint32_t sys_sts_get_dac_cmd_fifo_status(struct sys_sts_t *sys_sts, uint8_t board, bool verbose) {
-  if (board >= 8) {
-    fprintf(stderr, "Invalid board number %u for DAC command FIFO status. Must be 0-7.\n", board);
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid board number %u for DAC command FIFO status. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
     exit(EXIT_FAILURE);
   }
   return get_fifo_status(sys_sts->dac_cmd_fifo_sts[board], "DAC Command", verbose);
@@ -381,8 +282,8 @@ uint32_t sys_sts_get_dac_cmd_fifo_status(struct sys_sts_t *sys_sts, uint8_t boar
 
 // Get DAC data FIFO status for a specific board
 uint32_t sys_sts_get_dac_data_fifo_status(struct sys_sts_t *sys_sts, uint8_t board, bool verbose) {
-  if (board >= 8) {
-    fprintf(stderr, "Invalid board number %u for DAC data FIFO status. Must be 0-7.\n", board);
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid board number %u for DAC data FIFO status. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
     exit(EXIT_FAILURE);
   }
   return get_fifo_status(sys_sts->dac_data_fifo_sts[board], "DAC Data", verbose);
@@ -390,8 +291,8 @@ uint32_t sys_sts_get_dac_data_fifo_status(struct sys_sts_t *sys_sts, uint8_t boa
 
 // Get ADC command FIFO status for a specific board
 uint32_t sys_sts_get_adc_cmd_fifo_status(struct sys_sts_t *sys_sts, uint8_t board, bool verbose) {
-  if (board >= 8) {
-    fprintf(stderr, "Invalid board number %u for ADC command FIFO status. Must be 0-7.\n", board);
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid board number %u for ADC command FIFO status. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
     exit(EXIT_FAILURE);
   }
   return get_fifo_status(sys_sts->adc_cmd_fifo_sts[board], "ADC Command", verbose);
@@ -399,8 +300,8 @@ uint32_t sys_sts_get_adc_cmd_fifo_status(struct sys_sts_t *sys_sts, uint8_t boar
 
 // Get ADC data FIFO status for a specific board
 uint32_t sys_sts_get_adc_data_fifo_status(struct sys_sts_t *sys_sts, uint8_t board, bool verbose) {
-  if (board >= 8) {
-    fprintf(stderr, "Invalid board number %u for ADC data FIFO status. Must be 0-7.\n", board);
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid board number %u for ADC data FIFO status. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
     exit(EXIT_FAILURE);
   }
   return get_fifo_status(sys_sts->adc_data_fifo_sts[board], "ADC Data", verbose);
@@ -454,8 +355,8 @@ uint32_t sys_sts_get_adc_min_delay_time(struct sys_sts_t *sys_sts, bool verbose)
 
 // Get last received DAC command for a specific board
 uint32_t sys_sts_get_last_received_dac_cmd(struct sys_sts_t *sys_sts, uint8_t board, bool verbose) {
-  if (board >= 8) {
-    fprintf(stderr, "Invalid board number %u for last received DAC command. Must be 0-7.\n", board);
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid board number %u for last received DAC command. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
     exit(EXIT_FAILURE);
   }
 
@@ -469,8 +370,8 @@ uint32_t sys_sts_get_last_received_dac_cmd(struct sys_sts_t *sys_sts, uint8_t bo
 
 // Get last received ADC command for a specific board
 uint32_t sys_sts_get_last_received_adc_cmd(struct sys_sts_t *sys_sts, uint8_t board, bool verbose) {
-  if (board >= 8) {
-    fprintf(stderr, "Invalid board number %u for last received ADC command. Must be 0-7.\n", board);
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid board number %u for last received ADC command. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
     exit(EXIT_FAILURE);
   }
 
@@ -484,8 +385,8 @@ uint32_t sys_sts_get_last_received_adc_cmd(struct sys_sts_t *sys_sts, uint8_t bo
 
 // Get DAC command count since reset for a specific board
 uint32_t sys_sts_get_dac_cmds_since_reset(struct sys_sts_t *sys_sts, uint8_t board, bool verbose) {
-  if (board >= 8) {
-    fprintf(stderr, "Invalid board number %u for DAC command count since reset. Must be 0-7.\n", board);
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid board number %u for DAC command count since reset. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
     exit(EXIT_FAILURE);
   }
 
@@ -499,8 +400,8 @@ uint32_t sys_sts_get_dac_cmds_since_reset(struct sys_sts_t *sys_sts, uint8_t boa
 
 // Get ADC command count since reset for a specific board
 uint32_t sys_sts_get_adc_cmds_since_reset(struct sys_sts_t *sys_sts, uint8_t board, bool verbose) {
-  if (board >= 8) {
-    fprintf(stderr, "Invalid board number %u for ADC command count since reset. Must be 0-7.\n", board);
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid board number %u for ADC command count since reset. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
     exit(EXIT_FAILURE);
   }
 
@@ -648,3 +549,153 @@ int sys_sts_start_hw_manager_irq_monitor(struct sys_sts_t *sys_sts, bool verbose
   return 0;
 }
 
+// Microseconds elapsed since a monotonic start time
+static uint32_t elapsed_us_since(uint64_t start_ns) {
+  return (uint32_t)((timing_now_ns() - start_ns) / 1000ULL);
+}
+
+// Wait for the hardware manager to reach a state (fails early if the system halts on the way)
+int sys_sts_wait_for_state(struct sys_sts_t *sys_sts, uint32_t state, uint32_t timeout_us, bool verbose) {
+  uint64_t start_ns = timing_now_ns();
+
+  while (true) {
+    uint32_t hw_status = *(sys_sts->hw_status_reg);
+    uint32_t elapsed_us = elapsed_us_since(start_ns);
+    if (HW_STS_STATE(hw_status) == state) {
+      if (verbose) {
+        printf("Hardware reached state %u after %u us\n", state, elapsed_us);
+      }
+      return 0;
+    }
+    if (HW_STS_STATE(hw_status) == S_HALTED) {
+      fprintf(stderr, "Hardware halted after %u us while waiting for state %u. Status: 0x%08X\n",
+              elapsed_us, state, hw_status);
+      return -1;
+    }
+    if (elapsed_us >= timeout_us) {
+      fprintf(stderr, "Timed out after %u us waiting for hardware state %u (current state %u). Status: 0x%08X\n",
+              elapsed_us, state, HW_STS_STATE(hw_status), hw_status);
+      return -1;
+    }
+    usleep(SYS_STS_POLL_INTERVAL_US);
+  }
+}
+
+// Check that every present FIFO selected by the buffer masks is empty, naming the first one that isn't
+static bool fifos_empty(struct sys_sts_t *sys_sts, uint32_t cmd_mask, uint32_t data_mask, const char **busy_name, int *busy_board) {
+  for (int board = 0; board < SHIM_MAX_BOARDS; board++) {
+    uint32_t dac_bit = 1U << (2 * board);
+    uint32_t adc_bit = 1U << (2 * board + 1);
+    uint32_t sts;
+    *busy_board = board;
+    if (cmd_mask & dac_bit) {
+      sts = *(sys_sts->dac_cmd_fifo_sts[board]);
+      if (FIFO_PRESENT(sts) && !FIFO_STS_EMPTY(sts)) { *busy_name = "DAC command"; return false; }
+    }
+    if (data_mask & dac_bit) {
+      sts = *(sys_sts->dac_data_fifo_sts[board]);
+      if (FIFO_PRESENT(sts) && !FIFO_STS_EMPTY(sts)) { *busy_name = "DAC data"; return false; }
+    }
+    if (cmd_mask & adc_bit) {
+      sts = *(sys_sts->adc_cmd_fifo_sts[board]);
+      if (FIFO_PRESENT(sts) && !FIFO_STS_EMPTY(sts)) { *busy_name = "ADC command"; return false; }
+    }
+    if (data_mask & adc_bit) {
+      sts = *(sys_sts->adc_data_fifo_sts[board]);
+      if (FIFO_PRESENT(sts) && !FIFO_STS_EMPTY(sts)) { *busy_name = "ADC data"; return false; }
+    }
+  }
+  *busy_board = -1;
+  if (cmd_mask & SYS_STS_BUF_MASK_TRIG) {
+    uint32_t sts = *(sys_sts->trig_cmd_fifo_sts);
+    if (FIFO_PRESENT(sts) && !FIFO_STS_EMPTY(sts)) { *busy_name = "Trigger command"; return false; }
+  }
+  if (data_mask & SYS_STS_BUF_MASK_TRIG) {
+    uint32_t sts = *(sys_sts->trig_data_fifo_sts);
+    if (FIFO_PRESENT(sts) && !FIFO_STS_EMPTY(sts)) { *busy_name = "Trigger data"; return false; }
+  }
+  return true;
+}
+
+// Wait for every present command/data FIFO selected by the buffer masks to be empty
+int sys_sts_wait_for_fifos_empty(struct sys_sts_t *sys_sts, uint32_t cmd_mask, uint32_t data_mask, uint32_t timeout_us, bool verbose) {
+  uint64_t start_ns = timing_now_ns();
+  const char *busy_name = NULL;
+  int busy_board = -1;
+
+  while (true) {
+    bool empty = fifos_empty(sys_sts, cmd_mask, data_mask, &busy_name, &busy_board);
+    uint32_t elapsed_us = elapsed_us_since(start_ns);
+    if (empty) {
+      if (verbose) {
+        printf("FIFOs empty (cmd mask 0x%05X, data mask 0x%05X) after %u us\n", cmd_mask, data_mask, elapsed_us);
+      }
+      return 0;
+    }
+    if (elapsed_us >= timeout_us) {
+      if (busy_board >= 0) {
+        fprintf(stderr, "Timed out after %u us waiting for board %d %s FIFO to empty.\n", elapsed_us, busy_board, busy_name);
+      } else {
+        fprintf(stderr, "Timed out after %u us waiting for %s FIFO to empty.\n", elapsed_us, busy_name);
+      }
+      return -1;
+    }
+    usleep(SYS_STS_POLL_INTERVAL_US);
+  }
+}
+
+// Hold an asserted buffer reset for at least SYS_STS_BUF_RESET_HOLD_US and until the selected FIFOs read empty.
+// A FIFO held in reset can read empty well before the reset has propagated, so the empty flag alone is not enough.
+int sys_sts_hold_buf_reset(struct sys_sts_t *sys_sts, uint32_t cmd_mask, uint32_t data_mask, uint32_t timeout_us, bool verbose) {
+  usleep(SYS_STS_BUF_RESET_HOLD_US);
+  return sys_sts_wait_for_fifos_empty(sys_sts, cmd_mask, data_mask, timeout_us, verbose);
+}
+
+// Wait for a board's DAC command count since reset to reach a value
+int sys_sts_wait_for_dac_cmds_since_reset(struct sys_sts_t *sys_sts, uint8_t board, uint32_t count, uint32_t timeout_us, bool verbose) {
+  if (board >= SHIM_MAX_BOARDS) {
+    fprintf(stderr, "Invalid board number %u for DAC command count since reset. Must be 0-%d.\n", board, SHIM_MAX_BOARDS - 1);
+    return -1;
+  }
+
+  uint64_t start_ns = timing_now_ns();
+
+  while (true) {
+    uint32_t value = *(sys_sts->dac_cmds_since_reset[board]);
+    uint32_t elapsed_us = elapsed_us_since(start_ns);
+    if (value >= count) {
+      if (verbose) {
+        printf("DAC board %u command count reached %u after %u us\n", board, value, elapsed_us);
+      }
+      return 0;
+    }
+    if (elapsed_us >= timeout_us) {
+      fprintf(stderr, "Timed out after %u us waiting for DAC board %u to process commands (count %u, expected %u).\n",
+              elapsed_us, board, value, count);
+      return -1;
+    }
+    usleep(SYS_STS_POLL_INTERVAL_US);
+  }
+}
+
+// Wait for the trigger count to reach a value
+int sys_sts_wait_for_trig_count(struct sys_sts_t *sys_sts, uint32_t count, uint32_t timeout_us, bool verbose) {
+  uint64_t start_ns = timing_now_ns();
+
+  while (true) {
+    uint32_t value = *(sys_sts->trig_counter);
+    uint32_t elapsed_us = elapsed_us_since(start_ns);
+    if (value >= count) {
+      if (verbose) {
+        printf("Trigger count reached %u after %u us\n", value, elapsed_us);
+      }
+      return 0;
+    }
+    if (elapsed_us >= timeout_us) {
+      fprintf(stderr, "Timed out after %u us waiting for triggers (count %u, expected %u).\n",
+              elapsed_us, value, count);
+      return -1;
+    }
+    usleep(SYS_STS_POLL_INTERVAL_US);
+  }
+}
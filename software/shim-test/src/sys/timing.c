@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "timing.h"
+
+// Clear a histogram and set its bin edges
+void timing_hist_init(timing_hist_t *hist, const double *edges_us, int bin_count) {
+  memset(hist, 0, sizeof(*hist));
+  hist->edges_us = edges_us;
+  hist->bin_count = (bin_count < 1) ? 1 : (bin_count > TIMING_HIST_MAX_BINS) ? TIMING_HIST_MAX_BINS : bin_count;
+}
+
+// Add one sample
+void timing_hist_add(timing_hist_t *hist, double us) {
+  int bin = 0;
+  while (bin < hist->bin_count - 1 && us > hist->edges_us[bin]) {
+    bin++;
+  }
+  hist->bins[bin]++;
+  if (hist->count == 0 || us < hist->min_us) hist->min_us = us;
+  if (hist->count == 0 || us > hist->max_us) hist->max_us = us;
+  hist->sum_us += us;
+  hist->sum_sq_us += us * us;
+  hist->count++;
+}
+
+// Mean of the samples (0 if there are none)
+double timing_hist_mean_us(const timing_hist_t *hist) {
+  return hist->count ? hist->sum_us / (double)hist->count : 0.0;
+}
+
+// Print the non-empty bins with their share of the samples, one line each
+void timing_hist_print_bins(const timing_hist_t *hist) {
+  double lower = 0.0;
+  for (int bin = 0; bin < hist->bin_count; bin++) {
+    if (hist->bins[bin] != 0) {
+      double percent = 100.0 * (double)hist->bins[bin] / (double)hist->count;
+      if (bin < hist->bin_count - 1) {
+        printf("    %6.0f - %6.0f us : %10" PRIu64 " (%5.1f%%)\n", lower, hist->edges_us[bin], hist->bins[bin], percent);
+      } else {
+        printf("    %6.0f +        us : %10" PRIu64 " (%5.1f%%)\n", lower, hist->bins[bin], percent);
+      }
+    }
+    if (bin < hist->bin_count - 1) lower = hist->edges_us[bin];
+  }
+}
@@ -6,7 +6,7 @@
 
 // Create trigger control structure
 struct trigger_ctrl_t create_trigger_ctrl(bool verbose) {
-  struct trigger_ctrl_t trigger_ctrl;
+  struct trigger_ctrl_t trigger_ctrl = {0}; // Absolute logging until a reset count selects delta
 
   // Map trigger command FIFO
   trigger_ctrl.buffer = map_32bit_memory(TRIG_FIFO, 1, "Trigger FIFO", verbose);
@@ -18,11 +18,51 @@ struct trigger_ctrl_t create_trigger_ctrl(bool verbose) {
   return trigger_ctrl;
 }
 
-// Read 64-bit trigger data from FIFO as a pair of 32-bit words
+// Read one absolute 64-bit trigger timestamp from FIFO
+// The words of a two-word entry are written in consecutive cycles, so the second is there once the first is
 uint64_t trigger_read(struct trigger_ctrl_t *trigger_ctrl) {
-  uint32_t low_word = *(trigger_ctrl->buffer);
-  uint32_t high_word = *(trigger_ctrl->buffer);
-  return ((uint64_t)high_word << 32) | low_word; // Combine into 64-bit value
+  uint64_t timestamp;
+  while (!trigger_decode_word(trigger_ctrl, *(trigger_ctrl->buffer), &timestamp));
+  return timestamp;
+}
+
+// Read one raw 32-bit word from the trigger data FIFO
+uint32_t trigger_read_word(struct trigger_ctrl_t *trigger_ctrl) {
+  return *(trigger_ctrl->buffer);
+}
+
+// Feed one raw trigger data word to the decoder
+bool trigger_decode_word(struct trigger_ctrl_t *trigger_ctrl, uint32_t word, uint64_t *timestamp) {
+  if (!trigger_ctrl->partial) {
+    // A short delta is a whole entry
+    if (trigger_ctrl->delta_log && !(word & (1U << TRIG_DELTA_ESCAPE_BIT))) {
+      trigger_ctrl->last_timestamp += word;
+      *timestamp = trigger_ctrl->last_timestamp;
+      return true;
+    }
+    trigger_ctrl->partial = true;
+    trigger_ctrl->partial_word = word;
+    return false;
+  }
+
+  trigger_ctrl->partial = false;
+  if (trigger_ctrl->delta_log) {
+    // Escape word holds the upper delta bits
+    trigger_ctrl->last_timestamp += ((uint64_t)(trigger_ctrl->partial_word & TRIG_DELTA_HIGH_MASK) << 32) | word;
+    *timestamp = trigger_ctrl->last_timestamp;
+  } else {
+    *timestamp = ((uint64_t)word << 32) | trigger_ctrl->partial_word; // Low word first
+  }
+  return true;
+}
+
+// Restart the decoder after the trigger data FIFO was reset
+void trigger_reset_decoder(struct trigger_ctrl_t *trigger_ctrl, bool core_reset) {
+  // A buffer reset leaves the core's logging mode alone; only a core reset returns it to absolute
+  if (core_reset) trigger_ctrl->delta_log = false;
+  trigger_ctrl->last_timestamp = 0;
+  trigger_ctrl->partial = false;
+  trigger_ctrl->partial_word = 0;
 }
 
 // Trigger command functions
@@ -106,6 +146,47 @@ void trigger_cmd_force_trig(struct trigger_ctrl_t *trigger_ctrl, bool log, bool
   *(trigger_ctrl->buffer) = cmd_word;
 }
 
+void trigger_cmd_set_period(struct trigger_ctrl_t *trigger_ctrl, uint32_t cycles, bool verbose) {
+  if (cycles < TRIG_PERIOD_MIN || cycles > TRIG_CMD_PERIODIC_VALUE_MASK) {
+    fprintf(stderr, "Trigger period out of range: %u (valid range: %u - 134217727)\n", cycles, TRIG_PERIOD_MIN);
+    return;
+  }
+
+  uint32_t cmd_word = (TRIG_CMD_PERIODIC << TRIG_CMD_CODE_SHIFT) | (cycles & TRIG_CMD_PERIODIC_VALUE_MASK);
+
+  if (verbose) {
+    printf("  Writing trigger set_period command: 0x%08" PRIX32 " (cmd=0x%01" PRIX32 ", cycles=%u)\n",
+           (uint32_t)cmd_word, (uint32_t)TRIG_CMD_PERIODIC, cycles);
+  }
+
+  *(trigger_ctrl->buffer) = cmd_word;
+}
+
+void trigger_cmd_periodic(struct trigger_ctrl_t *trigger_ctrl, uint32_t count, bool log, bool verbose) {
+  if (count > TRIG_CMD_PERIODIC_VALUE_MASK) {
+    fprintf(stderr, "Periodic trigger count out of range: %u (valid range: 0 - 134217727)\n", count);
+    return;
+  }
+
+  uint32_t cmd_word = (TRIG_CMD_PERIODIC << TRIG_CMD_CODE_SHIFT) |
+                      ((log ? 1 : 0) << TRIG_CMD_LOG_BIT) |
+                      (1U << TRIG_CMD_PERIODIC_START_BIT) |
+                      (count & TRIG_CMD_PERIODIC_VALUE_MASK);
+
+  if (verbose) {
+    printf("  Writing trigger periodic command: 0x%08" PRIX32 " (cmd=0x%01" PRIX32 ", log=%d, count=",
+           (uint32_t)cmd_word, (uint32_t)TRIG_CMD_PERIODIC, log ? 1 : 0);
+    if (count == 0) {
+      printf("infinite");
+    } else {
+      printf("%u", count);
+    }
+    printf(")\n");
+  }
+
+  *(trigger_ctrl->buffer) = cmd_word;
+}
+
 void trigger_cmd_cancel(struct trigger_ctrl_t *trigger_ctrl, bool verbose) {
   uint32_t cmd_word = (TRIG_CMD_CANCEL << TRIG_CMD_CODE_SHIFT);
 
@@ -117,14 +198,19 @@ void trigger_cmd_cancel(struct trigger_ctrl_t *trigger_ctrl, bool verbose) {
   *(trigger_ctrl->buffer) = cmd_word;
 }
 
-void trigger_cmd_reset_count(struct trigger_ctrl_t *trigger_ctrl, bool verbose) {
-  uint32_t cmd_word = (TRIG_CMD_RESET_COUNT << TRIG_CMD_CODE_SHIFT);
+void trigger_cmd_reset_count(struct trigger_ctrl_t *trigger_ctrl, bool delta_log, bool verbose) {
+  uint32_t cmd_word = (TRIG_CMD_RESET_COUNT << TRIG_CMD_CODE_SHIFT) |
+                      ((delta_log ? 1 : 0) << TRIG_CMD_LOG_BIT);
 
   if (verbose) {
-    printf("  Writing trigger reset_count command: 0x%08" PRIX32 " (cmd=0x%01" PRIX32 ")\n",
-           (uint32_t)cmd_word, (uint32_t)TRIG_CMD_RESET_COUNT);
+    printf("  Writing trigger reset_count command: 0x%08" PRIX32 " (cmd=0x%01" PRIX32 ", delta_log=%d)\n",
+           (uint32_t)cmd_word, (uint32_t)TRIG_CMD_RESET_COUNT, delta_log ? 1 : 0);
   }
 
+  // Restart the decoder with the hardware timer
+  trigger_reset_decoder(trigger_ctrl, false);
+  trigger_ctrl->delta_log = delta_log;
+
   *(trigger_ctrl->buffer) = cmd_word;
 }
 
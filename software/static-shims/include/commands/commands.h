@@ -7,6 +7,7 @@
 
 #include "hardware.h"
 #include "file_handling.h"
+#include "regulator.h"
 
 #define COMMAND_FILE_PATH_MAX 256
 
@@ -28,6 +29,7 @@ typedef enum {
   CMD_EXIT_FILE,
   CMD_RESET,
   CMD_TRIGGER,
+  CMD_REGULATE,
   CMD_INVALID
 } command_type_t;
 
@@ -40,6 +42,9 @@ typedef struct {
   double update_amps[HW_MAX_CHANNELS];
   uint32_t update_count;
   double trigger_lockout_ms;
+  double regulate_rate_hz;   // 0 stops regulation
+  double regulate_kp;
+  double regulate_ki;
 } parsed_command_t;
 
 typedef struct {
@@ -50,6 +55,8 @@ typedef struct {
   char last_file[COMMAND_FILE_PATH_MAX];
   double trigger_lockout_ms;
   file_loader_t loader;
+  double setpoint_amps[HW_MAX_CHANNELS]; // Last manual setpoints, held by the regulator
+  regulator_t regulator;
 } shim_runtime_state_t;
 
 shim_runtime_state_t commands_init_state(hw_t *hw, bool verbose);
@@ -10,11 +10,29 @@
 #include "clk_ctrl.h"
 #include "sys_sts.h"
 #include "trigger_ctrl.h"
+#include "adc_convert.h"
 
 #define HW_SLEEP usleep(1000) // 1 ms sleep for hardware timing
-#define HW_MAX_CHANNELS 64 // Maximum number of channels supported by hardware
+#define HW_POLL_TIMEOUT_US    (uint32_t) 100000  // 100 ms bound on FIFO and command completion polls
+#define HW_DAC_WR_SETTLE_US   (uint32_t) 200     // Bound on a DAC write's SPI transfer finishing after the core accepts it
+#define HW_CTRL_ON_TIMEOUT_US (uint32_t) 7000000 // SPI reset check (1 s) + shutdown force delay (100 ms) + SPI start wait (5 s) + margin
+#define HW_POW_ON_TIMEOUT_US  (uint32_t) 500000  // Shutdown reset pulse (100 us) + reset delay (100 ms) + margin
+#define HW_PROFILE_MAX_MARKS 32 // Maximum bring-up profiler marks
+#define HW_MAX_CHANNELS SHIM_MAX_CHANNELS // Maximum number of channels supported by hardware
 #define HW_MAX_ABS_AMPS 5.0 // Maximum absolute current in amps for DAC channels
 
+// Bring-up time profiler: labeled timestamps relative to the last profiler reset
+typedef struct {
+  const char *label;
+  uint64_t    t_us;
+} hw_profile_mark_t;
+
+typedef struct {
+  uint64_t          start_us;
+  uint32_t          mark_count;
+  hw_profile_mark_t marks[HW_PROFILE_MAX_MARKS];
+} hw_profile_t;
+
 // Aggregates all hardware control structures needed for boot and operation
 typedef struct {
   struct sys_ctrl_t     sys_ctrl;
@@ -25,6 +43,8 @@ typedef struct {
   struct trigger_ctrl_t trigger_ctrl;
   uint32_t              channel_count;
   bool                  verbose;
+  hw_profile_t          profile;
+  adc_convert_t         adc_convert; // ADC sample to amps conversion (no bias correction)
 } hw_t;
 
 // Initialize and validate hardware control structure for a given channel count. Exits on failure
@@ -34,6 +54,15 @@ hw_t hw_init(uint32_t channel_count, bool verbose);
 // Print full hardware status to stdout
 void hw_status_summary(hw_t *hw);
 
+// Restart the bring-up profiler
+void hw_profile_reset(hw_t *hw);
+
+// Record a labeled bring-up profiler mark (label must be a string literal)
+void hw_profile_mark(hw_t *hw, const char *label);
+
+// Print the time between bring-up profiler marks (full breakdown if verbose, total otherwise)
+void hw_profile_print(hw_t *hw, const char *title);
+
 // Configure clock. Returns 0 on success, non-zero on failure
 int hw_set_clk(hw_t *hw);
 
@@ -96,6 +125,10 @@ int hw_set_dac_channel(hw_t *hw, uint32_t channel, double amps);
 // (buffer is HW_MAX_CHANNELS in length and indexed by channel number)
 int hw_set_dacs(hw_t *hw, const double *amps);
 
+// Write DAC values to all channels immediately, without clearing buffers or resetting triggers
+// (for repeated updates such as closed-loop regulation; buffer is HW_MAX_CHANNELS long)
+int hw_write_dacs(hw_t *hw, const double *amps);
+
 // Check if DAC command FIFOs have room for a new command
 bool hw_dac_fifo_has_room(hw_t *hw);
 
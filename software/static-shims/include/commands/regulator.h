@@ -0,0 +1,90 @@
+#ifndef REGULATOR_H
+#define REGULATOR_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hardware.h"
+#include "timing.h"
+
+// Closed-loop current regulation: a thread that reads every channel back from the ADCs,
+// applies a per-channel PI correction and writes the corrected values to the DACs, at a
+// fixed rate scheduled on absolute CLOCK_MONOTONIC deadlines.
+//
+// Per channel, with e = setpoint - readback (amps) and dt = measured iteration period:
+//   integral += e * dt                      (held while the output is saturated, anti-windup)
+//   output    = setpoint + kp * e + ki * integral, clamped to +/-HW_MAX_ABS_AMPS
+#define REGULATOR_DEFAULT_RATE_HZ 100.0
+#define REGULATOR_MAX_RATE_HZ     2000.0
+#define REGULATOR_DEFAULT_KP      0.2     // Proportional gain (amps per amp of error)
+#define REGULATOR_DEFAULT_KI      20.0    // Integral gain (per second)
+#define REGULATOR_HIST_BINS       10      // Histogram bins, upper edges in regulator.c
+
+// Status of the regulator, readable from outside the thread.
+typedef enum {
+  REGULATOR_STOPPED,      // Not regulating
+  REGULATOR_RUNNING,      // Thread is active and regulating
+  REGULATOR_ERROR,        // Thread stopped after a hardware read or write failed
+} regulator_status_t;
+
+// Snapshot of the regulator state, copied out under the mutex
+typedef struct {
+  regulator_status_t status;
+  double   rate_hz;                        // Requested loop rate
+  double   kp;
+  double   ki;
+  uint64_t iterations;
+  uint64_t overruns;                       // Iterations that missed their deadline by a full period
+  double   elapsed_s;                      // Time since the loop started
+  timing_hist_t    latency;                // ADC read start to DAC write complete
+  timing_hist_t    jitter;                 // Wake-up time minus scheduled time
+  double   setpoint_amps[HW_MAX_CHANNELS];
+  double   readback_amps[HW_MAX_CHANNELS]; // Latest ADC readback
+  double   output_amps[HW_MAX_CHANNELS];   // Latest DAC output
+} regulator_stats_t;
+
+// All state for the regulation loop. Create with regulator_init() and destroy with
+// regulator_destroy() when done.
+typedef struct {
+  hw_t *hw;
+  bool  verbose;
+
+  // Private -- access only through the regulator_* functions below.
+  pthread_t          thread;
+  pthread_mutex_t    mutex;
+  bool               stop_requested; // main thread writes; regulator thread reads
+  bool               started;        // true once 'thread' holds a real, joinable handle
+  regulator_stats_t  stats;          // regulator thread writes (setpoints: main thread); under mutex
+  double             integral[HW_MAX_CHANNELS]; // regulator thread only
+} regulator_t;
+
+// Initialize the regulator struct and its mutex.
+regulator_t regulator_init(hw_t *hw, bool verbose);
+
+// Destroy the regulator's mutex. Call after the thread has been joined.
+void regulator_destroy(regulator_t *reg);
+
+// Start regulating to setpoint_amps (HW_MAX_CHANNELS long, indexed by channel number).
+// Hardware must be running and nothing else may use it until the regulator is stopped.
+// Returns 0 on success, -1 on bad arguments or if the thread could not be created.
+int regulator_start(regulator_t *reg, const double *setpoint_amps, double rate_hz, double kp, double ki);
+
+// Change one channel's setpoint (or all of them) while regulating. Returns -1 if out of range.
+int regulator_set_setpoint(regulator_t *reg, uint32_t channel, double amps);
+int regulator_set_setpoints(regulator_t *reg, const double *setpoint_amps);
+
+// Signal the regulator thread to stop after the current iteration, then wait for it.
+// Returns the final status via *status_out (pass NULL to ignore).
+void regulator_stop(regulator_t *reg, regulator_status_t *status_out);
+
+// Read the current status without blocking. Thread-safe.
+regulator_status_t regulator_get_status(regulator_t *reg);
+
+// Copy the current state and statistics. Thread-safe.
+void regulator_get_stats(regulator_t *reg, regulator_stats_t *out);
+
+// Print loop rate, latency and jitter histograms and per-channel tracking error.
+void regulator_print_stats(regulator_t *reg);
+
+#endif // REGULATOR_H
@@ -5,6 +5,8 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "rt_sched.h"
+
 // Build a default runtime state for a fixed channel count
 shim_runtime_state_t commands_init_state(hw_t *hw, bool verbose) {
   shim_runtime_state_t state;
@@ -15,6 +17,8 @@ shim_runtime_state_t commands_init_state(hw_t *hw, bool verbose) {
   state.last_file[0] = '\0';
   state.trigger_lockout_ms = 10.0;
   state.loader = file_loader_init(hw, 10.0, verbose);
+  memset(state.setpoint_amps, 0, sizeof(state.setpoint_amps));
+  state.regulator = regulator_init(hw, verbose);
   return state;
 }
 
@@ -28,6 +32,8 @@ void commands_cleanup_state(shim_runtime_state_t *state) {
     file_loader_join(&state->loader, NULL);
   }
   file_loader_destroy(&state->loader);
+  regulator_stop(&state->regulator, NULL);
+  regulator_destroy(&state->regulator);
 }
 
 //// -- General commands --
@@ -59,6 +65,22 @@ static bool is_buffered(shim_runtime_state_t *state) {
   }
 }
 
+// Check if closed-loop regulation is active
+static bool is_regulating(shim_runtime_state_t *state) {
+  return regulator_get_status(&state->regulator) == REGULATOR_RUNNING;
+}
+
+// Stop closed-loop regulation (if active) before another command takes over the hardware
+static void stop_regulation(shim_runtime_state_t *state) {
+  if (!is_regulating(state)) {
+    regulator_stop(&state->regulator, NULL); // Joins a thread that stopped on error
+    return;
+  }
+  printf("Stopping current regulation.\n");
+  regulator_stop(&state->regulator, NULL);
+  regulator_print_stats(&state->regulator);
+}
+
 // Print all supported interactive commands
 void commands_print_help(void) {
   printf("-------------------------\n");
@@ -91,6 +113,11 @@ void commands_print_help(void) {
   printf("  E          : Exit loaded file and reset trigger counter.\n");
   printf("  R          : Reset buffers and restart file if loaded.\n");
   printf("\n");
+  printf(" --- Regulation commands ---\n");
+  printf("  G [f] [kp ki] : Hold the manual setpoints with closed-loop ADC feedback at f Hz (default %.0f Hz,\n", REGULATOR_DEFAULT_RATE_HZ);
+  printf("                  kp %.2f, ki %.1f/s). While regulating, 'n x' and 'U' change the setpoints;\n", REGULATOR_DEFAULT_KP, REGULATOR_DEFAULT_KI);
+  printf("                  other hardware commands stop regulation. 'G 0' stops and prints loop statistics.\n");
+  printf("\n");
 }
 
 // Print current runtime state for quick diagnostics
@@ -116,6 +143,15 @@ void commands_print_status(shim_runtime_state_t *state) {
   }
   printf("  Last file              : %s\n", state->last_file[0] != '\0' ? state->last_file : "(none)");
   printf("  Trigger lockout        : %.4f ms\n", state->trigger_lockout_ms);
+  // Regulation status
+  regulator_status_t regulator_status = regulator_get_status(&state->regulator);
+  if (regulator_status != REGULATOR_STOPPED) {
+    regulator_print_stats(&state->regulator);
+  }
+  // Real-time profile and loop timing
+  if (rt_sched_enabled()) {
+    rt_sched_print_status();
+  }
   // Hardware status
   hw_status_summary(state->hw);
 }
@@ -163,6 +199,8 @@ static bool run_hard_reset(shim_runtime_state_t *state) {
     return false;
   }
   printf("Performing hard reset: power off and clear file / buffers.\n");
+  stop_regulation(state);
+  memset(state->setpoint_amps, 0, sizeof(state->setpoint_amps));
   // Stop any in-flight file load before resetting hardware state
   if (file_loader_get_status(&state->loader) == FILE_LOADER_LOADED) {
     file_loader_request_stop(&state->loader);
@@ -183,6 +221,8 @@ static bool run_zero(shim_runtime_state_t *state) {
   if (state == NULL) {
     return false;
   }
+  stop_regulation(state);
+  memset(state->setpoint_amps, 0, sizeof(state->setpoint_amps));
   if (file_loader_get_status(&state->loader) == FILE_LOADER_LOADED) {
     printf("Exiting loaded file.\n");
     file_loader_request_stop(&state->loader);
@@ -210,7 +250,12 @@ static bool run_read(const parsed_command_t *cmd, shim_runtime_state_t *state) {
     return false;
   }
   double adc_values_amps[HW_MAX_CHANNELS] = {0.0};
-  if (hw_read_adcs(state->hw, adc_values_amps) != 0) {
+  if (is_regulating(state)) {
+    // The regulator owns the hardware; report its latest readback
+    regulator_stats_t stats;
+    regulator_get_stats(&state->regulator, &stats);
+    memcpy(adc_values_amps, stats.readback_amps, sizeof(adc_values_amps));
+  } else if (hw_read_adcs(state->hw, adc_values_amps) != 0) {
     fprintf(stderr, "I: failed to read ADC values from hardware.\n");
     return false;
   }
@@ -251,6 +296,15 @@ static bool run_set_channel(const parsed_command_t *cmd, shim_runtime_state_t *s
     file_loader_request_stop(&state->loader);
     file_loader_join(&state->loader, NULL);
   }
+  if (is_regulating(state)) {
+    printf("Regulating channel %d to %.4f A.\n", cmd->channel, cmd->amps);
+    if (regulator_set_setpoint(&state->regulator, (uint32_t)cmd->channel, cmd->amps) != 0) {
+      fprintf(stderr, "Failed to change setpoint of channel %d to %.4f A.\n", cmd->channel, cmd->amps);
+      return false;
+    }
+    state->setpoint_amps[cmd->channel] = cmd->amps;
+    return true;
+  }
   if (is_buffered(state)) {
     printf("Clearing buffered command.\n");
   }
@@ -261,6 +315,7 @@ static bool run_set_channel(const parsed_command_t *cmd, shim_runtime_state_t *s
     fprintf(stderr, "Failed to set channel %d to %.4f A.\n", cmd->channel, cmd->amps);
     return false;
   }
+  state->setpoint_amps[cmd->channel] = cmd->amps;
 
   // Read the currents back to validate
   double readback_amps = 0.0;
@@ -289,6 +344,15 @@ static bool run_update(const parsed_command_t *cmd, shim_runtime_state_t *state)
     file_loader_request_stop(&state->loader);
     file_loader_join(&state->loader, NULL);
   }
+  if (is_regulating(state)) {
+    printf("Regulating all active channels to new values.\n");
+    if (regulator_set_setpoints(&state->regulator, cmd->update_amps) != 0) {
+      fprintf(stderr, "Failed to change setpoints to new values.\n");
+      return false;
+    }
+    memcpy(state->setpoint_amps, cmd->update_amps, sizeof(double) * state->hw->channel_count);
+    return true;
+  }
   if (is_buffered(state)) {
     printf("Clearing buffered command.\n");
   }
@@ -299,6 +363,7 @@ static bool run_update(const parsed_command_t *cmd, shim_runtime_state_t *state)
     fprintf(stderr, "Failed to update all channels with new values.\n");
     return false;
   }
+  memcpy(state->setpoint_amps, cmd->update_amps, sizeof(double) * state->hw->channel_count);
 
   // Read the currents back to validate
   double adc_values_amps[HW_MAX_CHANNELS] = {0.0};
@@ -325,6 +390,7 @@ static bool run_buffer(const parsed_command_t *cmd, shim_runtime_state_t *state)
     fprintf(stderr, "Cannot buffer update because hardware is not powered on.\n");
     return false;
   }
+  stop_regulation(state);
   if (file_loader_get_status(&state->loader) == FILE_LOADER_LOADED) {
     printf("Cancelling in-progress file to apply manual update to all channels (you can use 'L' to reload from the beginning).\n");
     file_loader_request_stop(&state->loader);
@@ -365,6 +431,7 @@ static bool run_calibrate(shim_runtime_state_t *state) {
     printf("Cannot run calibration because hardware is not powered on. Please power on the hardware first using the 'P' command.\n");
     return false;
   }
+  stop_regulation(state);
   if (is_buffered(state)) {
     printf("Clearing buffered command.\n");
   }
@@ -399,6 +466,7 @@ static bool run_set_trigger_lockout(const parsed_command_t *cmd, shim_runtime_st
 
 // Advance through loaded shim rows by issuing trigger events
 static bool run_trigger(const parsed_command_t *cmd, shim_runtime_state_t *state) {
+  stop_regulation(state);
   // Check that the hardware is powered on and a file is loaded before allowing triggers
   if (!hw_running(state->hw)) {
     printf("Cannot issue triggers because hardware is not powered on. Please power on the hardware first using the 'P' command.\n");
@@ -534,6 +602,8 @@ static bool run_load(const parsed_command_t *cmd, shim_runtime_state_t *state) {
     (void)snprintf(selected_file, sizeof(selected_file), "%s", resolved);
   }
 
+  stop_regulation(state);
+
   // If a previous load is still in flight, stop it and wait for it to exit
   // before touching the hardware buffers
   file_loader_status_t prev_status = file_loader_get_status(&state->loader);
@@ -643,6 +713,7 @@ static bool run_reset(shim_runtime_state_t *state) {
     printf("Hardware isn't running, reset is unnecessary.\n");
     return true;
   }
+  stop_regulation(state);
   bool loaded = (file_loader_get_status(&state->loader) == FILE_LOADER_LOADED);
 
   if (loaded) {
@@ -687,6 +758,50 @@ static bool run_reset(shim_runtime_state_t *state) {
   return true;
 }
 
+// -- Regulation --
+
+// Start (or restart with new parameters) closed-loop regulation of the manual setpoints,
+// or stop it and print the loop statistics when the rate is 0
+static bool run_regulate(const parsed_command_t *cmd, shim_runtime_state_t *state) {
+  if (cmd == NULL) {
+    return false;
+  }
+  if (cmd->regulate_rate_hz == 0.0) {
+    if (regulator_get_status(&state->regulator) == REGULATOR_STOPPED) {
+      printf("Regulation is not running.\n");
+      return true;
+    }
+    stop_regulation(state);
+    return true;
+  }
+  if (!hw_running(state->hw)) {
+    fprintf(stderr, "Cannot regulate because hardware is not powered on.\n");
+    return false;
+  }
+  if (file_loader_get_status(&state->loader) == FILE_LOADER_LOADED) {
+    printf("Cannot regulate while a file is loaded. Please exit the file first using the 'E' command.\n");
+    return false;
+  }
+  stop_regulation(state);
+  if (is_buffered(state)) {
+    printf("Clearing buffered command.\n");
+    state->buffered = false;
+  }
+
+  // Start from a clean command stream so regulation writes land immediately
+  hw_clear_dac_buffers(state->hw);
+  hw_reset_triggers(state->hw);
+
+  printf("Regulating to the manual setpoints at %.1f Hz (kp %.3f, ki %.3f /s).\n",
+         cmd->regulate_rate_hz, cmd->regulate_kp, cmd->regulate_ki);
+  if (regulator_start(&state->regulator, state->setpoint_amps, cmd->regulate_rate_hz,
+                      cmd->regulate_kp, cmd->regulate_ki) != 0) {
+    fprintf(stderr, "G: failed to start regulation.\n");
+    return false;
+  }
+  return true;
+}
+
 // Dispatch a parsed command into runtime behavior
 bool commands_execute(const parsed_command_t *cmd, shim_runtime_state_t *state) {
   if (cmd == NULL || state == NULL) {
@@ -731,6 +846,8 @@ bool commands_execute(const parsed_command_t *cmd, shim_runtime_state_t *state)
       return run_exit_file(state);
     case CMD_RESET:
       return run_reset(state);
+    case CMD_REGULATE:
+      return run_regulate(cmd, state);
     case CMD_INVALID:
       fprintf(stderr, "Invalid command.\n");
       return false;
@@ -5,6 +5,8 @@
 #include <string.h>
 #include <unistd.h> // usleep
 
+#include "rt_sched.h"
+
 // ---------------------------------------------------------------------------
 // Internal helpers
 // ---------------------------------------------------------------------------
@@ -43,6 +45,7 @@ static void strip_comment(char *line) {
 
 static void *loader_thread_fn(void *arg) {
   file_loader_t *loader = (file_loader_t *)arg;
+  rt_sched_thread_enter(RT_CLASS_FIFO_DATA, "File loader", -1);
 
   loader_set_status(loader, FILE_LOADER_LOADED);
 
@@ -138,6 +141,7 @@ static void *loader_thread_fn(void *arg) {
 
   // Outer loop: repeats the whole file indefinitely until stop is requested.
   while (!loader_should_stop(loader)) {
+    rt_sched_loop_tick();
 
     if (fgets(line, sizeof(line), f) == NULL) {
       // EOF: treat like the outermost delimiter fired -- reset all levels,
@@ -287,7 +291,7 @@ static void *loader_thread_fn(void *arg) {
             loader_set_status(loader, FILE_LOADER_EMPTY);
             return NULL;
         }
-        usleep(usleep_time); // Sleep for half the trigger lockout time to avoid busy-waiting too aggressively
+        rt_sched_usleep(usleep_time); // Sleep for half the trigger lockout time to avoid busy-waiting too aggressively
       }
       // Buffer the DAC values to the hardware
       if (hw_buffer_dacs(loader->hw, amps) != 0) {
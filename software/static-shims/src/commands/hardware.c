@@ -3,6 +3,7 @@
 #include <unistd.h>
 
 #include "hardware.h"
+#include "timing.h"
 
 // Linearity status for channel calibration
 typedef enum {
@@ -22,6 +23,8 @@ hw_t hw_init(uint32_t channel_count, bool verbose) {
 
   hw.channel_count = channel_count;
   hw.verbose = verbose;
+  hw_profile_reset(&hw);
+  adc_convert_init(&hw.adc_convert, HW_MAX_ABS_AMPS);
 
   // Initialize all hardware control structures
   hw.sys_ctrl     = create_sys_ctrl(verbose);
@@ -53,10 +56,90 @@ hw_t hw_init(uint32_t channel_count, bool verbose) {
       exit(1);
     }
   }
+  hw_profile_mark(&hw, "map and check hardware");
 
   return hw;
 }
 
+// Monotonic time in microseconds
+static uint64_t hw_time_us(void) {
+  return timing_now_ns() / 1000ULL;
+}
+
+// Restart the bring-up profiler
+void hw_profile_reset(hw_t *hw) {
+  if (hw == NULL) {
+    return;
+  }
+  hw->profile.start_us = hw_time_us();
+  hw->profile.mark_count = 0;
+}
+
+// Record a labeled bring-up profiler mark
+void hw_profile_mark(hw_t *hw, const char *label) {
+  if (hw == NULL || hw->profile.mark_count >= HW_PROFILE_MAX_MARKS) {
+    return;
+  }
+  hw->profile.marks[hw->profile.mark_count].label = label;
+  hw->profile.marks[hw->profile.mark_count].t_us = hw_time_us() - hw->profile.start_us;
+  hw->profile.mark_count++;
+}
+
+// Print the time between bring-up profiler marks
+void hw_profile_print(hw_t *hw, const char *title) {
+  if (hw == NULL || hw->profile.mark_count == 0) {
+    return;
+  }
+  uint64_t total_us = hw->profile.marks[hw->profile.mark_count - 1].t_us;
+  printf("%s: %.3f ms\n", title, total_us / 1000.0);
+  if (!hw->verbose) {
+    return;
+  }
+  uint64_t prev_us = 0;
+  for (uint32_t i = 0; i < hw->profile.mark_count; i++) {
+    uint64_t step_us = hw->profile.marks[i].t_us - prev_us;
+    printf("  %-28s %10.3f ms (%5.1f%%)\n", hw->profile.marks[i].label, step_us / 1000.0,
+           total_us > 0 ? 100.0 * (double)step_us / (double)total_us : 0.0);
+    prev_us = hw->profile.marks[i].t_us;
+  }
+}
+
+// Buffer reset/poll mask selecting the DAC (bit 2b) or ADC (bit 2b+1) buffers of every configured board
+static uint32_t hw_buf_mask(hw_t *hw, uint32_t board_bit) {
+  uint32_t mask = 0;
+  uint32_t board_count = (hw->channel_count - 1) / 8 + 1;
+  for (uint32_t board = 0; board < board_count; board++) {
+    mask |= (board_bit << 2 * board);
+  }
+  return mask;
+}
+
+// Snapshot each configured board's DAC command count since reset
+static void hw_dac_cmd_counts(hw_t *hw, uint32_t *counts) {
+  uint32_t board_count = (hw->channel_count - 1) / 8 + 1;
+  for (uint32_t board = 0; board < board_count; board++) {
+    counts[board] = sys_sts_get_dac_cmds_since_reset(&hw->sys_sts, (uint8_t)board, false);
+  }
+}
+
+// Wait for each configured board to accept the commands sent since a count snapshot, then allow the last
+// accepted write to finish its SPI transfer. An empty command FIFO only means the words were popped.
+static int hw_wait_for_dac_cmds(hw_t *hw, const uint32_t *counts_before, const uint32_t *cmds_sent) {
+  uint32_t board_count = (hw->channel_count - 1) / 8 + 1;
+  for (uint32_t board = 0; board < board_count; board++) {
+    if (cmds_sent[board] == 0) {
+      continue;
+    }
+    if (sys_sts_wait_for_dac_cmds_since_reset(&hw->sys_sts, (uint8_t)board, counts_before[board] + cmds_sent[board],
+                                              HW_POLL_TIMEOUT_US, hw->verbose) != 0) {
+      fprintf(stderr, "Error: DAC board %u did not accept its commands.\n", board);
+      return -1;
+    }
+  }
+  usleep(HW_DAC_WR_SETTLE_US);
+  return 0;
+}
+
 // Print full hardware status to stdout
 void hw_status_summary(hw_t *hw) {
   if (hw == NULL) {
@@ -96,6 +179,7 @@ int hw_set_clk(hw_t *hw) {
   }
   // Sleep to allow hardware to stabilize after clock change
   HW_SLEEP;
+  hw_profile_mark(hw, "set SPI clock");
   // Verify that clock frequency is within 100 kHz of target
   uint32_t clk_freq = sys_sts_get_clk_freq_hz(&hw->sys_sts, hw->verbose);
   if (hw->verbose) {
@@ -108,6 +192,12 @@ int hw_set_clk(hw_t *hw) {
   return 0;
 }
 
+// Report the status of a failed power-on and turn the system back off
+static void hw_power_on_failed(hw_t *hw) {
+  print_hw_status(sys_sts_get_hw_status(&hw->sys_sts, hw->verbose), hw->verbose);
+  sys_ctrl_turn_off(&hw->sys_ctrl, hw->verbose);
+}
+
 // Power on hardware
 // Returns 0 on success, non-zero on failure
 int hw_power_on(hw_t *hw) {
@@ -120,34 +210,30 @@ int hw_power_on(hw_t *hw) {
   if (hw->verbose) {
     printf("Turning control board on...\n");
   }
+  hw_profile_reset(hw);
   sys_ctrl_turn_ctrl_on(&hw->sys_ctrl, hw->verbose);
-  // Wait 200ms for necessary power-on pulse durations
-  usleep(200000);
-  uint32_t hw_status = sys_sts_get_hw_status(&hw->sys_sts, hw->verbose);
-  if (HW_STS_STATE(hw_status) == S_HALTED) {
-    fprintf(stderr, "Error: hardware is in HALTED state after power on. Status: 0x%08X\n", hw_status);
-    print_hw_status(hw_status, hw->verbose);
-    return -1;
-  } else if (HW_STS_STATE(hw_status) != S_WAIT_FOR_POW_EN) {
-    fprintf(stderr, "Error: hardware is in unexpected state after power on. Status: 0x%08X\n", hw_status);
-    print_hw_status(hw_status, hw->verbose);
+  // Wait for the control board power-on sequence and SPI start
+  if (sys_sts_wait_for_state(&hw->sys_sts, S_WAIT_FOR_POW_EN, HW_CTRL_ON_TIMEOUT_US, hw->verbose) != 0) {
+    fprintf(stderr, "Error: control board failed to power on.\n");
+    hw_power_on_failed(hw);
     return -1;
   }
+  hw_profile_mark(hw, "control board on, SPI up");
   if (hw->verbose) {
     printf("Turning power amp on...\n");
   }
   sys_ctrl_turn_pow_on(&hw->sys_ctrl, hw->verbose);
-  // Wait 200ms for necessary power-on pulse durations
-  usleep(200000);
-  hw_status = sys_sts_get_hw_status(&hw->sys_sts, hw->verbose);
-  if (HW_STS_STATE(hw_status) != S_RUNNING) {
-    fprintf(stderr, "Error: hardware failed to enter RUNNING state after power on. Status: 0x%08X\n", hw_status);
-    print_hw_status(hw_status, hw->verbose);
+  // Wait for the power stage reset pulse and settling delay
+  if (sys_sts_wait_for_state(&hw->sys_sts, S_RUNNING, HW_POW_ON_TIMEOUT_US, hw->verbose) != 0) {
+    fprintf(stderr, "Error: hardware failed to enter RUNNING state after power on.\n");
+    hw_power_on_failed(hw);
     return -1;
   }
+  hw_profile_mark(hw, "power stage on, running");
   if (hw->verbose) {
     printf("Hardware powered on successfully.\n");
   }
+  hw_profile_print(hw, "Power-on to ready");
 
   return 0;
 }
@@ -197,17 +283,15 @@ int hw_clear_dac_buffers(hw_t *hw) {
   if (hw == NULL) {
     return -1;
   }
-  uint32_t dac_buf_reset_mask = 0;
+  uint32_t dac_buf_reset_mask = hw_buf_mask(hw, 0x1); // dac buffer reset bits
   uint32_t board_count = (hw->channel_count - 1) / 8 + 1;
-  for (uint32_t board = 0; board < board_count; board++) {
-    dac_buf_reset_mask |= (0x1 << 2 * board); // dac buffer reset bit for board
-  }
   sys_ctrl_set_cmd_buf_reset(&hw->sys_ctrl, dac_buf_reset_mask, hw->verbose);
   sys_ctrl_set_data_buf_reset(&hw->sys_ctrl, dac_buf_reset_mask, hw->verbose);
-  HW_SLEEP; // Sleep to allow hardware to process buffer resets
+  // Hold the resets for the minimum pulse width and until the buffers read empty
+  sys_sts_hold_buf_reset(&hw->sys_sts, dac_buf_reset_mask, dac_buf_reset_mask, HW_POLL_TIMEOUT_US, hw->verbose);
   sys_ctrl_set_cmd_buf_reset(&hw->sys_ctrl, 0, hw->verbose);
   sys_ctrl_set_data_buf_reset(&hw->sys_ctrl, 0, hw->verbose);
-  HW_SLEEP; // Sleep to allow hardware to process buffer resets
+  usleep(SYS_STS_BUF_RESET_SETTLE_US); // Let the buffers come out of reset
   
   // If powered on, send cancel commands to all DAC boards to clear any running commands
   if (hw_running(hw)) {
@@ -222,7 +306,9 @@ int hw_clear_dac_buffers(hw_t *hw) {
     for (uint32_t board = 0; board < board_count; board++) {
       dac_cmd_cancel(&hw->dac_ctrl, board, hw->verbose);
     }
-    HW_SLEEP; // Sleep to allow hardware to process cancel commands
+    // Wait for the cancel commands to be consumed, then for the cores to act on them
+    sys_sts_wait_for_fifos_empty(&hw->sys_sts, dac_buf_reset_mask, 0, HW_POLL_TIMEOUT_US, hw->verbose);
+    HW_SLEEP;
   }
 
   // Check that all DAC FIFOs are empty
@@ -245,24 +331,24 @@ int hw_clear_adc_buffers(hw_t *hw) {
   if (hw == NULL) {
     return -1;
   }
-  uint32_t adc_buf_reset_mask = 0;
+  uint32_t adc_buf_reset_mask = hw_buf_mask(hw, 0x2); // adc buffer reset bits
   uint32_t board_count = (hw->channel_count - 1) / 8 + 1;
-  for (uint32_t board = 0; board < board_count; board++) {
-    adc_buf_reset_mask |= (0x2 << 2 * board); // adc buffer reset bit for board
-  }
   sys_ctrl_set_cmd_buf_reset(&hw->sys_ctrl, adc_buf_reset_mask, hw->verbose);
   sys_ctrl_set_data_buf_reset(&hw->sys_ctrl, adc_buf_reset_mask, hw->verbose);
-  HW_SLEEP; // Sleep to allow hardware to process buffer resets
+  // Hold the resets for the minimum pulse width and until the buffers read empty
+  sys_sts_hold_buf_reset(&hw->sys_sts, adc_buf_reset_mask, adc_buf_reset_mask, HW_POLL_TIMEOUT_US, hw->verbose);
   sys_ctrl_set_cmd_buf_reset(&hw->sys_ctrl, 0, hw->verbose);
   sys_ctrl_set_data_buf_reset(&hw->sys_ctrl, 0, hw->verbose);
-	HW_SLEEP; // Sleep to allow hardware to process buffer resets
+  usleep(SYS_STS_BUF_RESET_SETTLE_US); // Let the buffers come out of reset
 
 	// If powered on, send cancel commands to all ADC boards to clear any running commands
 	if (hw_running(hw)) {
 		for (uint32_t board = 0; board < board_count; board++) {
 			adc_cmd_cancel(&hw->adc_ctrl, board, hw->verbose);
 		}
-		HW_SLEEP; // Sleep to allow hardware to process cancel commands
+		// Wait for the cancel commands to be consumed, then for the cores to act on them
+		sys_sts_wait_for_fifos_empty(&hw->sys_sts, adc_buf_reset_mask, 0, HW_POLL_TIMEOUT_US, hw->verbose);
+		HW_SLEEP;
 	}
 
   // Check that all ADC FIFOs are empty
@@ -285,17 +371,22 @@ int hw_clear_trigger_buffers(hw_t *hw) {
   if (hw == NULL) {
     return -1;
   }
-  sys_ctrl_set_cmd_buf_reset(&hw->sys_ctrl, 0x10000, hw->verbose);
-  sys_ctrl_set_data_buf_reset(&hw->sys_ctrl, 0x10000, hw->verbose);
-  HW_SLEEP; // Sleep to allow hardware to process buffer resets
+  sys_ctrl_set_cmd_buf_reset(&hw->sys_ctrl, SYS_STS_BUF_MASK_TRIG, hw->verbose);
+  sys_ctrl_set_data_buf_reset(&hw->sys_ctrl, SYS_STS_BUF_MASK_TRIG, hw->verbose);
+  // Hold the resets for the minimum pulse width and until the buffers read empty
+  sys_sts_hold_buf_reset(&hw->sys_sts, SYS_STS_BUF_MASK_TRIG, SYS_STS_BUF_MASK_TRIG, HW_POLL_TIMEOUT_US, hw->verbose);
   sys_ctrl_set_cmd_buf_reset(&hw->sys_ctrl, 0, hw->verbose);
   sys_ctrl_set_data_buf_reset(&hw->sys_ctrl, 0, hw->verbose);
-	HW_SLEEP; // Sleep to allow hardware to process buffer resets
+  usleep(SYS_STS_BUF_RESET_SETTLE_US); // Let the buffers come out of reset
+  // Logged words are gone, so restart the decoder (the core is held in reset while the system is off)
+  trigger_reset_decoder(&hw->trigger_ctrl, !hw_running(hw));
 
 	// If powered on, send cancel command to trigger controller to clear any running commands
 	if (hw_running(hw)) {
 		trigger_cmd_cancel(&hw->trigger_ctrl, hw->verbose);
-		HW_SLEEP; // Sleep to allow hardware to process cancel command
+		// Wait for the cancel command to be consumed, then for the core to act on it
+		sys_sts_wait_for_fifos_empty(&hw->sys_sts, SYS_STS_BUF_MASK_TRIG, 0, HW_POLL_TIMEOUT_US, hw->verbose);
+		HW_SLEEP;
 	}
 
   // Check that trigger FIFOs are empty
@@ -323,7 +414,8 @@ int hw_start_triggers(hw_t *hw) {
   hw_clear_trigger_buffers(hw);
   // Expect "0" triggers (treated as infinite)
   trigger_cmd_expect_ext(&hw->trigger_ctrl, 0, false, hw->verbose);
-  HW_SLEEP; // Sleep to allow hardware to process command
+  // Wait for the command to be consumed
+  sys_sts_wait_for_fifos_empty(&hw->sys_sts, SYS_STS_BUF_MASK_TRIG, 0, HW_POLL_TIMEOUT_US, hw->verbose);
   // Check that the trigger buffer is empty
   uint32_t trig_cmd_fifo_sts = sys_sts_get_trig_cmd_fifo_status(&hw->sys_sts, hw->verbose);
   if (!FIFO_STS_EMPTY(trig_cmd_fifo_sts)) {
@@ -345,7 +437,8 @@ int hw_expect_one_trigger(hw_t *hw) {
   hw_clear_trigger_buffers(hw);
   // Expect one trigger
   trigger_cmd_expect_ext(&hw->trigger_ctrl, 1, false, hw->verbose);
-  HW_SLEEP; // Sleep to allow hardware to process command
+  // Wait for the command to be consumed
+  sys_sts_wait_for_fifos_empty(&hw->sys_sts, SYS_STS_BUF_MASK_TRIG, 0, HW_POLL_TIMEOUT_US, hw->verbose);
   // Check that the trigger buffer is empty
   uint32_t trig_cmd_fifo_sts = sys_sts_get_trig_cmd_fifo_status(&hw->sys_sts, hw->verbose);
   if (!FIFO_STS_EMPTY(trig_cmd_fifo_sts)) {
@@ -382,7 +475,8 @@ int hw_force_trigger(hw_t *hw, uint32_t n) {
       return -1;
     }
     trigger_cmd_force_trig(&hw->trigger_ctrl, false, hw->verbose);
-    HW_SLEEP; // Sleep to allow hardware to process command
+    // Wait for the command to be consumed
+    sys_sts_wait_for_fifos_empty(&hw->sys_sts, SYS_STS_BUF_MASK_TRIG, 0, HW_POLL_TIMEOUT_US, hw->verbose);
   }
   // Check that the trigger buffer is empty
   uint32_t trig_cmd_fifo_sts = sys_sts_get_trig_cmd_fifo_status(&hw->sys_sts, hw->verbose);
@@ -411,8 +505,9 @@ int hw_reset_triggers(hw_t *hw) {
     return 0;
   }
   hw_clear_trigger_buffers(hw);
-  trigger_cmd_reset_count(&hw->trigger_ctrl, hw->verbose);
-  HW_SLEEP; // Sleep to allow hardware to process reset command
+  trigger_cmd_reset_count(&hw->trigger_ctrl, false, hw->verbose);
+  // Wait for the reset command to be consumed
+  sys_sts_wait_for_fifos_empty(&hw->sys_sts, SYS_STS_BUF_MASK_TRIG, 0, HW_POLL_TIMEOUT_US, hw->verbose);
   // Check that trigger counter is reset to 0 and the trigger buffer is empty
   uint32_t trig_count = sys_sts_get_trig_count(&hw->sys_sts, hw->verbose);
   uint32_t trig_cmd_fifo_sts = sys_sts_get_trig_cmd_fifo_status(&hw->sys_sts, hw->verbose);
@@ -448,7 +543,8 @@ int hw_set_trigger_lockout(hw_t *hw, double trigger_lockout_ms) {
   }
   uint32_t lockout_cycles = (uint32_t)(lockout_cycles_double + 0.5); // Round to nearest integer
   trigger_cmd_set_lockout(&hw->trigger_ctrl, lockout_cycles, hw->verbose);
-  HW_SLEEP; // Sleep to allow hardware to process command
+  // Wait for the command to be consumed
+  sys_sts_wait_for_fifos_empty(&hw->sys_sts, SYS_STS_BUF_MASK_TRIG, 0, HW_POLL_TIMEOUT_US, hw->verbose);
   // Check that the trigger buffer is empty
   uint32_t trig_cmd_fifo_sts = sys_sts_get_trig_cmd_fifo_status(&hw->sys_sts, hw->verbose);
   if (!FIFO_STS_EMPTY(trig_cmd_fifo_sts)) {
@@ -546,8 +642,7 @@ int hw_calibrate(hw_t *hw) {
           }
 
           uint32_t adc_word = adc_read_word(&hw->adc_ctrl, (uint8_t)board);
-          uint16_t adc_reading_raw = (uint16_t)(adc_word & 0xFFFF);
-          int16_t adc_reading = adc_reading_raw < 32768 ? adc_reading_raw : adc_reading_raw - 65536; // Convert to signed
+          int16_t adc_reading = adc_word_sample_lo(adc_word);
           double adc_value = (double)adc_reading;
 
           if (hw->verbose && avg < 3) {  // Only show first few readings to avoid spam
@@ -773,11 +868,18 @@ int hw_zero_dacs(hw_t *hw) {
     return 0;
   }
   hw_clear_dac_buffers(hw);
+  uint32_t counts_before[SHIM_MAX_BOARDS] = {0};
+  uint32_t cmds_sent[SHIM_MAX_BOARDS] = {0};
+  hw_dac_cmd_counts(hw, counts_before);
   for (uint32_t ch = 0; ch < hw->channel_count; ch++) {
     uint8_t board = ch / 8;
     dac_cmd_zero(&hw->dac_ctrl, board, hw->verbose);
+    cmds_sent[board]++;
+  }
+  // Wait for the zero commands to be executed
+  if (hw_wait_for_dac_cmds(hw, counts_before, cmds_sent) != 0) {
+    return -1;
   }
-  HW_SLEEP; // Sleep to allow hardware to process zero commands
   // Check that all DAC FIFOs are empty
   uint32_t board_count = (hw->channel_count - 1) / 8 + 1;
   for (uint32_t board = 0; board < board_count; board++) {
@@ -828,9 +930,7 @@ int hw_read_adc_channel(hw_t *hw, uint32_t channel, double *adc_value_amps) {
 
   // Read ADC value from FIFO
   uint32_t adc_word = adc_read_word(&hw->adc_ctrl, board);
-  uint16_t adc_reading_raw = (uint16_t)(adc_word & 0xFFFF);
-  int16_t adc_reading = adc_reading_raw <= 32767 ? (int16_t)adc_reading_raw : (int16_t)(adc_reading_raw - 65536);
-  *adc_value_amps = HW_MAX_ABS_AMPS * ((double)adc_reading) / 32767.0;
+  *adc_value_amps = adc_convert_amps(&hw->adc_convert, (int)channel, adc_word_sample_lo(adc_word));
 
   return 0;
 }
@@ -845,13 +945,31 @@ int hw_read_adcs(hw_t *hw, double *adc_values_amps) {
     fprintf(stderr, "Error: cannot read ADCs because hardware is not running.\n");
     return -1;
   }
-  hw_clear_adc_buffers(hw);
   uint32_t board_count = (hw->channel_count - 1) / 8 + 1;
+  // A completed read leaves every ADC FIFO empty, so only pulse the buffer resets to clear leftovers
+  bool adc_leftovers = false;
+  for (uint8_t board = 0; board < board_count; board++) {
+    if (!FIFO_STS_EMPTY(sys_sts_get_adc_cmd_fifo_status(&hw->sys_sts, board, false)) ||
+        !FIFO_STS_EMPTY(sys_sts_get_adc_data_fifo_status(&hw->sys_sts, board, false))) {
+      adc_leftovers = true;
+      break;
+    }
+  }
+  if (adc_leftovers && hw_clear_adc_buffers(hw) != 0) {
+    return -1;
+  }
   for (uint8_t board = 0; board < board_count; board++) {
     adc_cmd_adc_rd(&hw->adc_ctrl, board, ADC_TRIGGER_WAIT, ADC_NO_CONTINUE, 0, 0, hw->verbose);
   }
 
-  HW_SLEEP; // Sleep to allow hardware to process ADC read commands
+  // Wait for each board's read to land (4 words), bounded by the poll timeout
+  uint64_t start_us = hw_time_us();
+  for (uint8_t board = 0; board < board_count; board++) {
+    while (FIFO_STS_WORD_COUNT(sys_sts_get_adc_data_fifo_status(&hw->sys_sts, board, false)) < 4 &&
+           hw_time_us() - start_us < HW_POLL_TIMEOUT_US) {
+      usleep(SYS_STS_POLL_INTERVAL_US);
+    }
+  }
 
   // Expect 4 words in each ADC data FIFO
   for (uint8_t board = 0; board < board_count; board++) {
@@ -863,24 +981,14 @@ int hw_read_adcs(hw_t *hw, double *adc_values_amps) {
     }
   }
 
-  // Read ADC values from FIFOs, 4 pairs per included board.
-  uint32_t channel_index = 0;
+  // Read ADC values from FIFOs, one 8-channel frame (4 pairs) per included board
   for (uint32_t board = 0; board < board_count; board++) {
-    for (uint32_t pair = 0; pair < 4; pair++) {
-      uint32_t adc_pair_word = adc_read_word(&hw->adc_ctrl, board);
-      uint16_t raw = (uint16_t)(adc_pair_word & 0xFFFF);
-      int16_t adc_val_ch_1 = (raw <= 32767) ? (int16_t)raw : (int16_t)(raw - 65536);
-      raw = (uint16_t)((adc_pair_word >> 16) & 0xFFFF);
-      int16_t adc_val_ch_2 = (raw <= 32767) ? (int16_t)raw : (int16_t)(raw - 65536);
-
-      if (channel_index < hw->channel_count) {
-        double adc_val_ch_1_amps = HW_MAX_ABS_AMPS * ((double)adc_val_ch_1) / 32767.0;
-        adc_values_amps[channel_index++] = adc_val_ch_1_amps;
-      }
-      if (channel_index < hw->channel_count) {
-        double adc_val_ch_2_amps = HW_MAX_ABS_AMPS * ((double)adc_val_ch_2) / 32767.0;
-        adc_values_amps[channel_index++] = adc_val_ch_2_amps;
-      }
+    uint32_t frame[ADC_CONVERT_FRAME_WORDS];
+    float frame_amps[ADC_CONVERT_FRAME_CHANNELS];
+    adc_read_words(&hw->adc_ctrl, (uint8_t)board, frame, ADC_CONVERT_FRAME_WORDS);
+    adc_convert_frame_amps(&hw->adc_convert, (int)(board * 8), frame, frame_amps);
+    for (uint32_t ch = 0; ch < ADC_CONVERT_FRAME_CHANNELS && board * 8 + ch < hw->channel_count; ch++) {
+      adc_values_amps[board * 8 + ch] = frame_amps[ch];
     }
   }
   
@@ -923,9 +1031,16 @@ int hw_set_dac_channel(hw_t *hw, uint32_t channel, double value_amps) {
   int16_t dac_value = (int16_t)((value_amps / HW_MAX_ABS_AMPS) * 32767.0);
   
   // Send DAC set channel command
+  uint32_t counts_before[SHIM_MAX_BOARDS] = {0};
+  uint32_t cmds_sent[SHIM_MAX_BOARDS] = {0};
+  hw_dac_cmd_counts(hw, counts_before);
   dac_cmd_dac_wr_ch(&hw->dac_ctrl, board, ch_in_board, dac_value, hw->verbose);
+  cmds_sent[board] = 1;
 
-  HW_SLEEP; // Sleep to allow hardware to process DAC command
+  // Wait for the DAC command to be executed
+  if (hw_wait_for_dac_cmds(hw, counts_before, cmds_sent) != 0) {
+    return -1;
+  }
 
   // Check that the DAC command FIFO is empty
   uint32_t dac_cmd_fifo_status = sys_sts_get_dac_cmd_fifo_status(&hw->sys_sts, board, hw->verbose);
@@ -952,8 +1067,21 @@ int hw_set_dacs(hw_t *hw, const double *amps) {
   // Reset triggers
   hw_reset_triggers(hw);
 
+  return hw_write_dacs(hw, amps);
+}
+
+// Write DAC values to all channels immediately, without clearing buffers or resetting triggers
+// (buffer is HW_MAX_CHANNELS in length and indexed by channel number)
+int hw_write_dacs(hw_t *hw, const double *amps) {
+  if (hw == NULL || amps == NULL) {
+    return -1;
+  }
+
   // Send DAC set all channels commands board by board
   uint32_t board_count = (hw->channel_count - 1) / 8 + 1;
+  uint32_t counts_before[SHIM_MAX_BOARDS] = {0};
+  uint32_t cmds_sent[SHIM_MAX_BOARDS] = {0};
+  hw_dac_cmd_counts(hw, counts_before);
   for (uint8_t board = 0; board < board_count; board++) {
     int16_t dac_values[8] = {0}; // Default to 0 for all channels
 
@@ -972,9 +1100,13 @@ int hw_set_dacs(hw_t *hw, const double *amps) {
 
     // Send DAC set all channels command for this board
     dac_cmd_dac_wr(&hw->dac_ctrl, board, dac_values, DAC_TRIGGER_WAIT, DAC_NO_CONTINUE, DAC_LDAC, 0, hw->verbose);
+    cmds_sent[board] = 1;
   }
 
-  HW_SLEEP; // Sleep to allow hardware to process DAC commands
+  // Wait for the DAC commands to be executed
+  if (hw_wait_for_dac_cmds(hw, counts_before, cmds_sent) != 0) {
+    return -1;
+  }
   // Check that all DAC command FIFOs are empty
   for (uint8_t board = 0; board < board_count; board++) {
     uint32_t dac_cmd_fifo_status = sys_sts_get_dac_cmd_fifo_status(&hw->sys_sts, board, hw->verbose);
@@ -418,6 +418,44 @@ static bool parse_trigger(parsed_command_t *out, parse_state_t *state) {
   return true;
 }
 
+// -- Regulation --
+
+// Parse G [f] [kp ki] (closed-loop regulation at f Hz, G 0 stops).
+static bool parse_regulate(parsed_command_t *out, parse_state_t *state) {
+  if (!(state->token[1] == '\0' && cmd_match(state->token[0], 'G'))) {
+    return false;
+  }
+  out->type = CMD_REGULATE;
+  out->regulate_rate_hz = REGULATOR_DEFAULT_RATE_HZ;
+  out->regulate_kp = REGULATOR_DEFAULT_KP;
+  out->regulate_ki = REGULATOR_DEFAULT_KI;
+
+  char *rate_token = next_token(&state->cursor);
+  if (rate_token == NULL) {
+    return true;
+  }
+  if (!parse_double(rate_token, &out->regulate_rate_hz) ||
+      out->regulate_rate_hz < 0.0 || out->regulate_rate_hz > REGULATOR_MAX_RATE_HZ) {
+    command_error(state->error_buf, state->error_buf_size, "G f requires a rate in Hz from 0 (stop) to 2000");
+    return true;
+  }
+
+  char *kp_token = next_token(&state->cursor);
+  if (kp_token == NULL) {
+    return true;
+  }
+  char *ki_token = next_token(&state->cursor);
+  if (ki_token == NULL || !parse_double(kp_token, &out->regulate_kp) || !parse_double(ki_token, &out->regulate_ki) ||
+      out->regulate_kp < 0.0 || out->regulate_ki < 0.0) {
+    command_error(state->error_buf, state->error_buf_size, "G f kp ki requires non-negative numeric gains");
+    return true;
+  }
+  if (next_token(&state->cursor) != NULL) {
+    command_error(state->error_buf, state->error_buf_size, "G accepts at most three arguments: f kp ki");
+  }
+  return true;
+}
+
 // Parse one input line into a command and argument payload.
 input_parse_result_t input_parse_line(const char *line,
                                   parsed_command_t *out,
@@ -439,6 +477,9 @@ input_parse_result_t input_parse_line(const char *line,
   out->trigger_count = 0;
   out->file_path[0] = '\0';
   out->trigger_lockout_ms = 0.0;
+  out->regulate_rate_hz = 0.0;
+  out->regulate_kp = 0.0;
+  out->regulate_ki = 0.0;
 
   if (line == NULL) {
     command_error(error_buf, error_buf_size, "empty command");
@@ -491,6 +532,7 @@ input_parse_result_t input_parse_line(const char *line,
     parse_exit_file,
     parse_reset,
     parse_trigger,
+    parse_regulate,
   };
 
   for (size_t i = 0; i < (sizeof(parsers) / sizeof(parsers[0])); ++i) {
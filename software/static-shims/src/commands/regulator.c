@@ -0,0 +1,325 @@
+#include "regulator.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "rt_sched.h"
+#include "timing.h"
+
+// Upper bin edges in microseconds (the last bin is open-ended)
+static const double hist_edges_us[REGULATOR_HIST_BINS - 1] = {
+  10.0, 20.0, 50.0, 100.0, 200.0, 500.0, 1000.0, 2000.0, 5000.0
+};
+
+// ---------------------------------------------------------------------------
+// Internal helpers
+// ---------------------------------------------------------------------------
+
+static void hist_print(const char *name, const timing_hist_t *hist) {
+  if (hist->count == 0) {
+    printf("  %s: no samples\n", name);
+    return;
+  }
+  printf("  %s: min %.1f us, mean %.1f us, max %.1f us\n", name,
+         hist->min_us, timing_hist_mean_us(hist), hist->max_us);
+  timing_hist_print_bins(hist);
+}
+
+static bool regulator_should_stop(regulator_t *reg) {
+  pthread_mutex_lock(&reg->mutex);
+  bool stop = reg->stop_requested;
+  pthread_mutex_unlock(&reg->mutex);
+  return stop;
+}
+
+static void timespec_from_ns(struct timespec *ts, uint64_t ns) {
+  ts->tv_sec = (time_t)(ns / 1000000000ULL);
+  ts->tv_nsec = (long)(ns % 1000000000ULL);
+}
+
+// ---------------------------------------------------------------------------
+// Regulator thread
+// ---------------------------------------------------------------------------
+
+static void *regulator_thread_fn(void *arg) {
+  regulator_t *reg = (regulator_t *)arg;
+  hw_t *hw = reg->hw;
+  uint32_t channel_count = hw->channel_count;
+  rt_sched_thread_enter(RT_CLASS_CONTROL, "Regulator", -1);
+
+  pthread_mutex_lock(&reg->mutex);
+  double rate_hz = reg->stats.rate_hz;
+  double kp = reg->stats.kp;
+  double ki = reg->stats.ki;
+  pthread_mutex_unlock(&reg->mutex);
+
+  uint64_t period_ns = (uint64_t)(1e9 / rate_hz);
+  uint64_t start_ns = timing_now_ns();
+  uint64_t deadline_ns = start_ns;
+  uint64_t last_ns = start_ns;
+  regulator_status_t exit_status = REGULATOR_STOPPED;
+
+  double setpoint[HW_MAX_CHANNELS];
+  double readback[HW_MAX_CHANNELS];
+  double output[HW_MAX_CHANNELS];
+
+  while (!regulator_should_stop(reg)) {
+    // Sleep until the next absolute deadline so scheduling error doesn't accumulate
+    deadline_ns += period_ns;
+    struct timespec deadline;
+    timespec_from_ns(&deadline, deadline_ns);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {}
+
+    uint64_t wake_ns = timing_now_ns();
+    rt_sched_loop_tick();
+    double late_us = (wake_ns > deadline_ns) ? (double)(wake_ns - deadline_ns) * 1e-3 : 0.0;
+    bool overrun = false;
+    if (wake_ns > deadline_ns + period_ns) {
+      // Missed at least a whole period; restart the schedule from now instead of bursting to catch up
+      overrun = true;
+      deadline_ns = wake_ns;
+    }
+    double dt = (double)(wake_ns - last_ns) * 1e-9;
+    last_ns = wake_ns;
+
+    pthread_mutex_lock(&reg->mutex);
+    memcpy(setpoint, reg->stats.setpoint_amps, sizeof(setpoint));
+    pthread_mutex_unlock(&reg->mutex);
+
+    if (hw_read_adcs(hw, readback) != 0) {
+      fprintf(stderr, "Regulator: failed to read ADC values, stopping regulation.\n");
+      exit_status = REGULATOR_ERROR;
+      break;
+    }
+
+    for (uint32_t ch = 0; ch < channel_count; ch++) {
+      double error = setpoint[ch] - readback[ch];
+      double integral = reg->integral[ch] + error * dt;
+      double out = setpoint[ch] + kp * error + ki * integral;
+      if (out > HW_MAX_ABS_AMPS) {
+        out = HW_MAX_ABS_AMPS;
+      } else if (out < -HW_MAX_ABS_AMPS) {
+        out = -HW_MAX_ABS_AMPS;
+      } else {
+        reg->integral[ch] = integral; // Only integrate while the output is not saturated
+      }
+      output[ch] = out;
+    }
+
+    if (hw_write_dacs(hw, output) != 0) {
+      fprintf(stderr, "Regulator: failed to write DAC values, stopping regulation.\n");
+      exit_status = REGULATOR_ERROR;
+      break;
+    }
+    uint64_t done_ns = timing_now_ns();
+
+    pthread_mutex_lock(&reg->mutex);
+    reg->stats.iterations++;
+    if (overrun) reg->stats.overruns++;
+    reg->stats.elapsed_s = (double)(done_ns - start_ns) * 1e-9;
+    timing_hist_add(&reg->stats.latency, (double)(done_ns - wake_ns) * 1e-3);
+    timing_hist_add(&reg->stats.jitter, late_us);
+    memcpy(reg->stats.readback_amps, readback, sizeof(readback));
+    memcpy(reg->stats.output_amps, output, sizeof(output));
+    pthread_mutex_unlock(&reg->mutex);
+  }
+
+  pthread_mutex_lock(&reg->mutex);
+  reg->stats.status = exit_status;
+  pthread_mutex_unlock(&reg->mutex);
+  if (reg->verbose) {
+    printf("Regulator: thread exiting.\n");
+  }
+  return NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+
+// Initialize the regulator struct and its mutex.
+regulator_t regulator_init(hw_t *hw, bool verbose) {
+  regulator_t reg;
+  memset(&reg, 0, sizeof(reg));
+
+  reg.hw      = hw;
+  reg.verbose = verbose;
+
+  if (pthread_mutex_init(&(reg.mutex), NULL) != 0) {
+    fprintf(stderr, "Regulator: failed to initialize mutex.\n");
+    exit(1);
+  }
+  reg.stop_requested = false;
+  reg.started        = false;
+  reg.stats.status   = REGULATOR_STOPPED;
+
+  return reg;
+}
+
+// Destroy the regulator's mutex.
+void regulator_destroy(regulator_t *reg) {
+  if (reg == NULL) {
+    return;
+  }
+  pthread_mutex_destroy(&reg->mutex);
+}
+
+// Start regulating to the given setpoints
+int regulator_start(regulator_t *reg, const double *setpoint_amps, double rate_hz, double kp, double ki) {
+  if (reg == NULL || reg->hw == NULL || setpoint_amps == NULL) {
+    return -1;
+  }
+  if (!(rate_hz > 0.0) || rate_hz > REGULATOR_MAX_RATE_HZ) {
+    fprintf(stderr, "Regulator: rate %.1f Hz is out of range (0 to %.0f Hz).\n", rate_hz, REGULATOR_MAX_RATE_HZ);
+    return -1;
+  }
+  if (kp < 0.0 || ki < 0.0) {
+    fprintf(stderr, "Regulator: gains must be non-negative.\n");
+    return -1;
+  }
+  for (uint32_t ch = 0; ch < reg->hw->channel_count; ch++) {
+    if (setpoint_amps[ch] > HW_MAX_ABS_AMPS || setpoint_amps[ch] < -HW_MAX_ABS_AMPS) {
+      fprintf(stderr, "Regulator: setpoint %.3f A for channel %u is out of range (valid range is -%.1f to %.1f amps).\n", setpoint_amps[ch], ch, HW_MAX_ABS_AMPS, HW_MAX_ABS_AMPS);
+      return -1;
+    }
+  }
+
+  pthread_mutex_lock(&reg->mutex);
+  if (reg->started) {
+    // Caller must regulator_stop() before starting again
+    pthread_mutex_unlock(&reg->mutex);
+    return -1;
+  }
+  reg->stop_requested = false;
+  memset(&reg->stats, 0, sizeof(reg->stats));
+  timing_hist_init(&reg->stats.latency, hist_edges_us, REGULATOR_HIST_BINS);
+  timing_hist_init(&reg->stats.jitter, hist_edges_us, REGULATOR_HIST_BINS);
+  reg->stats.status = REGULATOR_RUNNING;
+  reg->stats.rate_hz = rate_hz;
+  reg->stats.kp = kp;
+  reg->stats.ki = ki;
+  memcpy(reg->stats.setpoint_amps, setpoint_amps, sizeof(reg->stats.setpoint_amps));
+  memset(reg->integral, 0, sizeof(reg->integral));
+  pthread_mutex_unlock(&reg->mutex);
+
+  if (pthread_create(&reg->thread, NULL, regulator_thread_fn, reg) != 0) {
+    fprintf(stderr, "Regulator: failed to create thread.\n");
+    pthread_mutex_lock(&reg->mutex);
+    reg->stats.status = REGULATOR_STOPPED;
+    pthread_mutex_unlock(&reg->mutex);
+    return -1;
+  }
+
+  pthread_mutex_lock(&reg->mutex);
+  reg->started = true;
+  pthread_mutex_unlock(&reg->mutex);
+  return 0;
+}
+
+// Change one channel's setpoint while regulating
+int regulator_set_setpoint(regulator_t *reg, uint32_t channel, double amps) {
+  if (reg == NULL || reg->hw == NULL || channel >= reg->hw->channel_count) {
+    return -1;
+  }
+  if (amps > HW_MAX_ABS_AMPS || amps < -HW_MAX_ABS_AMPS) {
+    fprintf(stderr, "Regulator: setpoint %.3f A for channel %u is out of range (valid range is -%.1f to %.1f amps).\n", amps, channel, HW_MAX_ABS_AMPS, HW_MAX_ABS_AMPS);
+    return -1;
+  }
+  pthread_mutex_lock(&reg->mutex);
+  reg->stats.setpoint_amps[channel] = amps;
+  pthread_mutex_unlock(&reg->mutex);
+  return 0;
+}
+
+// Change all setpoints while regulating
+int regulator_set_setpoints(regulator_t *reg, const double *setpoint_amps) {
+  if (reg == NULL || reg->hw == NULL || setpoint_amps == NULL) {
+    return -1;
+  }
+  for (uint32_t ch = 0; ch < reg->hw->channel_count; ch++) {
+    if (setpoint_amps[ch] > HW_MAX_ABS_AMPS || setpoint_amps[ch] < -HW_MAX_ABS_AMPS) {
+      fprintf(stderr, "Regulator: setpoint %.3f A for channel %u is out of range (valid range is -%.1f to %.1f amps).\n", setpoint_amps[ch], ch, HW_MAX_ABS_AMPS, HW_MAX_ABS_AMPS);
+      return -1;
+    }
+  }
+  pthread_mutex_lock(&reg->mutex);
+  memcpy(reg->stats.setpoint_amps, setpoint_amps, sizeof(double) * reg->hw->channel_count);
+  pthread_mutex_unlock(&reg->mutex);
+  return 0;
+}
+
+// Stop the regulator thread and wait for it to exit
+void regulator_stop(regulator_t *reg, regulator_status_t *status_out) {
+  if (reg == NULL) {
+    return;
+  }
+
+  pthread_mutex_lock(&reg->mutex);
+  reg->stop_requested = true;
+  bool was_started = reg->started;
+  pthread_mutex_unlock(&reg->mutex);
+
+  if (was_started) {
+    pthread_join(reg->thread, NULL);
+    pthread_mutex_lock(&reg->mutex);
+    reg->started = false;
+    pthread_mutex_unlock(&reg->mutex);
+  }
+  if (status_out != NULL) {
+    *status_out = regulator_get_status(reg);
+  }
+}
+
+// Read the current status without blocking. Thread-safe.
+regulator_status_t regulator_get_status(regulator_t *reg) {
+  if (reg == NULL) {
+    return REGULATOR_ERROR;
+  }
+  pthread_mutex_lock(&reg->mutex);
+  regulator_status_t status = reg->stats.status;
+  pthread_mutex_unlock(&reg->mutex);
+  return status;
+}
+
+// Copy the current state and statistics. Thread-safe.
+void regulator_get_stats(regulator_t *reg, regulator_stats_t *out) {
+  if (reg == NULL || out == NULL) {
+    return;
+  }
+  pthread_mutex_lock(&reg->mutex);
+  *out = reg->stats;
+  pthread_mutex_unlock(&reg->mutex);
+}
+
+// Print loop rate, latency and jitter histograms and per-channel tracking error
+void regulator_print_stats(regulator_t *reg) {
+  if (reg == NULL || reg->hw == NULL) {
+    return;
+  }
+  regulator_stats_t stats;
+  regulator_get_stats(reg, &stats);
+
+  const char *status_name = (stats.status == REGULATOR_RUNNING) ? "running" :
+                            (stats.status == REGULATOR_ERROR) ? "stopped on error" : "stopped";
+  printf("Regulation %s: kp %.3f, ki %.3f /s\n", status_name, stats.kp, stats.ki);
+  double measured_hz = (stats.elapsed_s > 0.0) ? (double)stats.iterations / stats.elapsed_s : 0.0;
+  printf("  Loop rate: %.1f Hz requested, %.1f Hz measured (%" PRIu64 " iterations, %" PRIu64 " overruns)\n",
+         stats.rate_hz, measured_hz, stats.iterations, stats.overruns);
+  hist_print("Latency (ADC read to DAC write)", &stats.latency);
+  hist_print("Jitter (wake-up past deadline)", &stats.jitter);
+
+  if (stats.iterations == 0) {
+    return;
+  }
+  double amps_per_lsb = HW_MAX_ABS_AMPS / 32767.0;
+  printf("  Channel   Setpoint   Readback     Output   Error (LSB)\n");
+  for (uint32_t ch = 0; ch < reg->hw->channel_count; ch++) {
+    double error_lsb = (stats.setpoint_amps[ch] - stats.readback_amps[ch]) / amps_per_lsb;
+    printf("  %7u  %+8.4f A %+8.4f A %+8.4f A   %+9.1f\n", ch,
+           stats.setpoint_amps[ch], stats.readback_amps[ch], stats.output_amps[ch], error_lsb);
+  }
+}
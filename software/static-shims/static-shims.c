@@ -7,6 +7,7 @@
 #include "hardware.h"
 #include "commands.h"
 #include "input.h"
+#include "rt_sched.h"
 
 // Global pointer to hardware state so the signal handler can reach it
 static hw_t *g_hw = NULL;
@@ -24,23 +25,26 @@ static void handle_sigint(int sig) {
 // Entry point for interactive static-shims command interface
 int main(int argc, char **argv) {
   bool verbose = false;
+  bool realtime = false;
   const char *channel_count_arg = NULL;
 
-  // Capture verbose flag and channel count argument
+  // Capture verbose and real-time flags and channel count argument
   for (int i = 1; i < argc; i++) {
     if (strcmp(argv[i], "--verbose") == 0) {
       verbose = true;
+    } else if (strcmp(argv[i], "--rt") == 0) {
+      realtime = true;
     } else if (channel_count_arg == NULL) {
       channel_count_arg = argv[i];
     } else {
-      fprintf(stderr, "Usage: %s [--verbose] <channel_count>\n", argv[0]);
+      fprintf(stderr, "Usage: %s [--verbose] [--rt] <channel_count>\n", argv[0]);
       return 1;
     }
   }
 
   // Validate channel count argument
   if (channel_count_arg == NULL) {
-    fprintf(stderr, "Usage: %s [--verbose] <channel_count>\n", argv[0]);
+    fprintf(stderr, "Usage: %s [--verbose] [--rt] <channel_count>\n", argv[0]);
     return 1;
   }
 
@@ -58,6 +62,11 @@ int main(int argc, char **argv) {
     return 1;
   }
 
+  // Real-time profile: the regulator and file loader threads run SCHED_FIFO on their own core
+  if (realtime && rt_sched_enable(RT_SCHED_DEFAULT_FIFO_CPU, RT_SCHED_DEFAULT_IO_CPU, verbose) != 0) {
+    fprintf(stderr, "Warning: continuing without the real-time profile.\n");
+  }
+
   // Register Ctrl+C handler before touching hardware
   signal(SIGINT, handle_sigint);
 
@@ -70,6 +79,7 @@ int main(int argc, char **argv) {
     hw_power_off(&hw);
     return 1;
   }
+  hw_profile_print(&hw, "Boot to prompt");
 
   shim_runtime_state_t state = commands_init_state(&hw, verbose);
 